@@ -2,65 +2,196 @@
 #include "FileWatcher.h"
 #include <utils/winapi_error.h>
 
-std::optional<FILETIME> FileWatcher::MyFileTime()
+#include <algorithm>
+#include <map>
+#include <vector>
+
+namespace
 {
-    HANDLE hFile = CreateFileW(m_path.c_str(), FILE_READ_ATTRIBUTES, FILE_SHARE_DELETE | FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, 0, nullptr);
-    std::optional<FILETIME> result;
-    if (hFile != INVALID_HANDLE_VALUE)
+    std::wstring to_lower(std::wstring str)
+    {
+        std::transform(str.begin(), str.end(), str.begin(), ::towlower);
+        return str;
+    }
+}
+
+// One change reader per watched directory, dispatching the changes to the watchers of the changed file.
+// Lives while there are watchers.
+class DirectoryWatchers
+{
+public:
+    static std::shared_ptr<DirectoryWatchers> instance()
+    {
+        static std::mutex mutex;
+        static std::weak_ptr<DirectoryWatchers> current;
+
+        std::unique_lock lock(mutex);
+        auto result = current.lock();
+        if (!result)
+        {
+            result = std::make_shared<DirectoryWatchers>();
+            current = result;
+        }
+
+        return result;
+    }
+
+    void Subscribe(FileWatcher* watcher)
+    {
+        std::unique_lock lock(m_mutex);
+
+        auto& directory = m_directories[watcher->m_directory];
+        if (directory.watchers.empty())
+        {
+            directory.reader = wil::make_folder_change_reader_nothrow(
+                watcher->m_directory.c_str(),
+                false,
+                wil::FolderChangeEvents::LastWriteTime,
+                [this, key = watcher->m_directory](wil::FolderChangeEvent, PCWSTR fileName) {
+                    OnChange(key, fileName);
+                });
+
+            if (!directory.reader)
+            {
+                Logger::error(L"Failed to start folder change reader for path {}. {}", watcher->m_path, get_last_error_or_default(GetLastError()));
+            }
+        }
+
+        directory.watchers.push_back(watcher);
+    }
+
+    // No change of the file is passed to the watcher once this returns
+    void Unsubscribe(FileWatcher* watcher)
+    {
+        wil::unique_folder_change_reader_nothrow reader;
+        {
+            std::unique_lock lock(m_mutex);
+
+            auto directory = m_directories.find(watcher->m_directory);
+            if (directory == m_directories.end())
+            {
+                return;
+            }
+
+            auto& watchers = directory->second.watchers;
+            watchers.erase(std::remove(watchers.begin(), watchers.end(), watcher), watchers.end());
+            if (watchers.empty())
+            {
+                reader = std::move(directory->second.reader);
+                m_directories.erase(directory);
+            }
+        }
+
+        // Waits for the running callbacks, which need the lock
+        reader.reset();
+    }
+
+private:
+    struct Directory
+    {
+        wil::unique_folder_change_reader_nothrow reader;
+        std::vector<FileWatcher*> watchers;
+    };
+
+    std::mutex m_mutex;
+    // By lowercase directory path
+    std::map<std::wstring, Directory> m_directories;
+
+    void OnChange(const std::wstring& directoryPath, PCWSTR fileName)
     {
-        FILETIME lastWrite;
-        if (GetFileTime(hFile, nullptr, nullptr, &lastWrite))
+        const auto lowerFileName = to_lower(fileName);
+
+        std::unique_lock lock(m_mutex);
+        auto directory = m_directories.find(directoryPath);
+        if (directory == m_directories.end())
         {
-            result = lastWrite;
+            return;
         }
 
-        CloseHandle(hFile);
+        for (auto* watcher : directory->second.watchers)
+        {
+            if (watcher->m_file_name == lowerFileName)
+            {
+                watcher->OnChange();
+            }
+        }
+    }
+};
+
+bool FileWatcher::FileIdentity::operator==(const FileIdentity& other) const
+{
+    return CompareFileTime(&lastWrite, &other.lastWrite) == 0 && size == other.size;
+}
+
+std::optional<FileWatcher::FileIdentity> FileWatcher::MyFileIdentity()
+{
+    // Doesn't open the file
+    WIN32_FILE_ATTRIBUTE_DATA data;
+    if (!GetFileAttributesExW(m_path.c_str(), GetFileExInfoStandard, &data))
+    {
+        return std::nullopt;
     }
 
-    return result;
+    return FileIdentity{ data.ftLastWriteTime, (static_cast<ULONGLONG>(data.nFileSizeHigh) << 32) | data.nFileSizeLow };
 }
 
-FileWatcher::FileWatcher(const std::wstring& path, std::function<void()> callback) :
+FileWatcher::FileWatcher(const std::wstring& path, std::function<void()> callback, std::chrono::milliseconds debounce) :
     m_path(path),
+    m_debounce(debounce),
     m_callback(callback)
 {
     std::filesystem::path fsPath(path);
-    m_file_name = fsPath.filename();
-    std::transform(m_file_name.begin(), m_file_name.end(), m_file_name.begin(), ::towlower);
-    m_folder_change_reader = wil::make_folder_change_reader_nothrow(
-        fsPath.parent_path().c_str(),
-        false,
-        wil::FolderChangeEvents::LastWriteTime,
-        [this](wil::FolderChangeEvent, PCWSTR fileName) {
-            std::wstring lowerFileName(fileName);
-            std::transform(lowerFileName.begin(), lowerFileName.end(), lowerFileName.begin(), ::towlower);
-
-            if (m_file_name.compare(fileName) == 0)
-            {
-                auto lastWrite = MyFileTime();
-                if (!m_lastWrite.has_value())
-                {
-                    m_lastWrite = lastWrite;
-                }
-                else if (lastWrite.has_value())
-                {
-                    if (m_lastWrite->dwHighDateTime != lastWrite->dwHighDateTime ||
-                        m_lastWrite->dwLowDateTime != lastWrite->dwLowDateTime)
-                    {
-                        m_lastWrite = lastWrite;
-                        m_callback();
-                    }
-                }
-            }
-        });
+    m_directory = to_lower(fsPath.parent_path());
+    m_file_name = to_lower(fsPath.filename());
+    m_identity = MyFileIdentity();
 
-    if (!m_folder_change_reader)
+    m_timer.reset(CreateThreadpoolTimer(
+        [](PTP_CALLBACK_INSTANCE, PVOID context, PTP_TIMER) {
+            static_cast<FileWatcher*>(context)->OnDebounced();
+        },
+        this,
+        nullptr));
+    if (!m_timer)
     {
-        Logger::error(L"Failed to start folder change reader for path {}. {}", path, get_last_error_or_default(GetLastError()));
+        Logger::error(L"Failed to create the timer of the file watcher for path {}. {}", path, get_last_error_or_default(GetLastError()));
+        return;
     }
+
+    m_directoryWatchers = DirectoryWatchers::instance();
+    m_directoryWatchers->Subscribe(this);
 }
 
 FileWatcher::~FileWatcher()
 {
-    m_folder_change_reader.reset();
+    if (m_directoryWatchers)
+    {
+        m_directoryWatchers->Unsubscribe(this);
+    }
+
+    // Cancels the pending callback and waits for the running one
+    m_timer.reset();
+}
+
+void FileWatcher::OnChange()
+{
+    // Pushes the callback back while the changes keep coming
+    // Negative for a time relative to now, in 100 ns units
+    ULARGE_INTEGER relativeTime;
+    relativeTime.QuadPart = static_cast<ULONGLONG>(-10000LL * m_debounce.count());
+    FILETIME dueTime{ relativeTime.LowPart, relativeTime.HighPart };
+    SetThreadpoolTimer(m_timer.get(), &dueTime, 0, 0);
+}
+
+void FileWatcher::OnDebounced()
+{
+    std::unique_lock lock(m_callbackMutex);
+
+    auto identity = MyFileIdentity();
+    if (!identity.has_value() || identity == m_identity)
+    {
+        return;
+    }
+
+    m_identity = identity;
+    m_callback();
 }
@@ -4,21 +4,57 @@
 #define NOMINMAX
 #include <Windows.h>
 
+#include <wil/resource.h>
+
+#include <chrono>
+#include <memory>
+#include <mutex>
 #include <thread>
 #include <optional>
 #include <string>
 #include <functional>
 
+class DirectoryWatchers;
+
+// Calls the callback when the file was written. The watchers of the files of a directory share one change reader.
+// The callback is called once a burst of changes is over, i.e. after no change was seen for the debounce time.
 class FileWatcher
 {
+public:
+    constexpr static std::chrono::milliseconds DefaultDebounce{ 100 };
+
+    FileWatcher(const std::wstring& path, std::function<void()> callback, std::chrono::milliseconds debounce = DefaultDebounce);
+    ~FileWatcher();
+
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+private:
+    friend class DirectoryWatchers;
+
+    struct FileIdentity
+    {
+        FILETIME lastWrite;
+        ULONGLONG size;
+
+        bool operator==(const FileIdentity& other) const;
+    };
+
     std::wstring m_path;
+    std::wstring m_directory;
     std::wstring m_file_name;
-    std::optional<FILETIME> m_lastWrite;
+    std::chrono::milliseconds m_debounce;
     std::function<void()> m_callback;
-    wil::unique_folder_change_reader_nothrow m_folder_change_reader;
 
-    std::optional<FILETIME> MyFileTime();
-public:
-    FileWatcher(const std::wstring& path, std::function<void()> callback);
-    ~FileWatcher();
+    std::mutex m_callbackMutex;
+    std::optional<FileIdentity> m_identity;
+
+    wil::unique_threadpool_timer m_timer;
+    std::shared_ptr<DirectoryWatchers> m_directoryWatchers;
+
+    std::optional<FileIdentity> MyFileIdentity();
+
+    // Called by the directory reader for each change of the file
+    void OnChange();
+    void OnDebounced();
 };
@@ -0,0 +1,258 @@
+#include "pch.h"
+#include <common/logger/async_log_writer.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace std::chrono_literals;
+
+namespace UnitTestsCommonLib
+{
+    namespace
+    {
+        struct Record
+        {
+            int producer = 0;
+            int index = 0;
+        };
+
+        // Collects the written records, and can hold the writer inside a write until it's released
+        struct Output
+        {
+            std::mutex mutex;
+            std::condition_variable condition;
+            std::vector<Record> records;
+            int flushes = 0;
+            bool holding = false;
+            bool held = false;
+
+            AsyncLogWriter<Record>::WriteFunction Write()
+            {
+                return [this](Record& record) {
+                    std::unique_lock lock(mutex);
+                    records.push_back(record);
+                    if (holding)
+                    {
+                        held = true;
+                        condition.notify_all();
+                        condition.wait(lock, [this] { return !holding; });
+                    }
+                    return size_t{ 1 };
+                };
+            }
+
+            AsyncLogWriter<Record>::FlushFunction Flush()
+            {
+                return [this] {
+                    std::unique_lock lock(mutex);
+                    ++flushes;
+                };
+            }
+
+            // Pushes an urgent record, so that the writer picks it up right away, and waits until the writer holds it
+            void Hold(AsyncLogWriter<Record>& writer)
+            {
+                {
+                    std::unique_lock lock(mutex);
+                    holding = true;
+                }
+                writer.Push([](Record& record) { record = Record{ -1, 0 }; }, true);
+
+                std::unique_lock lock(mutex);
+                Assert::IsTrue(condition.wait_for(lock, 5s, [this] { return held; }), L"The writer didn't pick up the record");
+            }
+
+            void Release()
+            {
+                std::unique_lock lock(mutex);
+                holding = false;
+                condition.notify_all();
+            }
+        };
+
+        AsyncLogOptions Options(size_t capacity, AsyncLogOverflow overflow)
+        {
+            AsyncLogOptions options;
+            options.capacity = capacity;
+            options.overflow = overflow;
+            // Nothing is flushed by time while a test runs
+            options.flushInterval = 1h;
+            return options;
+        }
+
+        bool PushRecord(AsyncLogWriter<Record>& writer, int producer, int index)
+        {
+            return writer.Push([=](Record& record) { record = Record{ producer, index }; });
+        }
+    }
+
+    TEST_CLASS (AsyncLogWriterTests)
+    {
+    public:
+        TEST_METHOD (WritesRecordsInOrder)
+        {
+            constexpr int producerCount = 4;
+            constexpr int recordCount = 10000;
+
+            Output output;
+            AsyncLogWriter<Record> writer(Options(64, AsyncLogOverflow::Block), output.Write(), output.Flush());
+
+            std::vector<std::thread> producers;
+            for (int producer = 0; producer < producerCount; ++producer)
+            {
+                producers.emplace_back([&, producer] {
+                    for (int i = 0; i < recordCount; ++i)
+                    {
+                        PushRecord(writer, producer, i);
+                    }
+                });
+            }
+            for (auto& producer : producers)
+            {
+                producer.join();
+            }
+            writer.Stop();
+
+            Assert::AreEqual(static_cast<size_t>(producerCount * recordCount), output.records.size());
+            std::vector<int> nextIndex(producerCount, 0);
+            for (const auto& record : output.records)
+            {
+                Assert::AreEqual(nextIndex[record.producer]++, record.index);
+            }
+
+            const auto stats = writer.Stats();
+            Assert::AreEqual(static_cast<uint64_t>(producerCount * recordCount), stats.written);
+            Assert::AreEqual(uint64_t{ 0 }, stats.dropped);
+        }
+
+        TEST_METHOD (DropsRecordsWhenFull)
+        {
+            Output output;
+            AsyncLogWriter<Record> writer(Options(4, AsyncLogOverflow::Drop), output.Write(), output.Flush());
+            output.Hold(writer);
+
+            // The slot of the held record is only freed once it's written, so the ring takes 3 more
+            for (int i = 0; i < 6; ++i)
+            {
+                Assert::AreEqual(i < 3, PushRecord(writer, 0, i));
+            }
+
+            output.Release();
+            writer.Stop();
+
+            const auto stats = writer.Stats();
+            Assert::AreEqual(uint64_t{ 4 }, stats.written);
+            Assert::AreEqual(uint64_t{ 3 }, stats.dropped);
+            Assert::AreEqual(uint64_t{ 0 }, stats.blocked);
+            Assert::AreEqual(size_t{ 4 }, output.records.size());
+            Assert::AreEqual(2, output.records.back().index);
+        }
+
+        TEST_METHOD (BlocksWhenFull)
+        {
+            Output output;
+            AsyncLogWriter<Record> writer(Options(4, AsyncLogOverflow::Block), output.Write(), output.Flush());
+            output.Hold(writer);
+
+            std::atomic<int> pushed = 0;
+            std::thread producer([&] {
+                for (int i = 0; i < 6; ++i)
+                {
+                    PushRecord(writer, 0, i);
+                    ++pushed;
+                }
+            });
+
+            const auto deadline = std::chrono::steady_clock::now() + 5s;
+            while (pushed < 3 && std::chrono::steady_clock::now() < deadline)
+            {
+                std::this_thread::sleep_for(1ms);
+            }
+            std::this_thread::sleep_for(50ms);
+            const int pushedWhileFull = pushed;
+            const uint64_t blockedWhileFull = writer.Stats().blocked;
+
+            output.Release();
+            producer.join();
+            writer.Stop();
+
+            Assert::AreEqual(3, pushedWhileFull);
+            Assert::AreEqual(uint64_t{ 1 }, blockedWhileFull);
+            const auto stats = writer.Stats();
+            Assert::AreEqual(uint64_t{ 7 }, stats.written);
+            Assert::AreEqual(uint64_t{ 0 }, stats.dropped);
+            Assert::AreEqual(uint64_t{ 1 }, stats.blocked);
+        }
+
+        TEST_METHOD (DrainWritesAndFlushesOnTheCallingThread)
+        {
+            Output output;
+            AsyncLogWriter<Record> writer(Options(64, AsyncLogOverflow::Drop), output.Write(), output.Flush());
+            for (int i = 0; i < 3; ++i)
+            {
+                PushRecord(writer, 0, i);
+            }
+
+            writer.Drain();
+
+            std::unique_lock lock(output.mutex);
+            Assert::AreEqual(size_t{ 3 }, output.records.size());
+            Assert::IsTrue(output.flushes >= 1);
+        }
+
+        TEST_METHOD (StopWritesRemainingRecordsAndDropsLaterOnes)
+        {
+            Output output;
+            AsyncLogWriter<Record> writer(Options(64, AsyncLogOverflow::Block), output.Write(), output.Flush());
+            for (int i = 0; i < 10; ++i)
+            {
+                PushRecord(writer, 0, i);
+            }
+
+            writer.Stop();
+            Assert::AreEqual(size_t{ 10 }, output.records.size());
+            Assert::AreEqual(1, output.flushes);
+
+            Assert::IsFalse(PushRecord(writer, 0, 10));
+            const auto stats = writer.Stats();
+            Assert::AreEqual(uint64_t{ 10 }, stats.written);
+            Assert::AreEqual(uint64_t{ 1 }, stats.dropped);
+            Assert::AreEqual(size_t{ 10 }, output.records.size());
+        }
+
+        TEST_METHOD (ThrowingFillDoesNotStallTheWriter)
+        {
+            Output output;
+            AsyncLogWriter<Record> writer(Options(4, AsyncLogOverflow::Block), output.Write(), output.Flush());
+
+            bool thrown = false;
+            try
+            {
+                writer.Push([](Record&) { throw std::runtime_error("fill"); });
+            }
+            catch (const std::runtime_error&)
+            {
+                thrown = true;
+            }
+            Assert::IsTrue(thrown);
+
+            // More records than the ring holds, which would block forever behind an unpublished slot
+            for (int i = 0; i < 10; ++i)
+            {
+                PushRecord(writer, 0, i);
+            }
+            writer.Stop();
+
+            Assert::AreEqual(size_t{ 10 }, output.records.size());
+            const auto stats = writer.Stats();
+            Assert::AreEqual(uint64_t{ 10 }, stats.written);
+            Assert::AreEqual(uint64_t{ 1 }, stats.dropped);
+        }
+    };
+}
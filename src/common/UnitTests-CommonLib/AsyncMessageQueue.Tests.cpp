@@ -0,0 +1,215 @@
+#include "pch.h"
+#include <common/interop/async_message_queue.h>
+
+#include <chrono>
+#include <format>
+#include <thread>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace UnitTestsCommonLib
+{
+    namespace
+    {
+        struct RunResult
+        {
+            bool ordered = true;
+            double nsPerMessage = 0;
+            // Longest time a producer spent in queue_message
+            double maxPushUs = 0;
+        };
+
+        // Pushes messageCount messages from each producer and checks that every message is popped once, and in order
+        // per producer. consumerDelay stalls the consumer after each pop
+        RunResult Run(size_t capacity, int producerCount, int messageCount, bool batch, std::chrono::microseconds consumerDelay = {})
+        {
+            using Clock = std::chrono::steady_clock;
+
+            AsyncMessageQueue queue(capacity);
+            std::vector<double> maxPushUs(producerCount, 0);
+
+            const auto start = Clock::now();
+            std::vector<std::thread> producers;
+            for (int producer = 0; producer < producerCount; ++producer)
+            {
+                producers.emplace_back([&, producer] {
+                    for (int i = 0; i < messageCount; ++i)
+                    {
+                        std::wstring message = std::to_wstring(producer) + L":" + std::to_wstring(i);
+                        const auto pushStart = Clock::now();
+                        queue.queue_message(std::move(message));
+                        const double pushUs = std::chrono::duration<double, std::micro>(Clock::now() - pushStart).count();
+                        maxPushUs[producer] = (std::max)(maxPushUs[producer], pushUs);
+                    }
+                });
+            }
+
+            RunResult result;
+            std::vector<int> nextMessage(producerCount, 0);
+            std::vector<std::wstring> messages;
+            const size_t total = static_cast<size_t>(producerCount) * messageCount;
+            size_t received = 0;
+            while (received < total)
+            {
+                messages.clear();
+                if (batch)
+                {
+                    queue.pop_batch(messages);
+                }
+                else
+                {
+                    messages.push_back(queue.pop_message());
+                }
+                received += messages.size();
+
+                for (const auto& message : messages)
+                {
+                    const auto separator = message.find(L':');
+                    const int producer = std::stoi(message.substr(0, separator));
+                    result.ordered &= nextMessage[producer]++ == std::stoi(message.substr(separator + 1));
+                }
+
+                if (consumerDelay.count() != 0)
+                {
+                    std::this_thread::sleep_for(consumerDelay);
+                }
+            }
+
+            for (auto& producer : producers)
+            {
+                producer.join();
+            }
+
+            result.nsPerMessage = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / total;
+            for (int producer = 0; producer < producerCount; ++producer)
+            {
+                result.ordered &= nextMessage[producer] == messageCount;
+                result.maxPushUs = (std::max)(result.maxPushUs, maxPushUs[producer]);
+            }
+            return result;
+        }
+    }
+
+    TEST_CLASS (AsyncMessageQueueTests)
+    {
+    public:
+        TEST_METHOD (PopsMessagesInOrder)
+        {
+            AsyncMessageQueue queue(4);
+            Assert::IsTrue(queue.queue_message(L"first"));
+            Assert::IsTrue(queue.queue_message(L"second"));
+            Assert::IsTrue(queue.queue_message(L""));
+
+            Assert::AreEqual(std::wstring(L"first"), queue.pop_message());
+            Assert::AreEqual(std::wstring(L"second"), queue.pop_message());
+            Assert::AreEqual(std::wstring(L""), queue.pop_message());
+        }
+
+        TEST_METHOD (PopsBatches)
+        {
+            AsyncMessageQueue queue(8);
+            for (int i = 0; i < 5; ++i)
+            {
+                Assert::IsTrue(queue.queue_message(std::to_wstring(i)));
+            }
+
+            std::vector<std::wstring> messages;
+            Assert::AreEqual(size_t{ 3 }, queue.pop_batch(messages, 3));
+            Assert::AreEqual(size_t{ 2 }, queue.pop_batch(messages));
+            Assert::AreEqual(size_t{ 0 }, queue.pop_batch(messages, 0));
+
+            Assert::AreEqual(size_t{ 5 }, messages.size());
+            for (int i = 0; i < 5; ++i)
+            {
+                Assert::AreEqual(std::to_wstring(i), messages[i]);
+            }
+        }
+
+        TEST_METHOD (InterruptWakesConsumer)
+        {
+            AsyncMessageQueue queue;
+            std::thread interrupter([&] {
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+                queue.interrupt();
+            });
+
+            std::vector<std::wstring> messages;
+            Assert::AreEqual(size_t{ 0 }, queue.pop_batch(messages));
+            Assert::AreEqual(std::wstring(L""), queue.pop_message());
+            interrupter.join();
+        }
+
+        TEST_METHOD (FullQueueSpillsWithoutWaiting)
+        {
+            // Nothing pops the messages, as when the consumer is blocked on the other side of a pipe
+            AsyncMessageQueue queue(2);
+            for (int i = 0; i < 100; ++i)
+            {
+                Assert::IsTrue(queue.queue_message(std::to_wstring(i)));
+            }
+
+            std::vector<std::wstring> messages;
+            Assert::AreEqual(size_t{ 100 }, queue.pop_batch(messages));
+            for (int i = 0; i < 100; ++i)
+            {
+                Assert::AreEqual(std::to_wstring(i), messages[i]);
+            }
+        }
+
+        TEST_METHOD (DropsMessagesAfterInterrupt)
+        {
+            AsyncMessageQueue queue(2);
+            queue.interrupt();
+            Assert::IsFalse(queue.queue_message(L"1"));
+        }
+
+        TEST_METHOD (ManyProducersKeepTheirOrder)
+        {
+            // A small ring, so that messages often spill
+            const auto result = Run(16, 4, 20000, true);
+            Assert::IsTrue(result.ordered);
+        }
+
+        TEST_METHOD (ManyProducersKeepTheirOrderWithTinyRing)
+        {
+            // The ring is full most of the time, so messages spill while other producers are between claiming a slot
+            // and filling it
+            for (int run = 0; run < 10; ++run)
+            {
+                Assert::IsTrue(Run(2, 8, 5000, false).ordered);
+                Assert::IsTrue(Run(2, 8, 5000, true).ordered);
+            }
+        }
+
+        TEST_METHOD (ThroughputBenchmark)
+        {
+            struct Scenario
+            {
+                const wchar_t* name;
+                size_t capacity;
+                int producerCount;
+                int messageCount;
+                bool batch;
+                std::chrono::microseconds consumerDelay;
+            };
+
+            const Scenario scenarios[] = {
+                { L"1 producer, pop_message", 1024, 1, 200000, false, {} },
+                { L"1 producer, pop_batch", 1024, 1, 200000, true, {} },
+                { L"4 producers, pop_message", 1024, 4, 100000, false, {} },
+                { L"4 producers, pop_batch", 1024, 4, 100000, true, {} },
+                { L"4 producers, ring of 16, pop_batch", 16, 4, 100000, true, {} },
+                // As a reader blocked on the other side of a pipe would
+                { L"4 producers, stalled consumer", 16, 4, 2000, false, std::chrono::microseconds(200) },
+            };
+
+            for (const auto& scenario : scenarios)
+            {
+                const auto result = Run(scenario.capacity, scenario.producerCount, scenario.messageCount, scenario.batch, scenario.consumerDelay);
+                Logger::WriteMessage(std::format(L"{}: {:.0f} ns/message, longest push {:.1f} us\n", scenario.name, result.nsPerMessage, result.maxPushUs).c_str());
+                Assert::IsTrue(result.ordered);
+            }
+        }
+    };
+}
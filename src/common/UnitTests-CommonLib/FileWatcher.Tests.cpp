@@ -0,0 +1,126 @@
+#include "pch.h"
+#include <common/SettingsAPI/FileWatcher.h>
+
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace UnitTestsCommonLib
+{
+    TEST_CLASS (FileWatcherTests)
+    {
+        std::filesystem::path m_folder = std::filesystem::temp_directory_path() / L"PowerToysFileWatcherTests";
+
+        std::wstring FilePath(const wchar_t* name) const
+        {
+            return (m_folder / name).wstring();
+        }
+
+        static void Write(const std::wstring& path, int changeCount)
+        {
+            for (int i = 0; i < changeCount; ++i)
+            {
+                std::ofstream file(path, std::ios::app);
+                file << i;
+            }
+        }
+
+        // Waits for the callbacks to come, then for the ones that shouldn't
+        static void WaitForCallbacks(const std::atomic<int>& callbacks, int expected)
+        {
+            for (int i = 0; i < 200 && callbacks < expected; ++i)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(500));
+        }
+
+    public:
+        TEST_METHOD_INITIALIZE(Init)
+        {
+            std::filesystem::create_directories(m_folder);
+            for (auto name : { L"first.json", L"second.json" })
+            {
+                std::ofstream file(FilePath(name));
+            }
+        }
+
+        TEST_METHOD_CLEANUP(CleanUp)
+        {
+            std::error_code error;
+            std::filesystem::remove_all(m_folder, error);
+        }
+
+        TEST_METHOD (ChangeStormIsDeliveredOnce)
+        {
+            std::atomic<int> callbacks = 0;
+            FileWatcher watcher(FilePath(L"first.json"), [&] { callbacks++; }, std::chrono::milliseconds(200));
+
+            Write(FilePath(L"first.json"), 100);
+
+            WaitForCallbacks(callbacks, 1);
+            Assert::AreEqual(1, callbacks.load());
+        }
+
+        TEST_METHOD (SeparateBurstsAreDelivered)
+        {
+            std::atomic<int> callbacks = 0;
+            FileWatcher watcher(FilePath(L"first.json"), [&] { callbacks++; }, std::chrono::milliseconds(50));
+
+            for (int burst = 1; burst <= 3; ++burst)
+            {
+                Write(FilePath(L"first.json"), 10);
+                WaitForCallbacks(callbacks, burst);
+            }
+
+            Assert::AreEqual(3, callbacks.load());
+        }
+
+        TEST_METHOD (ChangesAreDispatchedByFileName)
+        {
+            std::atomic<int> firstCallbacks = 0;
+            std::atomic<int> secondCallbacks = 0;
+            std::atomic<int> otherFirstCallbacks = 0;
+            FileWatcher first(FilePath(L"first.json"), [&] { firstCallbacks++; });
+            FileWatcher second(FilePath(L"second.json"), [&] { secondCallbacks++; });
+            FileWatcher otherFirst(FilePath(L"FIRST.json"), [&] { otherFirstCallbacks++; });
+
+            Write(FilePath(L"first.json"), 50);
+            Write(FilePath(L"unwatched.json"), 50);
+
+            WaitForCallbacks(firstCallbacks, 1);
+            Assert::AreEqual(1, firstCallbacks.load());
+            Assert::AreEqual(1, otherFirstCallbacks.load());
+            Assert::AreEqual(0, secondCallbacks.load());
+        }
+
+        TEST_METHOD (NoCallbackAfterDestruction)
+        {
+            std::atomic<int> callbacks = 0;
+            {
+                FileWatcher watcher(FilePath(L"first.json"), [&] { callbacks++; }, std::chrono::milliseconds(200));
+                Write(FilePath(L"first.json"), 10);
+            }
+
+            WaitForCallbacks(callbacks, 1);
+            Assert::AreEqual(0, callbacks.load());
+        }
+
+        TEST_METHOD (WatcherCanBeRecreated)
+        {
+            std::atomic<int> callbacks = 0;
+            {
+                FileWatcher watcher(FilePath(L"first.json"), [&] { callbacks++; });
+            }
+            FileWatcher watcher(FilePath(L"first.json"), [&] { callbacks++; });
+
+            Write(FilePath(L"first.json"), 10);
+
+            WaitForCallbacks(callbacks, 1);
+            Assert::AreEqual(1, callbacks.load());
+        }
+    };
+}
@@ -0,0 +1,148 @@
+#include "pch.h"
+#include <common/interop/pipe_message_framing.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace UnitTestsCommonLib
+{
+    // Hands out the bytes it was given in chunks of at most chunk_size, like a pipe
+    class MemoryConnection : public MessagePipeConnection
+    {
+    public:
+        std::vector<char> bytes;
+        size_t position = 0;
+        size_t chunk_size = SIZE_MAX;
+        size_t reads = 0;
+        bool broken = false;
+
+        size_t read(void* buffer, size_t size) override
+        {
+            const size_t count = (std::min)({ size, chunk_size, bytes.size() - position });
+            memcpy(buffer, bytes.data() + position, count);
+            position += count;
+            reads += count != 0;
+            return count;
+        }
+
+        bool write(const void* data, size_t size) override
+        {
+            if (broken)
+            {
+                return false;
+            }
+            bytes.insert(bytes.end(), static_cast<const char*>(data), static_cast<const char*>(data) + size);
+            return true;
+        }
+    };
+
+    class MemoryTransport : public MessagePipeTransport
+    {
+    public:
+        std::vector<MemoryConnection*> connections;
+
+        std::unique_ptr<MessagePipeConnection> accept() override
+        {
+            return nullptr;
+        }
+
+        std::unique_ptr<MessagePipeConnection> connect() override
+        {
+            auto connection = std::make_unique<MemoryConnection>();
+            connections.push_back(connection.get());
+            return connection;
+        }
+
+        void close() override
+        {
+        }
+    };
+
+    TEST_CLASS (PipeMessageFramingTests)
+    {
+    public:
+        static std::vector<std::wstring> ReadAll(MemoryConnection& connection)
+        {
+            std::vector<std::wstring> messages;
+            pipe_message_framing::read_frames(connection, [&](std::wstring message) { messages.push_back(std::move(message)); });
+            return messages;
+        }
+
+        TEST_METHOD (ReadsFramesSplitAcrossReads)
+        {
+            const std::vector<std::wstring> expected = { L"{\"powertoys\":{}}", L"", L"second message" };
+            MemoryConnection connection;
+            for (const auto& message : expected)
+            {
+                Assert::IsTrue(pipe_message_framing::append_frame(connection.bytes, message));
+            }
+
+            // Every split of the headers and payloads
+            for (size_t chunk_size = 1; chunk_size <= connection.bytes.size(); ++chunk_size)
+            {
+                connection.position = 0;
+                connection.chunk_size = chunk_size;
+                const auto messages = ReadAll(connection);
+                Assert::AreEqual(expected.size(), messages.size());
+                for (size_t i = 0; i < expected.size(); ++i)
+                {
+                    Assert::AreEqual(expected[i], messages[i]);
+                }
+            }
+        }
+
+        TEST_METHOD (ReadsLargeFrameInFewReads)
+        {
+            const std::wstring large(1024 * 1024, L'x');
+            MemoryConnection connection;
+            pipe_message_framing::append_frame(connection.bytes, large);
+            pipe_message_framing::append_frame(connection.bytes, L"small");
+
+            const auto messages = ReadAll(connection);
+            Assert::AreEqual(size_t{ 2 }, messages.size());
+            Assert::IsTrue(large == messages[0]);
+            Assert::AreEqual(std::wstring(L"small"), messages[1]);
+            // The rest of the large payload is read directly into the message, in a single read
+            Assert::AreEqual(size_t{ 3 }, connection.reads);
+        }
+
+        TEST_METHOD (StopsAtInvalidFrame)
+        {
+            MemoryConnection connection;
+            pipe_message_framing::append_frame(connection.bytes, L"valid");
+            const char odd_size[] = { 3, 0, 0, 0, 'a', 'b', 'c' };
+            connection.bytes.insert(connection.bytes.end(), std::begin(odd_size), std::end(odd_size));
+            pipe_message_framing::append_frame(connection.bytes, L"never read");
+
+            const auto messages = ReadAll(connection);
+            Assert::AreEqual(size_t{ 1 }, messages.size());
+            Assert::AreEqual(std::wstring(L"valid"), messages[0]);
+        }
+
+        TEST_METHOD (SenderKeepsConnectionBetweenBatches)
+        {
+            MemoryTransport transport;
+            pipe_message_framing::MessageSender sender(transport);
+            Assert::IsTrue(sender.send({ L"a", L"b" }));
+            Assert::IsTrue(sender.send({ L"c" }));
+            Assert::AreEqual(size_t{ 1 }, transport.connections.size());
+
+            const auto messages = ReadAll(*transport.connections[0]);
+            Assert::AreEqual(size_t{ 3 }, messages.size());
+            Assert::AreEqual(std::wstring(L"c"), messages[2]);
+        }
+
+        TEST_METHOD (SenderReconnectsOnceAfterBrokenConnection)
+        {
+            MemoryTransport transport;
+            pipe_message_framing::MessageSender sender(transport);
+            Assert::IsTrue(sender.send({ L"a" }));
+            transport.connections[0]->broken = true;
+
+            Assert::IsTrue(sender.send({ L"b" }));
+            Assert::AreEqual(size_t{ 2 }, transport.connections.size());
+            const auto messages = ReadAll(*transport.connections[1]);
+            Assert::AreEqual(size_t{ 1 }, messages.size());
+            Assert::AreEqual(std::wstring(L"b"), messages[0]);
+        }
+    };
+}
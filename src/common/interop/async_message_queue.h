@@ -1,54 +1,278 @@
 #pragma once
-#include <queue>
-#include <thread>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
 #include <mutex>
-#include <condition_variable>
 #include <string>
+#include <thread>
+#include <vector>
 
+// Unbounded queue of messages with any number of producers and a single consumer.
+// Messages are moved in and out of a ring buffer, so they are never copied. When the ring is full, messages spill to
+// a list until the consumer catches up: producers never wait for the consumer. The pipe IPC queues the messages read
+// from a pipe and the messages to write to it, and both sides of a pipe block on each other, so a producer waiting
+// for room could deadlock the two processes.
+// A waiting consumer spins for a while before it parks, and producers only signal it while it is parked, so a burst
+// of messages costs one wake up at most.
 class AsyncMessageQueue
 {
 private:
-    std::mutex queue_mutex;
-    std::queue<std::wstring> message_queue;
-    std::condition_variable message_ready;
-    bool interrupted = false;
+    struct Slot
+    {
+        // Equal to the position of the next message to push to the slot, or to that position + 1 once it is pushed
+        std::atomic<size_t> sequence;
+        std::wstring message;
+    };
 
-    //Disable copy
-    AsyncMessageQueue(const AsyncMessageQueue&);
-    AsyncMessageQueue& operator=(const AsyncMessageQueue&);
+    static constexpr size_t min_spin_count = 16;
+    static constexpr size_t max_spin_count = 4096;
 
-public:
-    AsyncMessageQueue()
+    const size_t mask;
+    const std::unique_ptr<Slot[]> slots;
+
+    std::atomic<size_t> enqueue_position = 0;
+
+    // Messages pushed while the ring was full. Once a message spilled, the next ones spill too until the consumer
+    // takes them, so that the messages of each producer stay in order
+    std::mutex overflow_mutex;
+    std::deque<std::wstring> overflow;
+    std::atomic<size_t> overflow_size = 0;
+
+    // Only used by the consumer. Spilled messages taken from the overflow list, popped before the ring
+    std::deque<std::wstring> spilled;
+    size_t dequeue_position = 0;
+    size_t spin_count = min_spin_count;
+
+    // Bumped whenever a parked consumer may be able to continue
+    std::atomic<uint32_t> consumer_signal = 0;
+    std::atomic<bool> consumer_parked = false;
+    std::atomic<bool> interrupted = false;
+
+    static size_t round_up_to_power_of_two(size_t value)
     {
+        size_t result = 2;
+        while (result < value)
+        {
+            result <<= 1;
+        }
+        return result;
     }
-    void queue_message(std::wstring message)
+
+    // Moves the message to the ring if there is room left. The message is left untouched otherwise
+    bool try_push(std::wstring& message)
     {
-        this->queue_mutex.lock();
-        this->message_queue.push(message);
-        this->queue_mutex.unlock();
-        this->message_ready.notify_one();
+        size_t position = enqueue_position.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            Slot& slot = slots[position & mask];
+            const size_t sequence = slot.sequence.load(std::memory_order_acquire);
+            const auto difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+            if (difference == 0)
+            {
+                if (enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                {
+                    slot.message = std::move(message);
+                    slot.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (difference < 0)
+            {
+                // The consumer hasn't popped the message pushed one lap earlier yet
+                return false;
+            }
+            else
+            {
+                position = enqueue_position.load(std::memory_order_relaxed);
+            }
+        }
     }
-    std::wstring pop_message()
+
+    bool ring_has_message() const
+    {
+        return slots[dequeue_position & mask].sequence.load(std::memory_order_acquire) == dequeue_position + 1;
+    }
+
+    // True when no slot of the ring was claimed past the consumer. A producer may have claimed the next slot without
+    // having moved its message in yet, so the ring being empty can't be told from the next slot alone
+    bool ring_is_empty() const
+    {
+        return enqueue_position.load(std::memory_order_acquire) == dequeue_position;
+    }
+
+    bool has_message() const
+    {
+        return !spilled.empty() || ring_has_message() || (overflow_size.load(std::memory_order_acquire) != 0 && ring_is_empty());
+    }
+
+    bool try_pop(std::wstring& message)
+    {
+        if (spilled.empty() && !ring_has_message())
+        {
+            if (overflow_size.load(std::memory_order_acquire) == 0)
+            {
+                return false;
+            }
+
+            std::unique_lock lock(overflow_mutex);
+            // Checked under the lock: a producer claims its slot before it spills its next message. The spilled
+            // messages may have been pushed after the message of a slot claimed but not filled yet, wait for it
+            if (!ring_is_empty())
+            {
+                return false;
+            }
+
+            // The ring is drained, so every message that spilled was pushed after the messages of the ring
+            spilled.swap(overflow);
+            overflow_size.store(0, std::memory_order_release);
+        }
+
+        if (!spilled.empty())
+        {
+            message = std::move(spilled.front());
+            spilled.pop_front();
+            return true;
+        }
+
+        Slot& slot = slots[dequeue_position & mask];
+        message = std::move(slot.message);
+        slot.message = std::wstring();
+        slot.sequence.store(dequeue_position + mask + 1, std::memory_order_release);
+        ++dequeue_position;
+        return true;
+    }
+
+    // Waits until there is a message to pop or the queue is interrupted. Returns false if it was interrupted
+    bool wait_for_message()
+    {
+        for (;;)
+        {
+            for (size_t i = 0; i < spin_count; ++i)
+            {
+                if (interrupted.load(std::memory_order_acquire))
+                {
+                    return false;
+                }
+                if (has_message())
+                {
+                    // Messages keep coming, spin longer next time
+                    spin_count = (std::min)(spin_count * 2, max_spin_count);
+                    return true;
+                }
+                if (i % 16 == 15)
+                {
+                    std::this_thread::yield();
+                }
+            }
+            spin_count = (std::max)(spin_count / 2, min_spin_count);
+
+            const uint32_t signal = consumer_signal.load(std::memory_order_acquire);
+            consumer_parked.store(true, std::memory_order_relaxed);
+            // Pairs with the fence in queue_message, so that either the producer sees the consumer parked or the consumer sees the message
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (!has_message() && !interrupted.load(std::memory_order_acquire))
+            {
+                consumer_signal.wait(signal, std::memory_order_acquire);
+            }
+            consumer_parked.store(false, std::memory_order_relaxed);
+        }
+    }
+
+public:
+    // The capacity is the size of the ring, more messages spill to a list
+    explicit AsyncMessageQueue(size_t capacity = 1024) :
+        mask(round_up_to_power_of_two(capacity) - 1),
+        slots(std::make_unique<Slot[]>(mask + 1))
     {
-        std::unique_lock<std::mutex> lock(this->queue_mutex);
-        while (message_queue.empty() && !this->interrupted)
+        for (size_t i = 0; i <= mask; ++i)
         {
-            this->message_ready.wait(lock);
+            slots[i].sequence.store(i, std::memory_order_relaxed);
         }
-        if (this->interrupted)
+    }
+
+    //Disable copy
+    AsyncMessageQueue(const AsyncMessageQueue&) = delete;
+    AsyncMessageQueue& operator=(const AsyncMessageQueue&) = delete;
+
+    // Never waits. Returns false and drops the message if the queue was interrupted
+    bool queue_message(std::wstring message)
+    {
+        if (interrupted.load(std::memory_order_acquire))
         {
-            //Just returns a empty string if the queue was interrupted.
-            return std::wstring(L"");
+            return false;
         }
-        std::wstring message = this->message_queue.front();
-        this->message_queue.pop();
+
+        if (overflow_size.load(std::memory_order_acquire) != 0 || !try_push(message))
+        {
+            std::unique_lock lock(overflow_mutex);
+            // The consumer may have taken the spilled messages and made room meanwhile
+            if (!overflow.empty() || !try_push(message))
+            {
+                overflow.push_back(std::move(message));
+                overflow_size.store(overflow.size(), std::memory_order_release);
+            }
+        }
+
+        // Pairs with the fence in wait_for_message
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (consumer_parked.load(std::memory_order_relaxed))
+        {
+            consumer_signal.fetch_add(1, std::memory_order_release);
+            consumer_signal.notify_one();
+        }
+        return true;
+    }
+
+    // Waits for a message. Only one thread may pop messages.
+    std::wstring pop_message()
+    {
+        std::wstring message;
+        do
+        {
+            if (!wait_for_message())
+            {
+                //Just returns a empty string if the queue was interrupted.
+                return std::wstring(L"");
+            }
+        } while (!try_pop(message));
+
         return message;
     }
+
+    // Waits for a message, then moves it and up to max_count - 1 other queued messages to the end of messages.
+    // Returns the number of messages moved, or 0 if the queue was interrupted. Only one thread may pop messages.
+    size_t pop_batch(std::vector<std::wstring>& messages, size_t max_count = SIZE_MAX)
+    {
+        if (max_count == 0)
+        {
+            return 0;
+        }
+
+        size_t count = 0;
+        std::wstring message;
+        do
+        {
+            // A producer may claim a slot between the wait and the pops, so nothing may be ready yet
+            if (!wait_for_message())
+            {
+                return 0;
+            }
+
+            while (count < max_count && try_pop(message))
+            {
+                messages.push_back(std::move(message));
+                ++count;
+            }
+        } while (count == 0);
+        return count;
+    }
+
     void interrupt()
     {
-        this->queue_mutex.lock();
-        this->interrupted = true;
-        this->queue_mutex.unlock();
-        this->message_ready.notify_all();
+        interrupted.store(true, std::memory_order_release);
+        consumer_signal.fetch_add(1, std::memory_order_release);
+        consumer_signal.notify_all();
     }
 };
@@ -0,0 +1,33 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+
+// Byte stream between two processes, e.g. an instance of a named pipe
+class MessagePipeConnection
+{
+public:
+    virtual ~MessagePipeConnection() = default;
+
+    // Waits for some bytes and reads at most size of them. Returns 0 once the connection is broken or the transport was closed
+    virtual size_t read(void* buffer, size_t size) = 0;
+
+    // Writes all the bytes. Returns false if the connection is broken or the transport was closed
+    virtual bool write(const void* data, size_t size) = 0;
+};
+
+// Connections used by TwoWayPipeMessageIPC: the ones peers open to its input pipe and the one it opens to its output pipe.
+// Any number of threads may wait for incoming connections at the same time.
+class MessagePipeTransport
+{
+public:
+    virtual ~MessagePipeTransport() = default;
+
+    // Waits for a peer to connect to the input pipe. Returns nullptr if the transport was closed
+    virtual std::unique_ptr<MessagePipeConnection> accept() = 0;
+
+    // Connects to the output pipe, waiting a while if it's busy. Returns nullptr on failure
+    virtual std::unique_ptr<MessagePipeConnection> connect() = 0;
+
+    // Makes every pending and later accept, read and write call fail
+    virtual void close() = 0;
+};
@@ -0,0 +1,216 @@
+#pragma once
+#include <Windows.h>
+#include <algorithm>
+#include <functional>
+#include <string>
+
+#include "message_pipe_transport.h"
+
+// Named pipes in byte mode. All I/O is overlapped, so that closing the transport interrupts every pending call.
+class NamedPipeTransport : public MessagePipeTransport
+{
+public:
+    // Called for every new instance of the input pipe before a peer can connect to it, e.g. to change its security
+    typedef std::function<void(HANDLE)> pipe_created_callback;
+
+    // Size of the pipe buffers. Large enough for most settings messages to be written in one go
+    static constexpr DWORD buffer_size = 64 * 1024;
+
+    NamedPipeTransport(std::wstring _input_pipe_name, std::wstring _output_pipe_name, pipe_created_callback _on_pipe_created) :
+        input_pipe_name(std::move(_input_pipe_name)),
+        output_pipe_name(std::move(_output_pipe_name)),
+        on_pipe_created(std::move(_on_pipe_created)),
+        closed_event(CreateEvent(nullptr, TRUE, FALSE, nullptr))
+    {
+    }
+
+    ~NamedPipeTransport() override
+    {
+        if (closed_event)
+        {
+            CloseHandle(closed_event);
+        }
+    }
+
+    //Disable copy
+    NamedPipeTransport(const NamedPipeTransport&) = delete;
+    NamedPipeTransport& operator=(const NamedPipeTransport&) = delete;
+
+    std::unique_ptr<MessagePipeConnection> accept() override
+    {
+        // Adapted from https://learn.microsoft.com/windows/win32/ipc/named-pipe-server-using-overlapped-i-o
+        while (!is_closed())
+        {
+            HANDLE pipe = CreateNamedPipe(
+                input_pipe_name.c_str(),
+                PIPE_ACCESS_DUPLEX |
+                    WRITE_DAC |
+                    FILE_FLAG_OVERLAPPED,
+                PIPE_TYPE_BYTE |
+                    PIPE_READMODE_BYTE |
+                    PIPE_WAIT,
+                PIPE_UNLIMITED_INSTANCES,
+                buffer_size,
+                buffer_size,
+                0,
+                NULL);
+            if (pipe == INVALID_HANDLE_VALUE)
+            {
+                return nullptr;
+            }
+
+            if (on_pipe_created)
+            {
+                on_pipe_created(pipe);
+            }
+
+            auto connection = std::make_unique<Connection>(*this, pipe, true);
+            if (connection->connect())
+            {
+                return connection;
+            }
+        }
+        return nullptr;
+    }
+
+    std::unique_ptr<MessagePipeConnection> connect() override
+    {
+        // Adapted from https://learn.microsoft.com/windows/win32/ipc/named-pipe-client
+        while (!is_closed())
+        {
+            HANDLE pipe = CreateFile(
+                output_pipe_name.c_str(),
+                GENERIC_READ | GENERIC_WRITE,
+                0, // no sharing
+                NULL, // default security attributes
+                OPEN_EXISTING,
+                FILE_FLAG_OVERLAPPED,
+                NULL); // no template file
+
+            if (pipe != INVALID_HANDLE_VALUE)
+            {
+                return std::make_unique<Connection>(*this, pipe, false);
+            }
+
+            // All pipe instances are busy, so wait for 20 seconds.
+            if (GetLastError() != ERROR_PIPE_BUSY || !WaitNamedPipe(output_pipe_name.c_str(), 20000))
+            {
+                return nullptr;
+            }
+        }
+        return nullptr;
+    }
+
+    void close() override
+    {
+        SetEvent(closed_event);
+    }
+
+private:
+    class Connection : public MessagePipeConnection
+    {
+    public:
+        Connection(NamedPipeTransport& _transport, HANDLE _pipe, bool _is_server) :
+            transport(_transport), pipe(_pipe), is_server(_is_server), io_event(CreateEvent(nullptr, TRUE, FALSE, nullptr))
+        {
+        }
+
+        ~Connection() override
+        {
+            if (is_server)
+            {
+                DisconnectNamedPipe(pipe);
+            }
+            CloseHandle(pipe);
+            if (io_event)
+            {
+                CloseHandle(io_event);
+            }
+        }
+
+        // Waits for a peer to connect to this instance of the input pipe
+        bool connect()
+        {
+            OVERLAPPED overlapped = { 0 };
+            overlapped.hEvent = io_event;
+            if (ConnectNamedPipe(pipe, &overlapped))
+            {
+                return true;
+            }
+
+            DWORD ignored;
+            switch (GetLastError())
+            {
+            case ERROR_PIPE_CONNECTED:
+                return true;
+            case ERROR_IO_PENDING:
+                return wait(overlapped, ignored);
+            default:
+                return false;
+            }
+        }
+
+        size_t read(void* buffer, size_t size) override
+        {
+            OVERLAPPED overlapped = { 0 };
+            overlapped.hEvent = io_event;
+            DWORD bytes_read = 0;
+            const DWORD bytes_to_read = static_cast<DWORD>((std::min)(size, static_cast<size_t>(MAXDWORD)));
+            if (!ReadFile(pipe, buffer, bytes_to_read, &bytes_read, &overlapped) &&
+                (GetLastError() != ERROR_IO_PENDING || !wait(overlapped, bytes_read)))
+            {
+                return 0;
+            }
+            return bytes_read;
+        }
+
+        bool write(const void* data, size_t size) override
+        {
+            auto bytes = static_cast<const char*>(data);
+            while (size > 0)
+            {
+                OVERLAPPED overlapped = { 0 };
+                overlapped.hEvent = io_event;
+                DWORD bytes_written = 0;
+                const DWORD bytes_to_write = static_cast<DWORD>((std::min)(size, static_cast<size_t>(MAXDWORD)));
+                if (!WriteFile(pipe, bytes, bytes_to_write, &bytes_written, &overlapped) &&
+                    (GetLastError() != ERROR_IO_PENDING || !wait(overlapped, bytes_written)))
+                {
+                    return false;
+                }
+                bytes += bytes_written;
+                size -= bytes_written;
+            }
+            return true;
+        }
+
+    private:
+        NamedPipeTransport& transport;
+        HANDLE pipe;
+        bool is_server;
+        HANDLE io_event;
+
+        // Waits for the pending operation to complete, or cancels it if the transport is closed first
+        bool wait(OVERLAPPED& overlapped, DWORD& bytes_transferred)
+        {
+            const HANDLE events[] = { overlapped.hEvent, transport.closed_event };
+            if (WaitForMultipleObjects(2, events, FALSE, INFINITE) != WAIT_OBJECT_0)
+            {
+                CancelIoEx(pipe, &overlapped);
+                GetOverlappedResult(pipe, &overlapped, &bytes_transferred, TRUE);
+                return false;
+            }
+            return GetOverlappedResult(pipe, &overlapped, &bytes_transferred, FALSE);
+        }
+    };
+
+    std::wstring input_pipe_name;
+    std::wstring output_pipe_name;
+    pipe_created_callback on_pipe_created;
+    HANDLE closed_event;
+
+    bool is_closed() const
+    {
+        return WaitForSingleObject(closed_event, 0) == WAIT_OBJECT_0;
+    }
+};
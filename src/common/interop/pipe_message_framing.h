@@ -0,0 +1,196 @@
+#pragma once
+#include "message_pipe_transport.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Messages are sent over persistent connections as frames: the size of the payload in bytes as a little endian
+// uint32, followed by the wchar_t units of the message without the null terminator.
+namespace pipe_message_framing
+{
+    constexpr size_t header_size = sizeof(uint32_t);
+
+    // A larger frame means the stream is broken, so the connection is dropped
+    constexpr size_t max_payload_size = 64 * 1024 * 1024;
+
+    // Frames are read and written through buffers of this size. Larger payloads go straight between the pipe and the message
+    constexpr size_t chunk_size = 64 * 1024;
+
+    inline void append_header(std::vector<char>& buffer, size_t payload_size)
+    {
+        for (size_t i = 0; i < header_size; ++i)
+        {
+            buffer.push_back(static_cast<char>((payload_size >> (8 * i)) & 0xFF));
+        }
+    }
+
+    // Returns false if the message is too large to be sent
+    inline bool append_frame(std::vector<char>& buffer, const std::wstring& message)
+    {
+        const size_t payload_size = message.size() * sizeof(wchar_t);
+        if (payload_size > max_payload_size)
+        {
+            return false;
+        }
+
+        append_header(buffer, payload_size);
+        const auto payload = reinterpret_cast<const char*>(message.data());
+        buffer.insert(buffer.end(), payload, payload + payload_size);
+        return true;
+    }
+
+    inline size_t read_header(const char* data)
+    {
+        size_t payload_size = 0;
+        for (size_t i = 0; i < header_size; ++i)
+        {
+            payload_size |= static_cast<size_t>(static_cast<unsigned char>(data[i])) << (8 * i);
+        }
+        return payload_size;
+    }
+
+    // Calls on_message with every message read from the connection, until it's broken or a frame is invalid
+    template<typename Callback>
+    void read_frames(MessagePipeConnection& connection, Callback&& on_message)
+    {
+        std::vector<char> buffer(chunk_size);
+        size_t begin = 0;
+        size_t end = 0;
+        for (;;)
+        {
+            while (end - begin >= header_size)
+            {
+                const size_t payload_size = read_header(buffer.data() + begin);
+                if (payload_size > max_payload_size || payload_size % sizeof(wchar_t) != 0)
+                {
+                    return;
+                }
+
+                const size_t available = end - begin - header_size;
+                const bool large = header_size + payload_size > buffer.size();
+                if (available < payload_size && !large)
+                {
+                    break;
+                }
+
+                std::wstring message(payload_size / sizeof(wchar_t), L'\0');
+                const auto payload = reinterpret_cast<char*>(message.data());
+                if (available >= payload_size)
+                {
+                    memcpy(payload, buffer.data() + begin + header_size, payload_size);
+                    begin += header_size + payload_size;
+                }
+                else
+                {
+                    // Read the rest of a payload that doesn't fit in the buffer directly into the message
+                    memcpy(payload, buffer.data() + begin + header_size, available);
+                    for (size_t bytes_read = available; bytes_read < payload_size;)
+                    {
+                        const size_t count = connection.read(payload + bytes_read, payload_size - bytes_read);
+                        if (count == 0)
+                        {
+                            return;
+                        }
+                        bytes_read += count;
+                    }
+                    begin = end = 0;
+                }
+                on_message(std::move(message));
+            }
+
+            // Keep the partial frame at the start of the buffer
+            std::copy(buffer.begin() + begin, buffer.begin() + end, buffer.begin());
+            end -= begin;
+            begin = 0;
+
+            const size_t bytes_read = connection.read(buffer.data() + end, buffer.size() - end);
+            if (bytes_read == 0)
+            {
+                return;
+            }
+            end += bytes_read;
+        }
+    }
+
+    // Reads messages from the connections peers open on the transport, until it's closed
+    template<typename Callback>
+    void receive_messages(MessagePipeTransport& transport, Callback&& on_message)
+    {
+        while (auto connection = transport.accept())
+        {
+            read_frames(*connection, on_message);
+        }
+    }
+
+    // Sends batches of messages through a single connection, which is kept open between batches
+    class MessageSender
+    {
+    public:
+        explicit MessageSender(MessagePipeTransport& transport) :
+            transport(transport)
+        {
+        }
+
+        // Returns false if the messages couldn't all be sent. The ones that weren't are dropped
+        bool send(const std::vector<std::wstring>& messages)
+        {
+            bool first_write = true;
+            const auto write_buffer = [&] {
+                const bool written = buffer.empty() || write(buffer.data(), buffer.size(), first_write);
+                buffer.clear();
+                first_write = false;
+                return written;
+            };
+
+            buffer.clear();
+            for (const auto& message : messages)
+            {
+                const size_t payload_size = message.size() * sizeof(wchar_t);
+                if (payload_size < chunk_size)
+                {
+                    append_frame(buffer, message);
+                    if (buffer.size() >= chunk_size && !write_buffer())
+                    {
+                        return false;
+                    }
+                }
+                else if (payload_size <= max_payload_size)
+                {
+                    // Don't copy large payloads to the buffer
+                    append_header(buffer, payload_size);
+                    if (!write_buffer() || !write(message.data(), payload_size, false))
+                    {
+                        return false;
+                    }
+                }
+            }
+            return write_buffer();
+        }
+
+    private:
+        MessagePipeTransport& transport;
+        std::unique_ptr<MessagePipeConnection> connection;
+        std::vector<char> buffer;
+
+        // Opens a connection if there is none. A connection kept open since the last batch may have been closed by the
+        // peer in the meantime, so the first write of a batch is retried once with a new connection.
+        bool write(const void* data, size_t size, bool first_write)
+        {
+            const bool reused = connection != nullptr;
+            if (!reused)
+            {
+                connection = transport.connect();
+            }
+            if (connection && connection->write(data, size))
+            {
+                return true;
+            }
+
+            connection.reset();
+            return reused && first_write && write(data, size, false);
+        }
+    };
+}
@@ -1,6 +1,7 @@
 #pragma once
 #include <Windows.h>
 #include "async_message_queue.h"
+#include "message_pipe_transport.h"
 #include <WinSafer.h>
 #include <accctrl.h>
 #include <aclapi.h>
@@ -22,21 +23,18 @@ private:
     std::wstring input_pipe_name;
     std::thread input_queue_thread;
     std::thread output_queue_thread;
-    std::thread input_pipe_thread;
-    std::mutex pipe_connect_handle_mutex; // For manipulating the current_connect_pipe
+    std::vector<std::thread> input_pipe_threads; // Each one reads from one peer connection at a time
+    std::unique_ptr<MessagePipeTransport> transport;
     std::wstring outgoing_message; // Store the updated json settings.
 
-    HANDLE current_connect_pipe_handle = NULL;
     bool closed = false;
     TwoWayPipeMessageIPC::callback_function dispatch_inc_message_function;
 
-    void send_pipe_message(std::wstring message);
     void consume_output_queue_thread();
     BOOL GetLogonSID(HANDLE hToken, PSID* ppsid);
     VOID FreeLogonSID(PSID* ppsid);
     int change_pipe_security_allow_restricted_token(HANDLE handle, HANDLE token);
     HANDLE create_medium_integrity_token();
-    void handle_pipe_connection(HANDLE input_pipe_handle);
-    void start_named_pipe_server(HANDLE token);
+    void read_input_pipe_connections();
     void consume_input_queue_thread();
 };
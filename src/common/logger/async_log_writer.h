@@ -0,0 +1,375 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+// What logging does when the ring is full
+enum class AsyncLogOverflow
+{
+    // The message is dropped and counted, the logging thread never waits
+    Drop,
+    // The logging thread waits for the writer to make room
+    Block,
+};
+
+struct AsyncLogOptions
+{
+    // Messages the ring holds, rounded up to a power of 2
+    size_t capacity = 8192;
+    AsyncLogOverflow overflow = AsyncLogOverflow::Drop;
+    // Messages are flushed at most this long after they were logged, or once this many bytes were written
+    std::chrono::milliseconds flushInterval{ 1000 };
+    size_t flushBytes = 64 * 1024;
+};
+
+struct AsyncLogStats
+{
+    uint64_t written = 0;
+    // Messages lost because the ring was full, with AsyncLogOverflow::Drop
+    uint64_t dropped = 0;
+    // Messages that waited for room, with AsyncLogOverflow::Block
+    uint64_t blocked = 0;
+};
+
+// Passes log records from any thread to a writer thread through a preallocated lock-free ring, so that logging
+// doesn't wait for the disk. The writer writes the records in batches and flushes them by time and size.
+// Doesn't depend on spdlog or on Windows.
+template<typename Record>
+class AsyncLogWriter
+{
+public:
+    // Writes a record and returns the number of bytes written
+    using WriteFunction = std::function<size_t(Record&)>;
+    using FlushFunction = std::function<void()>;
+
+    AsyncLogWriter(const AsyncLogOptions& options, WriteFunction write, FlushFunction flush) :
+        m_options(options),
+        m_write(std::move(write)),
+        m_flush(std::move(flush))
+    {
+        size_t capacity = 2;
+        while (capacity < options.capacity)
+        {
+            capacity *= 2;
+        }
+
+        m_mask = capacity - 1;
+        m_slots = std::make_unique<Slot[]>(capacity);
+        for (size_t i = 0; i < capacity; ++i)
+        {
+            m_slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+
+        m_thread = std::thread([this] { Run(); });
+    }
+
+    ~AsyncLogWriter()
+    {
+        Stop();
+    }
+
+    AsyncLogWriter(const AsyncLogWriter&) = delete;
+    AsyncLogWriter& operator=(const AsyncLogWriter&) = delete;
+
+    // Calls fill with a record of the ring to copy the message into. Returns false if the message was dropped.
+    // An urgent message is flushed as soon as it's written. If fill throws, the message is dropped and the exception
+    // is passed on.
+    template<typename Fill>
+    bool Push(Fill&& fill, bool urgent = false)
+    {
+        if (m_stopped.load(std::memory_order_relaxed))
+        {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        bool waited = false;
+        while (!TryPush(fill))
+        {
+            if (m_options.overflow == AsyncLogOverflow::Drop || m_stopped.load(std::memory_order_relaxed))
+            {
+                m_dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+
+            if (!waited)
+            {
+                waited = true;
+                m_blocked.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            Wake();
+            std::this_thread::yield();
+        }
+
+        if (urgent)
+        {
+            m_flushRequested.store(true, std::memory_order_relaxed);
+            Wake();
+        }
+        else if (IsHalfFull())
+        {
+            // Waking the writer takes a system call, so until the ring fills up the records wait for its timeout.
+            // Pairs with the fence of the writer going to sleep: either it sees the ring half full or we see it sleeping.
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (m_sleeping.load(std::memory_order_relaxed))
+            {
+                Wake();
+            }
+        }
+
+        return true;
+    }
+
+    // Writes the records of the ring on the calling thread and flushes them.
+    // Used by Logger::flush, which the crash handlers call, so it gives up rather than wait long for a writer thread
+    // which may never finish, e.g. when it crashed while writing.
+    void Drain()
+    {
+        if (std::this_thread::get_id() == m_thread.get_id())
+        {
+            return;
+        }
+
+        std::unique_lock lock(m_flushMutex, std::try_to_lock);
+        for (auto deadline = std::chrono::steady_clock::now() + DrainTimeout; !lock.owns_lock(); lock.try_lock())
+        {
+            if (std::chrono::steady_clock::now() >= deadline)
+            {
+                return;
+            }
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        WriteRecords();
+        m_flush();
+        m_unflushedBytes = 0;
+    }
+
+    // Writes the remaining records and stops the writer thread. Messages logged afterwards are dropped.
+    void Stop()
+    {
+        if (m_stopped.exchange(true))
+        {
+            return;
+        }
+
+        Wake();
+        if (m_thread.joinable())
+        {
+            m_thread.join();
+        }
+    }
+
+    AsyncLogStats Stats() const
+    {
+        return AsyncLogStats{
+            m_written.load(std::memory_order_relaxed),
+            m_dropped.load(std::memory_order_relaxed),
+            m_blocked.load(std::memory_order_relaxed)
+        };
+    }
+
+private:
+    constexpr static std::chrono::milliseconds DrainTimeout{ 1000 };
+
+    struct Slot
+    {
+        // The position the slot can be pushed at, or that position + 1 once it holds a record
+        std::atomic<size_t> sequence;
+        // False if filling the record threw, in which case the writer skips it
+        bool filled = false;
+        Record record;
+    };
+
+    const AsyncLogOptions m_options;
+    WriteFunction m_write;
+    FlushFunction m_flush;
+
+    std::unique_ptr<Slot[]> m_slots;
+    size_t m_mask = 0;
+    alignas(64) std::atomic<size_t> m_pushPosition = 0;
+    alignas(64) std::atomic<size_t> m_popPosition = 0;
+
+    alignas(64) std::atomic<bool> m_sleeping = false;
+    std::atomic<bool> m_flushRequested = false;
+    std::atomic<bool> m_stopped = false;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+
+    // Serializes the writes and flushes of the writer thread and of Drain
+    std::mutex m_flushMutex;
+    size_t m_unflushedBytes = 0;
+    std::chrono::steady_clock::time_point m_firstUnflushed;
+
+    std::atomic<uint64_t> m_written = 0;
+    std::atomic<uint64_t> m_dropped = 0;
+    std::atomic<uint64_t> m_blocked = 0;
+
+    std::thread m_thread;
+
+    template<typename Fill>
+    bool TryPush(Fill& fill)
+    {
+        size_t position = m_pushPosition.load(std::memory_order_relaxed);
+        while (true)
+        {
+            Slot& slot = m_slots[position & m_mask];
+            const size_t sequence = slot.sequence.load(std::memory_order_acquire);
+            const auto difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+            if (difference == 0)
+            {
+                if (m_pushPosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                {
+                    // The slot is claimed, so it has to be published even if fill throws, or the writer would wait for it forever
+                    struct Publish
+                    {
+                        Slot& slot;
+                        size_t sequence;
+
+                        ~Publish()
+                        {
+                            slot.sequence.store(sequence, std::memory_order_release);
+                        }
+                    } publish{ slot, position + 1 };
+
+                    slot.filled = false;
+                    fill(slot.record);
+                    slot.filled = true;
+                    return true;
+                }
+            }
+            else if (difference < 0)
+            {
+                // Full
+                return false;
+            }
+            else
+            {
+                position = m_pushPosition.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    template<typename Consume>
+    bool TryPop(Consume&& consume)
+    {
+        size_t position = m_popPosition.load(std::memory_order_relaxed);
+        while (true)
+        {
+            Slot& slot = m_slots[position & m_mask];
+            const size_t sequence = slot.sequence.load(std::memory_order_acquire);
+            const auto difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position + 1);
+            if (difference == 0)
+            {
+                if (m_popPosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                {
+                    if (slot.filled)
+                    {
+                        consume(slot.record);
+                    }
+                    else
+                    {
+                        m_dropped.fetch_add(1, std::memory_order_relaxed);
+                    }
+                    slot.sequence.store(position + m_mask + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (difference < 0)
+            {
+                // Empty
+                return false;
+            }
+            else
+            {
+                position = m_popPosition.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool IsHalfFull() const
+    {
+        return m_pushPosition.load(std::memory_order_relaxed) - m_popPosition.load(std::memory_order_relaxed) > m_mask / 2;
+    }
+
+    void Wake()
+    {
+        m_sleeping.store(false, std::memory_order_relaxed);
+        std::unique_lock lock(m_mutex);
+        m_condition.notify_one();
+    }
+
+    // Called with m_flushMutex held. Returns the number of records written
+    size_t WriteRecords()
+    {
+        size_t count = 0;
+        while (TryPop([&](Record& record) {
+            if (m_unflushedBytes == 0)
+            {
+                m_firstUnflushed = std::chrono::steady_clock::now();
+            }
+            m_unflushedBytes += m_write(record) + 1;
+            ++count;
+        }))
+        {
+        }
+
+        m_written.fetch_add(count, std::memory_order_relaxed);
+        return count;
+    }
+
+    void Run()
+    {
+        // Whether the records written next waited for a whole timeout already
+        bool timedOut = false;
+        while (true)
+        {
+            const bool stopping = m_stopped.load();
+
+            // Records pushed meanwhile are written by the next round, at most flushInterval later
+            std::chrono::steady_clock::duration timeout = m_options.flushInterval;
+            {
+                std::unique_lock lock(m_flushMutex);
+                WriteRecords();
+                if (m_unflushedBytes > 0)
+                {
+                    const auto flushTime = m_firstUnflushed + m_options.flushInterval;
+                    const auto now = std::chrono::steady_clock::now();
+                    if (stopping || timedOut || m_flushRequested.exchange(false) || m_unflushedBytes >= m_options.flushBytes || now >= flushTime)
+                    {
+                        m_flush();
+                        m_unflushedBytes = 0;
+                    }
+                    else
+                    {
+                        timeout = flushTime - now;
+                    }
+                }
+            }
+
+            if (stopping)
+            {
+                // The records pushed before Stop were written
+                return;
+            }
+
+            std::unique_lock lock(m_mutex);
+            m_sleeping.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            timedOut = false;
+            if (!IsHalfFull() && !m_stopped.load() && !m_flushRequested.load(std::memory_order_relaxed))
+            {
+                timedOut = m_condition.wait_for(lock, timeout) == std::cv_status::timeout;
+            }
+            m_sleeping.store(false, std::memory_order_relaxed);
+        }
+    }
+};
@@ -0,0 +1,92 @@
+#include "pch.h"
+#include "async_sink.h"
+
+AsyncSink::AsyncSink(std::vector<spdlog::sink_ptr> sinks, const AsyncLogOptions& options) :
+    m_sinks(std::move(sinks)),
+    m_writer(
+        options,
+        [this](spdlog::details::log_msg_buffer& msg) { return write(msg); },
+        [this] { flush_sinks(); })
+{
+}
+
+AsyncSink::~AsyncSink()
+{
+    m_writer.Stop();
+
+    const auto stats = m_writer.Stats();
+    if (stats.dropped > 0 || stats.blocked > 0)
+    {
+        // The counters can't go through the writer anymore
+        const auto text = fmt::format("Async logging dropped {} and blocked on {} of {} messages", stats.dropped, stats.blocked, stats.written + stats.dropped);
+        write(spdlog::details::log_msg("", spdlog::level::warn, text));
+        flush_sinks();
+    }
+}
+
+void AsyncSink::log(const spdlog::details::log_msg& msg)
+{
+    // Copies the message into the preallocated record, which only allocates for long messages
+    m_writer.Push([&](spdlog::details::log_msg_buffer& record) { record = spdlog::details::log_msg_buffer(msg); },
+                  msg.level >= spdlog::level::err);
+}
+
+void AsyncSink::flush()
+{
+    m_writer.Drain();
+}
+
+void AsyncSink::set_pattern(const std::string& pattern)
+{
+    for (auto& sink : m_sinks)
+    {
+        sink->set_pattern(pattern);
+    }
+}
+
+void AsyncSink::set_formatter(std::unique_ptr<spdlog::formatter> sink_formatter)
+{
+    for (auto& sink : m_sinks)
+    {
+        sink->set_formatter(sink_formatter->clone());
+    }
+}
+
+AsyncLogStats AsyncSink::stats() const
+{
+    return m_writer.Stats();
+}
+
+size_t AsyncSink::write(const spdlog::details::log_msg& msg)
+{
+    for (auto& sink : m_sinks)
+    {
+        if (sink->should_log(msg.level))
+        {
+            try
+            {
+                sink->log(msg);
+            }
+            catch (...)
+            {
+                // There is no caller on the writer thread to pass the error to
+            }
+        }
+    }
+
+    return msg.payload.size();
+}
+
+void AsyncSink::flush_sinks()
+{
+    for (auto& sink : m_sinks)
+    {
+        try
+        {
+            sink->flush();
+        }
+        catch (...)
+        {
+        }
+    }
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include <spdlog/details/log_msg_buffer.h>
+#include <spdlog/sinks/sink.h>
+#include "async_log_writer.h"
+
+// Passes the messages to the wrapped sinks on a writer thread, see AsyncLogWriter.
+// The writer thread is joined when the sink is destroyed, so it's meant for executables: in a DLL that would happen
+// under the loader lock.
+class AsyncSink : public spdlog::sinks::sink
+{
+public:
+    AsyncSink(std::vector<spdlog::sink_ptr> sinks, const AsyncLogOptions& options);
+    ~AsyncSink();
+
+    void log(const spdlog::details::log_msg& msg) override;
+
+    // Writes the queued messages on the calling thread
+    void flush() override;
+
+    void set_pattern(const std::string& pattern) override;
+    void set_formatter(std::unique_ptr<spdlog::formatter> sink_formatter) override;
+
+    AsyncLogStats stats() const;
+
+private:
+    std::vector<spdlog::sink_ptr> m_sinks;
+    AsyncLogWriter<spdlog::details::log_msg_buffer> m_writer;
+
+    size_t write(const spdlog::details::log_msg& msg);
+    void flush_sinks();
+};
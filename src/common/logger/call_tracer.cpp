@@ -1,8 +1,13 @@
 #include "pch.h"
 #include "call_tracer.h"
 
-#include <map>
-#include <thread>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 namespace
 {
@@ -10,46 +15,195 @@ namespace
     const std::string entering = " Enter";
     const std::string exiting = " Exit";
 
-    std::mutex indentLevelMutex;
-    std::map<std::thread::id, int> indentLevel;
+    constexpr int MaxIndentLevel = 64;
+    constexpr size_t MaxSpansPerThread = 64 * 1024;
 
-    std::string GetIndentation()
+    thread_local int indentLevel = 0;
+
+    // 2 * level - 1 spaces followed by " - "
+    std::string_view GetIndentation(int level)
     {
-        std::unique_lock lock(indentLevelMutex);
-        int level = indentLevel[std::this_thread::get_id()];
+        static const std::string indentation = std::string(2 * MaxIndentLevel - 1, ' ') + " - ";
 
         if (level <= 0)
         {
             return {};
         }
-        else
+
+        return std::string_view(indentation).substr(2 * static_cast<size_t>(MaxIndentLevel - (std::min)(level, MaxIndentLevel)));
+    }
+
+    long long Now()
+    {
+        return std::chrono::steady_clock::now().time_since_epoch().count();
+    }
+
+    double ToMicroseconds(long long ticks)
+    {
+        return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::duration(ticks)).count();
+    }
+
+    struct Span
+    {
+        const char* name;
+        long long start;
+        long long end;
+    };
+
+    // The spans a thread recorded in a session. Only the thread adds spans, stop_recording reads them meanwhile.
+    struct ThreadSpans
+    {
+        DWORD threadId = 0;
+        unsigned session = 0;
+        std::unique_ptr<Span[]> spans = std::make_unique<Span[]>(MaxSpansPerThread);
+        // The spans below count are complete
+        std::atomic<size_t> count = 0;
+        std::atomic<size_t> dropped = 0;
+    };
+
+    std::mutex recordingMutex;
+    // Each recording gets new buffers, so that a thread still adding to the previous ones doesn't need a lock
+    std::atomic<unsigned> session = 0;
+    long long sessionStart = 0;
+    std::vector<std::shared_ptr<ThreadSpans>> recordedThreads;
+
+    thread_local std::shared_ptr<ThreadSpans> threadSpans;
+
+    void Record(const char* name, long long start, long long end)
+    {
+        const unsigned currentSession = session.load(std::memory_order_acquire);
+        if (!threadSpans || threadSpans->session != currentSession)
+        {
+            threadSpans = std::make_shared<ThreadSpans>();
+            threadSpans->threadId = GetCurrentThreadId();
+            threadSpans->session = currentSession;
+
+            std::unique_lock lock(recordingMutex);
+            recordedThreads.push_back(threadSpans);
+        }
+
+        const size_t count = threadSpans->count.load(std::memory_order_relaxed);
+        if (count == MaxSpansPerThread)
+        {
+            threadSpans->dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        threadSpans->spans[count] = Span{ name, start, end };
+        threadSpans->count.store(count + 1, std::memory_order_release);
+    }
+
+    void WriteJsonString(std::ostream& stream, const char* text)
+    {
+        stream << '"';
+        for (; *text; ++text)
         {
-            return std::string(static_cast<int64_t>(2) * min(level, 64) - 1, ' ') + " - ";
+            const char c = *text;
+            if (c == '"' || c == '\\')
+            {
+                stream << '\\' << c;
+            }
+            else if (static_cast<unsigned char>(c) < 0x20)
+            {
+                stream << ' ';
+            }
+            else
+            {
+                stream << c;
+            }
         }
+        stream << '"';
     }
+}
 
-    void Indent()
+void CallTracer::on_enter()
+{
+    if (logged)
     {
-        std::unique_lock lock(indentLevelMutex);
-        indentLevel[std::this_thread::get_id()]++;
+        Logger::trace("{}{}{}", GetIndentation(indentLevel), functionName, entering);
+        indentLevel++;
     }
 
-    void Unindent()
+    if (recorded)
     {
-        std::unique_lock lock(indentLevelMutex);
-        indentLevel[std::this_thread::get_id()]--;
+        startTime = Now();
     }
 }
 
-CallTracer::CallTracer(const char* functionName) :
-    functionName(functionName)
+void CallTracer::on_exit()
 {
-    Logger::trace((GetIndentation() + functionName + entering).c_str());
-    Indent();
+    if (recorded)
+    {
+        Record(functionName, startTime, Now());
+    }
+
+    if (logged)
+    {
+        indentLevel--;
+        Logger::trace("{}{}{}", GetIndentation(indentLevel), functionName, exiting);
+    }
+}
+
+void CallTracer::start_recording()
+{
+    std::unique_lock lock(recordingMutex);
+    recordedThreads.clear();
+    sessionStart = Now();
+    session.fetch_add(1, std::memory_order_release);
+    recording = true;
 }
 
-CallTracer::~CallTracer()
+bool CallTracer::stop_recording(const std::filesystem::path& path)
 {
-    Unindent();
-    Logger::trace((GetIndentation() + functionName + exiting).c_str());
+    std::vector<std::shared_ptr<ThreadSpans>> threads;
+    long long start;
+    {
+        std::unique_lock lock(recordingMutex);
+        if (!recording.exchange(false))
+        {
+            return false;
+        }
+
+        threads = std::move(recordedThreads);
+        recordedThreads.clear();
+        start = sessionStart;
+    }
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open())
+    {
+        Logger::error(L"Failed to open {} to write the call trace", path.wstring());
+        return false;
+    }
+
+    // Complete ("X") events of the Chrome trace event format
+    file << std::fixed << std::setprecision(3) << "{\"traceEvents\":[";
+
+    const auto processId = GetCurrentProcessId();
+    bool first = true;
+    size_t dropped = 0;
+    for (const auto& thread : threads)
+    {
+        const size_t count = thread->count.load(std::memory_order_acquire);
+        for (size_t i = 0; i < count; ++i)
+        {
+            const auto& span = thread->spans[i];
+            file << (first ? "\n" : ",\n") << "{\"name\":";
+            WriteJsonString(file, span.name);
+            file << ",\"ph\":\"X\",\"pid\":" << processId << ",\"tid\":" << thread->threadId
+                 << ",\"ts\":" << ToMicroseconds(span.start - start) << ",\"dur\":" << ToMicroseconds(span.end - span.start) << "}";
+            first = false;
+        }
+
+        dropped += thread->dropped.load(std::memory_order_relaxed);
+    }
+
+    file << "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+    if (dropped > 0)
+    {
+        Logger::warn("The call trace is missing {} calls, the buffers of the threads were full", dropped);
+    }
+
+    return file.good();
 }
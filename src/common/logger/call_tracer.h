@@ -1,15 +1,62 @@
 #pragma once
 
+#include <atomic>
+#include <filesystem>
 #include <string>
 
 #include "logger.h"
 
+// Define DISABLE_CALL_TRACER to compile the traces out
+#ifdef DISABLE_CALL_TRACER
+#define _TRACER_
+#else
 #define _TRACER_ CallTracer callTracer(__FUNCTION__)
+#endif
 
+// Logs entering and exiting the function at trace level, indented by the call depth of the thread.
+// While recording, the call is also recorded as a span, see start_recording.
+// When neither is on, it costs a check.
 class CallTracer
 {
-    std::string functionName;
 public:
-    CallTracer(const char* functionName);
-    ~CallTracer();
+    // functionName must outlive the tracer, like the __FUNCTION__ literal
+    CallTracer(const char* functionName) :
+        functionName(functionName),
+        logged(Logger::should_log(spdlog::level::trace)),
+        recorded(recording.load(std::memory_order_relaxed))
+    {
+        if (logged | recorded)
+        {
+            on_enter();
+        }
+    }
+
+    ~CallTracer()
+    {
+        if (logged | recorded)
+        {
+            on_exit();
+        }
+    }
+
+    CallTracer(const CallTracer&) = delete;
+    CallTracer& operator=(const CallTracer&) = delete;
+
+    // Starts recording the traced calls of all threads, in a buffer per thread. Drops the previous recording.
+    static void start_recording();
+
+    // Stops recording and writes the recorded calls as Chrome trace events, which chrome://tracing and
+    // https://ui.perfetto.dev show as flame graphs
+    static bool stop_recording(const std::filesystem::path& path);
+
+private:
+    inline static std::atomic<bool> recording = false;
+
+    const char* functionName;
+    bool logged;
+    bool recorded;
+    long long startTime = 0;
+
+    void on_enter();
+    void on_exit();
 };
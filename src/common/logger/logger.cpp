@@ -3,6 +3,10 @@
 #include "pch.h"
 #include "framework.h"
 #include "logger.h"
+#include "async_sink.h"
+#include "call_tracer.h"
+#include <cstdlib>
+#include <filesystem>
 #include <unordered_map>
 #include <spdlog/sinks/daily_file_sink.h>
 #include <spdlog/sinks/msvc_sink.h>
@@ -27,11 +31,26 @@ namespace
         { L"critical", level_enum::critical },
         { L"off", level_enum::off },
     };
+
+    // Written when the process exits
+    std::filesystem::path callTracePath;
+
+    void startCallTrace(const std::wstring& logFilePath)
+    {
+        if (!callTracePath.empty())
+        {
+            return;
+        }
+
+        callTracePath = std::filesystem::path(logFilePath).replace_filename(L"call-trace-" + std::to_wstring(GetCurrentProcessId()) + L".json");
+        CallTracer::start_recording();
+        std::atexit([] { CallTracer::stop_recording(callTracePath); });
+    }
 }
 
-level_enum getLogLevel(std::wstring_view logSettingsPath)
+level_enum getLogLevel(const LogSettings& settings)
 {
-    auto logLevel = get_log_settings(logSettingsPath).logLevel;
+    auto logLevel = settings.logLevel;
     if (auto it = logLevelMapping.find(logLevel); it != logLevelMapping.end())
     {
         return it->second;
@@ -45,6 +64,7 @@ level_enum getLogLevel(std::wstring_view logSettingsPath)
 }
 
 std::shared_ptr<spdlog::logger> Logger::logger = spdlog::null_logger_mt("null");
+std::shared_ptr<AsyncSink> Logger::asyncSink;
 
 bool Logger::wasLogFailedShown()
 {
@@ -55,25 +75,32 @@ bool Logger::wasLogFailedShown()
     return len;
 }
 
-void Logger::init(std::string loggerName, std::wstring logFilePath, std::wstring_view logSettingsPath)
+void Logger::init(std::string loggerName, std::wstring logFilePath, std::wstring_view logSettingsPath, std::optional<AsyncLogOptions> asyncOptions)
 {
-    auto logLevel = getLogLevel(logSettingsPath);
+    auto settings = get_log_settings(logSettingsPath);
+    auto logLevel = getLogLevel(settings);
     bool newLoggerCreated = false;
     try
     {
         logger = spdlog::get(loggerName);
         if (logger == nullptr)
         {
-            auto sink = make_shared<daily_file_sink_mt>(logFilePath, 0, 0, false, LogSettings::retention);
+            std::vector<spdlog::sink_ptr> sinks{ make_shared<daily_file_sink_mt>(logFilePath, 0, 0, false, LogSettings::retention) };
             if (IsDebuggerPresent())
             {
                 auto msvc_sink = make_shared<msvc_sink_mt>();
                 msvc_sink->set_pattern("[%Y-%m-%d %H:%M:%S.%f] [%n] [t-%t] [%l] %v");
-                logger = make_shared<spdlog::logger>(loggerName, sinks_init_list{ sink, msvc_sink });
+                sinks.push_back(msvc_sink);
+            }
+
+            if (asyncOptions)
+            {
+                asyncSink = make_shared<AsyncSink>(std::move(sinks), *asyncOptions);
+                logger = make_shared<spdlog::logger>(loggerName, asyncSink);
             }
             else
             {
-                logger = make_shared<spdlog::logger>(loggerName, sink);
+                logger = make_shared<spdlog::logger>(loggerName, begin(sinks), end(sinks));
             }
             newLoggerCreated = true;
         }
@@ -99,13 +126,26 @@ void Logger::init(std::string loggerName, std::wstring logFilePath, std::wstring
     {
         logger->set_level(logLevel);
         logger->set_pattern("[%Y-%m-%d %H:%M:%S.%f] [p-%P] [t-%t] [%l] %v");
-        logger->flush_on(logLevel); // Auto flush on every log message.
+        if (!asyncSink)
+        {
+            logger->flush_on(logLevel); // Auto flush on every log message.
+        }
         spdlog::register_logger(logger);
+
+        if (settings.traceCalls)
+        {
+            startCallTrace(logFilePath);
+        }
     }
 
     logger->info("{} logger is initialized", loggerName);
 }
 
+AsyncLogStats Logger::async_stats()
+{
+    return asyncSink ? asyncSink->stats() : AsyncLogStats{};
+}
+
 void Logger::init(std::vector<spdlog::sink_ptr> sinks)
 {
     auto init_logger = std::make_shared<spdlog::logger>("", begin(sinks), end(sinks));
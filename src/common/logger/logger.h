@@ -1,18 +1,25 @@
 #pragma once
+#include <optional>
 #include <spdlog/spdlog.h>
+#include "async_log_writer.h"
 #include "logger_settings.h"
 
+class AsyncSink;
+
 class Logger
 {
 private:
     inline const static std::wstring logFailedShown = L"logFailedShown";
     static std::shared_ptr<spdlog::logger> logger;
+    static std::shared_ptr<AsyncSink> asyncSink;
     static bool wasLogFailedShown();
 
 public:
     Logger() = delete;
 
-    static void init(std::string loggerName, std::wstring logFilePath, std::wstring_view logSettingsPath);
+    // With asyncOptions the messages are written on a background thread, for the processes logging from hooks.
+    // Logger::flush still writes everything logged so far.
+    static void init(std::string loggerName, std::wstring logFilePath, std::wstring_view logSettingsPath, std::optional<AsyncLogOptions> asyncOptions = std::nullopt);
     static void init(std::vector<spdlog::sink_ptr> sinks);
 
     // log message should not be localized
@@ -57,8 +64,16 @@ public:
         logger->critical(fmt, args...);
     }
 
+    static bool should_log(spdlog::level::level_enum level)
+    {
+        return logger->should_log(level);
+    }
+
     static void flush()
     {
         logger->flush();
     }
+
+    // Empty unless the logger is asynchronous
+    static AsyncLogStats async_stats();
 };
@@ -10,6 +10,7 @@ using namespace winrt::Windows::Data::Json;
 LogSettings::LogSettings()
 {
     logLevel = defaultLogLevel;
+    traceCalls = false;
 }
 
 std::optional<JsonObject> from_file(std::wstring_view file_name)
@@ -47,6 +48,7 @@ JsonObject to_json(LogSettings settings)
 {
     JsonObject result;
     result.SetNamedValue(LogSettings::logLevelOption, JsonValue::CreateStringValue(settings.logLevel));
+    result.SetNamedValue(LogSettings::traceCallsOption, JsonValue::CreateBooleanValue(settings.traceCalls));
 
     return result;
 }
@@ -56,13 +58,15 @@ LogSettings to_settings(JsonObject jobject)
     LogSettings result;
     try
     {
+        // Parsed first, so that a missing log level keeps it
+        result.traceCalls = jobject.GetNamedBoolean(LogSettings::traceCallsOption, false);
         result.logLevel = jobject.GetNamedString(LogSettings::logLevelOption);
     }
     catch (...)
     {
         result.logLevel = LogSettings::defaultLogLevel;
     }
-    
+
     return result;
 }
 
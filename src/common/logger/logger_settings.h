@@ -6,6 +6,7 @@ struct LogSettings
     // The following strings are not localizable
     inline const static std::wstring defaultLogLevel = L"trace";
     inline const static std::wstring logLevelOption = L"logLevel";
+    inline const static std::wstring traceCallsOption = L"traceCalls";
     inline const static std::string runnerLoggerName = "runner";
     inline const static std::wstring logPath = L"Logs\\";
     inline const static std::wstring runnerLogPath = L"RunnerLogs\\runner-log.txt";
@@ -78,6 +79,8 @@ struct LogSettings
     inline const static std::wstring workspacesSnapshotToolLogPath = L"workspaces-snapshot-tool-log.txt";
     inline const static int retention = 30;
     std::wstring logLevel;
+    // Record the calls traced by _TRACER_ and write them next to the log when the process exits
+    bool traceCalls;
     LogSettings();
 };
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <filesystem>
+#include <optional>
 #include <common/version/version.h>
 #include <common/SettingsAPI/settings_helpers.h>
 
@@ -81,7 +82,8 @@ namespace LoggerHelpers
         return result;
     }
 
-    inline void init_logger(std::wstring moduleName, std::wstring internalPath, std::string loggerName)
+    // Pass asyncOptions to write the log on a background thread, see Logger::init
+    inline void init_logger(std::wstring moduleName, std::wstring internalPath, std::string loggerName, std::optional<AsyncLogOptions> asyncOptions = std::nullopt)
     {
         std::filesystem::path rootFolder(PTSettingsHelper::get_module_save_folder_location(moduleName));
         rootFolder.append(internalPath);
@@ -92,7 +94,7 @@ namespace LoggerHelpers
 
         auto logsPath = currentFolder;
         logsPath.append(L"log.txt");
-        Logger::init(loggerName, logsPath.wstring(), PTSettingsHelper::get_log_settings_file_location());
+        Logger::init(loggerName, logsPath.wstring(), PTSettingsHelper::get_log_settings_file_location(), asyncOptions);
 
         delete_other_versions_log_folders(rootFolder.wstring(), currentFolder); 
     }
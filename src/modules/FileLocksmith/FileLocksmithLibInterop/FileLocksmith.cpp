@@ -1,6 +1,7 @@
 #include "pch.h"
 
 #include "FileLocksmith.h"
+#include "KernelPathTrie.h"
 #include "NtdllExtensions.h"
 
 static bool is_directory(const std::wstring path)
@@ -9,72 +10,67 @@ static bool is_directory(const std::wstring path)
     return attributes != INVALID_FILE_ATTRIBUTES && attributes & FILE_ATTRIBUTE_DIRECTORY;
 }
 
-// C++20 method
-static constexpr bool starts_with(std::wstring_view whole, std::wstring_view part)
-{
-    return whole.size() >= part.size() && whole.substr(0, part.size()) == part;
-}
-
-std::vector<ProcessResult> find_processes_recursive(const std::vector<std::wstring>& paths)
+std::vector<ProcessResult> find_processes_recursive(const std::vector<std::wstring>& paths, const std::function<void(const ProcessResult&)>& on_progress)
 {
     NtdllExtensions nt_ext;
 
-    // TODO use a trie!
-
-    // This maps kernel names of files within `paths` to their normal paths.
-    std::map<std::wstring, std::wstring> kernel_names_files;
-
-    // This maps kernel names of directories within `paths` to their normal paths.
-    std::map<std::wstring, std::wstring> kernel_names_dirs;
+    // This maps kernel names of files and directories within `paths` to their normal paths.
+    KernelPathTrie kernel_names;
 
     for (const auto& path : paths)
     {
         auto kernel_path = nt_ext.path_to_kernel_name(path.c_str());
         if (!kernel_path.empty())
         {
-            (is_directory(path) ? kernel_names_dirs : kernel_names_files)[kernel_path] = path;
+            kernel_names.insert(kernel_path, path, is_directory(path));
         }
     }
 
     std::map<ULONG_PTR, std::set<std::wstring>> pid_files;
 
-    // Returns a normal path of the file specified by kernel_name, if it matches
-    // the search criteria. Otherwise, return an empty string.
-    auto kernel_paths_contain = [&](const std::wstring& kernel_name) -> std::wstring
-    {
-        // Normal equivalence
-        if (auto it = kernel_names_files.find(kernel_name); it != kernel_names_files.end())
-        {
-            return it->second;
-        }
+    // Processes with files found since the last progress report.
+    std::set<ULONG_PTR> changed_pids;
+    std::map<DWORD, std::wstring> names;
+    std::map<ULONG_PTR, std::wstring> users;
 
-        if (auto it = kernel_names_dirs.find(kernel_name); it != kernel_names_dirs.end())
+    auto report_progress = [&] {
+        if (!on_progress)
         {
-            return it->second;
+            return;
         }
 
-        for (const auto& [dir_kernel_name, dir_path] : kernel_names_dirs)
+        for (auto pid : changed_pids)
         {
-            if (starts_with(kernel_name, dir_kernel_name + (dir_kernel_name.length()>0&&dir_kernel_name[dir_kernel_name.length()-1]!=L'\\' ? L"\\" : L"")))
+            auto user = users.find(pid);
+            if (user == users.end())
             {
-                return dir_path + kernel_name.substr(dir_kernel_name.size());
+                user = users.emplace(pid, nt_ext.pid_to_user(static_cast<DWORD>(pid))).first;
             }
+
+            const auto& files = pid_files[pid];
+            on_progress(ProcessResult{ names[static_cast<DWORD>(pid)], static_cast<DWORD>(pid), user->second, std::vector(files.begin(), files.end()) });
         }
 
-        return {};
+        changed_pids.clear();
     };
 
-    for (const auto& handle_info : nt_ext.handles())
+    if (on_progress)
     {
-        if (handle_info.type_name == L"File")
+        names = nt_ext.process_names();
+    }
+
+    nt_ext.handles([&](std::vector<NtdllExtensions::HandleInfo>& handles) {
+        for (auto& handle_info : handles)
         {
-            auto path = kernel_paths_contain(handle_info.kernel_file_name);
-            if (!path.empty())
+            auto path = kernel_names.find(handle_info.kernel_file_name);
+            if (!path.empty() && pid_files[handle_info.pid].insert(std::move(path)).second)
             {
-                pid_files[handle_info.pid].insert(std::move(path));
+                changed_pids.insert(handle_info.pid);
             }
         }
-    }
+
+        report_progress();
+    });
 
     // Check all modules used by processes
     auto processes = nt_ext.processes();
@@ -85,12 +81,14 @@ std::vector<ProcessResult> find_processes_recursive(const std::vector<std::wstri
         {
             auto kernel_name = nt_ext.path_to_kernel_name(path.c_str());
 
-            auto found_path = kernel_paths_contain(kernel_name);
-            if (!found_path.empty())
+            auto found_path = kernel_names.find(kernel_name);
+            if (!found_path.empty() && pid_files[process.pid].insert(std::move(found_path)).second)
             {
-                pid_files[process.pid].insert(std::move(found_path));
+                changed_pids.insert(process.pid);
             }
         }
+
+        report_progress();
     }
 
     std::vector<ProcessResult> result;
@@ -2,6 +2,8 @@
 
 #include "pch.h"
 
+#include <functional>
+
 struct ProcessResult
 {
     std::wstring name;
@@ -11,7 +13,8 @@ struct ProcessResult
 };
 
 // Second version, checks handles towards files and all subfiles and folders of given dirs, if any.
-std::vector<ProcessResult> find_processes_recursive(const std::vector<std::wstring>& paths);
+// on_progress is called with a process as soon as it's found, and again when more of its files are found.
+std::vector<ProcessResult> find_processes_recursive(const std::vector<std::wstring>& paths, const std::function<void(const ProcessResult&)>& on_progress = nullptr);
 
 // Gives the full path of the executable, given the process id
 std::wstring pid_to_full_path(DWORD pid);
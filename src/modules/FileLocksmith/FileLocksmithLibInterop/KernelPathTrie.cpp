@@ -0,0 +1,181 @@
+#include "pch.h"
+
+#include "KernelPathTrie.h"
+
+#include <algorithm>
+#include <cwctype>
+
+namespace
+{
+    // Returns the component of path at pos, skipping leading backslashes, and moves pos past it.
+    // Returns an empty string at the end of path.
+    std::wstring_view next_component(std::wstring_view path, size_t& pos)
+    {
+        while (pos < path.size() && path[pos] == L'\\')
+        {
+            pos++;
+        }
+
+        const size_t start = pos;
+        while (pos < path.size() && path[pos] != L'\\')
+        {
+            pos++;
+        }
+
+        return path.substr(start, pos - start);
+    }
+
+    bool at_end(std::wstring_view path, size_t pos)
+    {
+        return next_component(path, pos).empty();
+    }
+
+    bool components_equal(std::wstring_view a, std::wstring_view b)
+    {
+        return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](wchar_t x, wchar_t y) {
+                   return x == y || std::towlower(x) == std::towlower(y);
+               });
+    }
+
+    // Matches the components of edge with the components of path at pos, moving pos past the matched ones.
+    // Returns the length of the matched part of edge.
+    size_t match_edge(std::wstring_view edge, std::wstring_view path, size_t& pos)
+    {
+        size_t edge_pos = 0;
+        while (true)
+        {
+            size_t next_edge_pos = edge_pos;
+            size_t next_pos = pos;
+            const auto edge_component = next_component(edge, next_edge_pos);
+            if (edge_component.empty() || !components_equal(edge_component, next_component(path, next_pos)))
+            {
+                return edge_pos;
+            }
+
+            edge_pos = next_edge_pos;
+            pos = next_pos;
+        }
+    }
+
+    std::wstring join_components(std::wstring_view path)
+    {
+        std::wstring result;
+        size_t pos = 0;
+        for (auto component = next_component(path, pos); !component.empty(); component = next_component(path, pos))
+        {
+            if (!result.empty())
+            {
+                result += L'\\';
+            }
+            result += component;
+        }
+
+        return result;
+    }
+}
+
+void KernelPathTrie::insert(std::wstring_view kernel_name, std::wstring path, bool is_directory)
+{
+    Node* node = &m_root;
+    size_t pos = 0;
+
+    while (!at_end(kernel_name, pos))
+    {
+        // The edges of the children of a node start with different components
+        auto child = std::find_if(node->children.begin(), node->children.end(), [&](const Node& candidate) {
+            size_t edge_pos = 0;
+            size_t name_pos = pos;
+            return components_equal(next_component(candidate.edge, edge_pos), next_component(kernel_name, name_pos));
+        });
+
+        if (child == node->children.end())
+        {
+            node->children.push_back(Node{ .edge = join_components(kernel_name.substr(pos)) });
+            node = &node->children.back();
+            break;
+        }
+
+        const size_t matched = match_edge(child->edge, kernel_name, pos);
+        if (matched < child->edge.size())
+        {
+            // Split the edge where kernel_name leaves it
+            Node tail = std::move(*child);
+            *child = Node{ .edge = tail.edge.substr(0, matched) };
+            tail.edge.erase(0, matched + 1);
+            child->children.push_back(std::move(tail));
+        }
+
+        node = &*child;
+    }
+
+    node->path = std::move(path);
+    node->is_directory = is_directory;
+}
+
+std::wstring KernelPathTrie::find(std::wstring_view kernel_name) const
+{
+    const Node* node = &m_root;
+    size_t pos = 0;
+
+    // The outermost directory containing kernel_name, and the end of its part of kernel_name
+    const Node* directory = nullptr;
+    size_t directory_end = 0;
+
+    while (node)
+    {
+        if (at_end(kernel_name, pos))
+        {
+            if (node->path)
+            {
+                return *node->path;
+            }
+            break;
+        }
+
+        if (node->path && node->is_directory && !directory)
+        {
+            directory = node;
+            directory_end = pos;
+        }
+
+        node = find_child(*node, kernel_name, pos);
+    }
+
+    if (!directory)
+    {
+        return {};
+    }
+
+    const std::wstring& directory_path = *directory->path;
+    auto rest = kernel_name.substr(directory_end);
+    if (!directory_path.empty() && directory_path.back() == L'\\' && !rest.empty() && rest.front() == L'\\')
+    {
+        rest.remove_prefix(1);
+    }
+
+    std::wstring result;
+    result.reserve(directory_path.size() + rest.size());
+    result += directory_path;
+    result += rest;
+    return result;
+}
+
+bool KernelPathTrie::empty() const
+{
+    return m_root.children.empty() && !m_root.path;
+}
+
+const KernelPathTrie::Node* KernelPathTrie::find_child(const Node& node, std::wstring_view kernel_name, size_t& pos)
+{
+    for (const auto& child : node.children)
+    {
+        size_t child_pos = pos;
+        if (match_edge(child.edge, kernel_name, child_pos) == child.edge.size())
+        {
+            pos = child_pos;
+            return &child;
+        }
+    }
+
+    return nullptr;
+}
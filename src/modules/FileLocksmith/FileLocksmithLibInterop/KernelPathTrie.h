@@ -0,0 +1,36 @@
+#pragma once
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Maps kernel names of files and directories to their normal paths, and finds the normal path of a kernel name
+// that is one of the files or directories, or within one of the directories.
+// It's a trie of case insensitive path components, where a chain of nodes without a path is merged into one edge.
+// Doesn't depend on Windows headers.
+class KernelPathTrie
+{
+public:
+    void insert(std::wstring_view kernel_name, std::wstring path, bool is_directory);
+
+    // Returns the normal path of kernel_name if it matches, otherwise an empty string.
+    // Only allocates the returned string.
+    std::wstring find(std::wstring_view kernel_name) const;
+
+    bool empty() const;
+
+private:
+    struct Node
+    {
+        // One or more components separated by a single backslash, without leading or trailing backslashes
+        std::wstring edge;
+        std::vector<Node> children;
+        std::optional<std::wstring> path;
+        bool is_directory = false;
+    };
+
+    Node m_root;
+
+    static const Node* find_child(const Node& node, std::wstring_view kernel_name, size_t& pos);
+};
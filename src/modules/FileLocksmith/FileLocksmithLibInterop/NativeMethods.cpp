@@ -3,6 +3,8 @@
 #include "FileLocksmith.h"
 #include "../FileLocksmithLib/Constants.h"
 
+#include <winrt/Windows.Foundation.Collections.h>
+
 namespace winrt::PowerToys::FileLocksmithLib::Interop::implementation
 {
 
@@ -21,6 +23,20 @@ namespace winrt::PowerToys::FileLocksmithLib::Interop::implementation
         return path;
     }
 
+    winrt::PowerToys::FileLocksmithLib::Interop::ProcessResult to_process_result(const ::ProcessResult& process)
+    {
+        return winrt::PowerToys::FileLocksmithLib::Interop::ProcessResult
+        {
+            hstring{ process.name },
+            process.pid,
+            hstring{ process.user },
+            winrt::com_array<hstring>
+            {
+                process.files.begin(), process.files.end()
+            }
+        };
+    }
+
 #pragma endregion
 
     com_array<winrt::PowerToys::FileLocksmithLib::Interop::ProcessResult> NativeMethods::FindProcessesRecursive(array_view<hstring const> paths)
@@ -28,30 +44,29 @@ namespace winrt::PowerToys::FileLocksmithLib::Interop::implementation
         std::vector<std::wstring> paths_cpp{ paths.begin(), paths.end() };
 
         auto result_cpp = find_processes_recursive(paths_cpp);
-        const auto result_size = static_cast<int>(result_cpp.size());
 
         std::vector<ProcessResult> result;
+        std::transform(result_cpp.begin(), result_cpp.end(), std::back_inserter(result), to_process_result);
 
-        if (result_size == 0)
-        {
-            return com_array<ProcessResult>();
-        }
+        return com_array<ProcessResult>{ result.begin(), result.end() };
+    }
 
-        for (int i = 0; i < result_size; i++)
-        {
-            result.push_back(ProcessResult
-            {
-                hstring { result_cpp[i].name },
-                result_cpp[i].pid,
-                hstring{ result_cpp[i].user },
-                    winrt::com_array<hstring>
-                {
-                    result_cpp[i].files.begin(), result_cpp[i].files.end()
-                }
-            });
-        }
+    Windows::Foundation::IAsyncOperationWithProgress<Windows::Foundation::Collections::IVectorView<ProcessResult>, ProcessResult> NativeMethods::FindProcessesRecursiveAsync(array_view<hstring const> paths)
+    {
+        // paths is only valid until the first suspension
+        std::vector<std::wstring> paths_cpp{ paths.begin(), paths.end() };
 
-        return com_array<ProcessResult>{ result.begin(), result.end() };
+        auto progress = co_await winrt::get_progress_token();
+        co_await winrt::resume_background();
+
+        auto result_cpp = find_processes_recursive(paths_cpp, [&](const ::ProcessResult& process) {
+            progress(to_process_result(process));
+        });
+
+        std::vector<ProcessResult> result;
+        std::transform(result_cpp.begin(), result_cpp.end(), std::back_inserter(result), to_process_result);
+
+        co_return winrt::single_threaded_vector(std::move(result)).GetView();
     }
 
     hstring NativeMethods::PidToFullPath(uint32_t pid)
@@ -8,6 +8,7 @@ namespace winrt::PowerToys::FileLocksmithLib::Interop::implementation
         NativeMethods() = default;
 
         static com_array<winrt::PowerToys::FileLocksmithLib::Interop::ProcessResult> FindProcessesRecursive(array_view<hstring const> paths);
+        static Windows::Foundation::IAsyncOperationWithProgress<Windows::Foundation::Collections::IVectorView<winrt::PowerToys::FileLocksmithLib::Interop::ProcessResult>, winrt::PowerToys::FileLocksmithLib::Interop::ProcessResult> FindProcessesRecursiveAsync(array_view<hstring const> paths);
         static hstring PidToFullPath(uint32_t pid);
         static com_array<hstring> ReadPathsFromFile();
         static bool StartAsElevated(array_view<hstring const> paths);
@@ -3,6 +3,11 @@
 #include "NtdllExtensions.h"
 #include <thread>
 #include <atomic>
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <numeric>
 
 #define STATUS_INFO_LENGTH_MISMATCH ((LONG)0xC0000004)
 
@@ -152,139 +157,315 @@ std::wstring NtdllExtensions::path_to_kernel_name(LPCWSTR path)
     return kernel_name;
 }
 
+namespace
+{
+    // What a handle type index stands for, learned from the first handle of the type
+    enum class HandleType : uint8_t
+    {
+        Unknown,
+        File,
+        Other,
+    };
+
+    // Handles of one process: [begin, end) in HandleEnumeration::order
+    struct HandleShard
+    {
+        ULONG_PTR pid;
+        size_t begin;
+        size_t end;
+    };
+}
+
+struct NtdllExtensions::HandleEnumeration
+{
+    SYSTEM_HANDLE_INFORMATION_EX* info = nullptr;
+
+    // Indices of the handles, sorted by process
+    std::vector<ULONG_PTR> order;
+    std::vector<HandleShard> shards;
+    std::atomic<size_t> next_shard = 0;
+
+    // Indexed by ObjectTypeIndex, so that the type of most handles is known without duplicating them
+    std::array<std::atomic<HandleType>, USHRT_MAX + 1> types{};
+
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::vector<HandleInfo> found;
+};
+
+// The state of a worker thread, kept until the enumeration ends even if the thread is terminated
+struct NtdllExtensions::HandleWorker
+{
+    std::thread thread;
+
+    // The remaining handles of the process the worker is going through
+    ULONG_PTR pid = 0;
+    size_t position = 0;
+    size_t end = 0;
+    HANDLE process_handle = NULL;
+    HANDLE handle_copy = NULL;
+
+    std::vector<BYTE> buffer = std::vector<BYTE>(DefaultResultBufferSize);
+
+    std::atomic<size_t> progress = 0;
+    // Set around the system calls that were reported to hang, the only place where the worker can be terminated
+    std::atomic<bool> in_system_call = false;
+    std::atomic<bool> done = false;
+};
+
+void NtdllExtensions::handle_worker(HandleEnumeration& enumeration, HandleWorker& worker)
+{
+    const auto current_pid = static_cast<ULONG_PTR>(GetCurrentProcessId());
+
+    while (true)
+    {
+        if (worker.position >= worker.end)
+        {
+            if (worker.process_handle)
+            {
+                CloseHandle(worker.process_handle);
+                worker.process_handle = NULL;
+            }
+
+            const size_t shard_index = enumeration.next_shard++;
+            if (shard_index >= enumeration.shards.size())
+            {
+                break;
+            }
+
+            const auto& shard = enumeration.shards[shard_index];
+            worker.pid = shard.pid;
+            worker.position = shard.begin;
+            worker.end = shard.end;
+
+            // Our own handles can't be held by another process
+            worker.process_handle = worker.pid != current_pid ? OpenProcess(PROCESS_DUP_HANDLE, FALSE, static_cast<DWORD>(worker.pid)) : NULL;
+            if (!worker.process_handle)
+            {
+                worker.position = worker.end;
+                continue;
+            }
+        }
+
+        const auto& handle_info = enumeration.info->Handles[enumeration.order[worker.position]];
+        worker.position++;
+        worker.progress++;
+
+        auto& type = enumeration.types[handle_info.ObjectTypeIndex];
+        if (type == HandleType::Other)
+        {
+            continue;
+        }
+
+        // According to this:
+        // https://stackoverflow.com/questions/46384048/enumerate-handles
+        // NtQueryObject could hang. The same was reported for GetFileType.
+        worker.in_system_call = true;
+        HANDLE handle_copy;
+        auto dh_result = DuplicateHandle(worker.process_handle, reinterpret_cast<HANDLE>(handle_info.HandleValue), GetCurrentProcess(), &handle_copy, 0, 0, DUPLICATE_SAME_ACCESS);
+        worker.handle_copy = dh_result ? handle_copy : NULL;
+        worker.in_system_call = false;
+        if (dh_result == 0)
+        {
+            // Ignore this handle.
+            continue;
+        }
+
+        ULONG return_length;
+        if (type == HandleType::Unknown)
+        {
+            worker.in_system_call = true;
+            auto status = NtQueryObject(handle_copy, ObjectTypeInformation, worker.buffer.data(), static_cast<ULONG>(worker.buffer.size()), &return_length);
+            worker.in_system_call = false;
+            if (NT_ERROR(status))
+            {
+                // Ignore this handle.
+                CloseHandle(handle_copy);
+                worker.handle_copy = NULL;
+                continue;
+            }
+
+            auto object_type_info = reinterpret_cast<OBJECT_TYPE_INFORMATION*>(worker.buffer.data());
+            type = unicode_to_view(object_type_info->Name) == L"File" ? HandleType::File : HandleType::Other;
+        }
+
+        bool has_name = false;
+        if (type == HandleType::File)
+        {
+            worker.in_system_call = true;
+            has_name = GetFileType(handle_copy) == FILE_TYPE_DISK &&
+                       NT_SUCCESS(NtQueryObject(handle_copy, ObjectNameInformation, worker.buffer.data(), static_cast<ULONG>(worker.buffer.size()), &return_length));
+            worker.in_system_call = false;
+        }
+
+        CloseHandle(handle_copy);
+        worker.handle_copy = NULL;
+
+        if (type == HandleType::File)
+        {
+            auto file_name = has_name ? unicode_to_str(*reinterpret_cast<UNICODE_STRING*>(worker.buffer.data())) : std::wstring{};
+
+            std::unique_lock lock(enumeration.mutex);
+            enumeration.found.push_back(HandleInfo{ worker.pid, handle_info.HandleValue, L"File", std::move(file_name) });
+            enumeration.changed.notify_one();
+        }
+    }
+
+    std::unique_lock lock(enumeration.mutex);
+    worker.done = true;
+    enumeration.changed.notify_one();
+}
+
 std::vector<NtdllExtensions::HandleInfo> NtdllExtensions::handles() noexcept
+{
+    std::vector<HandleInfo> result;
+    handles([&](std::vector<HandleInfo>& found) {
+        std::move(found.begin(), found.end(), std::back_inserter(result));
+    });
+
+    return result;
+}
+
+void NtdllExtensions::handles(const std::function<void(std::vector<HandleInfo>&)>& on_found) noexcept
 {
     auto get_info_result = NtQuerySystemInformationMemoryLoop(SystemExtendedHandleInformation);
     if (NT_ERROR(get_info_result.status))
     {
-        return {};
+        return;
     }
 
-    auto info_ptr = reinterpret_cast<SYSTEM_HANDLE_INFORMATION_EX*>(get_info_result.memory.data());
+    auto enumeration = std::make_unique<HandleEnumeration>();
+    enumeration->info = reinterpret_cast<SYSTEM_HANDLE_INFORMATION_EX*>(get_info_result.memory.data());
 
-    std::map<ULONG_PTR, HANDLE> pid_to_handle;
-    std::vector<HandleInfo> result;
+    const auto handle_count = enumeration->info->NumberOfHandles;
+    const auto* handle_infos = enumeration->info->Handles;
+    enumeration->order.resize(handle_count);
+    std::iota(enumeration->order.begin(), enumeration->order.end(), ULONG_PTR{ 0 });
+    std::stable_sort(enumeration->order.begin(), enumeration->order.end(), [&](ULONG_PTR a, ULONG_PTR b) {
+        return handle_infos[a].UniqueProcessId < handle_infos[b].UniqueProcessId;
+    });
 
-    std::vector<BYTE> object_info_buffer(DefaultResultBufferSize);
+    for (size_t begin = 0; begin < handle_count;)
+    {
+        const auto pid = handle_infos[enumeration->order[begin]].UniqueProcessId;
+        size_t end = begin + 1;
+        while (end < handle_count && handle_infos[enumeration->order[end]].UniqueProcessId == pid)
+        {
+            end++;
+        }
 
-    std::atomic<ULONG> i = 0;
-    std::atomic<ULONG_PTR> handle_count = info_ptr->NumberOfHandles;
-    std::atomic<HANDLE> process_handle = NULL;
-    std::atomic<HANDLE> handle_copy = NULL;
-    ULONG previous_i;
+        enumeration->shards.push_back(HandleShard{ pid, begin, end });
+        begin = end;
+    }
 
+    // The system calls we use in the workers were reported to hang on some machines.
+    // Unfortunately, there are no alternative APIs to what we're using that accept timeouts. (NtQueryObject and GetFileType)
+    // Each worker is watched, terminated when it doesn't make progress, and replaced by a worker resuming after the handle.
+    std::vector<std::unique_ptr<HandleWorker>> workers;
+    std::vector<HandleWorker*> running;
+    std::map<HandleWorker*, size_t> last_progress;
+
+    auto start_worker = [&](std::unique_ptr<HandleWorker> worker) {
+        auto& started = *worker;
+        workers.push_back(std::move(worker));
+        running.push_back(&started);
+        last_progress[&started] = 0;
+        started.thread = std::thread([this, &enumeration, &started] { handle_worker(*enumeration, started); });
+    };
+
+    const auto worker_count = std::clamp(std::thread::hardware_concurrency(), 1u, MaxHandleWorkers);
+    for (unsigned i = 0; i < worker_count && i < enumeration->shards.size(); i++)
+    {
+        start_worker(std::make_unique<HandleWorker>());
+    }
 
-    while (i < handle_count)
+    std::vector<HandleInfo> found;
+    auto last_check = std::chrono::steady_clock::now();
+    while (!running.empty())
     {
-        previous_i = i;
+        {
+            std::unique_lock lock(enumeration->mutex);
+            enumeration->changed.wait_until(lock, last_check + std::chrono::milliseconds(HandleQueryTimeoutMs), [&] {
+                return !enumeration->found.empty() || std::any_of(running.begin(), running.end(), [](HandleWorker* worker) { return worker->done.load(); });
+            });
+            found.swap(enumeration->found);
+        }
 
-        // The system calls we use in this block were reported to hang on some machines.
-        // We need to offload the cycle to another thread and keep track of progress to terminate and resume when needed.
-        // Unfortunately, there are no alternative APIs to what we're using that accept timeouts. (NtQueryObject and GetFileType)
-        auto offload_function = std::thread([&] {
-            for (; i < handle_count; i++)
-            {
-                process_handle = NULL;
-                handle_copy = NULL;
-
-                auto handle_info = info_ptr->Handles + i;
-                auto pid = handle_info->UniqueProcessId;
-
-                auto iter = pid_to_handle.find(pid);
-                if (iter != pid_to_handle.end())
-                {
-                    process_handle = iter->second;
-                }
-                else
-                {
-                    process_handle = OpenProcess(PROCESS_DUP_HANDLE, FALSE, static_cast<DWORD>(pid));
-                    if (!process_handle)
-                    {
-                        continue;
-                    }
-                    pid_to_handle[pid] = process_handle;
-                }
-
-                // According to this:
-                // https://stackoverflow.com/questions/46384048/enumerate-handles
-                // NtQueryObject could hang
-
-                // TODO uncomment and investigate
-                // if (handle_info->GrantedAccess == 0x0012019f) {
-                //     continue;
-                // }
-
-                HANDLE local_handle_copy;
-                auto dh_result = DuplicateHandle(process_handle, reinterpret_cast<HANDLE>(handle_info->HandleValue), GetCurrentProcess(), &local_handle_copy, 0, 0, DUPLICATE_SAME_ACCESS);
-                if (dh_result == 0)
-                {
-                    // Ignore this handle.
-                    continue;
-                }
-                handle_copy = local_handle_copy;
-
-                ULONG return_length;
-                auto status = NtQueryObject(handle_copy, ObjectTypeInformation, object_info_buffer.data(), static_cast<ULONG>(object_info_buffer.size()), &return_length);
-                if (NT_ERROR(status))
-                {
-                    // Ignore this handle.
-                    CloseHandle(handle_copy);
-                    handle_copy = NULL;
-                    continue;
-                }
-
-                auto object_type_info = reinterpret_cast<OBJECT_TYPE_INFORMATION*>(object_info_buffer.data());
-                auto type_name = unicode_to_str(object_type_info->Name);
-
-                std::wstring file_name;
-
-                if (type_name == L"File")
-                {
-                    file_name = file_handle_to_kernel_name(handle_copy, object_info_buffer);
-                    result.push_back(HandleInfo{ pid, handle_info->HandleValue, type_name, file_name });
-                }
+        if (!found.empty())
+        {
+            on_found(found);
+            found.clear();
+        }
 
-                CloseHandle(handle_copy);
-                handle_copy = NULL;
+        for (auto it = running.begin(); it != running.end();)
+        {
+            auto* worker = *it;
+            if (worker->done)
+            {
+                worker->thread.join();
+                it = running.erase(it);
+            }
+            else
+            {
+                ++it;
             }
-        });
+        }
+
+        if (std::chrono::steady_clock::now() < last_check + std::chrono::milliseconds(HandleQueryTimeoutMs))
+        {
+            continue;
+        }
+        last_check = std::chrono::steady_clock::now();
 
-        offload_function.detach();
-        do
+        for (auto* worker : std::vector(running))
         {
-            Sleep(200); // Timeout in milliseconds for detecting that the system hang on getting information for a handle.
-            if (i >= handle_count)
+            const size_t progress = worker->progress;
+            if (progress != last_progress[worker] || !worker->in_system_call)
             {
-                // We're done.
-                break;
+                last_progress[worker] = progress;
+                continue;
             }
 
-            if (previous_i >= i)
+            // Make sure the worker didn't leave the system call in the meantime, e.g. to take a lock.
+            // GetThreadContext waits for the suspension to take effect.
+            CONTEXT context{};
+            context.ContextFlags = CONTEXT_CONTROL;
+            SuspendThread(worker->thread.native_handle());
+            GetThreadContext(worker->thread.native_handle(), &context);
+            if (!worker->in_system_call)
             {
-                // The thread looks like it's hanging on some handle. Let's kill it and resume.
+                ResumeThread(worker->thread.native_handle());
+                continue;
+            }
 
-                // HACK: This is unsafe and may leak something, but looks like there's no way to properly clean up a thread when it's hanging on a system call.
-                TerminateThread(offload_function.native_handle(), 1);
+            // The worker looks like it's hanging on a handle. Let's kill it and resume after the handle.
 
-                // Close Handles that might be lingering.
-                if (handle_copy!=NULL)
-                {
-                    CloseHandle(handle_copy);
-                }
-                i++;
-                break;
+            // HACK: This is unsafe and may leak something, but looks like there's no way to properly clean up a thread when it's hanging on a system call.
+            TerminateThread(worker->thread.native_handle(), 1);
+            worker->thread.join();
+
+            // Close the handle that might be lingering.
+            if (worker->handle_copy != NULL)
+            {
+                CloseHandle(worker->handle_copy);
             }
-            previous_i = i;
-        } while (1);
 
+            auto replacement = std::make_unique<HandleWorker>();
+            replacement->pid = worker->pid;
+            replacement->position = worker->position;
+            replacement->end = worker->end;
+            replacement->process_handle = worker->process_handle;
+
+            running.erase(std::find(running.begin(), running.end(), worker));
+            start_worker(std::move(replacement));
+        }
     }
 
-    for (auto [pid, handle] : pid_to_handle)
+    // The workers could find handles after the last call
+    if (!enumeration->found.empty())
     {
-        CloseHandle(handle);
+        on_found(enumeration->found);
     }
-
-    return result;
 }
 
 // Returns the list of all processes.
@@ -340,6 +521,27 @@ std::wstring NtdllExtensions::pid_to_user(DWORD pid)
 }
 
 
+std::map<DWORD, std::wstring> NtdllExtensions::process_names() noexcept
+{
+    auto get_info_result = NtQuerySystemInformationMemoryLoop(SystemProcessInformation);
+
+    if (NT_ERROR(get_info_result.status))
+    {
+        return {};
+    }
+
+    std::map<DWORD, std::wstring> result;
+    auto info_ptr = reinterpret_cast<PSYSTEM_PROCESS_INFORMATION>(get_info_result.memory.data());
+
+    while (info_ptr->NextEntryOffset)
+    {
+        info_ptr = reinterpret_cast<decltype(info_ptr)>(reinterpret_cast<LPBYTE>(info_ptr) + info_ptr->NextEntryOffset);
+        result[static_cast<DWORD>(reinterpret_cast<uintptr_t>(info_ptr->UniqueProcessId))] = unicode_to_str(info_ptr->ImageName);
+    }
+
+    return result;
+}
+
 std::vector<NtdllExtensions::ProcessInfo> NtdllExtensions::processes() noexcept
 {
     auto get_info_result = NtQuerySystemInformationMemoryLoop(SystemProcessInformation);
@@ -2,6 +2,8 @@
 
 #include "pch.h"
 
+#include <functional>
+
 #include "NtdllBase.h"
 
 class NtdllExtensions : protected Ntdll
@@ -13,6 +15,11 @@ private:
     constexpr static int ObjectNameInformation = 1;
     constexpr static int SystemExtendedHandleInformation = 64;
 
+    // Handles are queried by this many threads at most, each one going through the handles of one process at a time
+    constexpr static unsigned MaxHandleWorkers = 4;
+    // A worker stuck in a system call for this long is terminated, and another one resumes after the handle
+    constexpr static DWORD HandleQueryTimeoutMs = 200;
+
     struct MemoryLoopResult
     {
         NTSTATUS status = 0;
@@ -24,6 +31,11 @@ private:
 
     std::wstring file_handle_to_kernel_name(HANDLE file_handle, std::vector<BYTE>& buffer);
 
+    struct HandleEnumeration;
+    struct HandleWorker;
+
+    void handle_worker(HandleEnumeration& enumeration, HandleWorker& worker);
+
 public:
     struct ProcessInfo
     {
@@ -50,6 +62,12 @@ public:
 
     std::vector<HandleInfo> handles() noexcept;
 
+    // Calls on_found on this thread with the file handles found since the previous call, while they're being enumerated.
+    void handles(const std::function<void(std::vector<HandleInfo>&)>& on_found) noexcept;
+
+    // Gives the image names of all processes, without the slower details of processes().
+    std::map<DWORD, std::wstring> process_names() noexcept;
+
     // Returns the list of all processes.
     // On failure, returns an empty vector.
     std::vector<ProcessInfo> processes() noexcept;
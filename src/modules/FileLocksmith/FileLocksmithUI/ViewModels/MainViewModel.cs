@@ -96,27 +96,41 @@ namespace PowerToys.FileLocksmithUI.ViewModels
 
             _cancelProcessWatching = new CancellationTokenSource();
 
-            var processes_found = await FindProcesses(paths);
-            if (processes_found is not null)
+            // Show the processes as they're found, the list is complete once the operation completes.
+            var progress = new Progress<ProcessResult>(process =>
             {
-                foreach (ProcessResult p in processes_found)
-                {
-                    Processes.Add(p);
-                    WatchProcess(p, _cancelProcessWatching.Token);
-                }
+                AddOrUpdateProcess(process);
+                IsLoading = false;
+            });
+            var processes_found = await NativeMethods.FindProcessesRecursiveAsync(paths).AsTask(progress);
+
+            // Processes that exited while searching aren't in the results.
+            foreach (ProcessResult p in Processes.Where(process => processes_found.All(found => found.pid != process.pid)).ToList())
+            {
+                Processes.Remove(p);
+            }
+
+            foreach (ProcessResult p in processes_found)
+            {
+                AddOrUpdateProcess(p);
+                WatchProcess(p, _cancelProcessWatching.Token);
             }
 
             IsLoading = false;
         }
 
-        private async Task<List<ProcessResult>> FindProcesses(string[] paths)
+        private void AddOrUpdateProcess(ProcessResult process)
         {
-            var results = new List<ProcessResult>();
-            await Task.Run(() =>
+            for (int i = 0; i < Processes.Count; i++)
             {
-                results = NativeMethods.FindProcessesRecursive(paths)?.ToList();
-            });
-            return results;
+                if (Processes[i].pid == process.pid)
+                {
+                    Processes[i] = process;
+                    return;
+                }
+            }
+
+            Processes.Add(process);
         }
 
         private async void WatchProcess(ProcessResult process, CancellationToken token)
@@ -0,0 +1,105 @@
+#include "pch.h"
+
+#include <string>
+
+#include <KernelPathTrie.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace KernelPathTrieTests
+{
+    TEST_CLASS (KernelPathTrieTests)
+    {
+    public:
+        TEST_METHOD (FindsNothingWhenEmpty)
+        {
+            KernelPathTrie trie;
+            Assert::IsTrue(trie.empty());
+            Assert::AreEqual(std::wstring(), trie.find(L"\\Device\\HarddiskVolume3\\file.txt"));
+            Assert::AreEqual(std::wstring(), trie.find(L""));
+        }
+
+        TEST_METHOD (FindsExactFile)
+        {
+            KernelPathTrie trie;
+            trie.insert(L"\\Device\\HarddiskVolume3\\Users\\file.txt", L"C:\\Users\\file.txt", false);
+            Assert::IsFalse(trie.empty());
+
+            Assert::AreEqual(std::wstring(L"C:\\Users\\file.txt"), trie.find(L"\\Device\\HarddiskVolume3\\Users\\file.txt"));
+
+            // A file doesn't contain anything, and its name has to match whole components
+            Assert::AreEqual(std::wstring(), trie.find(L"\\Device\\HarddiskVolume3\\Users\\file.txt\\stream"));
+            Assert::AreEqual(std::wstring(), trie.find(L"\\Device\\HarddiskVolume3\\Users\\file.tx"));
+            Assert::AreEqual(std::wstring(), trie.find(L"\\Device\\HarddiskVolume3\\Users\\file.txt2"));
+            Assert::AreEqual(std::wstring(), trie.find(L"\\Device\\HarddiskVolume3\\Users"));
+        }
+
+        TEST_METHOD (FindsPathsWithinDirectory)
+        {
+            KernelPathTrie trie;
+            trie.insert(L"\\Device\\HarddiskVolume3\\Users", L"C:\\Users", true);
+
+            Assert::AreEqual(std::wstring(L"C:\\Users"), trie.find(L"\\Device\\HarddiskVolume3\\Users"));
+            Assert::AreEqual(std::wstring(L"C:\\Users\\a\\file.txt"), trie.find(L"\\Device\\HarddiskVolume3\\Users\\a\\file.txt"));
+            Assert::AreEqual(std::wstring(), trie.find(L"\\Device\\HarddiskVolume3\\UsersOld\\file.txt"));
+            Assert::AreEqual(std::wstring(), trie.find(L"\\Device\\HarddiskVolume2\\Users\\file.txt"));
+        }
+
+        TEST_METHOD (OutermostDirectoryWins)
+        {
+            // The inner directory is selected through another path, e.g. a mapped drive
+            KernelPathTrie trie;
+            trie.insert(L"\\Device\\HarddiskVolume3\\Users\\a\\b", L"X:\\", true);
+            trie.insert(L"\\Device\\HarddiskVolume3\\Users", L"C:\\Users", true);
+
+            Assert::AreEqual(std::wstring(L"C:\\Users\\a\\b\\file.txt"), trie.find(L"\\Device\\HarddiskVolume3\\Users\\a\\b\\file.txt"));
+            Assert::AreEqual(std::wstring(L"C:\\Users\\a\\file.txt"), trie.find(L"\\Device\\HarddiskVolume3\\Users\\a\\file.txt"));
+
+            // An exact match is still reported with its own path
+            Assert::AreEqual(std::wstring(L"X:\\"), trie.find(L"\\Device\\HarddiskVolume3\\Users\\a\\b"));
+        }
+
+        TEST_METHOD (FindsPathsWithinDriveRoot)
+        {
+            KernelPathTrie trie;
+            trie.insert(L"\\Device\\HarddiskVolume3\\", L"C:\\", true);
+
+            Assert::AreEqual(std::wstring(L"C:\\"), trie.find(L"\\Device\\HarddiskVolume3\\"));
+            Assert::AreEqual(std::wstring(L"C:\\"), trie.find(L"\\Device\\HarddiskVolume3"));
+            Assert::AreEqual(std::wstring(L"C:\\file.txt"), trie.find(L"\\Device\\HarddiskVolume3\\file.txt"));
+            Assert::AreEqual(std::wstring(L"C:\\Users\\file.txt"), trie.find(L"\\Device\\HarddiskVolume3\\Users\\file.txt"));
+            Assert::AreEqual(std::wstring(), trie.find(L"\\Device\\HarddiskVolume30\\file.txt"));
+        }
+
+        TEST_METHOD (MatchesCaseInsensitively)
+        {
+            KernelPathTrie trie;
+            trie.insert(L"\\Device\\HarddiskVolume3\\Users\\File.txt", L"C:\\Users\\File.txt", false);
+            trie.insert(L"\\Device\\HarddiskVolume3\\Program Files", L"C:\\Program Files", true);
+
+            Assert::AreEqual(std::wstring(L"C:\\Users\\File.txt"), trie.find(L"\\DEVICE\\harddiskvolume3\\users\\FILE.TXT"));
+
+            // The part within the directory keeps the case of the kernel name
+            Assert::AreEqual(std::wstring(L"C:\\Program Files\\App\\App.exe"), trie.find(L"\\device\\HARDDISKVOLUME3\\program files\\App\\App.exe"));
+        }
+
+        TEST_METHOD (KeepsSiblingsWhenSplittingEdges)
+        {
+            KernelPathTrie trie;
+            trie.insert(L"\\Device\\HarddiskVolume3\\Users\\a\\one.txt", L"C:\\Users\\a\\one.txt", false);
+            trie.insert(L"\\Device\\HarddiskVolume3\\Users\\b", L"C:\\Users\\b", true);
+            trie.insert(L"\\Device\\HarddiskVolume3\\Users\\a\\two.txt", L"C:\\Users\\a\\two.txt", false);
+            trie.insert(L"\\Device\\HarddiskVolume2\\Data", L"D:\\Data", true);
+
+            Assert::AreEqual(std::wstring(L"C:\\Users\\a\\one.txt"), trie.find(L"\\Device\\HarddiskVolume3\\Users\\a\\one.txt"));
+            Assert::AreEqual(std::wstring(L"C:\\Users\\a\\two.txt"), trie.find(L"\\Device\\HarddiskVolume3\\Users\\a\\two.txt"));
+            Assert::AreEqual(std::wstring(L"C:\\Users\\b\\three.txt"), trie.find(L"\\Device\\HarddiskVolume3\\Users\\b\\three.txt"));
+            Assert::AreEqual(std::wstring(L"D:\\Data\\four.txt"), trie.find(L"\\Device\\HarddiskVolume2\\Data\\four.txt"));
+
+            // The nodes created by the splits don't have a path
+            Assert::AreEqual(std::wstring(), trie.find(L"\\Device\\HarddiskVolume3\\Users\\a"));
+            Assert::AreEqual(std::wstring(), trie.find(L"\\Device\\HarddiskVolume3\\Users\\a\\three.txt"));
+            Assert::AreEqual(std::wstring(), trie.find(L"\\Device"));
+        }
+    };
+}
@@ -2,6 +2,7 @@
 
 #include "constants.h"
 #include "EdgeDetection.h"
+#include "EdgeScanKernels.h"
 
 template<bool PerChannel,
          bool IsX,
@@ -10,51 +11,29 @@ inline long FindEdge(const BGRATextureView& texture, const POINT centerPoint, co
 {
     using namespace consts;
 
-    const size_t maxDim = IsX ? texture.width : texture.height;
+    const long maxDim = static_cast<long>(IsX ? texture.width : texture.height);
 
-    long x = std::clamp<long>(centerPoint.x, 1, static_cast<long>(texture.width - 2));
-    long y = std::clamp<long>(centerPoint.y, 1, static_cast<long>(texture.height - 2));
+    const long x = std::clamp<long>(centerPoint.x, 1, static_cast<long>(texture.width - 2));
+    const long y = std::clamp<long>(centerPoint.y, 1, static_cast<long>(texture.height - 2));
 
     const uint32_t startPixel = texture.GetPixel(x, y);
-    while (true)
-    {
-        long oldX = x;
-        long oldY = y;
-        if constexpr (IsX)
-        {
-            if constexpr (Increment)
-            {
-                if (++x == maxDim)
-                    break;
-            }
-            else
-            {
-                if (--x == 0)
-                    break;
-            }
-        }
-        else
-        {
-            if constexpr (Increment)
-            {
-                if (++y == maxDim)
-                    break;
-            }
-            else
-            {
-                if (--y == 0)
-                    break;
-            }
-        }
+    const long startPos = IsX ? x : y;
+
+    // Pixels are scanned from the neighbor of the start pixel towards the edge. The last pixel is
+    // checked when incrementing, but pixel 0 isn't checked when decrementing.
+    const long firstPos = Increment ? startPos + 1 : startPos - 1;
+    const size_t count = static_cast<size_t>(Increment ? maxDim - 1 - startPos : startPos - 1);
+    const ptrdiff_t pitch = static_cast<ptrdiff_t>(texture.pitch);
+    const ptrdiff_t stride = (IsX ? 1 : pitch) * (Increment ? 1 : -1);
+    const uint32_t* first = texture.pixels + (IsX ? firstPos + pitch * y : x + pitch * firstPos);
 
-        const uint32_t nextPixel = texture.GetPixel(x, y);
-        if (!texture.PixelsClose<PerChannel>(startPixel, nextPixel, tolerance))
-        {
-            return IsX ? oldX : oldY;
-        }
+    const long closeCount = static_cast<long>(CountClosePixels<PerChannel>(first, stride, count, startPixel, tolerance));
+    if (closeCount == static_cast<long>(count))
+    {
+        return Increment ? maxDim - 1 : 0;
     }
 
-    return Increment ? static_cast<long>(IsX ? texture.width : texture.height) - 1 : 0;
+    return Increment ? startPos + closeCount : startPos - closeCount;
 }
 
 template<bool PerChannel>
@@ -85,3 +64,30 @@ RECT DetectEdges(const BGRATextureView& texture,
 
     return function(texture, centerPoint, tolerance);
 }
+
+template<bool PerChannel>
+inline std::pair<long, long> DetectEdgesAlongAxisInternal(const BGRATextureView& texture,
+                                                          const POINT centerPoint,
+                                                          const uint8_t tolerance,
+                                                          const bool isX)
+{
+    if (isX)
+    {
+        return { FindEdge<PerChannel, true, false>(texture, centerPoint, tolerance),
+                 FindEdge<PerChannel, true, true>(texture, centerPoint, tolerance) };
+    }
+
+    return { FindEdge<PerChannel, false, false>(texture, centerPoint, tolerance),
+             FindEdge<PerChannel, false, true>(texture, centerPoint, tolerance) };
+}
+
+std::pair<long, long> DetectEdgesAlongAxis(const BGRATextureView& texture,
+                                           const POINT centerPoint,
+                                           const bool perChannel,
+                                           const uint8_t tolerance,
+                                           const bool isX)
+{
+    auto function = perChannel ? &DetectEdgesAlongAxisInternal<true> : DetectEdgesAlongAxisInternal<false>;
+
+    return function(texture, centerPoint, tolerance, isX);
+}
@@ -2,7 +2,16 @@
 
 #include "BGRATextureView.h"
 
+#include <utility>
+
 RECT DetectEdges(const BGRATextureView& texture,
                  const POINT centerPoint,
                  const bool perChannel,
-                 const uint8_t tolerance);
\ No newline at end of file
+                 const uint8_t tolerance);
+
+// Same as DetectEdges, but only scans one axis. Returns {left, right} if isX and {top, bottom} otherwise.
+std::pair<long, long> DetectEdgesAlongAxis(const BGRATextureView& texture,
+                                           const POINT centerPoint,
+                                           const bool perChannel,
+                                           const uint8_t tolerance,
+                                           const bool isX);
@@ -0,0 +1,233 @@
+#include "pch.h"
+
+#include "EdgeDetection.h"
+#include "EdgeDetectionCache.h"
+
+namespace
+{
+    template<bool IsX>
+    inline uint32_t GetLinePixel(const BGRATextureView& texture, const size_t line, const size_t pos)
+    {
+        return IsX ? texture.GetPixel(pos, line) : texture.GetPixel(line, pos);
+    }
+
+    template<bool PerChannel, bool IsX>
+    std::pair<long, long> FindEdgesFromRuns(const BGRATextureView& texture,
+                                            const std::vector<uint32_t>& starts,
+                                            const size_t line,
+                                            const long startPos,
+                                            const uint8_t tolerance)
+    {
+        const uint32_t startPixel = GetLinePixel<IsX>(texture, line, startPos);
+        const long maxDim = static_cast<long>(IsX ? texture.width : texture.height);
+        const auto startRunIt = std::upper_bound(begin(starts), end(starts), static_cast<uint32_t>(startPos));
+        const size_t startRun = static_cast<size_t>(startRunIt - begin(starts)) - 1;
+
+        // Since each run consists of identical pixels, checking one pixel per run is enough.
+        // Same as FindEdge, pixel 0 is never checked when going backwards.
+        long low = 0;
+        for (size_t run = startRun; run > 0; --run)
+        {
+            const uint32_t prevRunEnd = starts[run] - 1;
+            if (prevRunEnd == 0)
+            {
+                break;
+            }
+
+            if (!BGRATextureView::PixelsClose<PerChannel>(startPixel, GetLinePixel<IsX>(texture, line, prevRunEnd), tolerance))
+            {
+                low = static_cast<long>(prevRunEnd) + 1;
+                break;
+            }
+        }
+
+        long high = maxDim - 1;
+        for (size_t run = startRun + 1; run < starts.size(); ++run)
+        {
+            if (!BGRATextureView::PixelsClose<PerChannel>(startPixel, GetLinePixel<IsX>(texture, line, starts[run]), tolerance))
+            {
+                high = static_cast<long>(starts[run]) - 1;
+                break;
+            }
+        }
+
+        return { low, high };
+    }
+
+    template<bool IsX>
+    std::pair<long, long> FindEdgesFromRuns(const BGRATextureView& texture,
+                                            const std::vector<uint32_t>& starts,
+                                            const size_t line,
+                                            const long startPos,
+                                            const bool perChannel,
+                                            const uint8_t tolerance)
+    {
+        auto function = perChannel ? &FindEdgesFromRuns<true, IsX> : &FindEdgesFromRuns<false, IsX>;
+
+        return function(texture, starts, line, startPos, tolerance);
+    }
+}
+
+EdgeDetectionCache::EdgeDetectionCache(const bool summarizeOnFirstQuery_) :
+    summarizeOnFirstQuery{ summarizeOnFirstQuery_ }
+{
+}
+
+void EdgeDetectionCache::Invalidate()
+{
+    for (auto& runs : rows)
+    {
+        runs.state = LineState::Dirty;
+    }
+
+    for (auto& runs : columns)
+    {
+        runs.state = LineState::Dirty;
+    }
+}
+
+void EdgeDetectionCache::InvalidateRect(const RECT& rect)
+{
+    const size_t top = static_cast<size_t>(std::max(rect.top, 0L));
+    const size_t bottom = std::min(static_cast<size_t>(std::max(rect.bottom + 1, 0L)), rows.size());
+    for (size_t row = top; row < bottom; ++row)
+    {
+        rows[row].state = LineState::Dirty;
+    }
+
+    const size_t left = static_cast<size_t>(std::max(rect.left, 0L));
+    const size_t right = std::min(static_cast<size_t>(std::max(rect.right + 1, 0L)), columns.size());
+    for (size_t column = left; column < right; ++column)
+    {
+        columns[column].state = LineState::Dirty;
+    }
+}
+
+void EdgeDetectionCache::SummarizeRow(const BGRATextureView& texture, const size_t row)
+{
+    LineRuns& runs = rows[row];
+    runs.starts.clear();
+    runs.starts.push_back(0);
+
+    uint32_t prevPixel = texture.GetPixel(0, row);
+    for (size_t x = 1; x < width; ++x)
+    {
+        const uint32_t pixel = texture.GetPixel(x, row);
+        if (pixel != prevPixel)
+        {
+            runs.starts.push_back(static_cast<uint32_t>(x));
+            prevPixel = pixel;
+        }
+    }
+
+    runs.state = LineState::Summarized;
+}
+
+void EdgeDetectionCache::SummarizeColumns(const BGRATextureView& texture, const size_t first, const size_t last)
+{
+    // Walking down a single column touches a new cache line for every pixel, so all eligible columns
+    // sharing those cache lines are summarized in the same pass.
+    std::array<size_t, COLUMN_STRIP_WIDTH> stripColumns = {};
+    std::array<uint32_t, COLUMN_STRIP_WIDTH> prevPixels = {};
+    size_t stripSize = 0;
+    for (size_t x = first; x < last; ++x)
+    {
+        LineRuns& runs = columns[x];
+        if (runs.state == LineState::Summarized || (runs.state == LineState::Dirty && !summarizeOnFirstQuery))
+        {
+            continue;
+        }
+
+        runs.starts.clear();
+        runs.starts.push_back(0);
+        prevPixels[stripSize] = texture.GetPixel(x, 0);
+        stripColumns[stripSize++] = x;
+    }
+
+    for (size_t y = 1; y < height; ++y)
+    {
+        for (size_t i = 0; i < stripSize; ++i)
+        {
+            const uint32_t pixel = texture.GetPixel(stripColumns[i], y);
+            if (pixel != prevPixels[i])
+            {
+                columns[stripColumns[i]].starts.push_back(static_cast<uint32_t>(y));
+                prevPixels[i] = pixel;
+            }
+        }
+    }
+
+    for (size_t i = 0; i < stripSize; ++i)
+    {
+        columns[stripColumns[i]].state = LineState::Summarized;
+    }
+}
+
+template<bool IsX>
+const EdgeDetectionCache::LineRuns* EdgeDetectionCache::GetRuns(const BGRATextureView& texture, const size_t index)
+{
+    LineRuns& runs = IsX ? rows[index] : columns[index];
+    if (runs.state == LineState::Dirty && !summarizeOnFirstQuery)
+    {
+        runs.state = LineState::Queried;
+        return nullptr;
+    }
+
+    if (runs.state != LineState::Summarized)
+    {
+        if constexpr (IsX)
+        {
+            SummarizeRow(texture, index);
+        }
+        else
+        {
+            const size_t stripStart = index - index % COLUMN_STRIP_WIDTH;
+            SummarizeColumns(texture, stripStart, std::min(stripStart + COLUMN_STRIP_WIDTH, width));
+        }
+    }
+
+    return &runs;
+}
+
+RECT EdgeDetectionCache::DetectEdges(const BGRATextureView& texture,
+                                     const POINT centerPoint,
+                                     const bool perChannel,
+                                     const uint8_t tolerance)
+{
+    if (texture.pitch != pitch || texture.width != width || texture.height != height)
+    {
+        pitch = texture.pitch;
+        width = texture.width;
+        height = texture.height;
+        rows.assign(height, {});
+        columns.assign(width, {});
+    }
+
+    const long x = std::clamp<long>(centerPoint.x, 1, static_cast<long>(width - 2));
+    const long y = std::clamp<long>(centerPoint.y, 1, static_cast<long>(height - 2));
+
+    std::pair<long, long> horizontal;
+    if (const LineRuns* runs = GetRuns<true>(texture, static_cast<size_t>(y)))
+    {
+        horizontal = FindEdgesFromRuns<true>(texture, runs->starts, static_cast<size_t>(y), x, perChannel, tolerance);
+    }
+    else
+    {
+        horizontal = DetectEdgesAlongAxis(texture, centerPoint, perChannel, tolerance, true);
+    }
+
+    std::pair<long, long> vertical;
+    if (const LineRuns* runs = GetRuns<false>(texture, static_cast<size_t>(x)))
+    {
+        vertical = FindEdgesFromRuns<false>(texture, runs->starts, static_cast<size_t>(x), y, perChannel, tolerance);
+    }
+    else
+    {
+        vertical = DetectEdgesAlongAxis(texture, centerPoint, perChannel, tolerance, false);
+    }
+
+    return RECT{ .left = horizontal.first,
+                 .top = vertical.first,
+                 .right = horizontal.second,
+                 .bottom = vertical.second };
+}
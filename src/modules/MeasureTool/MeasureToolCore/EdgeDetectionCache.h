@@ -0,0 +1,60 @@
+#pragma once
+
+#include "BGRATextureView.h"
+
+#include <array>
+#include <vector>
+
+// Keeps run-length summaries of texture rows and columns, so that edges around a new cursor position
+// can be found with a binary search and a hop over each run of identical pixels, instead of
+// comparing pixels one by one. Summaries are built lazily and the owner must invalidate
+// the parts of the texture which have changed since the previous DetectEdges call.
+class EdgeDetectionCache
+{
+public:
+    // If summarizeOnFirstQuery is false, a line is only summarized once it's queried a second time
+    // without being invalidated in between, so a texture which changes every frame never pays for it.
+    explicit EdgeDetectionCache(const bool summarizeOnFirstQuery);
+
+    void Invalidate();
+    // Corners are inclusive
+    void InvalidateRect(const RECT& rect);
+
+    // Gives the same result as ::DetectEdges. All summaries are dropped if the texture dimensions change.
+    RECT DetectEdges(const BGRATextureView& texture,
+                     const POINT centerPoint,
+                     const bool perChannel,
+                     const uint8_t tolerance);
+
+private:
+    enum class LineState : uint8_t
+    {
+        Dirty,
+        Queried,
+        Summarized
+    };
+
+    struct LineRuns
+    {
+        // Index of the first pixel of each run of identical pixels, the first one is always 0
+        std::vector<uint32_t> starts;
+        LineState state = LineState::Dirty;
+    };
+
+    // Number of adjacent columns which fit into a cache line
+    static constexpr size_t COLUMN_STRIP_WIDTH = 16;
+
+    void SummarizeRow(const BGRATextureView& texture, const size_t row);
+    void SummarizeColumns(const BGRATextureView& texture, const size_t first, const size_t last);
+
+    template<bool IsX>
+    const LineRuns* GetRuns(const BGRATextureView& texture, const size_t index);
+
+    bool summarizeOnFirstQuery = true;
+    size_t pitch = 0;
+    size_t width = 0;
+    size_t height = 0;
+
+    std::vector<LineRuns> rows;
+    std::vector<LineRuns> columns;
+};
@@ -0,0 +1,245 @@
+#include "pch.h"
+
+#include "BGRATextureView.h"
+#include "EdgeScanKernels.h"
+
+#include <bit>
+
+#if !defined(_M_ARM64)
+#include <intrin.h>
+#endif
+
+namespace
+{
+    // SSE2 on x64, NEON on ARM64
+    constexpr size_t BASE_KERNEL_WIDTH = 4;
+    constexpr ptrdiff_t BASE_KERNEL_STEP = static_cast<ptrdiff_t>(BASE_KERNEL_WIDTH);
+    constexpr uint32_t ALL_CLOSE = 0xF;
+
+#if defined(_M_ARM64)
+    using PixelBlock = uint32x4_t;
+
+    template<bool PerChannel>
+    inline PixelBlock BroadcastTolerance(const uint8_t tolerance)
+    {
+        if constexpr (PerChannel)
+        {
+            return vreinterpretq_u32_u8(vdupq_n_u8(tolerance));
+        }
+        else
+        {
+            return vdupq_n_u32(tolerance);
+        }
+    }
+
+    inline PixelBlock BroadcastPixel(const uint32_t pixel)
+    {
+        return vdupq_n_u32(pixel);
+    }
+
+    inline PixelBlock LoadPixels(const uint32_t* first, const ptrdiff_t stride)
+    {
+        if (stride == 1)
+        {
+            return vld1q_u32(first);
+        }
+        else if (stride == -1)
+        {
+            const uint32x4_t pixels = vrev64q_u32(vld1q_u32(first - 3));
+            return vextq_u32(pixels, pixels, 2);
+        }
+
+        uint32x4_t pixels = vdupq_n_u32(first[0]);
+        pixels = vsetq_lane_u32(first[stride], pixels, 1);
+        pixels = vsetq_lane_u32(first[2 * stride], pixels, 2);
+        return vsetq_lane_u32(first[3 * stride], pixels, 3);
+    }
+
+    template<bool PerChannel>
+    inline uint32_t ClosePixelsMask(const PixelBlock pixels, const PixelBlock start, const PixelBlock tolerances)
+    {
+        const uint8x16_t distances = vabdq_u8(vreinterpretq_u8_u32(pixels), vreinterpretq_u8_u32(start));
+        uint32x4_t close;
+        if constexpr (PerChannel)
+        {
+            const uint8x16_t excess = vqsubq_u8(distances, vreinterpretq_u8_u32(tolerances));
+            close = vceqq_u32(vreinterpretq_u32_u8(excess), vdupq_n_u32(0));
+        }
+        else
+        {
+            // The channel sum is truncated to a byte, same as in PixelsClose
+            const uint32x4_t scores = vandq_u32(vpaddlq_u16(vpaddlq_u8(distances)), vdupq_n_u32(0xFF));
+            close = vcleq_u32(scores, tolerances);
+        }
+
+        static const uint32_t laneBits[BASE_KERNEL_WIDTH] = { 1, 2, 4, 8 };
+        return vaddvq_u32(vandq_u32(close, vld1q_u32(laneBits)));
+    }
+#else
+    using PixelBlock = __m128i;
+
+    template<bool PerChannel>
+    inline PixelBlock BroadcastTolerance(const uint8_t tolerance)
+    {
+        if constexpr (PerChannel)
+        {
+            return _mm_set1_epi8(static_cast<char>(tolerance));
+        }
+        else
+        {
+            return _mm_set1_epi32(tolerance);
+        }
+    }
+
+    inline PixelBlock BroadcastPixel(const uint32_t pixel)
+    {
+        return _mm_set1_epi32(static_cast<int>(pixel));
+    }
+
+    inline PixelBlock LoadPixels(const uint32_t* first, const ptrdiff_t stride)
+    {
+        if (stride == 1)
+        {
+            return _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+        }
+        else if (stride == -1)
+        {
+            return _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(first - 3)), _MM_SHUFFLE(0, 1, 2, 3));
+        }
+
+        return _mm_setr_epi32(static_cast<int>(first[0]),
+                              static_cast<int>(first[stride]),
+                              static_cast<int>(first[2 * stride]),
+                              static_cast<int>(first[3 * stride]));
+    }
+
+    template<bool PerChannel>
+    inline uint32_t ClosePixelsMask(const PixelBlock pixels, const PixelBlock start, const PixelBlock tolerances)
+    {
+        const __m128i distances = distance_epu8(pixels, start);
+        if constexpr (PerChannel)
+        {
+            const __m128i excess = _mm_subs_epu8(distances, tolerances);
+            return static_cast<uint32_t>(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(excess, _mm_setzero_si128()))));
+        }
+        else
+        {
+            // The channel sum is truncated to a byte, same as in PixelsClose
+            const __m128i pairSums = _mm_add_epi16(_mm_and_si128(distances, _mm_set1_epi16(0xFF)), _mm_srli_epi16(distances, 8));
+            const __m128i scores = _mm_and_si128(_mm_madd_epi16(pairSums, _mm_set1_epi16(1)), _mm_set1_epi32(0xFF));
+            return ~static_cast<uint32_t>(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(scores, tolerances)))) & ALL_CLOSE;
+        }
+    }
+
+    bool CpuSupportsAVX2()
+    {
+        int info[4] = {};
+        __cpuid(info, 0);
+        if (info[0] < 7)
+        {
+            return false;
+        }
+
+        __cpuid(info, 1);
+        const bool osSavesYmm = (info[2] & (1 << 27)) && (_xgetbv(0) & 0x6) == 0x6;
+        if (!osSavesYmm || !(info[2] & (1 << 28)))
+        {
+            return false;
+        }
+
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+    }
+#endif
+
+    template<bool PerChannel>
+    size_t CountClosePixelsBase(const uint32_t* first,
+                                const ptrdiff_t stride,
+                                const size_t count,
+                                const uint32_t startPixel,
+                                const uint8_t tolerance)
+    {
+        const PixelBlock start = BroadcastPixel(startPixel);
+        const PixelBlock tolerances = BroadcastTolerance<PerChannel>(tolerance);
+
+        const size_t blocksEnd = count - count % BASE_KERNEL_WIDTH;
+        for (size_t i = 0; i < blocksEnd; i += BASE_KERNEL_WIDTH, first += stride * BASE_KERNEL_STEP)
+        {
+            const uint32_t closeMask = ClosePixelsMask<PerChannel>(LoadPixels(first, stride), start, tolerances);
+            if (closeMask != ALL_CLOSE)
+            {
+                return i + static_cast<size_t>(std::countr_one(closeMask));
+            }
+        }
+
+        return blocksEnd;
+    }
+
+    template<bool PerChannel>
+    size_t CountClosePixelsScalar(const uint32_t* first,
+                                  const ptrdiff_t stride,
+                                  const size_t count,
+                                  const uint32_t startPixel,
+                                  const uint8_t tolerance)
+    {
+        for (size_t i = 0; i < count; ++i, first += stride)
+        {
+            if (!BGRATextureView::PixelsClose<PerChannel>(startPixel, *first, tolerance))
+            {
+                return i;
+            }
+        }
+
+        return count;
+    }
+}
+
+const EdgeScanKernels& GetWideEdgeScanKernels()
+{
+    static const EdgeScanKernels kernels = [] {
+#if defined(_M_X64)
+        if (CpuSupportsAVX2())
+        {
+            return GetAVX2EdgeScanKernels();
+        }
+#endif
+        return EdgeScanKernels{ .perChannel = &CountClosePixelsBase<true>,
+                                .channelSum = &CountClosePixelsBase<false>,
+                                .width = BASE_KERNEL_WIDTH };
+    }();
+
+    return kernels;
+}
+
+template<bool PerChannel>
+size_t CountClosePixels(const uint32_t* first,
+                        const ptrdiff_t stride,
+                        const size_t count,
+                        const uint32_t startPixel,
+                        const uint8_t tolerance)
+{
+    const EdgeScanKernels& wide = GetWideEdgeScanKernels();
+    const std::pair<CountClosePixelsKernel, size_t> kernels[] = {
+        { PerChannel ? wide.perChannel : wide.channelSum, wide.width },
+        { &CountClosePixelsBase<PerChannel>, BASE_KERNEL_WIDTH },
+        { &CountClosePixelsScalar<PerChannel>, 1 },
+    };
+
+    // Each kernel scans as many whole blocks as it can and hands the rest over to a narrower one
+    size_t closeCount = 0;
+    for (const auto [kernel, width] : kernels)
+    {
+        const size_t remaining = count - closeCount;
+        const size_t blockCount = kernel(first + stride * static_cast<ptrdiff_t>(closeCount), stride, remaining, startPixel, tolerance);
+        closeCount += blockCount;
+        if (blockCount < remaining - remaining % width)
+        {
+            break;
+        }
+    }
+
+    return closeCount;
+}
+
+template size_t CountClosePixels<true>(const uint32_t*, const ptrdiff_t, const size_t, const uint32_t, const uint8_t);
+template size_t CountClosePixels<false>(const uint32_t*, const ptrdiff_t, const size_t, const uint32_t, const uint8_t);
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Returns how many pixels, starting at first and advancing by stride, are close to startPixel
+// according to BGRATextureView::PixelsClose. Stops at the first pixel which isn't close or after
+// count pixels. Vector kernels only look at whole blocks of their width and leave the rest
+// of the range to the caller, see CountClosePixels.
+using CountClosePixelsKernel = size_t (*)(const uint32_t* first,
+                                          const ptrdiff_t stride,
+                                          const size_t count,
+                                          const uint32_t startPixel,
+                                          const uint8_t tolerance);
+
+struct EdgeScanKernels
+{
+    CountClosePixelsKernel perChannel = nullptr;
+    CountClosePixelsKernel channelSum = nullptr;
+    size_t width = 0;
+};
+
+#if defined(_M_X64)
+// Lives in a separate translation unit which is compiled with /arch:AVX2,
+// so it must only be called after checking CPU support.
+EdgeScanKernels GetAVX2EdgeScanKernels();
+#endif
+
+// Widest vector kernel supported by the current CPU, selected once on the first call.
+const EdgeScanKernels& GetWideEdgeScanKernels();
+
+template<bool PerChannel>
+size_t CountClosePixels(const uint32_t* first,
+                        const ptrdiff_t stride,
+                        const size_t count,
+                        const uint32_t startPixel,
+                        const uint8_t tolerance);
@@ -0,0 +1,88 @@
+// This file is compiled with /arch:AVX2 and without the precompiled header. Only include
+// headers without inline functions, like the C type headers EdgeScanKernels.h needs: an inline
+// function compiled for AVX2 could be picked by the linker for other translation units and
+// crash on older CPUs.
+#include <immintrin.h>
+#include <intrin.h>
+
+#include "EdgeScanKernels.h"
+
+#if defined(_M_X64)
+
+namespace
+{
+    constexpr size_t AVX2_KERNEL_WIDTH = 8;
+    constexpr ptrdiff_t AVX2_KERNEL_STEP = static_cast<ptrdiff_t>(AVX2_KERNEL_WIDTH);
+    constexpr unsigned ALL_CLOSE = 0xFF;
+
+    inline __m256i LoadPixels(const uint32_t* first, const ptrdiff_t stride, const __m256i gatherOffsets)
+    {
+        if (stride == 1)
+        {
+            return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first));
+        }
+        else if (stride == -1)
+        {
+            return _mm256_permutevar8x32_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(first - 7)),
+                                               _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+        }
+
+        // Vertical scans take one pixel from each of the 8 rows
+        return _mm256_i32gather_epi32(reinterpret_cast<const int*>(first), gatherOffsets, sizeof(uint32_t));
+    }
+
+    template<bool PerChannel>
+    inline unsigned ClosePixelsMask(const __m256i pixels, const __m256i start, const __m256i tolerances)
+    {
+        const __m256i distances = _mm256_or_si256(_mm256_subs_epu8(pixels, start),
+                                                  _mm256_subs_epu8(start, pixels));
+        if constexpr (PerChannel)
+        {
+            const __m256i excess = _mm256_subs_epu8(distances, tolerances);
+            return static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(excess, _mm256_setzero_si256()))));
+        }
+        else
+        {
+            // The channel sum is truncated to a byte, same as in BGRATextureView::PixelsClose
+            const __m256i pairSums = _mm256_maddubs_epi16(distances, _mm256_set1_epi8(1));
+            const __m256i scores = _mm256_and_si256(_mm256_madd_epi16(pairSums, _mm256_set1_epi16(1)), _mm256_set1_epi32(0xFF));
+            return ~static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(scores, tolerances)))) & ALL_CLOSE;
+        }
+    }
+
+    template<bool PerChannel>
+    size_t CountClosePixelsAVX2(const uint32_t* first,
+                                const ptrdiff_t stride,
+                                const size_t count,
+                                const uint32_t startPixel,
+                                const uint8_t tolerance)
+    {
+        const __m256i start = _mm256_set1_epi32(static_cast<int>(startPixel));
+        const __m256i tolerances = PerChannel ? _mm256_set1_epi8(static_cast<char>(tolerance)) : _mm256_set1_epi32(tolerance);
+        const __m256i gatherOffsets = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7),
+                                                         _mm256_set1_epi32(static_cast<int>(stride)));
+
+        const size_t blocksEnd = count - count % AVX2_KERNEL_WIDTH;
+        for (size_t i = 0; i < blocksEnd; i += AVX2_KERNEL_WIDTH, first += stride * AVX2_KERNEL_STEP)
+        {
+            const unsigned closeMask = ClosePixelsMask<PerChannel>(LoadPixels(first, stride, gatherOffsets), start, tolerances);
+            if (closeMask != ALL_CLOSE)
+            {
+                unsigned long firstFarPixel = 0;
+                _BitScanForward(&firstFarPixel, ~closeMask);
+                return i + firstFarPixel;
+            }
+        }
+
+        return blocksEnd;
+    }
+}
+
+EdgeScanKernels GetAVX2EdgeScanKernels()
+{
+    return EdgeScanKernels{ .perChannel = &CountClosePixelsAVX2<true>,
+                            .channelSum = &CountClosePixelsAVX2<false>,
+                            .width = AVX2_KERNEL_WIDTH };
+}
+
+#endif
@@ -0,0 +1,139 @@
+#include "pch.h"
+
+#include "FrameMirror.h"
+
+#include <algorithm>
+#include <cstring>
+
+void FrameMirror::UpdateBand(const BGRATextureView& frame, const size_t top, const size_t bottom, const size_t firstTile, const size_t lastTile)
+{
+    const size_t bandLeft = firstTile * TILE_SIZE;
+    const size_t bandBytes = (std::min(lastTile * TILE_SIZE, view.width) - bandLeft) * sizeof(uint32_t);
+    dirtyTiles.assign(lastTile - firstTile, false);
+
+    // Most rows don't change at all, so compare them as a whole first
+    for (size_t y = top; y < bottom; ++y)
+    {
+        const uint32_t* source = frame.pixels + frame.pitch * y;
+        const uint32_t* mirror = pixels.data() + view.pitch * y;
+        stats.bytesCompared += bandBytes;
+        if (std::memcmp(source + bandLeft, mirror + bandLeft, bandBytes) == 0)
+        {
+            continue;
+        }
+
+        for (size_t tile = firstTile; tile < lastTile; ++tile)
+        {
+            const size_t left = tile * TILE_SIZE;
+            const size_t tileBytes = (std::min(left + TILE_SIZE, view.width) - left) * sizeof(uint32_t);
+            if (!dirtyTiles[tile - firstTile] && std::memcmp(source + left, mirror + left, tileBytes) != 0)
+            {
+                dirtyTiles[tile - firstTile] = true;
+            }
+        }
+    }
+
+    std::optional<size_t> dirtyRunStart;
+    for (size_t tile = firstTile; tile <= lastTile; ++tile)
+    {
+        if (tile < lastTile && dirtyTiles[tile - firstTile])
+        {
+            if (!dirtyRunStart)
+            {
+                dirtyRunStart = tile;
+            }
+            continue;
+        }
+
+        if (!dirtyRunStart)
+        {
+            continue;
+        }
+
+        // Copy the whole run of dirty tiles row by row
+        const size_t left = *dirtyRunStart * TILE_SIZE;
+        const size_t right = std::min(tile * TILE_SIZE, view.width);
+        const size_t runBytes = (right - left) * sizeof(uint32_t);
+        for (size_t y = top; y < bottom; ++y)
+        {
+            std::memcpy(pixels.data() + view.pitch * y + left, frame.pixels + frame.pitch * y + left, runBytes);
+        }
+
+        stats.bytesCopied += runBytes * (bottom - top);
+        dirtyRects.push_back(RECT{ .left = static_cast<long>(left),
+                                   .top = static_cast<long>(top),
+                                   .right = static_cast<long>(right) - 1,
+                                   .bottom = static_cast<long>(bottom) - 1 });
+        dirtyRunStart.reset();
+    }
+}
+
+const std::vector<RECT>& FrameMirror::Update(const BGRATextureView& frame, const POINT focus)
+{
+    dirtyRects.clear();
+
+    bool resized = false;
+    if (frame.width != view.width || frame.height != view.height)
+    {
+        // The mirror starts out black, the tiles are copied once they are compared
+        pixels.assign(frame.width * frame.height, 0);
+        view.pixels = pixels.data();
+        view.pitch = frame.width;
+        view.width = frame.width;
+        view.height = frame.height;
+        resized = true;
+    }
+
+    if (view.width == 0 || view.height == 0)
+    {
+        return dirtyRects;
+    }
+
+    const size_t tileCount = (view.width + TILE_SIZE - 1) / TILE_SIZE;
+    const size_t focusX = std::min(static_cast<size_t>(std::max(focus.x, 0L)), view.width - 1);
+    const size_t focusY = std::min(static_cast<size_t>(std::max(focus.y, 0L)), view.height - 1);
+    const size_t focusTile = focusX / TILE_SIZE;
+    const size_t focusBandTop = focusY - focusY % TILE_SIZE;
+    for (size_t top = 0; top < view.height; top += TILE_SIZE)
+    {
+        const size_t bottom = std::min(top + TILE_SIZE, view.height);
+        if (top == focusBandTop)
+        {
+            UpdateBand(frame, top, bottom, 0, tileCount);
+        }
+        else
+        {
+            UpdateBand(frame, top, bottom, focusTile, focusTile + 1);
+        }
+    }
+
+    if (resized)
+    {
+        // Everything derived from the frame of the previous size is invalid
+        dirtyRects.assign(1, RECT{ .left = 0,
+                                   .top = 0,
+                                   .right = static_cast<long>(view.width) - 1,
+                                   .bottom = static_cast<long>(view.height) - 1 });
+    }
+
+    if (dirtyRects.empty())
+    {
+        ++stats.framesSkipped;
+    }
+    else
+    {
+        ++stats.framesUpdated;
+    }
+
+    return dirtyRects;
+}
+
+const BGRATextureView& FrameMirror::View() const
+{
+    return view;
+}
+
+const FrameMirror::Stats& FrameMirror::GetStats() const
+{
+    return stats;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "BGRATextureView.h"
+
+#include <vector>
+
+// A CPU-side copy of the last captured frame. Edge detection only reads the row and the column through
+// the cursor, so each new frame is compared with the copy only in the band of tiles containing that row
+// and in the column of tiles containing that column. Only the tiles which have changed are copied over,
+// so consumers of View() can keep whatever they've derived from the unchanged parts of the screen.
+// The other tiles keep their old pixels until the cursor brings them into the compared bands.
+class FrameMirror
+{
+public:
+    struct Stats
+    {
+        uint64_t framesUpdated = 0;
+        uint64_t framesSkipped = 0; // frames identical to the previous one
+        uint64_t bytesCompared = 0;
+        uint64_t bytesCopied = 0;
+    };
+
+    static constexpr size_t TILE_SIZE = 32;
+
+    // Compares the bands of tiles crossing at focus and returns the changed areas as rects with inclusive
+    // corners. Horizontally adjacent dirty tiles are merged. A frame of a different size is reported dirty
+    // as a whole.
+    const std::vector<RECT>& Update(const BGRATextureView& frame, const POINT focus);
+
+    // Stays valid until the frame size changes
+    const BGRATextureView& View() const;
+
+    const Stats& GetStats() const;
+
+private:
+    // Updates the tiles [firstTile, lastTile) of a horizontal band and appends its dirty rects
+    void UpdateBand(const BGRATextureView& frame, const size_t top, const size_t bottom, const size_t firstTile, const size_t lastTile);
+
+    std::vector<uint32_t> pixels;
+    BGRATextureView view;
+    std::vector<RECT> dirtyRects;
+    std::vector<bool> dirtyTiles;
+    Stats stats;
+};
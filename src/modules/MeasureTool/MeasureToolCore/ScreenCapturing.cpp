@@ -4,6 +4,8 @@
 #include "constants.h"
 #include "CoordinateSystemConversion.h"
 #include "EdgeDetection.h"
+#include "EdgeDetectionCache.h"
+#include "FrameMirror.h"
 #include "ScreenCapturing.h"
 
 #include <common/Display/monitors.h>
@@ -72,6 +74,14 @@ public:
     MappedTextureView CaptureSingleFrame();
 
     void StopCapture();
+
+    // Calls callback while no frame is being handled, e.g. to read the state the frame callback updates
+    template<typename Callback>
+    void WithFrameCallbackLocked(Callback&& callback)
+    {
+        std::lock_guard callbackLock{ frameArrivedMutex };
+        callback();
+    }
 };
 
 D3DCaptureState::D3DCaptureState(DxgiAPI* dxgiAPI,
@@ -268,14 +278,15 @@ void D3DCaptureState::StopCapture()
     }
 }
 
-void UpdateCaptureState(const CommonState& commonState,
+void UpdateCaptureState(const POINT cursorPosSystemSpace,
                         Serialized<MeasureToolState>& state,
                         HWND window,
-                        const MappedTextureView& textureView)
+                        const BGRATextureView& textureView,
+                        EdgeDetectionCache& edgeDetectionCache)
 {
-    const auto cursorPos = convert::FromSystemToWindow(window, commonState.cursorPosSystemSpace);
-    const bool cursorInLeftScreenHalf = cursorPos.x < textureView.view.width / 2;
-    const bool cursorInTopScreenHalf = cursorPos.y < textureView.view.height / 2;
+    const auto cursorPos = convert::FromSystemToWindow(window, cursorPosSystemSpace);
+    const bool cursorInLeftScreenHalf = cursorPos.x < textureView.width / 2;
+    const bool cursorInTopScreenHalf = cursorPos.y < textureView.height / 2;
     uint8_t pixelTolerance = {};
     bool perColorChannelEdgeDetection = {};
     state.Access([&](MeasureToolState& state) {
@@ -290,10 +301,10 @@ void UpdateCaptureState(const CommonState& commonState,
     //          at 20x100, bounds should be [20,100]-[24,104]. We don't include [25,105] or
     //          [19,99], since those pixels are blue. Thus, square dims are equal to
     //          [24-20+1,104-100+1]=[5,5].
-    const RECT bounds = DetectEdges(textureView.view,
-                                    cursorPos,
-                                    perColorChannelEdgeDetection,
-                                    pixelTolerance);
+    const RECT bounds = edgeDetectionCache.DetectEdges(textureView,
+                                                       cursorPos,
+                                                       perColorChannelEdgeDetection,
+                                                       pixelTolerance);
 
 #if defined(DEBUG_EDGES)
     char buffer[256];
@@ -305,8 +316,8 @@ void UpdateCaptureState(const CommonState& commonState,
               bounds.top,
               bounds.right,
               bounds.bottom,
-              textureView.view.width,
-              textureView.view.height);
+              textureView.width,
+              textureView.height);
     OutputDebugStringA(buffer);
 #endif
     state.Access([&](MeasureToolState& state) {
@@ -326,6 +337,12 @@ std::thread StartCapturingThread(DxgiAPI* dxgiAPI,
             continuousCapture = state.global.continuousCapture;
         });
 
+        // A single captured frame never changes, so its lines can be summarized right away.
+        // In continuous mode, the cache is invalidated only where the frame mirror reports changes.
+        EdgeDetectionCache edgeDetectionCache{ !continuousCapture };
+        FrameMirror frameMirror;
+        POINT lastCursorPos = {};
+
         auto captureState = D3DCaptureState::Create(dxgiAPI,
                                                     monitor,
                                                     winrt::DirectXPixelFormat::B8G8R8A8UIntNormalized,
@@ -346,7 +363,21 @@ std::thread StartCapturingThread(DxgiAPI* dxgiAPI,
                 if (mouseOnMonitor)
                 {
                     captureState->StartCapture([&, window](MappedTextureView textureView) {
-                        UpdateCaptureState(commonState, state, window, textureView);
+                        // Only the lines through the cursor are read, so the mirror is only updated around them
+                        const POINT cursorPos = commonState.cursorPosSystemSpace;
+                        const auto& dirtyRects = frameMirror.Update(textureView.view, convert::FromSystemToWindow(window, cursorPos));
+                        if (dirtyRects.empty() && cursorPos.x == lastCursorPos.x && cursorPos.y == lastCursorPos.y)
+                        {
+                            return;
+                        }
+
+                        for (const RECT& rect : dirtyRects)
+                        {
+                            edgeDetectionCache.InvalidateRect(rect);
+                        }
+
+                        lastCursorPos = cursorPos;
+                        UpdateCaptureState(cursorPos, state, window, frameMirror.View(), edgeDetectionCache);
                     });
                 }
                 else
@@ -380,7 +411,7 @@ std::thread StartCapturingThread(DxgiAPI* dxgiAPI,
                     auto path = std::filesystem::temp_directory_path() / buf;
                     textureView.view.SaveAsBitmap(path.string().c_str());
 #endif
-                    UpdateCaptureState(commonState, state, window, textureView);
+                    UpdateCaptureState(commonState.cursorPosSystemSpace, state, window, textureView.view, edgeDetectionCache);
                     mouseOnMonitor = true;
                 }
                 else if (mouseOnMonitor)
@@ -400,5 +431,17 @@ std::thread StartCapturingThread(DxgiAPI* dxgiAPI,
         }
 
         captureState->StopCapture();
+
+        if (continuousCapture)
+        {
+            // A frame callback may still be running on a capture thread
+            FrameMirror::Stats stats;
+            captureState->WithFrameCallbackLocked([&] { stats = frameMirror.GetStats(); });
+            Logger::info(L"Continuous capture: {} frames updated, {} frames skipped, {} bytes compared, {} bytes copied",
+                         stats.framesUpdated,
+                         stats.framesSkipped,
+                         stats.bytesCompared,
+                         stats.bytesCopied);
+        }
     });
 }
@@ -0,0 +1,117 @@
+#include "pch.h"
+
+#include <format>
+#include <random>
+
+#include <EdgeDetection.h>
+#include <EdgeDetectionCache.h>
+
+#include "TestTextures.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace EdgeDetectionCacheTests
+{
+    void AssertCacheMatchesDetectEdges(EdgeDetectionCache& cache, const BGRATextureView& texture, const POINT centerPoint, const uint8_t tolerance)
+    {
+        for (const bool perChannel : { true, false })
+        {
+            const RECT expected = DetectEdges(texture, centerPoint, perChannel, tolerance);
+            const RECT actual = cache.DetectEdges(texture, centerPoint, perChannel, tolerance);
+            const auto message = std::format(L"{}x{} at {},{} tolerance {} perChannel {}: expected {} {} {} {}, got {} {} {} {}",
+                                             texture.width,
+                                             texture.height,
+                                             centerPoint.x,
+                                             centerPoint.y,
+                                             tolerance,
+                                             perChannel,
+                                             expected.left,
+                                             expected.top,
+                                             expected.right,
+                                             expected.bottom,
+                                             actual.left,
+                                             actual.top,
+                                             actual.right,
+                                             actual.bottom);
+            Assert::IsTrue(expected.left == actual.left && expected.top == actual.top && expected.right == actual.right && expected.bottom == actual.bottom,
+                           message.c_str());
+        }
+    }
+
+    // Queries each center twice, so that lines summarized only on their second query are looked up from their runs too
+    void AssertRandomQueriesMatch(EdgeDetectionCache& cache, const BGRATextureView& texture, std::mt19937& rng, const int queryCount)
+    {
+        for (int query = 0; query < queryCount; ++query)
+        {
+            const POINT centerPoint{ static_cast<long>(rng() % (texture.width + 4)) - 2, static_cast<long>(rng() % (texture.height + 4)) - 2 };
+            const uint8_t tolerance = RandomTolerance(rng);
+            AssertCacheMatchesDetectEdges(cache, texture, centerPoint, tolerance);
+            AssertCacheMatchesDetectEdges(cache, texture, centerPoint, tolerance);
+        }
+    }
+
+    TEST_CLASS (EdgeDetectionCacheTests)
+    {
+    public:
+        TEST_METHOD (MatchesDetectEdgesOnStaticTextures)
+        {
+            std::mt19937 rng(3);
+            for (const bool summarizeOnFirstQuery : { true, false })
+            {
+                for (int iteration = 0; iteration < 50; ++iteration)
+                {
+                    const size_t width = 3 + rng() % 150;
+                    TestTexture texture(width, 3 + rng() % 150, width + rng() % 8, 0);
+                    FillRandom(texture, rng);
+
+                    EdgeDetectionCache cache(summarizeOnFirstQuery);
+                    AssertRandomQueriesMatch(cache, texture.view, rng, 20);
+                }
+            }
+        }
+
+        TEST_METHOD (MatchesDetectEdgesAfterInvalidatingChanges)
+        {
+            std::mt19937 rng(4);
+            for (const bool summarizeOnFirstQuery : { true, false })
+            {
+                TestTexture texture(97, 61, 100, 0);
+                FillRandom(texture, rng);
+                EdgeDetectionCache cache(summarizeOnFirstQuery);
+
+                for (int iteration = 0; iteration < 200; ++iteration)
+                {
+                    if (iteration % 50 == 49)
+                    {
+                        FillRandom(texture, rng);
+                        cache.Invalidate();
+                    }
+                    else
+                    {
+                        // Changes which reach past the texture are clipped
+                        const RECT rect = RandomRect(texture, rng, 40);
+                        FillRect(texture, rect, rng() % 2 ? static_cast<uint32_t>(rng()) : SimilarColor(texture.At(rect.left, rect.top), rng));
+                        cache.InvalidateRect(rect);
+                    }
+
+                    AssertRandomQueriesMatch(cache, texture.view, rng, 3);
+                }
+            }
+        }
+
+        TEST_METHOD (DropsSummariesWhenTheSizeChanges)
+        {
+            std::mt19937 rng(5);
+            TestTexture small(40, 30, 40, 0);
+            TestTexture large(70, 50, 72, 0);
+            FillRandom(small, rng);
+            FillRandom(large, rng);
+
+            EdgeDetectionCache cache(true);
+            for (int iteration = 0; iteration < 20; ++iteration)
+            {
+                AssertRandomQueriesMatch(cache, (iteration % 2 ? small : large).view, rng, 5);
+            }
+        }
+    };
+}
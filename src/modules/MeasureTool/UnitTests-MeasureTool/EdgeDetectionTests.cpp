@@ -0,0 +1,259 @@
+#include "pch.h"
+
+#include <cstdlib>
+#include <format>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <EdgeDetection.h>
+#include <EdgeScanKernels.h>
+
+#include "TestTextures.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace EdgeDetectionTests
+{
+    template<bool PerChannel>
+    size_t CountClosePixelsReference(const uint32_t* first, const ptrdiff_t stride, const size_t count, const uint32_t startPixel, const uint8_t tolerance)
+    {
+        for (size_t i = 0; i < count; ++i, first += stride)
+        {
+            if (!BGRATextureView::PixelsClose<PerChannel>(startPixel, *first, tolerance))
+            {
+                return i;
+            }
+        }
+
+        return count;
+    }
+
+    // FindEdge as it was before it used the kernels, comparing one pixel at a time
+    template<bool PerChannel, bool IsX, bool Increment>
+    long FindEdgeReference(const BGRATextureView& texture, const POINT centerPoint, const uint8_t tolerance)
+    {
+        const long maxDim = static_cast<long>(IsX ? texture.width : texture.height);
+        long x = std::clamp<long>(centerPoint.x, 1, static_cast<long>(texture.width - 2));
+        long y = std::clamp<long>(centerPoint.y, 1, static_cast<long>(texture.height - 2));
+
+        const uint32_t startPixel = texture.GetPixel(x, y);
+        while (true)
+        {
+            const long oldPos = IsX ? x : y;
+            long& pos = IsX ? x : y;
+            pos += Increment ? 1 : -1;
+            if (Increment ? pos == maxDim : pos == 0)
+            {
+                break;
+            }
+
+            if (!BGRATextureView::PixelsClose<PerChannel>(startPixel, texture.GetPixel(x, y), tolerance))
+            {
+                return oldPos;
+            }
+        }
+
+        return Increment ? maxDim - 1 : 0;
+    }
+
+    template<bool PerChannel>
+    RECT DetectEdgesReference(const BGRATextureView& texture, const POINT centerPoint, const uint8_t tolerance)
+    {
+        return RECT{ .left = FindEdgeReference<PerChannel, true, false>(texture, centerPoint, tolerance),
+                     .top = FindEdgeReference<PerChannel, false, false>(texture, centerPoint, tolerance),
+                     .right = FindEdgeReference<PerChannel, true, true>(texture, centerPoint, tolerance),
+                     .bottom = FindEdgeReference<PerChannel, false, true>(texture, centerPoint, tolerance) };
+    }
+
+    void AssertSameEdges(const RECT& expected, const RECT& actual, const std::wstring& description)
+    {
+        const auto message = std::format(L"{}: expected {} {} {} {}, got {} {} {} {}",
+                                         description,
+                                         expected.left,
+                                         expected.top,
+                                         expected.right,
+                                         expected.bottom,
+                                         actual.left,
+                                         actual.top,
+                                         actual.right,
+                                         actual.bottom);
+        Assert::IsTrue(expected.left == actual.left && expected.top == actual.top && expected.right == actual.right && expected.bottom == actual.bottom,
+                       message.c_str());
+    }
+
+    void AssertDetectEdgesMatchesReference(const BGRATextureView& texture, const POINT centerPoint, const uint8_t tolerance)
+    {
+        for (const bool perChannel : { true, false })
+        {
+            const RECT expected = perChannel ? DetectEdgesReference<true>(texture, centerPoint, tolerance) :
+                                               DetectEdgesReference<false>(texture, centerPoint, tolerance);
+            const auto description = std::format(L"{}x{} pitch {} at {},{} tolerance {} perChannel {}",
+                                                 texture.width,
+                                                 texture.height,
+                                                 texture.pitch,
+                                                 centerPoint.x,
+                                                 centerPoint.y,
+                                                 tolerance,
+                                                 perChannel);
+            AssertSameEdges(expected, DetectEdges(texture, centerPoint, perChannel, tolerance), description);
+        }
+    }
+
+    // A line of count pixels in a buffer, laid out with the given stride, so that vertical and backward scans are covered too
+    struct Line
+    {
+        std::vector<uint32_t> buffer;
+        const uint32_t* first = nullptr;
+        ptrdiff_t stride = 0;
+
+        Line(const std::vector<uint32_t>& pixels, const ptrdiff_t stride_) :
+            buffer((pixels.size() + 2) * std::abs(stride_), 0xDEADBEEF), stride(stride_)
+        {
+            // Keep a guard pixel before the first and after the last one
+            const ptrdiff_t step = std::abs(stride);
+            const ptrdiff_t start = stride > 0 ? step : static_cast<ptrdiff_t>(pixels.size()) * step;
+            for (size_t i = 0; i < pixels.size(); ++i)
+            {
+                buffer[start + stride * static_cast<ptrdiff_t>(i)] = pixels[i];
+            }
+            first = buffer.data() + start;
+        }
+    };
+
+    // Compares the wide kernels, which only scan whole blocks, and CountClosePixels with the reference
+    template<bool PerChannel>
+    void AssertKernelsMatchReference(const std::vector<uint32_t>& pixels, const uint32_t startPixel, const uint8_t tolerance)
+    {
+        const EdgeScanKernels& wide = GetWideEdgeScanKernels();
+        const CountClosePixelsKernel kernel = PerChannel ? wide.perChannel : wide.channelSum;
+        const size_t count = pixels.size();
+
+        for (const ptrdiff_t stride : { 1, -1, 37, -37 })
+        {
+            const Line line(pixels, stride);
+            const size_t expected = CountClosePixelsReference<PerChannel>(line.first, stride, count, startPixel, tolerance);
+            const auto description = std::format(L"count {} stride {} tolerance {} perChannel {}", count, stride, tolerance, PerChannel);
+
+            const size_t blocksEnd = count - count % wide.width;
+            Assert::AreEqual((std::min)(expected, blocksEnd), kernel(line.first, stride, count, startPixel, tolerance), description.c_str());
+            Assert::AreEqual(expected, CountClosePixels<PerChannel>(line.first, stride, count, startPixel, tolerance), description.c_str());
+        }
+    }
+
+    TEST_CLASS (EdgeDetectionTests)
+    {
+    public:
+        TEST_METHOD (KernelsMatchScalarOnRandomLines)
+        {
+            Logger::WriteMessage(std::format("Wide edge scan kernels are {} pixels wide", GetWideEdgeScanKernels().width).c_str());
+
+            std::mt19937 rng(1);
+            for (int iteration = 0; iteration < 3000; ++iteration)
+            {
+                const uint32_t startPixel = static_cast<uint32_t>(rng());
+                std::vector<uint32_t> pixels(rng() % 100);
+                for (auto& pixel : pixels)
+                {
+                    pixel = rng() % 50 == 0 ? static_cast<uint32_t>(rng()) : SimilarColor(startPixel, rng);
+                }
+
+                const uint8_t tolerance = RandomTolerance(rng);
+                AssertKernelsMatchReference<true>(pixels, startPixel, tolerance);
+                AssertKernelsMatchReference<false>(pixels, startPixel, tolerance);
+            }
+        }
+
+        TEST_METHOD (KernelsFindFarPixelAtEveryPosition)
+        {
+            // Up to several blocks of the widest kernel, so that the far pixel is in a block or in the tail left to a narrower kernel
+            for (size_t count = 0; count <= 70; ++count)
+            {
+                const uint32_t startPixel = 0x80808080;
+                std::vector<uint32_t> pixels(count, startPixel);
+                AssertKernelsMatchReference<true>(pixels, startPixel, 0);
+                AssertKernelsMatchReference<false>(pixels, startPixel, 0);
+
+                for (size_t farPixel = 0; farPixel < count; ++farPixel)
+                {
+                    // Differs by one in a single channel, which only zero tolerance tells apart
+                    pixels.assign(count, startPixel);
+                    pixels[farPixel] = startPixel + (1u << (8 * (farPixel % 4)));
+                    AssertKernelsMatchReference<true>(pixels, startPixel, 0);
+                    AssertKernelsMatchReference<false>(pixels, startPixel, 0);
+                    Assert::AreEqual(farPixel, CountClosePixels<true>(pixels.data(), 1, count, startPixel, 0));
+
+                    AssertKernelsMatchReference<true>(pixels, startPixel, 1);
+                    AssertKernelsMatchReference<false>(pixels, startPixel, 1);
+                    Assert::AreEqual(count, CountClosePixels<false>(pixels.data(), 1, count, startPixel, 1));
+                }
+            }
+        }
+
+        TEST_METHOD (KernelsTruncateChannelSumLikePixelsClose)
+        {
+            // The channel distances sum up to 256, which PixelsClose truncates to 0
+            const uint32_t startPixel = 0x00000000;
+            std::vector<uint32_t> pixels(40, startPixel);
+            pixels[33] = 0x40404040;
+
+            AssertKernelsMatchReference<false>(pixels, startPixel, 0);
+            AssertKernelsMatchReference<true>(pixels, startPixel, 0);
+            Assert::AreEqual(size_t{ 40 }, CountClosePixels<false>(pixels.data(), 1, pixels.size(), startPixel, 0));
+            Assert::AreEqual(size_t{ 33 }, CountClosePixels<true>(pixels.data(), 1, pixels.size(), startPixel, 0));
+        }
+
+        TEST_METHOD (DetectEdgesMatchesScalarFindEdge)
+        {
+            std::mt19937 rng(2);
+            const size_t sizes[] = { 3, 4, 5, 8, 9, 31, 32, 33, 63, 65, 100, 257 };
+            for (int iteration = 0; iteration < 300; ++iteration)
+            {
+                const size_t width = iteration % 2 ? sizes[rng() % std::size(sizes)] : 3 + rng() % 300;
+                const size_t height = iteration % 3 ? sizes[rng() % std::size(sizes)] : 3 + rng() % 300;
+                TestTexture texture(width, height, width + rng() % 16, 0);
+                FillRandom(texture, rng);
+
+                for (int query = 0; query < 20; ++query)
+                {
+                    // Centers outside of the texture are clamped
+                    const POINT centerPoint{ static_cast<long>(rng() % (width + 4)) - 2, static_cast<long>(rng() % (height + 4)) - 2 };
+                    AssertDetectEdgesMatchesReference(texture.view, centerPoint, RandomTolerance(rng));
+                }
+            }
+        }
+
+        TEST_METHOD (DetectEdgesAtTheFirstAndLastPixels)
+        {
+            constexpr uint32_t color = 0xFF202020;
+            constexpr uint32_t edgeColor = 0xFFE0E0E0;
+            constexpr size_t width = 45;
+            constexpr size_t height = 37;
+            constexpr POINT center{ 20, 17 };
+
+            TestTexture texture(width, height, width + 3, color);
+            AssertDetectEdgesMatchesReference(texture.view, center, 0);
+            AssertSameEdges(RECT{ 0, 0, width - 1, height - 1 }, DetectEdges(texture.view, center, true, 0), L"uniform");
+
+            // The last pixel is checked, the first one isn't
+            FillRect(texture, RECT{ width - 1, 0, width - 1, height - 1 }, edgeColor);
+            FillRect(texture, RECT{ 0, height - 1, width - 1, height - 1 }, edgeColor);
+            FillRect(texture, RECT{ 0, 0, 0, height - 1 }, edgeColor);
+            FillRect(texture, RECT{ 0, 0, width - 1, 0 }, edgeColor);
+            AssertDetectEdgesMatchesReference(texture.view, center, 0);
+            AssertSameEdges(RECT{ 0, 0, width - 2, height - 2 }, DetectEdges(texture.view, center, true, 0), L"border");
+
+            // The neighbors of the center
+            FillRect(texture, RECT{ center.x - 1, center.y - 1, center.x + 1, center.y + 1 }, edgeColor);
+            texture.At(center.x, center.y) = color;
+            AssertDetectEdgesMatchesReference(texture.view, center, 0);
+            AssertSameEdges(RECT{ center.x, center.y, center.x, center.y }, DetectEdges(texture.view, center, false, 0), L"neighbors");
+
+            // Centers on the border are moved inside
+            for (const POINT corner : { POINT{ 0, 0 }, POINT{ width - 1, height - 1 } })
+            {
+                AssertDetectEdgesMatchesReference(texture.view, corner, 0);
+            }
+        }
+    };
+}
@@ -0,0 +1,175 @@
+#include "pch.h"
+
+#include <format>
+#include <random>
+#include <vector>
+
+#include <FrameMirror.h>
+
+#include "TestTextures.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace FrameMirrorTests
+{
+    constexpr size_t TILE_SIZE = FrameMirror::TILE_SIZE;
+
+    std::vector<uint32_t> Copy(const BGRATextureView& view)
+    {
+        std::vector<uint32_t> pixels;
+        for (size_t y = 0; y < view.height; ++y)
+        {
+            for (size_t x = 0; x < view.width; ++x)
+            {
+                pixels.push_back(view.GetPixel(x, y));
+            }
+        }
+        return pixels;
+    }
+
+    bool Contains(const std::vector<RECT>& rects, const size_t x, const size_t y)
+    {
+        return std::any_of(rects.begin(), rects.end(), [&](const RECT& rect) {
+            return static_cast<long>(x) >= rect.left && static_cast<long>(x) <= rect.right && static_cast<long>(y) >= rect.top && static_cast<long>(y) <= rect.bottom;
+        });
+    }
+
+    // Updates the mirror and checks that it matches the frame in the tiles crossing at focus, that it keeps its old
+    // pixels elsewhere, and that the dirty rects cover exactly the tiles that changed
+    void UpdateAndCheck(FrameMirror& mirror, const BGRATextureView& frame, const POINT focus)
+    {
+        const std::vector<uint32_t> before = Copy(mirror.View());
+        const std::vector<RECT> rects = mirror.Update(frame, focus);
+        const BGRATextureView& view = mirror.View();
+        Assert::AreEqual(frame.width, view.width);
+        Assert::AreEqual(frame.height, view.height);
+
+        const size_t focusX = std::clamp<long>(focus.x, 0, static_cast<long>(frame.width) - 1);
+        const size_t focusY = std::clamp<long>(focus.y, 0, static_cast<long>(frame.height) - 1);
+        for (size_t y = 0; y < frame.height; ++y)
+        {
+            for (size_t x = 0; x < frame.width; ++x)
+            {
+                const bool compared = x / TILE_SIZE == focusX / TILE_SIZE || y / TILE_SIZE == focusY / TILE_SIZE;
+                bool valid = true;
+                if (compared)
+                {
+                    valid = frame.GetPixel(x, y) == view.GetPixel(x, y);
+                }
+                else if (!before.empty())
+                {
+                    valid = before[x + frame.width * y] == view.GetPixel(x, y);
+                }
+
+                if (!before.empty() && before[x + frame.width * y] != view.GetPixel(x, y))
+                {
+                    valid = valid && Contains(rects, x, y);
+                }
+
+                if (!valid)
+                {
+                    Assert::Fail(std::format(L"{}x{} focus {},{} pixel {},{}", frame.width, frame.height, focus.x, focus.y, x, y).c_str());
+                }
+            }
+        }
+
+        // Each dirty rect is made of whole tiles of the compared bands, and each of those tiles changed
+        for (const RECT& rect : rects)
+        {
+            Assert::IsTrue(rect.left % TILE_SIZE == 0 && rect.top % TILE_SIZE == 0);
+            for (size_t tileTop = rect.top; tileTop <= static_cast<size_t>(rect.bottom); tileTop += TILE_SIZE)
+            {
+                for (size_t tileLeft = rect.left; tileLeft <= static_cast<size_t>(rect.right); tileLeft += TILE_SIZE)
+                {
+                    bool changed = before.empty();
+                    for (size_t y = tileTop; y < (std::min)(tileTop + TILE_SIZE, frame.height); ++y)
+                    {
+                        for (size_t x = tileLeft; x < (std::min)(tileLeft + TILE_SIZE, frame.width); ++x)
+                        {
+                            changed = changed || before[x + frame.width * y] != view.GetPixel(x, y);
+                        }
+                    }
+                    Assert::IsTrue(changed, std::format(L"Tile {},{} didn't change", tileLeft, tileTop).c_str());
+                }
+            }
+        }
+    }
+
+    TEST_CLASS (FrameMirrorTests)
+    {
+    public:
+        TEST_METHOD (FirstFrameIsDirtyAsAWhole)
+        {
+            std::mt19937 rng(6);
+            TestTexture frame(100, 70, 104, 0);
+            FillRandom(frame, rng);
+
+            FrameMirror mirror;
+            const auto& rects = mirror.Update(frame.view, POINT{ 50, 40 });
+            Assert::AreEqual(size_t{ 1 }, rects.size());
+            Assert::IsTrue(rects[0].left == 0 && rects[0].top == 0 && rects[0].right == 99 && rects[0].bottom == 69);
+            Assert::AreEqual(uint64_t{ 1 }, mirror.GetStats().framesUpdated);
+        }
+
+        TEST_METHOD (IdenticalFrameIsSkipped)
+        {
+            std::mt19937 rng(7);
+            TestTexture frame(100, 70, 100, 0);
+            FillRandom(frame, rng);
+
+            FrameMirror mirror;
+            mirror.Update(frame.view, POINT{ 10, 10 });
+            const uint64_t bytesCopied = mirror.GetStats().bytesCopied;
+
+            Assert::IsTrue(mirror.Update(frame.view, POINT{ 10, 10 }).empty());
+            Assert::AreEqual(uint64_t{ 1 }, mirror.GetStats().framesSkipped);
+            Assert::AreEqual(bytesCopied, mirror.GetStats().bytesCopied);
+        }
+
+        TEST_METHOD (CopiesChangedTilesCrossingAtFocus)
+        {
+            std::mt19937 rng(8);
+
+            // Sizes which aren't multiples of the tile size leave partial tiles at the right and bottom
+            for (const auto [width, height] : { std::pair<size_t, size_t>{ 100, 70 }, { 64, 64 }, { 33, 97 }, { 7, 5 } })
+            {
+                TestTexture frame(width, height, width + rng() % 8, 0);
+                FillRandom(frame, rng);
+
+                FrameMirror mirror;
+                UpdateAndCheck(mirror, frame.view, POINT{ 0, 0 });
+                for (int iteration = 0; iteration < 100; ++iteration)
+                {
+                    for (int change = rng() % 4; change > 0; --change)
+                    {
+                        FillRect(frame, RandomRect(frame, rng, 20), static_cast<uint32_t>(rng()));
+                    }
+
+                    // Single pixels in the last row and column, which are in partial tiles unless the size is a multiple of the tile size
+                    frame.At(rng() % width, height - 1) = static_cast<uint32_t>(rng());
+                    frame.At(width - 1, rng() % height) = static_cast<uint32_t>(rng());
+
+                    // Focus points outside of the frame are clamped
+                    const POINT focus{ static_cast<long>(rng() % (width + 20)) - 10, static_cast<long>(rng() % (height + 20)) - 10 };
+                    UpdateAndCheck(mirror, frame.view, focus);
+                }
+            }
+        }
+
+        TEST_METHOD (ResizedFrameIsDirtyAsAWhole)
+        {
+            std::mt19937 rng(9);
+            TestTexture small(40, 30, 40, 0);
+            TestTexture large(70, 50, 72, 0);
+            FillRandom(small, rng);
+            FillRandom(large, rng);
+
+            FrameMirror mirror;
+            mirror.Update(small.view, POINT{ 5, 5 });
+            const auto& rects = mirror.Update(large.view, POINT{ 5, 5 });
+            Assert::AreEqual(size_t{ 1 }, rects.size());
+            Assert::IsTrue(rects[0].left == 0 && rects[0].top == 0 && rects[0].right == 69 && rects[0].bottom == 49);
+            Assert::AreEqual(size_t{ 70 }, mirror.View().pitch);
+        }
+    };
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <BGRATextureView.h>
+
+#include <random>
+#include <vector>
+
+// A texture which owns its pixels
+struct TestTexture
+{
+    std::vector<uint32_t> pixels;
+    BGRATextureView view;
+
+    TestTexture(const size_t width, const size_t height, const size_t pitch, const uint32_t color) :
+        pixels(pitch * height, color)
+    {
+        view.pixels = pixels.data();
+        view.pitch = pitch;
+        view.width = width;
+        view.height = height;
+    }
+
+    TestTexture(const TestTexture&) = delete;
+    TestTexture& operator=(const TestTexture&) = delete;
+
+    uint32_t& At(const size_t x, const size_t y)
+    {
+        return pixels[x + view.pitch * y];
+    }
+};
+
+// Colors which differ from color by at most 7 in each channel
+inline uint32_t SimilarColor(const uint32_t color, std::mt19937& rng)
+{
+    return color ^ (rng() & 0x07070707);
+}
+
+// Paints rect with inclusive corners, clipped to the texture
+inline void FillRect(TestTexture& texture, const RECT& rect, const uint32_t color)
+{
+    const long right = (std::min)(rect.right, static_cast<long>(texture.view.width) - 1);
+    const long bottom = (std::min)(rect.bottom, static_cast<long>(texture.view.height) - 1);
+    for (long y = rect.top; y <= bottom; ++y)
+    {
+        for (long x = rect.left; x <= right; ++x)
+        {
+            texture.At(x, y) = color;
+        }
+    }
+}
+
+inline RECT RandomRect(const TestTexture& texture, std::mt19937& rng, const size_t maxSize)
+{
+    const long left = static_cast<long>(rng() % texture.view.width);
+    const long top = static_cast<long>(rng() % texture.view.height);
+    return RECT{ .left = left,
+                 .top = top,
+                 .right = left + static_cast<long>(rng() % maxSize),
+                 .bottom = top + static_cast<long>(rng() % maxSize) };
+}
+
+// Looks like what the tool measures: flat areas, rectangles, gradients from anti-aliasing and some noise
+inline void FillRandom(TestTexture& texture, std::mt19937& rng)
+{
+    const uint32_t background = static_cast<uint32_t>(rng());
+    for (auto& pixel : texture.pixels)
+    {
+        const auto roll = rng() % 40;
+        pixel = roll == 0 ? static_cast<uint32_t>(rng()) : roll < 14 ? SimilarColor(background, rng) : background;
+    }
+
+    for (int i = 0; i < 5; ++i)
+    {
+        FillRect(texture, RandomRect(texture, rng, 100), static_cast<uint32_t>(rng()));
+    }
+}
+
+// Mostly the tolerances the settings allow, sometimes none or the largest
+inline uint8_t RandomTolerance(std::mt19937& rng)
+{
+    switch (rng() % 4)
+    {
+    case 0:
+        return 0;
+    case 1:
+        return 255;
+    default:
+        return static_cast<uint8_t>(rng() % 256);
+    }
+}
@@ -0,0 +1,183 @@
+#include "pch.h"
+
+#include <chrono>
+#include <future>
+#include <thread>
+#include <vector>
+
+#include <LaunchScheduler.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace std::chrono_literals;
+
+namespace LaunchSchedulerTests
+{
+    using Clock = LaunchScheduler::Clock;
+
+    // The delays are scaled down, so that the tests don't take seconds
+    constexpr std::chrono::milliseconds maxInstanceWaitTime{ 600 };
+    constexpr std::chrono::milliseconds instanceLaunchDelay{ 200 };
+    // Slack for the scheduling of the test threads
+    constexpr std::chrono::milliseconds tolerance{ 150 };
+
+    // The apps of a workspace, identified by name
+    LaunchScheduler MakeScheduler(const std::vector<char>& apps)
+    {
+        return LaunchScheduler(
+            apps.size(), [apps](size_t first, size_t second) { return apps[first] == apps[second]; }, maxInstanceWaitTime, instanceLaunchDelay);
+    }
+
+    // Calls Next on another thread, so that a test can't hang when it doesn't return
+    std::future<std::optional<size_t>> NextAsync(LaunchScheduler& scheduler)
+    {
+        return std::async(std::launch::async, [&scheduler] { return scheduler.Next(); });
+    }
+
+    // Cancels the scheduler if Next doesn't return, so that the test fails instead of waiting for it forever
+    std::optional<size_t> Get(LaunchScheduler& scheduler, std::future<std::optional<size_t>>& next)
+    {
+        if (next.wait_for(5s) != std::future_status::ready)
+        {
+            scheduler.Cancel();
+            Assert::Fail(L"Next didn't return");
+        }
+        return next.get();
+    }
+
+    void AssertElapsed(Clock::time_point start, std::chrono::milliseconds expected)
+    {
+        const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - start);
+        Assert::IsTrue(elapsed >= expected, std::to_wstring(elapsed.count()).c_str());
+        Assert::IsTrue(elapsed < expected + tolerance, std::to_wstring(elapsed.count()).c_str());
+    }
+
+    TEST_CLASS (LaunchSchedulerTests)
+    {
+    public:
+        TEST_METHOD (DefaultDelays)
+        {
+            Assert::IsTrue(LaunchScheduler::MaxInstanceWaitTime == 3s);
+            Assert::IsTrue(LaunchScheduler::InstanceLaunchDelay == 1s);
+        }
+
+        TEST_METHOD (DifferentAppsLaunchRightAway)
+        {
+            auto scheduler = MakeScheduler({ 'a', 'b', 'c' });
+            const auto start = Clock::now();
+
+            Assert::IsTrue(scheduler.Next() == 0u);
+            Assert::IsTrue(scheduler.Next() == 1u);
+            Assert::IsTrue(scheduler.Next() == 2u);
+            Assert::IsFalse(scheduler.Next().has_value());
+            AssertElapsed(start, 0ms);
+        }
+
+        TEST_METHOD (SameAppWaitsForThePreviousInstance)
+        {
+            auto scheduler = MakeScheduler({ 'a', 'b', 'a' });
+            Assert::IsTrue(scheduler.Next() == 0u);
+            Assert::IsTrue(scheduler.Next() == 1u);
+
+            // The other app doesn't release the second instance
+            auto next = NextAsync(scheduler);
+            scheduler.Launched(1, true);
+            scheduler.Arranged(1);
+            Assert::IsTrue(next.wait_for(100ms) == std::future_status::timeout);
+
+            // Neither does the launch of the first instance, its window isn't moved yet
+            scheduler.Launched(0, true);
+            Assert::IsTrue(next.wait_for(100ms) == std::future_status::timeout);
+
+            const auto arranged = Clock::now();
+            scheduler.Arranged(0);
+            Assert::IsTrue(Get(scheduler, next) == 2u);
+            AssertElapsed(arranged, instanceLaunchDelay);
+        }
+
+        TEST_METHOD (SameAppInstancesAreChained)
+        {
+            auto scheduler = MakeScheduler({ 'a', 'a', 'a' });
+            for (size_t instance = 0; instance < 3; instance++)
+            {
+                auto next = NextAsync(scheduler);
+                Assert::IsTrue(Get(scheduler, next) == instance);
+
+                scheduler.Launched(instance, true);
+                scheduler.Arranged(instance);
+            }
+
+            Assert::IsFalse(scheduler.Next().has_value());
+        }
+
+        TEST_METHOD (NextInstanceLaunchesAfterTheTimeout)
+        {
+            auto scheduler = MakeScheduler({ 'a', 'a' });
+            Assert::IsTrue(scheduler.Next() == 0u);
+
+            // The window of the first instance is never moved
+            const auto launched = Clock::now();
+            scheduler.Launched(0, true);
+            auto next = NextAsync(scheduler);
+            Assert::IsTrue(Get(scheduler, next) == 1u);
+            AssertElapsed(launched, maxInstanceWaitTime + instanceLaunchDelay);
+        }
+
+        TEST_METHOD (ArrangedAfterTheTimeoutDoesNotDelayTheNextInstance)
+        {
+            auto scheduler = MakeScheduler({ 'a', 'a' });
+            Assert::IsTrue(scheduler.Next() == 0u);
+
+            const auto launched = Clock::now();
+            scheduler.Launched(0, true);
+            auto next = NextAsync(scheduler);
+            std::this_thread::sleep_for(maxInstanceWaitTime + 50ms);
+            scheduler.Arranged(0);
+
+            Assert::IsTrue(Get(scheduler, next) == 1u);
+            AssertElapsed(launched, maxInstanceWaitTime + instanceLaunchDelay);
+        }
+
+        TEST_METHOD (FailedLaunchReleasesTheNextInstance)
+        {
+            auto scheduler = MakeScheduler({ 'a', 'a' });
+            Assert::IsTrue(scheduler.Next() == 0u);
+
+            auto next = NextAsync(scheduler);
+            const auto failed = Clock::now();
+            scheduler.Launched(0, false);
+            Assert::IsTrue(Get(scheduler, next) == 1u);
+            AssertElapsed(failed, 0ms);
+        }
+
+        TEST_METHOD (CancelWakesBlockedCallers)
+        {
+            auto scheduler = MakeScheduler({ 'a', 'a', 'a' });
+            Assert::IsTrue(scheduler.Next() == 0u);
+
+            // Both wait for the first instance, which is never launched
+            auto first = NextAsync(scheduler);
+            auto second = NextAsync(scheduler);
+            Assert::IsTrue(first.wait_for(100ms) == std::future_status::timeout);
+
+            scheduler.Cancel();
+            Assert::IsFalse(Get(scheduler, first).has_value());
+            Assert::IsFalse(Get(scheduler, second).has_value());
+            Assert::IsFalse(scheduler.Next().has_value());
+        }
+
+        TEST_METHOD (CancelWakesCallersWaitingForTheDelay)
+        {
+            auto scheduler = MakeScheduler({ 'a', 'a' });
+            Assert::IsTrue(scheduler.Next() == 0u);
+            scheduler.Launched(0, true);
+
+            auto next = NextAsync(scheduler);
+            Assert::IsTrue(next.wait_for(100ms) == std::future_status::timeout);
+
+            const auto canceled = Clock::now();
+            scheduler.Cancel();
+            Assert::IsFalse(Get(scheduler, next).has_value());
+            AssertElapsed(canceled, 0ms);
+        }
+    };
+}
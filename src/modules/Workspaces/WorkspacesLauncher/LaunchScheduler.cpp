@@ -0,0 +1,130 @@
+#include "pch.h"
+#include "LaunchScheduler.h"
+
+LaunchScheduler::LaunchScheduler(size_t appCount,
+                                 const std::function<bool(size_t, size_t)>& sameApp,
+                                 std::chrono::milliseconds maxInstanceWaitTime,
+                                 std::chrono::milliseconds instanceLaunchDelay) :
+    m_maxInstanceWaitTime(maxInstanceWaitTime),
+    m_instanceLaunchDelay(instanceLaunchDelay),
+    m_apps(appCount)
+{
+    for (size_t app = 0; app < appCount; app++)
+    {
+        for (size_t previous = app; previous-- > 0;)
+        {
+            if (sameApp(previous, app))
+            {
+                m_apps[app].previousInstance = previous;
+                break;
+            }
+        }
+    }
+}
+
+std::optional<size_t> LaunchScheduler::Next()
+{
+    std::unique_lock lock(m_mutex);
+    while (!m_canceled)
+    {
+        const auto now = Clock::now();
+        bool waiting = false;
+        auto wakeTime = Clock::time_point::max();
+
+        for (size_t index = 0; index < m_apps.size(); index++)
+        {
+            auto& app = m_apps[index];
+            if (app.state != State::Waiting)
+            {
+                continue;
+            }
+
+            waiting = true;
+            auto readyTime = ReadyTime(app);
+            if (readyTime && *readyTime <= now)
+            {
+                app.state = State::Launching;
+                return index;
+            }
+
+            if (readyTime)
+            {
+                wakeTime = (std::min)(wakeTime, *readyTime);
+            }
+        }
+
+        if (!waiting)
+        {
+            break;
+        }
+
+        if (wakeTime == Clock::time_point::max())
+        {
+            m_condition.wait(lock);
+        }
+        else
+        {
+            m_condition.wait_until(lock, wakeTime);
+        }
+    }
+
+    return std::nullopt;
+}
+
+void LaunchScheduler::Launched(size_t app, bool success)
+{
+    {
+        std::unique_lock lock(m_mutex);
+        m_apps[app].state = success ? State::Launched : State::Failed;
+        m_apps[app].launchedTime = Clock::now();
+    }
+
+    m_condition.notify_all();
+}
+
+void LaunchScheduler::Arranged(size_t app)
+{
+    {
+        std::unique_lock lock(m_mutex);
+        if (m_apps[app].state != State::Launched)
+        {
+            return;
+        }
+
+        m_apps[app].state = State::Arranged;
+        m_apps[app].arrangedTime = Clock::now();
+    }
+
+    m_condition.notify_all();
+}
+
+void LaunchScheduler::Cancel()
+{
+    {
+        std::unique_lock lock(m_mutex);
+        m_canceled = true;
+    }
+
+    m_condition.notify_all();
+}
+
+std::optional<LaunchScheduler::Clock::time_point> LaunchScheduler::ReadyTime(const App& app) const
+{
+    if (!app.previousInstance)
+    {
+        return Clock::time_point::min();
+    }
+
+    const auto& previous = m_apps[*app.previousInstance];
+    switch (previous.state)
+    {
+    case State::Launched:
+        return previous.launchedTime + m_maxInstanceWaitTime + m_instanceLaunchDelay;
+    case State::Arranged:
+        return (std::min)(previous.arrangedTime, previous.launchedTime + m_maxInstanceWaitTime) + m_instanceLaunchDelay;
+    case State::Failed:
+        return Clock::time_point::min();
+    default:
+        return std::nullopt;
+    }
+}
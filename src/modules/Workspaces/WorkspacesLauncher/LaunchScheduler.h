@@ -0,0 +1,70 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+// Decides when the apps of a workspace are launched. Different apps are launched right away and concurrently.
+// The instances of the same app are launched one after another: the next one once the window of the previous one
+// was moved, or it timed out, and after a delay, since some apps (e.g. Outlook) fail when their instances are
+// launched right one after another.
+// The apps are referred to by their index in the project.
+class LaunchScheduler
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // How long an instance waits for the window of the previous instance to be moved
+    constexpr static std::chrono::milliseconds MaxInstanceWaitTime{ 3000 };
+    // Delay between the previous instance being moved and launching the next one
+    constexpr static std::chrono::milliseconds InstanceLaunchDelay{ 1000 };
+
+    // The delays can be shortened for tests
+    LaunchScheduler(size_t appCount,
+                    const std::function<bool(size_t, size_t)>& sameApp,
+                    std::chrono::milliseconds maxInstanceWaitTime = MaxInstanceWaitTime,
+                    std::chrono::milliseconds instanceLaunchDelay = InstanceLaunchDelay);
+
+    // Waits until an app can be launched and returns it. Returns nullopt once all apps were handed out or on Cancel.
+    std::optional<size_t> Next();
+
+    // The launch of the app returned by Next finished
+    void Launched(size_t app, bool success);
+
+    // The window of the app was moved, or failed to
+    void Arranged(size_t app);
+
+    void Cancel();
+
+private:
+    enum class State
+    {
+        Waiting,
+        Launching,
+        Launched,
+        Arranged,
+        Failed,
+    };
+
+    struct App
+    {
+        // The previous instance of the same app, launched before this one
+        std::optional<size_t> previousInstance;
+        State state = State::Waiting;
+        Clock::time_point launchedTime;
+        Clock::time_point arrangedTime;
+    };
+
+    const std::chrono::milliseconds m_maxInstanceWaitTime;
+    const std::chrono::milliseconds m_instanceLaunchDelay;
+    std::vector<App> m_apps;
+    bool m_canceled = false;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+
+    // nullopt while the previous instance is waiting or being launched
+    std::optional<Clock::time_point> ReadyTime(const App& app) const;
+};
@@ -19,7 +19,11 @@ Launcher::Launcher(const WorkspacesData::WorkspacesProject& project,
     m_start(std::chrono::high_resolution_clock::now()),
     m_uiHelper(std::make_unique<LauncherUIHelper>(std::bind(&Launcher::handleUIMessage, this, std::placeholders::_1))),
     m_windowArrangerHelper(std::make_unique<WindowArrangerHelper>(std::bind(&Launcher::handleWindowArrangerMessage, this, std::placeholders::_1))),
-    m_launchingStatus(m_project)
+    m_launchingStatus(m_project),
+    m_scheduler(m_project.apps.size(), [&](size_t first, size_t second) {
+        // the same as LaunchingStatus::AllInstancesOfTheAppLaunchedAndMoved
+        return m_project.apps[first].name == m_project.apps[second].name || m_project.apps[first].path == m_project.apps[second].path;
+    })
 {
     // main thread
     Logger::info(L"Launch Workspace {} : {}", m_project.name, m_project.id);
@@ -97,68 +101,69 @@ Launcher::~Launcher()
 
 void Launcher::Launch() // Launching thread
 {
-    const long maxWaitTimeMs = 3000;
-    const long ms = 100;
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < (std::min)(MaxParallelLaunches, m_project.apps.size()); i++)
+    {
+        threads.emplace_back([&]() {
+            for (auto index = m_scheduler.Next(); index.has_value(); index = m_scheduler.Next())
+            {
+                LaunchApp(index.value());
+            }
+        });
+    }
 
-    // Launch apps
-    for (auto appState = m_launchingStatus.GetNext(LaunchingState::Waiting); appState.has_value(); appState = m_launchingStatus.GetNext(LaunchingState::Waiting))
+    for (auto& thread : threads)
     {
-        auto app = appState.value().application;
-        
-        long waitingTime = 0;
-        bool additionalWait = false;
-        while (!m_launchingStatus.AllInstancesOfTheAppLaunchedAndMoved(app) && waitingTime < maxWaitTimeMs)
-        {
-            std::this_thread::sleep_for(std::chrono::milliseconds(ms));
-            waitingTime += ms;
-            additionalWait = true;
-        }
+        thread.join();
+    }
+}
 
-        if (additionalWait)
-        {
-            // Resolves an issue when Outlook does not launch when launching one after another.
-            // Launching Outlook instances right one after another causes error message.
-            // Launching Outlook instances with less than 1-second delay causes the second window not to appear
-            // even though there wasn't a launch error.
-            std::this_thread::sleep_for(std::chrono::milliseconds(1000));
-        }
+void Launcher::LaunchApp(size_t index) // Launching threads
+{
+    const auto& app = m_project.apps[index];
 
-        if (waitingTime >= maxWaitTimeMs)
-        {
-            Logger::info(L"Waiting time for launching next {} instance expired", app.name);
-        }
+    auto appState = m_launchingStatus.Get(app);
+    if (!appState.has_value() || appState.value().state != LaunchingState::Waiting)
+    {
+        // canceled
+        m_scheduler.Launched(index, false);
+        return;
+    }
 
-        bool launched{ false };
-        {
-            std::lock_guard lock(m_launchErrorsMutex);
-            launched = AppLauncher::Launch(app, m_launchErrors);
-        }
+    AppLauncher::ErrorList launchErrors{};
+    bool launched = AppLauncher::Launch(app, launchErrors);
+    if (!launchErrors.empty())
+    {
+        std::lock_guard lock(m_launchErrorsMutex);
+        m_launchErrors.insert(m_launchErrors.end(), launchErrors.begin(), launchErrors.end());
+    }
 
-        if (launched)
-        {
-            m_launchingStatus.Update(app, LaunchingState::Launched);
-        }
-        else
-        {
-            Logger::error(L"Failed to launch {}", app.name);
-            m_launchingStatus.Update(app, LaunchingState::Failed);
-            m_launchedSuccessfully = false;
-        }
+    if (launched)
+    {
+        m_launchingStatus.Update(app, LaunchingState::Launched);
+    }
+    else
+    {
+        Logger::error(L"Failed to launch {}", app.name);
+        m_launchingStatus.Update(app, LaunchingState::Failed);
+        m_launchedSuccessfully = false;
+    }
 
-        auto status = m_launchingStatus.Get(app); // updated after launch status 
-        if (status.has_value())
-        {
-            {
-                std::lock_guard lock(m_windowArrangerHelperMutex);
-                m_windowArrangerHelper->UpdateLaunchStatus(status.value());
-            }
-        }
+    m_scheduler.Launched(index, launched);
 
+    auto status = m_launchingStatus.Get(app); // updated after launch status 
+    if (status.has_value())
+    {
         {
-            std::lock_guard lock(m_uiHelperMutex);
-            m_uiHelper->UpdateLaunchStatus(m_launchingStatus.Get());
+            std::lock_guard lock(m_windowArrangerHelperMutex);
+            m_windowArrangerHelper->UpdateLaunchStatus(status.value());
         }
     }
+
+    {
+        std::lock_guard lock(m_uiHelperMutex);
+        m_uiHelper->UpdateLaunchStatus(m_launchingStatus.Get());
+    }
 }
 
 void Launcher::handleWindowArrangerMessage(const std::wstring& msg) // WorkspacesArranger IPC thread
@@ -175,7 +180,17 @@ void Launcher::handleWindowArrangerMessage(const std::wstring& msg) // Workspace
             if (data.has_value())
             {
                 m_launchingStatus.Update(data.value().application, data.value().state);
-                
+
+                if (data.value().state == LaunchingState::LaunchedAndMoved || data.value().state == LaunchingState::Failed)
+                {
+                    // lets the next instance of the app launch
+                    auto app = std::find(m_project.apps.begin(), m_project.apps.end(), data.value().application);
+                    if (app != m_project.apps.end())
+                    {
+                        m_scheduler.Arranged(std::distance(m_project.apps.begin(), app));
+                    }
+                }
+
                 {
                     std::lock_guard lock(m_uiHelperMutex);
                     m_uiHelper->UpdateLaunchStatus(m_launchingStatus.Get());
@@ -198,5 +213,6 @@ void Launcher::handleUIMessage(const std::wstring& msg) // UI IPC thread
     if (msg == L"cancel")
     {
         m_launchingStatus.Cancel();
+        m_scheduler.Cancel();
     }
 }
@@ -5,6 +5,7 @@
 
 #include <workspaces-common/InvokePoint.h>
 
+#include <LaunchScheduler.h>
 #include <LauncherUIHelper.h>
 #include <WindowArrangerHelper.h>
 
@@ -15,12 +16,16 @@ public:
     ~Launcher();
 
 private:
+    // Apps launched at the same time
+    constexpr static size_t MaxParallelLaunches = 4;
+
     WorkspacesData::WorkspacesProject m_project;
     std::vector<WorkspacesData::WorkspacesProject>& m_workspaces;
     const InvokePoint m_invokePoint;
     const std::chrono::steady_clock::time_point m_start;
     std::atomic<bool> m_launchedSuccessfully{};
     LaunchingStatus m_launchingStatus;
+    LaunchScheduler m_scheduler;
 
     std::unique_ptr<LauncherUIHelper> m_uiHelper;
     std::mutex m_uiHelperMutex;
@@ -32,6 +37,7 @@ private:
     std::mutex m_launchErrorsMutex;
 
     void Launch();
+    void LaunchApp(size_t index);
     void handleWindowArrangerMessage(const std::wstring& msg);
     void handleUIMessage(const std::wstring& msg);
 };
@@ -1,10 +1,13 @@
 #include "pch.h"
 
 #include <common/interop/two_way_pipe_message_ipc_impl.h>
+#include <common/interop/named_pipe_transport.h>
+#include <common/interop/pipe_message_framing.h>
 
 #include <iterator>
 
-constexpr DWORD BUFSIZE = 1024;
+// Peers usually keep a single connection open, a second thread covers one reconnecting before the old connection is dropped
+constexpr size_t INPUT_PIPE_THREADS = 2;
 
 TwoWayPipeMessageIPC::TwoWayPipeMessageIPC(
     std::wstring _input_pipe_name,
@@ -49,14 +52,23 @@ TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl::TwoWayPipeMessageIPCImpl(
 
 void TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl::send(std::wstring msg)
 {
-    output_queue.queue_message(msg);
+    output_queue.queue_message(std::move(msg));
 }
 
 void TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl::start(HANDLE _restricted_pipe_token)
 {
+    transport = std::make_unique<NamedPipeTransport>(input_pipe_name, output_pipe_name, [this, _restricted_pipe_token](HANDLE pipe) {
+        if (_restricted_pipe_token != NULL)
+        {
+            change_pipe_security_allow_restricted_token(pipe, _restricted_pipe_token);
+        }
+    });
     output_queue_thread = std::thread(&TwoWayPipeMessageIPCImpl::consume_output_queue_thread, this);
     input_queue_thread = std::thread(&TwoWayPipeMessageIPCImpl::consume_input_queue_thread, this);
-    input_pipe_thread = std::thread(&TwoWayPipeMessageIPCImpl::start_named_pipe_server, this, _restricted_pipe_token);
+    for (size_t i = 0; i < INPUT_PIPE_THREADS; ++i)
+    {
+        input_pipe_threads.emplace_back(&TwoWayPipeMessageIPCImpl::read_input_pipe_connections, this);
+    }
 }
 
 void TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl::end()
@@ -65,98 +77,29 @@ void TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl::end()
     input_queue.interrupt();
     input_queue_thread.join();
     output_queue.interrupt();
+    //Cancels the pending pipe operations, e.g. waiting for a connection.
+    transport->close();
     output_queue_thread.join();
-    pipe_connect_handle_mutex.lock();
-    if (current_connect_pipe_handle != NULL)
-    {
-        //Cancels the Pipe currently waiting for a connection.
-        CancelIoEx(current_connect_pipe_handle, NULL);
-    }
-    pipe_connect_handle_mutex.unlock();
-    input_pipe_thread.join();
-}
-
-void TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl::send_pipe_message(std::wstring message)
-{
-    // Adapted from https://learn.microsoft.com/windows/win32/ipc/named-pipe-client
-    HANDLE output_pipe_handle;
-    const wchar_t* message_send = message.c_str();
-    BOOL fSuccess = FALSE;
-    DWORD cbToWrite, cbWritten, dwMode;
-    const wchar_t* lpszPipename = output_pipe_name.c_str();
-
-    // Try to open a named pipe; wait for it, if necessary.
-
-    while (1)
-    {
-        output_pipe_handle = CreateFile(
-            lpszPipename, // pipe name
-            GENERIC_READ | // read and write access
-                GENERIC_WRITE,
-            0, // no sharing
-            NULL, // default security attributes
-            OPEN_EXISTING, // opens existing pipe
-            0, // default attributes
-            NULL); // no template file
-
-        // Break if the pipe handle is valid.
-
-        if (output_pipe_handle != INVALID_HANDLE_VALUE)
-            break;
-
-        // Exit if an error other than ERROR_PIPE_BUSY occurs.
-        DWORD curr_error = 0;
-        if ((curr_error = GetLastError()) != ERROR_PIPE_BUSY)
-        {
-            return;
-        }
-
-        // All pipe instances are busy, so wait for 20 seconds.
-
-        if (!WaitNamedPipe(lpszPipename, 20000))
-        {
-            return;
-        }
-    }
-    dwMode = PIPE_READMODE_MESSAGE;
-    fSuccess = SetNamedPipeHandleState(
-        output_pipe_handle, // pipe handle
-        &dwMode, // new pipe mode
-        NULL, // don't set maximum bytes
-        NULL); // don't set maximum time
-    if (!fSuccess)
+    for (auto& thread : input_pipe_threads)
     {
-        return;
+        thread.join();
     }
-
-    // Send a message to the pipe server.
-
-    cbToWrite = (lstrlen(message_send)) * sizeof(WCHAR); // no need to send final '\0'. Pipe is in message mode.
-
-    fSuccess = WriteFile(
-        output_pipe_handle, // pipe handle
-        message_send, // message
-        cbToWrite, // message length
-        &cbWritten, // bytes written
-        NULL); // not overlapped
-    if (!fSuccess)
-    {
-        return;
-    }
-    CloseHandle(output_pipe_handle);
-    return;
+    input_pipe_threads.clear();
 }
 
 void TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl::consume_output_queue_thread()
 {
+    pipe_message_framing::MessageSender sender(*transport);
+    std::vector<std::wstring> messages;
     while (!closed)
     {
-        std::wstring message = output_queue.pop_message();
-        if (message.length() == 0)
+        // Send everything that was queued since the last wake up in a single write
+        messages.clear();
+        if (output_queue.pop_batch(messages) == 0)
         {
             break;
         }
-        send_pipe_message(message);
+        sender.send(messages);
     }
 }
 
@@ -348,103 +291,15 @@ HANDLE TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl::create_medium_integrity_t
     return restricted_token_handle;
 }
 
-void TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl::handle_pipe_connection(HANDLE input_pipe_handle)
+void TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl::read_input_pipe_connections()
 {
-    if (!input_pipe_handle)
-    {
-        return;
-    }
-    constexpr DWORD readBlockBytes = BUFSIZE;
-    std::wstring message;
-    size_t iBlock = 0;
-    message.reserve(BUFSIZE);
-    bool ok;
-    do
-    {
-        constexpr size_t charsPerBlock = readBlockBytes / sizeof(message[0]);
-        message.resize(message.size() + charsPerBlock);
-        DWORD bytesRead = 0;
-        ok = ReadFile(
-            input_pipe_handle,
-            // read the message directly into the string block by block simultaneously resizing it
-            message.data() + iBlock * charsPerBlock,
-            readBlockBytes,
-            &bytesRead,
-            nullptr);
-
-        if (!ok && GetLastError() != ERROR_MORE_DATA)
+    pipe_message_framing::receive_messages(*transport, [this](std::wstring message) {
+        // An empty message would stop the input queue thread
+        if (!message.empty())
         {
-            break;
+            input_queue.queue_message(std::move(message));
         }
-        iBlock++;
-    } while (!ok);
-    // trim the message's buffer
-    const auto nullCharPos = message.find_last_not_of(L'\0');
-    if (nullCharPos != std::wstring::npos)
-    {
-        message.resize(nullCharPos + 1);
-    }
-
-    input_queue.queue_message(std::move(message));
-
-    // Flush the pipe to allow the client to read the pipe's contents
-    // before disconnecting. Then disconnect the pipe, and close the
-    // handle to this pipe instance.
-
-    FlushFileBuffers(input_pipe_handle);
-    DisconnectNamedPipe(input_pipe_handle);
-    CloseHandle(input_pipe_handle);
-}
-
-void TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl::start_named_pipe_server(HANDLE token)
-{
-    // Adapted from https://learn.microsoft.com/windows/win32/ipc/multithreaded-pipe-server
-    const wchar_t* pipe_name = input_pipe_name.c_str();
-    BOOL connected = FALSE;
-    HANDLE connect_pipe_handle = INVALID_HANDLE_VALUE;
-    while (!closed)
-    {
-        {
-            std::unique_lock lock(pipe_connect_handle_mutex);
-            connect_pipe_handle = CreateNamedPipe(
-                pipe_name,
-                PIPE_ACCESS_DUPLEX |
-                    WRITE_DAC,
-                PIPE_TYPE_MESSAGE |
-                    PIPE_READMODE_MESSAGE |
-                    PIPE_WAIT,
-                PIPE_UNLIMITED_INSTANCES,
-                BUFSIZE,
-                BUFSIZE,
-                0,
-                NULL);
-
-            if (connect_pipe_handle == INVALID_HANDLE_VALUE)
-            {
-                return;
-            }
-
-            if (token != NULL)
-            {
-                change_pipe_security_allow_restricted_token(connect_pipe_handle, token);
-            }
-            current_connect_pipe_handle = connect_pipe_handle;
-        }
-        connected = ConnectNamedPipe(connect_pipe_handle, NULL) ? TRUE : (GetLastError() == ERROR_PIPE_CONNECTED);
-        {
-            std::unique_lock lock(pipe_connect_handle_mutex);
-            current_connect_pipe_handle = NULL;
-        }
-        if (connected)
-        {
-            std::thread(&TwoWayPipeMessageIPCImpl::handle_pipe_connection, this, connect_pipe_handle).detach();
-        }
-        else
-        {
-            // Client could not connect.
-            CloseHandle(connect_pipe_handle);
-        }
-    }
+    });
 }
 
 void TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl::consume_input_queue_thread()
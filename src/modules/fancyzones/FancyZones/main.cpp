@@ -31,7 +31,8 @@ int WINAPI wWinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance,
     trace.UpdateState(true);
 
     winrt::init_apartment();
-    LoggerHelpers::init_logger(moduleName, internalPath, LogSettings::fancyZonesLoggerName);
+    // Logs from the hooks, which shouldn't wait for the disk
+    LoggerHelpers::init_logger(moduleName, internalPath, LogSettings::fancyZonesLoggerName, AsyncLogOptions{});
 
     if (powertoys_gpo::getConfiguredFancyZonesEnabledValue() == powertoys_gpo::gpo_rule_configured_disabled)
     {
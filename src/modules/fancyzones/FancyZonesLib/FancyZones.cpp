@@ -1,6 +1,9 @@
 #include "pch.h"
 #include "FancyZones.h"
 
+#include <algorithm>
+#include <chrono>
+
 #include <common/interop/shared_constants.h>
 #include <common/logger/logger.h>
 #include <common/logger/call_tracer.h>
@@ -153,7 +156,7 @@ protected:
 
 private:
     void UpdateWorkAreas(bool updateWindowPositions) noexcept;
-    bool ShouldWorkAreasBeRecreated(const std::vector<FancyZonesDataTypes::MonitorId>& monitors, const GUID& virtualDesktop, const std::unordered_map<HMONITOR, std::unique_ptr<WorkArea>>& workAreas) noexcept;
+    bool ShouldWorkAreaBeRecreated(const FancyZonesDataTypes::MonitorId& monitor, const GUID& virtualDesktop, const WorkArea& workArea) noexcept;
     void CycleWindows(bool reverse) noexcept;
 
     void SyncVirtualDesktops() noexcept;
@@ -280,6 +283,9 @@ FancyZones::Run() noexcept
 IFACEMETHODIMP_(void)
 FancyZones::Destroy() noexcept
 {
+    AppZoneHistory::instance().FlushData();
+    AppliedLayouts::instance().FlushData();
+
     m_workAreaConfiguration.Clear();
     BufferedPaintUnInit();
     if (m_window)
@@ -531,6 +537,9 @@ void FancyZones::ToggleEditor() noexcept
 
     m_terminateEditorEvent.reset(CreateEvent(nullptr, true, false, nullptr));
 
+    // The editor reads the applied layouts
+    AppliedLayouts::instance().FlushData();
+
     if (!EditorParameters::Save(m_workAreaConfiguration, m_dpiUnawareThread))
     {
         Logger::error(L"Failed to save editor startup parameters");
@@ -706,8 +715,11 @@ LRESULT FancyZones::WndProc(HWND window, UINT message, WPARAM wparam, LPARAM lpa
         }
         else if (message == WM_PRIV_APPLIED_LAYOUTS_FILE_UPDATE)
         {
-            AppliedLayouts::instance().LoadData();
-            RefreshLayouts();
+            // The watcher reports the writes of this process too, the layouts are up to date then
+            if (AppliedLayouts::instance().LoadData())
+            {
+                RefreshLayouts();
+            }
         }
         else if (message == WM_PRIV_DEFAULT_LAYOUTS_FILE_UPDATE)
         {
@@ -816,55 +828,96 @@ void FancyZones::UpdateWorkAreas(bool updateWindowPositions) noexcept
 {
     Logger::debug(L"Update work areas, update windows positions: {}", updateWindowPositions);
 
+    using Clock = std::chrono::steady_clock;
+    auto elapsedMs = [](Clock::time_point from, Clock::time_point to) {
+        return std::chrono::duration<double, std::milli>(to - from).count();
+    };
+
+    const auto startTime = Clock::now();
+
     auto currentVirtualDesktop = VirtualDesktop::instance().GetCurrentVirtualDesktopIdFromRegistry();
+    const bool spanZonesAcrossMonitors = FancyZonesSettings::settings().spanZonesAcrossMonitors;
 
-    if (FancyZonesSettings::settings().spanZonesAcrossMonitors)
+    std::vector<FancyZonesDataTypes::MonitorId> monitors;
+    if (spanZonesAcrossMonitors)
     {
-        std::vector<FancyZonesDataTypes::MonitorId> monitors = { FancyZonesDataTypes::MonitorId{ .monitor = nullptr, .deviceId = { .id = ZonedWindowProperties::MultiMonitorName, .instanceId = ZonedWindowProperties::MultiMonitorInstance } } };
-        if (ShouldWorkAreasBeRecreated(monitors, currentVirtualDesktop, m_workAreaConfiguration.GetAllWorkAreas()))
-        {
-            m_workAreaConfiguration.Clear();
+        monitors = { FancyZonesDataTypes::MonitorId{ .monitor = nullptr, .deviceId = { .id = ZonedWindowProperties::MultiMonitorName, .instanceId = ZonedWindowProperties::MultiMonitorInstance } } };
+    }
+    else
+    {
+        monitors = MonitorUtils::IdentifyMonitors();
+    }
 
-            FancyZonesDataTypes::WorkAreaId workAreaId;
-            workAreaId.virtualDesktopId = currentVirtualDesktop;
-            workAreaId.monitorId = { .deviceId = { .id = ZonedWindowProperties::MultiMonitorName, .instanceId = ZonedWindowProperties::MultiMonitorInstance } };
+    const auto topologyTime = Clock::now();
 
-            AddWorkArea(nullptr, workAreaId, FancyZonesUtils::GetAllMonitorsCombinedRect<&MONITORINFO::rcWork>());
+    // only the work areas of the monitors which changed are recreated, the others keep their windows
+    std::vector<HMONITOR> outdatedWorkAreas;
+    for (const auto& [monitor, workArea] : m_workAreaConfiguration.GetAllWorkAreas())
+    {
+        auto iter = std::find_if(monitors.begin(), monitors.end(), [monitor](const FancyZonesDataTypes::MonitorId& id) { return id.monitor == monitor; });
+        if (iter == monitors.end())
+        {
+            Logger::trace(L"Monitor was removed");
+            outdatedWorkAreas.push_back(monitor);
+        }
+        else if (!workArea || ShouldWorkAreaBeRecreated(*iter, currentVirtualDesktop, *workArea))
+        {
+            outdatedWorkAreas.push_back(monitor);
         }
     }
-    else
+
+    for (const auto monitor : outdatedWorkAreas)
     {
-        auto monitors = MonitorUtils::IdentifyMonitors();
-        const auto& workAreas = m_workAreaConfiguration.GetAllWorkAreas();
-        
-        if (ShouldWorkAreasBeRecreated(monitors, currentVirtualDesktop, workAreas))
+        m_workAreaConfiguration.RemoveWorkArea(monitor);
+    }
+
+    size_t addedWorkAreas = 0;
+    for (const auto& monitor : monitors)
+    {
+        if (m_workAreaConfiguration.GetWorkArea(monitor.monitor))
         {
-            m_workAreaConfiguration.Clear();
-            for (const auto& monitor : monitors)
-            {
-                FancyZonesDataTypes::WorkAreaId workAreaId;
-                workAreaId.virtualDesktopId = currentVirtualDesktop;
-                workAreaId.monitorId = monitor;
+            continue;
+        }
 
-                AddWorkArea(monitor.monitor, workAreaId, MonitorUtils::GetWorkAreaRect(monitor.monitor));
-            }
+        FancyZonesDataTypes::WorkAreaId workAreaId;
+        workAreaId.virtualDesktopId = currentVirtualDesktop;
+        workAreaId.monitorId = monitor;
+
+        const auto rect = spanZonesAcrossMonitors ? FancyZonesUtils::GetAllMonitorsCombinedRect<&MONITORINFO::rcWork>() : MonitorUtils::GetWorkAreaRect(monitor.monitor);
+        if (AddWorkArea(monitor.monitor, workAreaId, rect))
+        {
+            addedWorkAreas++;
         }
     }
 
-    // init previously snapped windows
+    const auto reconcileTime = Clock::now();
+
+    // init previously snapped windows, which aren't assigned to a work area anymore
     std::unordered_map<HWND, ZoneIndexSet> windowsToSnap{};
-    for (const auto& window : VirtualDesktop::instance().GetWindowsFromCurrentDesktop())
+    if (!outdatedWorkAreas.empty() || addedWorkAreas > 0)
     {
-        auto indexes = FancyZonesWindowProperties::RetrieveZoneIndexProperty(window);
-        if (indexes.size() == 0)
+        std::unordered_set<HWND> assignedWindows;
+        for (const auto& [_, workArea] : m_workAreaConfiguration.GetAllWorkAreas())
         {
-            continue;
+            for (const auto& [window, zones] : workArea->GetLayoutWindows().SnappedWindows())
+            {
+                assignedWindows.insert(window);
+            }
         }
 
-        windowsToSnap.insert({ window, indexes });
+        for (auto& [window, zones] : FancyZonesWindowProperties::GetZonedWindows())
+        {
+            if (!assignedWindows.contains(window) && VirtualDesktop::instance().IsWindowOnCurrentDesktop(window))
+            {
+                windowsToSnap.insert({ window, std::move(zones) });
+            }
+        }
     }
 
-    if (FancyZonesSettings::settings().spanZonesAcrossMonitors) // one work area across monitors
+    const auto windowsTime = Clock::now();
+    const size_t windowsToSnapCount = windowsToSnap.size();
+
+    if (spanZonesAcrossMonitors) // one work area across monitors
     {
         const auto workArea = m_workAreaConfiguration.GetWorkArea(nullptr);
         if (workArea)
@@ -909,6 +962,8 @@ void FancyZones::UpdateWorkAreas(bool updateWindowPositions) noexcept
         }
     }
 
+    const auto snapTime = Clock::now();
+
     if (updateWindowPositions)
     {
         for (const auto& [_, workArea] : m_workAreaConfiguration.GetAllWorkAreas())
@@ -919,49 +974,46 @@ void FancyZones::UpdateWorkAreas(bool updateWindowPositions) noexcept
             }
         }
     }
+
+    const auto endTime = Clock::now();
+
+    Logger::debug(L"Work areas updated in {:.2f} ms: {} recreated or removed, {} added, {} windows to snap. Monitors {:.2f} ms, work areas {:.2f} ms, windows {:.2f} ms, snap {:.2f} ms, positions {:.2f} ms",
+                  elapsedMs(startTime, endTime),
+                  outdatedWorkAreas.size(),
+                  addedWorkAreas,
+                  windowsToSnapCount,
+                  elapsedMs(startTime, topologyTime),
+                  elapsedMs(topologyTime, reconcileTime),
+                  elapsedMs(reconcileTime, windowsTime),
+                  elapsedMs(windowsTime, snapTime),
+                  elapsedMs(snapTime, endTime));
 }
 
-bool FancyZones::ShouldWorkAreasBeRecreated(const std::vector<FancyZonesDataTypes::MonitorId>& monitors, const GUID& virtualDesktop, const std::unordered_map<HMONITOR, std::unique_ptr<WorkArea>>& workAreas) noexcept
+bool FancyZones::ShouldWorkAreaBeRecreated(const FancyZonesDataTypes::MonitorId& monitor, const GUID& virtualDesktop, const WorkArea& workArea) noexcept
 {
-    if (monitors.size() != workAreas.size())
+    if (workArea.UniqueId().monitorId.deviceId != monitor.deviceId)
     {
-        Logger::trace(L"Monitor was added or removed");
+        Logger::trace(L"DeviceId changed");
         return true;
     }
 
-    for (const auto& monitor : monitors)
+    if (workArea.UniqueId().monitorId.serialNumber != monitor.serialNumber)
     {
-        auto iter = workAreas.find(monitor.monitor);
-        if (iter == workAreas.end())
-        {
-            Logger::trace(L"WorkArea not found");
-            return true;
-        }
-
-        if (iter->second->UniqueId().monitorId.deviceId != monitor.deviceId)
-        {
-            Logger::trace(L"DeviceId changed");
-            return true;
-        }
-
-        if (iter->second->UniqueId().monitorId.serialNumber != monitor.serialNumber)
-        {
-            Logger::trace(L"Serial number changed");
-            return true;
-        }
+        Logger::trace(L"Serial number changed");
+        return true;
+    }
 
-        if (iter->second->UniqueId().virtualDesktopId != virtualDesktop)
-        {
-            Logger::trace(L"Virtual desktop changed");
-            return true;
-        }
+    if (workArea.UniqueId().virtualDesktopId != virtualDesktop)
+    {
+        Logger::trace(L"Virtual desktop changed");
+        return true;
+    }
 
-        const auto rect = monitor.monitor ? MonitorUtils::GetWorkAreaRect(monitor.monitor) : FancyZonesUtils::Rect(FancyZonesUtils::GetMonitorsCombinedRect<&MONITORINFOEX::rcWork>(FancyZonesUtils::GetAllMonitorRects<&MONITORINFOEX::rcWork>()));
-        if (iter->second->GetWorkAreaRect() != rect)
-        {
-            Logger::trace(L"WorkArea size changed");
-            return true;
-        }
+    const auto rect = monitor.monitor ? MonitorUtils::GetWorkAreaRect(monitor.monitor) : FancyZonesUtils::Rect(FancyZonesUtils::GetMonitorsCombinedRect<&MONITORINFOEX::rcWork>(FancyZonesUtils::GetAllMonitorRects<&MONITORINFOEX::rcWork>()));
+    if (workArea.GetWorkAreaRect() != rect)
+    {
+        Logger::trace(L"WorkArea size changed");
+        return true;
     }
 
     return false;
@@ -1142,7 +1194,7 @@ void FancyZones::ApplyQuickLayout(int key) noexcept
         {
             RefreshLayouts();
             FlashZones();
-            AppliedLayouts::instance().SaveData();
+            AppliedLayouts::instance().ScheduleSave();
         }
     }
 }
@@ -243,7 +243,8 @@ namespace JsonUtils
 }
 
 
-AppZoneHistory::AppZoneHistory()
+AppZoneHistory::AppZoneHistory() :
+    m_writer(AppZoneHistoryFileName())
 {
 }
 
@@ -253,8 +254,17 @@ AppZoneHistory& AppZoneHistory::instance()
     return self;
 }
 
-void AppZoneHistory::LoadData()
+bool AppZoneHistory::LoadData()
 {
+    // Nothing to reload after the writer's own write, the changes scheduled since must be kept
+    if (m_writer.IsFileLastWritten())
+    {
+        return false;
+    }
+
+    // The file wins over the changes that weren't written yet
+    m_writer.Cancel();
+
     auto file = AppZoneHistoryFileName();
     auto data = json::from_file(file);
 
@@ -274,11 +284,25 @@ void AppZoneHistory::LoadData()
     {
         Logger::error(L"Parsing app-zone-history error: {}", e.message());
     }
+
+    return true;
 }
 
 void AppZoneHistory::SaveData()
 {
-    json::to_file(AppZoneHistoryFileName(), JsonUtils::SerializeJson(m_history));
+    ScheduleSave();
+    FlushData();
+}
+
+void AppZoneHistory::ScheduleSave()
+{
+    // The history is serialized on the writer thread, from a copy
+    m_writer.Schedule([history = m_history] { return JsonUtils::SerializeJson(history); });
+}
+
+void AppZoneHistory::FlushData()
+{
+    m_writer.Flush();
 }
 
 void AppZoneHistory::AdjustWorkAreaIds(const std::vector<FancyZonesDataTypes::MonitorId>& ids)
@@ -310,7 +334,7 @@ void AppZoneHistory::AdjustWorkAreaIds(const std::vector<FancyZonesDataTypes::Mo
 
     if (dirtyFlag)
     {
-        SaveData();
+        ScheduleSave();
     }
 }
 
@@ -348,7 +372,7 @@ bool AppZoneHistory::SetAppLastZones(HWND window, const FancyZonesDataTypes::Wor
                 data.processIdToHandleMap[processId] = window;
                 data.layoutId = layoutId;
                 data.zoneIndexSet = zoneIndexSet;
-                SaveData();
+                ScheduleSave();
                 return true;
             }
         }
@@ -372,7 +396,7 @@ bool AppZoneHistory::SetAppLastZones(HWND window, const FancyZonesDataTypes::Wor
         m_history[processPath] = std::vector<FancyZonesDataTypes::AppZoneHistoryData>{ data };
     }
 
-    SaveData();
+    ScheduleSave();
     return true;
 }
 
@@ -428,7 +452,7 @@ bool AppZoneHistory::RemoveAppLastZone(HWND window, const FancyZonesDataTypes::W
             {
                 m_history.erase(processPath);
             }
-            SaveData();
+            ScheduleSave();
             return true;
         }
         else
@@ -625,6 +649,6 @@ void AppZoneHistory::SyncVirtualDesktops(const GUID& currentVirtualDesktop, cons
 
     if (dirtyFlag)
     {
-        SaveData();
+        ScheduleSave();
     }
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <FancyZonesLib/FancyZonesDataTypes.h>
+#include <FancyZonesLib/FancyZonesData/DeferredJsonWriter.h>
 #include <FancyZonesLib/ModuleConstants.h>
 
 #include <common/SettingsAPI/settings_helpers.h>
@@ -48,8 +49,14 @@ public:
     }
 #endif
 
-    void LoadData();
+    // Returns false if the file holds the data this process wrote last, which is already loaded
+    bool LoadData();
+    // Writes the file now
     void SaveData();
+    // Writes the file in the background, after a short delay so that consecutive changes are written once
+    void ScheduleSave();
+    // Writes the changes scheduled with ScheduleSave now
+    void FlushData();
     void AdjustWorkAreaIds(const std::vector<FancyZonesDataTypes::MonitorId>& ids);
 
     bool SetAppLastZones(HWND window, const FancyZonesDataTypes::WorkAreaId& workAreaId, const GUID& layoutId, const ZoneIndexSet& zoneIndexSet);
@@ -70,4 +77,5 @@ private:
     ~AppZoneHistory() = default;
 
     TAppZoneHistoryMap m_history;
+    DeferredJsonWriter m_writer;
 };
@@ -241,7 +241,8 @@ namespace JsonUtils
 }
 
 
-AppliedLayouts::AppliedLayouts()
+AppliedLayouts::AppliedLayouts() :
+    m_writer(AppliedLayoutsFileName())
 {
     const std::wstring& fileName = AppliedLayoutsFileName();
     m_fileWatcher = std::make_unique<FileWatcher>(fileName, [&]() {
@@ -255,8 +256,17 @@ AppliedLayouts& AppliedLayouts::instance()
     return self;
 }
 
-void AppliedLayouts::LoadData()
+bool AppliedLayouts::LoadData()
 {
+    // Nothing to reload after the writer's own write, the changes scheduled since must be kept
+    if (m_writer.IsFileLastWritten())
+    {
+        return false;
+    }
+
+    // The file wins over the changes that weren't written yet
+    m_writer.Cancel();
+
     auto data = json::from_file(AppliedLayoutsFileName());
 
     try
@@ -275,11 +285,25 @@ void AppliedLayouts::LoadData()
     {
         Logger::error(L"Parsing applied-layouts error: {}", e.message());
     }
+
+    return true;
 }
 
 void AppliedLayouts::SaveData()
 {
-    json::to_file(AppliedLayoutsFileName(), JsonUtils::SerializeJson(m_layouts));
+    ScheduleSave();
+    FlushData();
+}
+
+void AppliedLayouts::ScheduleSave()
+{
+    // The layouts are serialized on the writer thread, from a copy
+    m_writer.Schedule([layouts = m_layouts] { return JsonUtils::SerializeJson(layouts); });
+}
+
+void AppliedLayouts::FlushData()
+{
+    m_writer.Flush();
 }
 
 void AppliedLayouts::AdjustWorkAreaIds(const std::vector<FancyZonesDataTypes::MonitorId>& ids)
@@ -318,7 +342,7 @@ void AppliedLayouts::AdjustWorkAreaIds(const std::vector<FancyZonesDataTypes::Mo
 
     if (dirtyFlag)
     {
-        SaveData();
+        ScheduleSave();
     }
 }
 
@@ -373,7 +397,7 @@ void AppliedLayouts::SyncVirtualDesktops(const GUID& currentVirtualDesktop, cons
     if (layouts != m_layouts)
     {
         m_layouts = layouts;
-        SaveData();
+        ScheduleSave();
 
         std::wstring currentStr = FancyZonesUtils::GuidToString(currentVirtualDesktop).value_or(L"incorrect guid");
         std::wstring lastUsedStr = FancyZonesUtils::GuidToString(lastUsedVirtualDesktop).value_or(L"incorrect guid");
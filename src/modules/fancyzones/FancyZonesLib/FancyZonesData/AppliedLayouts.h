@@ -4,6 +4,7 @@
 #include <memory>
 #include <optional>
 
+#include <FancyZonesLib/FancyZonesData/DeferredJsonWriter.h>
 #include <FancyZonesLib/FancyZonesData/LayoutData.h>
 #include <FancyZonesLib/ModuleConstants.h>
 
@@ -56,8 +57,14 @@ public:
     }
 #endif
 
-    void LoadData();
+    // Returns false if the file holds the data this process wrote last, which is already loaded
+    bool LoadData();
+    // Writes the file now
     void SaveData();
+    // Writes the file in the background, after a short delay so that consecutive changes are written once
+    void ScheduleSave();
+    // Writes the changes scheduled with ScheduleSave now, e.g. before the editor reads the file
+    void FlushData();
     void AdjustWorkAreaIds(const std::vector<FancyZonesDataTypes::MonitorId>& ids);
 
     void SyncVirtualDesktops(const GUID& currentVirtualDesktop, const GUID& lastUsedVirtualDesktop, std::optional<std::vector<GUID>> desktops);
@@ -77,4 +84,5 @@ private:
 
     std::unique_ptr<FileWatcher> m_fileWatcher;
     TAppliedLayoutsMap m_layouts;
+    DeferredJsonWriter m_writer;
 };
@@ -6,6 +6,7 @@
 #include <FancyZonesLib/FancyZonesData/LayoutDefaults.h>
 #include <FancyZonesLib/FancyZonesWinHookEventIDs.h>
 #include <FancyZonesLib/JsonHelpers.h>
+#include <FancyZonesLib/LayoutZonesCache.h>
 #include <FancyZonesLib/util.h>
 
 namespace JsonUtils
@@ -214,6 +215,9 @@ void CustomLayouts::LoadData()
     {
         Logger::error(L"Parsing custom-layouts error: {}", e.message());
     }
+
+    // The zones of the changed layouts are calculated again
+    LayoutZonesCache::instance().Clear();
 }
 
 std::optional<LayoutData> CustomLayouts::GetLayout(const GUID& id) const noexcept
@@ -0,0 +1,231 @@
+#include "../pch.h"
+#include "DeferredJsonWriter.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+
+#include <common/logger/logger.h>
+#include <common/utils/winapi_error.h>
+
+DeferredJsonWriter::DeferredJsonWriter(std::wstring fileName, std::chrono::milliseconds delay, std::chrono::milliseconds maxDelay) :
+    m_fileName(std::move(fileName)),
+    m_delay(delay),
+    m_maxDelay(maxDelay)
+{
+}
+
+DeferredJsonWriter::~DeferredJsonWriter()
+{
+    {
+        std::unique_lock lock(m_mutex);
+        m_flushRequested = true;
+    }
+    m_condition.notify_all();
+
+    if (m_thread.joinable())
+    {
+        m_thread.join();
+    }
+}
+
+void DeferredJsonWriter::Schedule(Serializer serializer)
+{
+    std::unique_lock lock(m_mutex);
+
+    const auto now = std::chrono::steady_clock::now();
+    if (!m_pending)
+    {
+        m_firstScheduled = now;
+    }
+    m_pending = std::move(serializer);
+    m_deadline = (std::min)(now + m_delay, m_firstScheduled + m_maxDelay);
+    ++m_scheduledCount;
+    ++m_stats.scheduled;
+
+    if (m_running)
+    {
+        m_condition.notify_all();
+        return;
+    }
+
+    // The previous thread is done, or about to be
+    if (m_thread.joinable())
+    {
+        m_thread.join();
+    }
+    m_running = true;
+    m_thread = std::thread([this] { Run(); });
+}
+
+void DeferredJsonWriter::Flush()
+{
+    std::unique_lock lock(m_mutex);
+    if (!m_running)
+    {
+        return;
+    }
+
+    const size_t target = m_scheduledCount;
+    m_flushRequested = true;
+    m_condition.notify_all();
+    m_condition.wait(lock, [&] { return m_doneCount >= target || !m_running; });
+}
+
+void DeferredJsonWriter::Cancel()
+{
+    std::unique_lock lock(m_mutex);
+
+    m_pending = nullptr;
+    m_doneCount = m_scheduledCount;
+    ++m_cancelCount;
+    m_condition.notify_all();
+}
+
+bool DeferredJsonWriter::IsFileLastWritten() const
+{
+    std::optional<size_t> lastWrittenHash;
+    {
+        std::unique_lock lock(m_mutex);
+        lastWrittenHash = m_lastWrittenHash;
+    }
+
+    if (!lastWrittenHash)
+    {
+        return false;
+    }
+
+    std::ifstream file(m_fileName, std::ios::binary);
+    if (!file)
+    {
+        return false;
+    }
+
+    const std::string content{ std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+    return std::hash<std::string>{}(content) == *lastWrittenHash;
+}
+
+DeferredJsonWriter::Stats DeferredJsonWriter::GetStats() const
+{
+    std::unique_lock lock(m_mutex);
+    return m_stats;
+}
+
+void DeferredJsonWriter::Run()
+{
+    winrt::init_apartment();
+
+    std::unique_lock lock(m_mutex);
+    while (m_pending)
+    {
+        // Wait for the changes to stop, the deadline moves with every change
+        while (m_pending && !m_flushRequested && std::chrono::steady_clock::now() < m_deadline)
+        {
+            m_condition.wait_until(lock, m_deadline);
+        }
+
+        if (!m_pending)
+        {
+            break;
+        }
+
+        Serializer serializer = std::move(m_pending);
+        m_pending = nullptr;
+        const size_t scheduledCount = m_scheduledCount;
+        const size_t cancelCount = m_cancelCount;
+
+        lock.unlock();
+        const size_t bytesWritten = Write(serializer, cancelCount);
+        serializer = nullptr;
+        lock.lock();
+
+        if (bytesWritten > 0)
+        {
+            ++m_stats.written;
+            m_stats.bytesWritten += bytesWritten;
+        }
+        m_doneCount = (std::max)(m_doneCount, scheduledCount);
+        if (!m_pending)
+        {
+            m_flushRequested = false;
+        }
+        m_condition.notify_all();
+    }
+
+    m_running = false;
+    m_condition.notify_all();
+    lock.unlock();
+
+    winrt::uninit_apartment();
+}
+
+// Returns the size of the file, or 0 if it couldn't be written or was cancelled
+size_t DeferredJsonWriter::Write(const Serializer& serializer, size_t cancelCount)
+{
+    std::string content;
+    try
+    {
+        content = winrt::to_string(serializer().Stringify());
+    }
+    catch (const winrt::hresult_error& e)
+    {
+        Logger::error(L"Failed to serialize {}: {}", m_fileName, e.message());
+        return 0;
+    }
+    catch (const std::exception& e)
+    {
+        Logger::error(L"Failed to serialize {}", m_fileName);
+        Logger::error("{}", e.what());
+        return 0;
+    }
+
+    // Write a temporary file and move it over the old one, so that a crash or a reader never sees a partial file
+    const std::wstring tempFileName = m_fileName + L".tmp";
+    wil::unique_hfile file(CreateFileW(tempFileName.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr));
+    if (!file)
+    {
+        Logger::error(L"Failed to create {}: {}", tempFileName, get_last_error_or_default(GetLastError()));
+        return 0;
+    }
+
+    DWORD bytesWritten = 0;
+    bool written = WriteFile(file.get(), content.data(), static_cast<DWORD>(content.size()), &bytesWritten, nullptr) &&
+                   bytesWritten == content.size() &&
+                   FlushFileBuffers(file.get());
+    file.reset();
+
+    DWORD error = ERROR_SUCCESS;
+    if (written)
+    {
+        // Cancel can't come between the check and the move: the file may just have been reloaded from another
+        // process's changes, which the stale data must not replace
+        std::unique_lock lock(m_mutex);
+        if (cancelCount != m_cancelCount)
+        {
+            DeleteFileW(tempFileName.c_str());
+            return 0;
+        }
+
+        const std::optional<size_t> previousHash = m_lastWrittenHash;
+        m_lastWrittenHash = std::hash<std::string>{}(content);
+        written = MoveFileExW(tempFileName.c_str(), m_fileName.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+        if (!written)
+        {
+            error = GetLastError();
+            m_lastWrittenHash = previousHash;
+        }
+    }
+    else
+    {
+        error = GetLastError();
+    }
+
+    if (!written)
+    {
+        Logger::error(L"Failed to write {}: {}", m_fileName, get_last_error_or_default(error));
+        DeleteFileW(tempFileName.c_str());
+        return 0;
+    }
+
+    return content.size();
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+
+#include <common/utils/json.h>
+
+// Writes a JSON file on a background thread once changes stop coming, so that a burst of changes is written once and
+// the caller doesn't wait for the serialization and the disk. The file is replaced atomically: other processes
+// never read it half written. The thread only runs while a write is pending.
+class DeferredJsonWriter
+{
+public:
+    // Builds the JSON of the data it captured. Runs on the writer thread, so it must not use the caller's data
+    using Serializer = std::function<json::JsonObject()>;
+
+    static constexpr std::chrono::milliseconds DefaultDelay{ 1000 };
+    // Continuous changes don't postpone the write for longer than this
+    static constexpr std::chrono::milliseconds DefaultMaxDelay{ 5000 };
+
+    struct Stats
+    {
+        size_t scheduled = 0;
+        size_t written = 0;
+        size_t bytesWritten = 0;
+    };
+
+    explicit DeferredJsonWriter(std::wstring fileName, std::chrono::milliseconds delay = DefaultDelay, std::chrono::milliseconds maxDelay = DefaultMaxDelay);
+    ~DeferredJsonWriter();
+
+    DeferredJsonWriter(const DeferredJsonWriter&) = delete;
+    DeferredJsonWriter& operator=(const DeferredJsonWriter&) = delete;
+
+    // Replaces the data waiting to be written
+    void Schedule(Serializer serializer);
+
+    // Returns once the data scheduled so far is written
+    void Flush();
+
+    // Drops the data waiting to be written, e.g. when the file was changed by another process and reloaded. A write
+    // in progress is dropped too, unless it already replaced the file.
+    void Cancel();
+
+    // Whether the file still holds the data this writer wrote last. The file watchers report the writer's own writes
+    // too, and reloading the file for them would drop the changes scheduled since.
+    bool IsFileLastWritten() const;
+
+    Stats GetStats() const;
+
+private:
+    void Run();
+    size_t Write(const Serializer& serializer, size_t cancelCount);
+
+    const std::wstring m_fileName;
+    const std::chrono::milliseconds m_delay;
+    const std::chrono::milliseconds m_maxDelay;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_condition;
+    Serializer m_pending;
+    std::chrono::steady_clock::time_point m_firstScheduled;
+    std::chrono::steady_clock::time_point m_deadline;
+    bool m_flushRequested = false;
+    // Schedule calls so far, and how many of them are written or cancelled
+    size_t m_scheduledCount = 0;
+    size_t m_doneCount = 0;
+    // Cancel calls so far. A write started before the last one holds stale data and doesn't replace the file.
+    size_t m_cancelCount = 0;
+    Stats m_stats;
+    // Hash of the content of the last write, set before the file is replaced so that the watcher never sees it unset
+    std::optional<size_t> m_lastWrittenHash;
+
+    bool m_running = false;
+    std::thread m_thread;
+};
@@ -5,6 +5,7 @@
 
 #include <FancyZonesLib/FancyZonesData/LayoutDefaults.h>
 #include <FancyZonesLib/FancyZonesWinHookEventIDs.h>
+#include <FancyZonesLib/LayoutZonesCache.h>
 
 namespace JsonUtils
 {
@@ -83,6 +84,9 @@ void LayoutTemplates::LoadData()
     {
         Logger::error(L"Parsing layout-templates error: {}", e.message());
     }
+
+    // The zones of the previous templates aren't used anymore
+    LayoutZonesCache::instance().Clear();
 }
 
 std::optional<LayoutData> LayoutTemplates::GetLayout(FancyZonesDataTypes::ZoneSetLayoutType type) const noexcept
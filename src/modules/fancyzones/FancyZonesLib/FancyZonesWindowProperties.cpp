@@ -1,6 +1,8 @@
 #include "pch.h"
 #include "FancyZonesWindowProperties.h"
 
+#include <mutex>
+
 #include <FancyZonesLib/ZoneIndexSetBitmask.h>
 
 #include <common/logger/logger.h>
@@ -17,6 +19,13 @@ namespace ZonedWindowProperties
     const wchar_t PropertySortKeyWithinZone[] = L"FancyZones_TabSortKeyWithinZone";
 }
 
+namespace
+{
+    std::mutex zonedWindowsMutex;
+    std::unordered_map<HWND, ZoneIndexSet> zonedWindows;
+    bool zonedWindowsFound = false;
+}
+
 bool FancyZonesWindowProperties::StampZoneIndexProperty(HWND window, const ZoneIndexSet& zoneSet)
 {
     RemoveZoneIndexProperty(window);
@@ -56,6 +65,12 @@ bool FancyZonesWindowProperties::StampZoneIndexProperty(HWND window, const ZoneI
         }
     }
 
+    if (!zoneSet.empty())
+    {
+        std::unique_lock lock(zonedWindowsMutex);
+        zonedWindows[window] = zoneSet;
+    }
+
     return true;
 }
 
@@ -63,6 +78,9 @@ void FancyZonesWindowProperties::RemoveZoneIndexProperty(HWND window)
 {
     ::RemoveProp(window, ZonedWindowProperties::PropertyMultipleZone64ID);
     ::RemoveProp(window, ZonedWindowProperties::PropertyMultipleZone128ID);
+
+    std::unique_lock lock(zonedWindowsMutex);
+    zonedWindows.erase(window);
 }
 
 ZoneIndexSet FancyZonesWindowProperties::RetrieveZoneIndexProperty(HWND window)
@@ -89,6 +107,48 @@ ZoneIndexSet FancyZonesWindowProperties::RetrieveZoneIndexProperty(HWND window)
     return bitmask.ToIndexSet();
 }
 
+std::unordered_map<HWND, ZoneIndexSet> FancyZonesWindowProperties::GetZonedWindows()
+{
+    std::unique_lock lock(zonedWindowsMutex);
+
+    if (!zonedWindowsFound)
+    {
+        zonedWindowsFound = true;
+
+        std::vector<HWND> windows;
+        EnumWindows([](HWND window, LPARAM data) -> BOOL {
+            reinterpret_cast<std::vector<HWND>*>(data)->push_back(window);
+            return TRUE;
+        }, reinterpret_cast<LPARAM>(&windows));
+
+        for (const auto window : windows)
+        {
+            auto zones = RetrieveZoneIndexProperty(window);
+            if (!zones.empty())
+            {
+                zonedWindows.insert({ window, std::move(zones) });
+            }
+        }
+    }
+
+    // Windows destroyed since they were stamped lose the property along with the handle, which may be reused
+    for (auto iter = zonedWindows.begin(); iter != zonedWindows.end();)
+    {
+        auto zones = IsWindow(iter->first) ? RetrieveZoneIndexProperty(iter->first) : ZoneIndexSet{};
+        if (zones.empty())
+        {
+            iter = zonedWindows.erase(iter);
+        }
+        else
+        {
+            iter->second = std::move(zones);
+            ++iter;
+        }
+    }
+
+    return zonedWindows;
+}
+
 void FancyZonesWindowProperties::StampMovedOnOpeningProperty(HWND window)
 {
     ::SetPropW(window, ZonedWindowProperties::PropertyMovedOnOpening, reinterpret_cast<HANDLE>(1));
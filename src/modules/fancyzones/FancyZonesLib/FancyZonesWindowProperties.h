@@ -1,6 +1,7 @@
 #pragma once
 
 #include <optional>
+#include <unordered_map>
 
 #include <FancyZonesLib/Zone.h>
 
@@ -22,6 +23,10 @@ namespace FancyZonesWindowProperties
     void RemoveZoneIndexProperty(HWND window);
     ZoneIndexSet RetrieveZoneIndexProperty(HWND window);
 
+    // The windows stamped with zones, tracked by Stamp and Remove so that they can be found without going through all windows.
+    // The first call also looks for the windows stamped before, e.g. by the previous FancyZones process.
+    std::unordered_map<HWND, ZoneIndexSet> GetZonedWindows();
+
     void StampMovedOnOpeningProperty(HWND window);
     bool RetrieveMovedOnOpeningProperty(HWND window);
 
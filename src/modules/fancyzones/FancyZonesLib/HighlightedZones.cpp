@@ -9,12 +9,12 @@ HighlightedZones::HighlightedZones() noexcept
 
 const ZoneIndexSet& HighlightedZones::Zones() const noexcept
 {
-    return m_highlightZone;
+    return m_highlightZoneIndexSet;
 }
 
 bool HighlightedZones::Empty() const noexcept
 {
-    return m_highlightZone.empty();
+    return m_highlightZone.Empty();
 }
 
 bool HighlightedZones::Update(const Layout* layout, POINT const& point, bool selectManyZones) noexcept
@@ -24,11 +24,11 @@ bool HighlightedZones::Update(const Layout* layout, POINT const& point, bool sel
         return false;
     }
 
-    auto highlightZone = layout->ZonesFromPoint(point);
+    auto highlightZone = ZoneIndexBitset::FromIndexSet(layout->ZonesFromPoint(point));
 
     if (selectManyZones)
     {
-        if (m_initialHighlightZone.empty())
+        if (m_initialHighlightZone.Empty())
         {
             // first time
             m_initialHighlightZone = highlightZone;
@@ -43,13 +43,19 @@ bool HighlightedZones::Update(const Layout* layout, POINT const& point, bool sel
         m_initialHighlightZone = {};
     }
 
-    const bool updated = (highlightZone != m_highlightZone);
-    m_highlightZone = std::move(highlightZone);
-    return updated;
+    if (highlightZone == m_highlightZone)
+    {
+        return false;
+    }
+
+    m_highlightZone = highlightZone;
+    m_highlightZoneIndexSet = highlightZone.ToIndexSet();
+    return true;
 }
 
 void HighlightedZones::Reset() noexcept
 {
     m_highlightZone = {};
     m_initialHighlightZone = {};
+    m_highlightZoneIndexSet = {};
 }
@@ -1,6 +1,6 @@
 #pragma once
 
-#include <FancyZonesLib/Zone.h>
+#include <FancyZonesLib/ZoneIndexBitset.h>
 
 class Layout;
 
@@ -17,6 +17,8 @@ public:
     void Reset() noexcept;
 
 private:
-    ZoneIndexSet m_initialHighlightZone;
-    ZoneIndexSet m_highlightZone;
+    ZoneIndexBitset m_initialHighlightZone;
+    ZoneIndexBitset m_highlightZone;
+    // m_highlightZone as returned by Zones(), rebuilt only when it changes
+    ZoneIndexSet m_highlightZoneIndexSet;
 };
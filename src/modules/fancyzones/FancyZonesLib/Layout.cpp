@@ -1,9 +1,8 @@
 #include "pch.h"
 #include "Layout.h"
 
-#include <FancyZonesLib/FancyZonesData/CustomLayouts.h>
 #include <FancyZonesLib/FancyZonesWindowProperties.h>
-#include <FancyZonesLib/LayoutConfigurator.h>
+#include <FancyZonesLib/LayoutZonesCache.h>
 #include <FancyZonesLib/Settings.h>
 #include <FancyZonesLib/WindowUtils.h>
 
@@ -127,45 +126,16 @@ bool Layout::Init(const FancyZonesUtils::Rect& workArea, HMONITOR monitor) noexc
         return false;
     }
 
-    auto spacing = m_data.showSpacing ? m_data.spacing : 0; 
-
-    switch (m_data.type)
-    {
-    case FancyZonesDataTypes::ZoneSetLayoutType::Blank:
-        m_zones = {};
-        break;
-    case FancyZonesDataTypes::ZoneSetLayoutType::Focus:
-        m_zones = LayoutConfigurator::Focus(workArea, m_data.zoneCount);
-        break;
-    case FancyZonesDataTypes::ZoneSetLayoutType::Columns:
-        m_zones = LayoutConfigurator::Columns(workArea, m_data.zoneCount, spacing);
-        break;
-    case FancyZonesDataTypes::ZoneSetLayoutType::Rows:
-        m_zones = LayoutConfigurator::Rows(workArea, m_data.zoneCount, spacing);
-        break;
-    case FancyZonesDataTypes::ZoneSetLayoutType::Grid:
-        m_zones = LayoutConfigurator::Grid(workArea, m_data.zoneCount, spacing);
-        break;
-    case FancyZonesDataTypes::ZoneSetLayoutType::PriorityGrid:
-        m_zones = LayoutConfigurator::PriorityGrid(workArea, m_data.zoneCount, spacing);
-        break;
-    case FancyZonesDataTypes::ZoneSetLayoutType::Custom:
+    auto zones = LayoutZonesCache::instance().GetZones(m_data, workArea, monitor);
+    if (!zones)
     {
-        const auto customLayoutData = CustomLayouts::instance().GetCustomLayoutData(m_data.uuid);
-        if (customLayoutData.has_value())
-        {
-            m_zones = LayoutConfigurator::Custom(workArea, monitor, customLayoutData.value(), spacing);
-        }
-        else
-        {
-            Logger::error(L"Custom layout not found");
-            return false;
-        }
-    }
-    break;
+        return false;
     }
 
-    return m_zones.size() == m_data.zoneCount;
+    m_zones = std::move(zones);
+    m_hitGrid = ZoneHitGrid(*m_zones, m_data.sensitivityRadius);
+
+    return m_zones->size() == m_data.zoneCount;
 }
 
 GUID Layout::Id() const noexcept
@@ -180,68 +150,22 @@ FancyZonesDataTypes::ZoneSetLayoutType Layout::Type() const noexcept
 
 const ZonesMap& Layout::Zones() const noexcept
 {
-    return m_zones;
+    return *m_zones;
 }
 
 ZoneIndexSet Layout::ZonesFromPoint(POINT pt) const noexcept
 {
-    ZoneIndexSet capturedZones;
-    ZoneIndexSet strictlyCapturedZones;
-    for (const auto& [zoneId, zone] : m_zones)
-    {
-        const RECT& zoneRect = zone.GetZoneRect();
-        if (zoneRect.left - m_data.sensitivityRadius <= pt.x && pt.x <= zoneRect.right + m_data.sensitivityRadius &&
-            zoneRect.top - m_data.sensitivityRadius <= pt.y && pt.y <= zoneRect.bottom + m_data.sensitivityRadius)
-        {
-            capturedZones.emplace_back(zoneId);
-        }
-
-        if (zoneRect.left <= pt.x && pt.x < zoneRect.right &&
-            zoneRect.top <= pt.y && pt.y < zoneRect.bottom)
-        {
-            strictlyCapturedZones.emplace_back(zoneId);
-        }
-    }
+    auto [capturedZones, strictlyCaptured, overlap] = m_hitGrid.ZonesFromPoint(pt);
 
     // If only one zone is captured, but it's not strictly captured
     // don't consider it as captured
-    if (capturedZones.size() == 1 && strictlyCapturedZones.size() == 0)
+    if (capturedZones.size() == 1 && !strictlyCaptured)
     {
         return {};
     }
 
     // If captured zones do not overlap, return all of them
     // Otherwise, return one of them based on the chosen selection algorithm.
-    bool overlap = false;
-    for (size_t i = 0; i < capturedZones.size(); ++i)
-    {
-        for (size_t j = i + 1; j < capturedZones.size(); ++j)
-        {
-            RECT rectI;
-            RECT rectJ;
-            try
-            {
-                rectI = m_zones.at(capturedZones[i]).GetZoneRect();
-                rectJ = m_zones.at(capturedZones[j]).GetZoneRect();
-            }
-            catch (std::out_of_range)
-            {
-                return {};
-            }
-
-            if (max(rectI.top, rectJ.top) + m_data.sensitivityRadius < min(rectI.bottom, rectJ.bottom) &&
-                max(rectI.left, rectJ.left) + m_data.sensitivityRadius < min(rectI.right, rectJ.right))
-            {
-                overlap = true;
-                break;
-            }
-        }
-        if (overlap)
-        {
-            break;
-        }
-    }
-
     if (overlap)
     {
         try
@@ -251,13 +175,13 @@ ZoneIndexSet Layout::ZonesFromPoint(POINT pt) const noexcept
             switch (FancyZonesSettings::settings().overlappingZonesAlgorithm)
             {
             case Algorithm::Smallest:
-                return ZoneSelectionAlgorithms::ZoneSelectPriority(m_zones, capturedZones, [&](auto zone1, auto zone2) { return zone1.GetZoneArea() < zone2.GetZoneArea(); });
+                return ZoneSelectionAlgorithms::ZoneSelectPriority(*m_zones, capturedZones, [&](auto zone1, auto zone2) { return zone1.GetZoneArea() < zone2.GetZoneArea(); });
             case Algorithm::Largest:
-                return ZoneSelectionAlgorithms::ZoneSelectPriority(m_zones, capturedZones, [&](auto zone1, auto zone2) { return zone1.GetZoneArea() > zone2.GetZoneArea(); });
+                return ZoneSelectionAlgorithms::ZoneSelectPriority(*m_zones, capturedZones, [&](auto zone1, auto zone2) { return zone1.GetZoneArea() > zone2.GetZoneArea(); });
             case Algorithm::Positional:
-                return ZoneSelectionAlgorithms::ZoneSelectSubregion(m_zones, capturedZones, pt, m_data.sensitivityRadius);
+                return ZoneSelectionAlgorithms::ZoneSelectSubregion(*m_zones, capturedZones, pt, m_data.sensitivityRadius);
             case Algorithm::ClosestCenter:
-                return ZoneSelectionAlgorithms::ZoneSelectClosestCenter(m_zones, capturedZones, pt);
+                return ZoneSelectionAlgorithms::ZoneSelectClosestCenter(*m_zones, capturedZones, pt);
             }
         }
         catch (std::out_of_range)
@@ -272,17 +196,21 @@ ZoneIndexSet Layout::ZonesFromPoint(POINT pt) const noexcept
 
 ZoneIndexSet Layout::GetCombinedZoneRange(const ZoneIndexSet& initialZones, const ZoneIndexSet& finalZones) const noexcept
 {
-    ZoneIndexSet combinedZones, result;
-    std::set_union(begin(initialZones), end(initialZones), begin(finalZones), end(finalZones), std::back_inserter(combinedZones));
+    return GetCombinedZoneRange(ZoneIndexBitset::FromIndexSet(initialZones), ZoneIndexBitset::FromIndexSet(finalZones)).ToIndexSet();
+}
+
+ZoneIndexBitset Layout::GetCombinedZoneRange(const ZoneIndexBitset& initialZones, const ZoneIndexBitset& finalZones) const noexcept
+{
+    ZoneIndexBitset result;
 
     RECT boundingRect{};
     bool boundingRectEmpty = true;
 
-    for (ZoneIndex zoneId : combinedZones)
-    {
-        if (m_zones.contains(zoneId))
+    (initialZones | finalZones).ForEach([&](ZoneIndex zoneId) {
+        const auto zone = m_zones->find(zoneId);
+        if (zone != m_zones->end())
         {
-            const RECT rect = m_zones.at(zoneId).GetZoneRect();
+            const RECT rect = zone->second.GetZoneRect();
             if (boundingRectEmpty)
             {
                 boundingRect = rect;
@@ -296,17 +224,17 @@ ZoneIndexSet Layout::GetCombinedZoneRange(const ZoneIndexSet& initialZones, cons
                 boundingRect.bottom = max(boundingRect.bottom, rect.bottom);
             }
         }
-    }
+    });
 
     if (!boundingRectEmpty)
     {
-        for (const auto& [zoneId, zone] : m_zones)
+        for (const auto& [zoneId, zone] : *m_zones)
         {
             const RECT rect = zone.GetZoneRect();
             if (boundingRect.left <= rect.left && rect.right <= boundingRect.right &&
                 boundingRect.top <= rect.top && rect.bottom <= boundingRect.bottom)
             {
-                result.push_back(zoneId);
+                result.Insert(zoneId);
             }
         }
     }
@@ -321,9 +249,9 @@ RECT Layout::GetCombinedZonesRect(const ZoneIndexSet& zones)
 
     for (ZoneIndex id : zones)
     {
-        if (m_zones.contains(id))
+        if (m_zones->contains(id))
         {
-            const auto& zone = m_zones.at(id);
+            const auto& zone = m_zones->at(id);
             const RECT newSize = zone.GetZoneRect();
             if (!sizeEmpty)
             {
@@ -4,6 +4,8 @@
 #include <FancyZonesLib/util.h>
 
 #include <FancyZonesLib/LayoutConfigurator.h> // ZonesMap
+#include <FancyZonesLib/ZoneHitGrid.h>
+#include <FancyZonesLib/ZoneIndexBitset.h>
 
 class Layout
 {
@@ -22,10 +24,13 @@ public:
      * Returns all zones spanned by the minimum bounding rectangle containing the two given zone index sets.
      */
     ZoneIndexSet GetCombinedZoneRange(const ZoneIndexSet& initialZones, const ZoneIndexSet& finalZones) const noexcept; 
+    ZoneIndexBitset GetCombinedZoneRange(const ZoneIndexBitset& initialZones, const ZoneIndexBitset& finalZones) const noexcept;
 
     RECT GetCombinedZonesRect(const ZoneIndexSet& zones);
 
 private:
     const LayoutData m_data;
-    ZonesMap m_zones{};
+    // Shared with the other layouts of the same geometry, see LayoutZonesCache
+    std::shared_ptr<const ZonesMap> m_zones = std::make_shared<const ZonesMap>();
+    ZoneHitGrid m_hitGrid{};
 };
@@ -0,0 +1,118 @@
+#include "pch.h"
+#include "LayoutZonesCache.h"
+
+#include <tuple>
+
+#include <common/display/dpi_aware.h>
+#include <common/logger/logger.h>
+
+#include <FancyZonesLib/FancyZonesData/CustomLayouts.h>
+#include <FancyZonesLib/GuidUtils.h>
+
+bool LayoutZonesCache::Key::operator<(const Key& other) const noexcept
+{
+    if (uuid != other.uuid)
+    {
+        return uuid < other.uuid;
+    }
+
+    return std::tie(type, zoneCount, spacing, width, height, dpi) < std::tie(other.type, other.zoneCount, other.spacing, other.width, other.height, other.dpi);
+}
+
+LayoutZonesCache& LayoutZonesCache::instance()
+{
+    static LayoutZonesCache self;
+    return self;
+}
+
+std::shared_ptr<const ZonesMap> LayoutZonesCache::GetZones(const LayoutData& data, const FancyZonesUtils::Rect& workArea, HMONITOR monitor)
+{
+    Key key{
+        .type = data.type,
+        .zoneCount = data.zoneCount,
+        .spacing = data.showSpacing ? data.spacing : 0,
+        .width = workArea.width(),
+        .height = workArea.height(),
+    };
+
+    if (data.type == FancyZonesDataTypes::ZoneSetLayoutType::Custom)
+    {
+        key.uuid = data.uuid;
+
+        // DPIAware::Convert uses the primary monitor for the work area spanning all monitors
+        const auto dpiMonitor = monitor ? monitor : MonitorFromPoint(POINT{ 0, 0 }, MONITOR_DEFAULTTOPRIMARY);
+        DPIAware::GetScreenDPIForMonitor(dpiMonitor, key.dpi);
+    }
+
+    {
+        std::unique_lock lock(m_mutex);
+        auto iter = m_zones.find(key);
+        if (iter != m_zones.end())
+        {
+            m_stats.hits++;
+            return iter->second;
+        }
+
+        m_stats.misses++;
+    }
+
+    ZonesMap zones;
+    switch (data.type)
+    {
+    case FancyZonesDataTypes::ZoneSetLayoutType::Blank:
+        break;
+    case FancyZonesDataTypes::ZoneSetLayoutType::Focus:
+        zones = LayoutConfigurator::Focus(workArea, key.zoneCount);
+        break;
+    case FancyZonesDataTypes::ZoneSetLayoutType::Columns:
+        zones = LayoutConfigurator::Columns(workArea, key.zoneCount, key.spacing);
+        break;
+    case FancyZonesDataTypes::ZoneSetLayoutType::Rows:
+        zones = LayoutConfigurator::Rows(workArea, key.zoneCount, key.spacing);
+        break;
+    case FancyZonesDataTypes::ZoneSetLayoutType::Grid:
+        zones = LayoutConfigurator::Grid(workArea, key.zoneCount, key.spacing);
+        break;
+    case FancyZonesDataTypes::ZoneSetLayoutType::PriorityGrid:
+        zones = LayoutConfigurator::PriorityGrid(workArea, key.zoneCount, key.spacing);
+        break;
+    case FancyZonesDataTypes::ZoneSetLayoutType::Custom:
+    {
+        const auto customLayoutData = CustomLayouts::instance().GetCustomLayoutData(data.uuid);
+        if (!customLayoutData.has_value())
+        {
+            Logger::error(L"Custom layout not found");
+            return nullptr;
+        }
+
+        zones = LayoutConfigurator::Custom(workArea, monitor, customLayoutData.value(), key.spacing);
+    }
+    break;
+    }
+
+    auto result = std::make_shared<const ZonesMap>(std::move(zones));
+
+    std::unique_lock lock(m_mutex);
+    if (m_zones.size() >= MaxEntries)
+    {
+        Logger::trace(L"Layout zones cache is full, clearing it");
+        m_zones.clear();
+    }
+
+    // Another thread may have added the same zones meanwhile, either of them is fine
+    m_zones.insert({ key, result });
+    return result;
+}
+
+void LayoutZonesCache::Clear() noexcept
+{
+    std::unique_lock lock(m_mutex);
+    Logger::debug(L"Clear layout zones cache, {} entries, {} hits, {} misses", m_zones.size(), m_stats.hits, m_stats.misses);
+    m_zones.clear();
+}
+
+LayoutZonesCache::Stats LayoutZonesCache::GetStats() const noexcept
+{
+    std::unique_lock lock(m_mutex);
+    return m_stats;
+}
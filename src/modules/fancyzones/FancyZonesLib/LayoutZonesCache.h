@@ -0,0 +1,57 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+
+#include <FancyZonesLib/FancyZonesData/LayoutData.h>
+#include <FancyZonesLib/LayoutConfigurator.h> // ZonesMap
+
+// Zones calculated by the LayoutConfigurator, shared by the layouts with the same geometry, e.g. the same layout
+// on monitors of the same size, or a layout applied again with the quick layout hotkeys.
+// The zones are relative to the work area, so they depend on its size only.
+class LayoutZonesCache
+{
+public:
+    struct Stats
+    {
+        size_t hits = 0;
+        size_t misses = 0;
+    };
+
+    static LayoutZonesCache& instance();
+
+    // Returns the zones of the layout on the work area, or nullptr if the custom layout isn't found.
+    // The returned zones never change, the cache calculates new ones for new parameters.
+    std::shared_ptr<const ZonesMap> GetZones(const LayoutData& data, const FancyZonesUtils::Rect& workArea, HMONITOR monitor);
+
+    // Drops the cached zones, called when the custom layouts or the layout templates are reloaded
+    void Clear() noexcept;
+
+    Stats GetStats() const noexcept;
+
+private:
+    // Cleared when full, the entries are recalculated on demand
+    static constexpr size_t MaxEntries = 256;
+
+    struct Key
+    {
+        // Set for custom layouts only, the other layouts depend on their type and parameters
+        GUID uuid = GUID_NULL;
+        FancyZonesDataTypes::ZoneSetLayoutType type{};
+        int zoneCount = 0;
+        int spacing = 0;
+        long width = 0;
+        long height = 0;
+        // Set for custom layouts only, canvas zones are scaled by the monitor DPI
+        UINT dpi = 0;
+
+        bool operator<(const Key& other) const noexcept;
+    };
+
+    LayoutZonesCache() = default;
+
+    mutable std::mutex m_mutex;
+    std::map<Key, std::shared_ptr<const ZonesMap>> m_zones;
+    Stats m_stats{};
+};
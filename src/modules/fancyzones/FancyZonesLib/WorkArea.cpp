@@ -249,7 +249,7 @@ void WorkArea::InitLayout(const FancyZonesDataTypes::WorkAreaId& parentUniqueId)
             AppliedLayouts::instance().ApplyDefaultLayout(m_uniqueId);
         }
 
-        AppliedLayouts::instance().SaveData();
+        AppliedLayouts::instance().ScheduleSave();
     }
 
     CalculateZoneSet();
@@ -61,6 +61,11 @@ void WorkAreaConfiguration::AddWorkArea(HMONITOR monitor, std::unique_ptr<WorkAr
     m_workAreaMap.insert({ monitor, std::move(workArea) });
 }
 
+void WorkAreaConfiguration::RemoveWorkArea(HMONITOR monitor) noexcept
+{
+    m_workAreaMap.erase(monitor);
+}
+
 void WorkAreaConfiguration::Clear() noexcept
 {
     m_workAreaMap.clear();
@@ -48,6 +48,13 @@ public:
      */
     void AddWorkArea(HMONITOR monitor, std::unique_ptr<WorkArea> workArea);
 
+    /**
+     * Unregister work area.
+     *
+     * @param[in]  monitor   Monitor handle.
+     */
+    void RemoveWorkArea(HMONITOR monitor) noexcept;
+
     /**
      * Clear all persisted work area related data.
      */
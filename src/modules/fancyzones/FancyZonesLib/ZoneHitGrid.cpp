@@ -0,0 +1,147 @@
+#include "pch.h"
+#include "ZoneHitGrid.h"
+
+#include <cmath>
+#include <numeric>
+
+namespace
+{
+    // Cells per side for each square root of the zone count
+    constexpr double CELLS_PER_ZONE_SQRT = 2.0;
+    constexpr size_t MAX_CELLS_PER_SIDE = 64;
+
+    bool Overlap(const RECT& rectI, const RECT& rectJ, int sensitivityRadius) noexcept
+    {
+        return max(rectI.top, rectJ.top) + sensitivityRadius < min(rectI.bottom, rectJ.bottom) &&
+               max(rectI.left, rectJ.left) + sensitivityRadius < min(rectI.right, rectJ.right);
+    }
+}
+
+ZoneHitGrid::ZoneHitGrid(const ZonesMap& zones, int sensitivityRadius) :
+    m_sensitivityRadius(sensitivityRadius)
+{
+    if (zones.empty())
+    {
+        return;
+    }
+
+    for (const auto& [zoneId, zone] : zones)
+    {
+        m_ids.push_back(zoneId);
+        m_rects.push_back(zone.GetZoneRect());
+    }
+
+    const size_t count = m_ids.size();
+    m_overlaps.resize(count * count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        for (size_t j = i + 1; j < count; ++j)
+        {
+            const bool overlap = Overlap(m_rects[i], m_rects[j], sensitivityRadius);
+            m_overlaps[i * count + j] = overlap;
+            m_overlaps[j * count + i] = overlap;
+        }
+    }
+
+    // Strictly captured points are in the zone rect, so a negative radius doesn't shrink the cells' zones
+    const LONG extent = max(sensitivityRadius, 0);
+    m_bounds = { LONG_MAX, LONG_MAX, LONG_MIN, LONG_MIN };
+    for (const auto& rect : m_rects)
+    {
+        m_bounds.left = min(m_bounds.left, rect.left - extent);
+        m_bounds.top = min(m_bounds.top, rect.top - extent);
+        m_bounds.right = max(m_bounds.right, rect.right + extent);
+        m_bounds.bottom = max(m_bounds.bottom, rect.bottom + extent);
+    }
+
+    const size_t cellsPerSide = std::clamp(static_cast<size_t>(std::ceil(CELLS_PER_ZONE_SQRT * std::sqrt(count))), size_t{ 1 }, MAX_CELLS_PER_SIDE);
+    m_columns = static_cast<size_t>(min(static_cast<int64_t>(cellsPerSide), static_cast<int64_t>(m_bounds.right) - m_bounds.left + 1));
+    m_rows = static_cast<size_t>(min(static_cast<int64_t>(cellsPerSide), static_cast<int64_t>(m_bounds.bottom) - m_bounds.top + 1));
+
+    // Count the zones of each cell, then fill them in id order
+    std::vector<uint32_t> cellCounts(m_columns * m_rows + 1, 0);
+    const auto forEachCell = [&](const RECT& rect, auto callback) {
+        const size_t lastColumn = CellColumn(rect.right + extent);
+        const size_t lastRow = CellRow(rect.bottom + extent);
+        for (size_t row = CellRow(rect.top - extent); row <= lastRow; ++row)
+        {
+            for (size_t column = CellColumn(rect.left - extent); column <= lastColumn; ++column)
+            {
+                callback(row * m_columns + column);
+            }
+        }
+    };
+
+    for (const auto& rect : m_rects)
+    {
+        forEachCell(rect, [&](size_t cell) { ++cellCounts[cell + 1]; });
+    }
+
+    m_cellStart.resize(cellCounts.size());
+    std::partial_sum(cellCounts.begin(), cellCounts.end(), m_cellStart.begin());
+    m_cellZones.resize(m_cellStart.back());
+
+    std::vector<uint32_t> cellFill(m_cellStart.begin(), m_cellStart.end() - 1);
+    for (uint32_t position = 0; position < count; ++position)
+    {
+        forEachCell(m_rects[position], [&](size_t cell) { m_cellZones[cellFill[cell]++] = position; });
+    }
+}
+
+ZoneHitGrid::Hit ZoneHitGrid::ZonesFromPoint(POINT pt) const
+{
+    Hit hit{};
+    if (m_ids.empty() ||
+        pt.x < m_bounds.left || pt.x > m_bounds.right ||
+        pt.y < m_bounds.top || pt.y > m_bounds.bottom)
+    {
+        return hit;
+    }
+
+    const size_t cell = CellRow(pt.y) * m_columns + CellColumn(pt.x);
+    std::vector<uint32_t> capturedPositions{};
+    for (uint32_t i = m_cellStart[cell]; i < m_cellStart[cell + 1]; ++i)
+    {
+        const uint32_t position = m_cellZones[i];
+        const RECT& zoneRect = m_rects[position];
+        if (zoneRect.left - m_sensitivityRadius <= pt.x && pt.x <= zoneRect.right + m_sensitivityRadius &&
+            zoneRect.top - m_sensitivityRadius <= pt.y && pt.y <= zoneRect.bottom + m_sensitivityRadius)
+        {
+            capturedPositions.push_back(position);
+            hit.capturedZones.push_back(m_ids[position]);
+        }
+
+        if (zoneRect.left <= pt.x && pt.x < zoneRect.right &&
+            zoneRect.top <= pt.y && pt.y < zoneRect.bottom)
+        {
+            hit.strictlyCaptured = true;
+        }
+    }
+
+    const size_t count = m_ids.size();
+    for (size_t i = 0; i < capturedPositions.size() && !hit.overlap; ++i)
+    {
+        for (size_t j = i + 1; j < capturedPositions.size(); ++j)
+        {
+            if (m_overlaps[capturedPositions[i] * count + capturedPositions[j]])
+            {
+                hit.overlap = true;
+                break;
+            }
+        }
+    }
+
+    return hit;
+}
+
+size_t ZoneHitGrid::CellColumn(LONG x) const noexcept
+{
+    const int64_t width = static_cast<int64_t>(m_bounds.right) - m_bounds.left + 1;
+    return static_cast<size_t>((static_cast<int64_t>(x) - m_bounds.left) * static_cast<int64_t>(m_columns) / width);
+}
+
+size_t ZoneHitGrid::CellRow(LONG y) const noexcept
+{
+    const int64_t height = static_cast<int64_t>(m_bounds.bottom) - m_bounds.top + 1;
+    return static_cast<size_t>((static_cast<int64_t>(y) - m_bounds.top) * static_cast<int64_t>(m_rows) / height);
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <FancyZonesLib/LayoutConfigurator.h> // ZonesMap
+
+/**
+ * Uniform grid over the zones of a layout, built once so that hit testing only looks at the zones near the point.
+ * Also caches which pairs of zones overlap by more than the sensitivity radius.
+ */
+class ZoneHitGrid
+{
+public:
+    struct Hit
+    {
+        // Zones whose rect extended by the sensitivity radius contains the point, in id order
+        ZoneIndexSet capturedZones{};
+        // Whether the point is inside any zone rect
+        bool strictlyCaptured = false;
+        // Whether two of the captured zones overlap
+        bool overlap = false;
+    };
+
+    ZoneHitGrid() = default;
+    ZoneHitGrid(const ZonesMap& zones, int sensitivityRadius);
+
+    Hit ZonesFromPoint(POINT pt) const;
+
+private:
+    size_t CellColumn(LONG x) const noexcept;
+    size_t CellRow(LONG y) const noexcept;
+
+    int m_sensitivityRadius = 0;
+
+    // Zones by position in id order
+    std::vector<ZoneIndex> m_ids{};
+    std::vector<RECT> m_rects{};
+    // m_overlaps[i * zone count + j] for the zones at positions i and j
+    std::vector<bool> m_overlaps{};
+
+    // Bounds of all the extended zone rects, right and bottom included
+    RECT m_bounds{};
+    size_t m_columns = 0;
+    size_t m_rows = 0;
+    // Positions of the zones touching each cell, row by row, as ranges of m_cellZones
+    std::vector<uint32_t> m_cellStart{};
+    std::vector<uint32_t> m_cellZones{};
+};
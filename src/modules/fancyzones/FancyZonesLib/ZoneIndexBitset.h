@@ -0,0 +1,172 @@
+#pragma once
+
+#include <FancyZonesLib/Zone.h>
+
+#include <array>
+#include <bit>
+
+/**
+ * Set of zone indexes below Capacity, the maximum zone count of a layout, stored as bits.
+ * Iteration and conversion to ZoneIndexSet follow increasing zone indexes, and indexes out of range are ignored.
+ */
+class ZoneIndexBitset
+{
+public:
+    static constexpr ZoneIndex Capacity = 128;
+    static constexpr size_t WordCount = Capacity / 64;
+
+    constexpr ZoneIndexBitset() noexcept = default;
+
+    static ZoneIndexBitset FromIndexSet(const ZoneIndexSet& set) noexcept
+    {
+        ZoneIndexBitset bitset{};
+        for (const ZoneIndex zoneIndex : set)
+        {
+            bitset.Insert(zoneIndex);
+        }
+        return bitset;
+    }
+
+    static constexpr ZoneIndexBitset FromWords(const std::array<uint64_t, WordCount>& words) noexcept
+    {
+        ZoneIndexBitset bitset{};
+        bitset.m_words = words;
+        return bitset;
+    }
+
+    ZoneIndexSet ToIndexSet() const
+    {
+        ZoneIndexSet set;
+        set.reserve(Size());
+        ForEach([&set](ZoneIndex zoneIndex) { set.push_back(zoneIndex); });
+        return set;
+    }
+
+    constexpr const std::array<uint64_t, WordCount>& Words() const noexcept
+    {
+        return m_words;
+    }
+
+    constexpr bool Insert(ZoneIndex zoneIndex) noexcept
+    {
+        if (!InRange(zoneIndex))
+        {
+            return false;
+        }
+
+        m_words[Word(zoneIndex)] |= Bit(zoneIndex);
+        return true;
+    }
+
+    constexpr void Erase(ZoneIndex zoneIndex) noexcept
+    {
+        if (InRange(zoneIndex))
+        {
+            m_words[Word(zoneIndex)] &= ~Bit(zoneIndex);
+        }
+    }
+
+    constexpr bool Contains(ZoneIndex zoneIndex) const noexcept
+    {
+        return InRange(zoneIndex) && (m_words[Word(zoneIndex)] & Bit(zoneIndex)) != 0;
+    }
+
+    constexpr bool Empty() const noexcept
+    {
+        for (const uint64_t word : m_words)
+        {
+            if (word != 0)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    constexpr size_t Size() const noexcept
+    {
+        size_t size = 0;
+        for (const uint64_t word : m_words)
+        {
+            size += std::popcount(word);
+        }
+        return size;
+    }
+
+    // Calls callback(zoneIndex) for each zone index in increasing order
+    template<typename Callback>
+    constexpr void ForEach(Callback&& callback) const
+    {
+        for (size_t i = 0; i < WordCount; ++i)
+        {
+            for (uint64_t word = m_words[i]; word != 0; word &= word - 1)
+            {
+                callback(static_cast<ZoneIndex>(i * 64 + std::countr_zero(word)));
+            }
+        }
+    }
+
+    constexpr ZoneIndexBitset& operator|=(const ZoneIndexBitset& other) noexcept
+    {
+        for (size_t i = 0; i < WordCount; ++i)
+        {
+            m_words[i] |= other.m_words[i];
+        }
+        return *this;
+    }
+
+    constexpr ZoneIndexBitset& operator&=(const ZoneIndexBitset& other) noexcept
+    {
+        for (size_t i = 0; i < WordCount; ++i)
+        {
+            m_words[i] &= other.m_words[i];
+        }
+        return *this;
+    }
+
+    // Set difference
+    constexpr ZoneIndexBitset& operator-=(const ZoneIndexBitset& other) noexcept
+    {
+        for (size_t i = 0; i < WordCount; ++i)
+        {
+            m_words[i] &= ~other.m_words[i];
+        }
+        return *this;
+    }
+
+    friend constexpr ZoneIndexBitset operator|(ZoneIndexBitset lhs, const ZoneIndexBitset& rhs) noexcept
+    {
+        return lhs |= rhs;
+    }
+
+    friend constexpr ZoneIndexBitset operator&(ZoneIndexBitset lhs, const ZoneIndexBitset& rhs) noexcept
+    {
+        return lhs &= rhs;
+    }
+
+    friend constexpr ZoneIndexBitset operator-(ZoneIndexBitset lhs, const ZoneIndexBitset& rhs) noexcept
+    {
+        return lhs -= rhs;
+    }
+
+    friend constexpr bool operator==(const ZoneIndexBitset& lhs, const ZoneIndexBitset& rhs) noexcept = default;
+
+private:
+    // Negative indexes wrap around to large unsigned values
+    static constexpr bool InRange(ZoneIndex zoneIndex) noexcept
+    {
+        return static_cast<uint64_t>(zoneIndex) < static_cast<uint64_t>(Capacity);
+    }
+
+    static constexpr size_t Word(ZoneIndex zoneIndex) noexcept
+    {
+        return static_cast<size_t>(static_cast<uint64_t>(zoneIndex) >> 6);
+    }
+
+    static constexpr uint64_t Bit(ZoneIndex zoneIndex) noexcept
+    {
+        return 1ull << (static_cast<uint64_t>(zoneIndex) & 63);
+    }
+
+    std::array<uint64_t, WordCount> m_words{};
+};
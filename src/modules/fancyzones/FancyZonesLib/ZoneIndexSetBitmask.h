@@ -1,6 +1,6 @@
 #pragma once
 
-#include <FancyZonesLib/Zone.h>
+#include <FancyZonesLib/ZoneIndexBitset.h>
 
 struct ZoneIndexSetBitmask
 {
@@ -9,50 +9,12 @@ struct ZoneIndexSetBitmask
 
     static ZoneIndexSetBitmask FromIndexSet(const ZoneIndexSet& set)
     {
-        ZoneIndexSetBitmask bitmask{};
-
-        for (const auto zoneIndex : set)
-        {
-            if (zoneIndex <= std::numeric_limits<ZoneIndex>::digits)
-            {
-                bitmask.part1 |= 1ull << zoneIndex;
-            }
-            else
-            {
-                ZoneIndex index = zoneIndex - std::numeric_limits<ZoneIndex>::digits - 1;
-                bitmask.part2 |= 1ull << index;
-            }
-        }
-
-        return bitmask;
+        const auto words = ZoneIndexBitset::FromIndexSet(set).Words();
+        return { .part1 = words[0], .part2 = words[1] };
     }
 
     ZoneIndexSet ToIndexSet() const noexcept
     {
-        ZoneIndexSet zoneIndexSet;
-
-        if (part1 != 0)
-        {
-            for (ZoneIndex i = 0; i <= std::numeric_limits<ZoneIndex>::digits; i++)
-            {
-                if ((1ull << i) & part1)
-                {
-                    zoneIndexSet.push_back(i);
-                }
-            }
-        }
-
-        if (part2 != 0)
-        {
-            for (ZoneIndex i = 0; i <= std::numeric_limits<ZoneIndex>::digits; i++)
-            {
-                if ((1ull << i) & part2)
-                {
-                    zoneIndexSet.push_back(i + std::numeric_limits<ZoneIndex>::digits + 1);
-                }
-            }
-        }
-
-        return zoneIndexSet;
+        return ZoneIndexBitset::FromWords({ part1, part2 }).ToIndexSet();
     }
-};
\ No newline at end of file
+};
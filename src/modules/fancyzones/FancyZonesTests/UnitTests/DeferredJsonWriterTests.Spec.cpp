@@ -0,0 +1,225 @@
+#include "pch.h"
+#include <chrono>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <future>
+#include <stdexcept>
+
+#include <FancyZonesLib/FancyZonesData/DeferredJsonWriter.h>
+#include <FancyZonesLib/ModuleConstants.h>
+
+#include <common/SettingsAPI/settings_helpers.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace FancyZonesUnitTests
+{
+    TEST_CLASS (DeferredJsonWriterUnitTests)
+    {
+        std::wstring m_fileName = PTSettingsHelper::get_module_save_folder_location(NonLocalizable::ModuleKey) + L"\\test-deferred-writer.json";
+
+        static DeferredJsonWriter::Serializer Counter(int value)
+        {
+            return [value] {
+                json::JsonObject root{};
+                root.SetNamedValue(L"counter", json::value(value));
+                return root;
+            };
+        }
+
+        int ReadCounter() const
+        {
+            auto data = json::from_file(m_fileName);
+            Assert::IsTrue(data.has_value());
+            return static_cast<int>(data->GetNamedNumber(L"counter"));
+        }
+
+        TEST_METHOD_CLEANUP(CleanUp)
+        {
+            std::filesystem::remove(m_fileName);
+        }
+
+        TEST_METHOD (CoalescesChanges)
+        {
+            DeferredJsonWriter writer(m_fileName, std::chrono::milliseconds(10000));
+            for (int i = 1; i <= 100; ++i)
+            {
+                writer.Schedule(Counter(i));
+            }
+            Assert::IsFalse(std::filesystem::exists(m_fileName));
+
+            writer.Flush();
+            Assert::AreEqual(100, ReadCounter());
+
+            const auto stats = writer.GetStats();
+            Assert::AreEqual(size_t{ 100 }, stats.scheduled);
+            Assert::AreEqual(size_t{ 1 }, stats.written);
+            Assert::AreEqual(static_cast<size_t>(std::filesystem::file_size(m_fileName)), stats.bytesWritten);
+            Assert::IsFalse(std::filesystem::exists(m_fileName + L".tmp"));
+        }
+
+        TEST_METHOD (WritesAfterDelay)
+        {
+            DeferredJsonWriter writer(m_fileName, std::chrono::milliseconds(10));
+            writer.Schedule(Counter(1));
+
+            for (int i = 0; i < 500 && writer.GetStats().written == 0; ++i)
+            {
+                Sleep(10);
+            }
+            Assert::AreEqual(1, ReadCounter());
+        }
+
+        TEST_METHOD (WritesAgainAfterWrite)
+        {
+            DeferredJsonWriter writer(m_fileName, std::chrono::milliseconds(10000));
+            writer.Schedule(Counter(1));
+            writer.Flush();
+            writer.Schedule(Counter(2));
+            writer.Flush();
+
+            Assert::AreEqual(2, ReadCounter());
+            Assert::AreEqual(size_t{ 2 }, writer.GetStats().written);
+        }
+
+        TEST_METHOD (CancelDropsPendingChanges)
+        {
+            DeferredJsonWriter writer(m_fileName, std::chrono::milliseconds(10000));
+            writer.Schedule(Counter(1));
+            writer.Cancel();
+            writer.Flush();
+
+            Assert::IsFalse(std::filesystem::exists(m_fileName));
+            Assert::AreEqual(size_t{ 0 }, writer.GetStats().written);
+        }
+
+        TEST_METHOD (CancelDropsWriteInProgress)
+        {
+            std::promise<void> serializing;
+            std::promise<void> cancelled;
+            std::shared_future<void> cancelledFuture = cancelled.get_future().share();
+
+            {
+                DeferredJsonWriter writer(m_fileName, std::chrono::milliseconds(0));
+                writer.Schedule([&serializing, cancelledFuture] {
+                    serializing.set_value();
+                    cancelledFuture.wait();
+                    return Counter(1)();
+                });
+
+                serializing.get_future().wait();
+                writer.Cancel();
+                cancelled.set_value();
+            }
+
+            Assert::IsFalse(std::filesystem::exists(m_fileName));
+            Assert::IsFalse(std::filesystem::exists(m_fileName + L".tmp"));
+        }
+
+        TEST_METHOD (SerializerExceptionIsNotFatal)
+        {
+            DeferredJsonWriter writer(m_fileName, std::chrono::milliseconds(10000));
+            writer.Schedule([]() -> json::JsonObject { throw std::runtime_error("serializer"); });
+            writer.Flush();
+            Assert::IsFalse(std::filesystem::exists(m_fileName));
+
+            writer.Schedule(Counter(2));
+            writer.Flush();
+            Assert::AreEqual(2, ReadCounter());
+            Assert::AreEqual(size_t{ 1 }, writer.GetStats().written);
+        }
+
+        TEST_METHOD (RecognizesOwnWrite)
+        {
+            DeferredJsonWriter writer(m_fileName, std::chrono::milliseconds(10000));
+            Assert::IsFalse(writer.IsFileLastWritten());
+
+            writer.Schedule(Counter(1));
+            writer.Flush();
+            Assert::IsTrue(writer.IsFileLastWritten());
+
+            // Changes scheduled after the write don't make it foreign
+            writer.Schedule(Counter(2));
+            Assert::IsTrue(writer.IsFileLastWritten());
+        }
+
+        TEST_METHOD (RecognizesExternalWrite)
+        {
+            DeferredJsonWriter writer(m_fileName, std::chrono::milliseconds(10000));
+            writer.Schedule(Counter(1));
+            writer.Flush();
+
+            {
+                std::ofstream file(m_fileName, std::ios::binary | std::ios::trunc);
+                file << "{\"counter\":5}";
+            }
+
+            Assert::IsFalse(writer.IsFileLastWritten());
+        }
+
+        // Measures what a burst of snaps costs with the deferred writer compared to writing the file on each snap:
+        // the time spent on the calling (UI) thread per snap and the bytes written for the burst.
+        TEST_METHOD (SnapBurstBenchmark)
+        {
+            constexpr int snaps = 200;
+
+            // Roughly the size of an app-zone-history file with a few dozen apps
+            json::JsonArray history{};
+            for (int i = 0; i < 50; ++i)
+            {
+                json::JsonObject app{};
+                app.SetNamedValue(L"app-path", json::value(std::format(L"C:\\Program Files\\App{}\\app{}.exe", i, i)));
+                app.SetNamedValue(L"zone-index-set", json::value(std::format(L"[{}]", i % 4)));
+                app.SetNamedValue(L"device-id", json::value(L"{E0A0C5B9-0F1D-4D2B-9C0C-2B1A5F0E7D31}_3840_2160"));
+                history.Append(app);
+            }
+            auto snapshot = [history](int counter) {
+                return [history, counter] {
+                    json::JsonObject root{};
+                    root.SetNamedValue(L"counter", json::value(counter));
+                    root.SetNamedValue(L"app-zone-history", history);
+                    return root;
+                };
+            };
+
+            using Clock = std::chrono::steady_clock;
+
+            auto start = Clock::now();
+            size_t syncBytes = 0;
+            for (int i = 1; i <= snaps; ++i)
+            {
+                json::to_file(m_fileName, snapshot(i)());
+                syncBytes += static_cast<size_t>(std::filesystem::file_size(m_fileName));
+            }
+            const auto syncTime = std::chrono::duration<double, std::micro>(Clock::now() - start) / snaps;
+
+            DeferredJsonWriter writer(m_fileName, std::chrono::milliseconds(10000));
+            start = Clock::now();
+            for (int i = 1; i <= snaps; ++i)
+            {
+                writer.Schedule(snapshot(i));
+            }
+            const auto deferredTime = std::chrono::duration<double, std::micro>(Clock::now() - start) / snaps;
+            writer.Flush();
+
+            const auto stats = writer.GetStats();
+            Logger::WriteMessage(std::format(L"{} snaps, per snap: {:.1f} us written on each snap, {:.1f} us deferred\n", snaps, syncTime.count(), deferredTime.count()).c_str());
+            Logger::WriteMessage(std::format(L"Bytes written: {} written on each snap, {} deferred\n", syncBytes, stats.bytesWritten).c_str());
+
+            Assert::AreEqual(snaps, ReadCounter());
+            Assert::AreEqual(size_t{ 1 }, stats.written);
+            Assert::IsTrue(stats.bytesWritten * (snaps / 2) < syncBytes);
+        }
+
+        TEST_METHOD (DestructorWritesPendingChanges)
+        {
+            {
+                DeferredJsonWriter writer(m_fileName, std::chrono::milliseconds(10000));
+                writer.Schedule(Counter(3));
+            }
+
+            Assert::AreEqual(3, ReadCounter());
+        }
+    };
+}
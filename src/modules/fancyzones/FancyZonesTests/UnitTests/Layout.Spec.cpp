@@ -6,6 +6,7 @@
 #include <FancyZonesLib/FancyZonesData/CustomLayouts.h>
 #include <FancyZonesLib/ZoneIndexSetBitmask.h>
 #include <FancyZonesLib/Layout.h>
+#include <FancyZonesLib/LayoutZonesCache.h>
 #include <FancyZonesLib/Settings.h>
 
 #include "Util.h"
@@ -183,6 +184,100 @@ namespace FancyZonesUnitTests
             Zone zone3({ 0, 100, 100, 200 }, 2);
             compareZones(zone3, layout->Zones().at(actual[1]));
         }
+
+        TEST_METHOD (CombinedZoneRange)
+        {
+            saveCustomLayout({ RECT{ 0, 0, 100, 100 }, RECT{ 100, 0, 200, 100 }, RECT{ 0, 100, 100, 200 }, RECT{ 100, 100, 200, 200 } });
+
+            LayoutData data = m_data;
+            data.type = FancyZonesDataTypes::ZoneSetLayoutType::Custom;
+            data.zoneCount = 4;
+
+            auto layout = std::make_unique<Layout>(data);
+            layout->Init(RECT{ 0, 0, 1920, 1080 }, Mocks::Monitor());
+
+            Assert::IsTrue(ZoneIndexSet{ 0, 1 } == layout->GetCombinedZoneRange(ZoneIndexSet{ 0 }, ZoneIndexSet{ 1 }));
+            Assert::IsTrue(ZoneIndexSet{ 0, 1, 2, 3 } == layout->GetCombinedZoneRange(ZoneIndexSet{ 3 }, ZoneIndexSet{ 0 }));
+            Assert::IsTrue(ZoneIndexSet{ 1, 3 } == layout->GetCombinedZoneRange(ZoneIndexBitset::FromIndexSet({ 1 }), ZoneIndexBitset::FromIndexSet({ 3, 42 })).ToIndexSet());
+            Assert::IsTrue(layout->GetCombinedZoneRange(ZoneIndexSet{}, ZoneIndexSet{ 42 }).empty());
+        }
+
+        TEST_METHOD (ZoneFromPointMatchesAllZonesScan)
+        {
+            // prepare layout with many overlapping zones
+            std::vector<RECT> zoneRects;
+            for (LONG i = 0; i < 40; i++)
+            {
+                const LONG left = (i * 137) % 1700;
+                const LONG top = (i * 89) % 900;
+                zoneRects.push_back(RECT{ left, top, left + 120 + (i * 53) % 300, top + 90 + (i * 31) % 200 });
+            }
+            saveCustomLayout(zoneRects);
+
+            LayoutData data = m_data;
+            data.type = FancyZonesDataTypes::ZoneSetLayoutType::Custom;
+            data.zoneCount = static_cast<int>(zoneRects.size());
+
+            auto settings = FancyZonesSettings::settings();
+            settings.overlappingZonesAlgorithm = OverlappingZonesAlgorithm::Smallest;
+            FancyZonesSettings::instance().SetSettings(settings);
+
+            auto layout = std::make_unique<Layout>(data);
+            Assert::IsTrue(layout->Init(RECT{ 0, 0, 1920, 1080 }, Mocks::Monitor()));
+
+            // expected result computed from every zone of the layout
+            const auto expectedZones = [&](POINT pt) {
+                const int radius = data.sensitivityRadius;
+                ZoneIndexSet captured;
+                bool strictlyCaptured = false;
+                for (const auto& [zoneId, zone] : layout->Zones())
+                {
+                    const RECT rect = zone.GetZoneRect();
+                    if (rect.left - radius <= pt.x && pt.x <= rect.right + radius && rect.top - radius <= pt.y && pt.y <= rect.bottom + radius)
+                    {
+                        captured.push_back(zoneId);
+                    }
+                    strictlyCaptured |= rect.left <= pt.x && pt.x < rect.right && rect.top <= pt.y && pt.y < rect.bottom;
+                }
+
+                if (captured.size() == 1 && !strictlyCaptured)
+                {
+                    return ZoneIndexSet{};
+                }
+
+                for (size_t i = 0; i < captured.size(); ++i)
+                {
+                    for (size_t j = i + 1; j < captured.size(); ++j)
+                    {
+                        const RECT rectI = layout->Zones().at(captured[i]).GetZoneRect();
+                        const RECT rectJ = layout->Zones().at(captured[j]).GetZoneRect();
+                        if (max(rectI.top, rectJ.top) + radius < min(rectI.bottom, rectJ.bottom) &&
+                            max(rectI.left, rectJ.left) + radius < min(rectI.right, rectJ.right))
+                        {
+                            ZoneIndex smallest = captured[0];
+                            for (ZoneIndex id : captured)
+                            {
+                                if (layout->Zones().at(id).GetZoneArea() < layout->Zones().at(smallest).GetZoneArea())
+                                {
+                                    smallest = id;
+                                }
+                            }
+                            return ZoneIndexSet{ smallest };
+                        }
+                    }
+                }
+
+                return captured;
+            };
+
+            for (LONG y = -50; y < 1130; y += 7)
+            {
+                for (LONG x = -50; x < 1970; x += 11)
+                {
+                    Assert::IsTrue(expectedZones(POINT{ x, y }) == layout->ZonesFromPoint(POINT{ x, y }));
+                }
+            }
+        }
     };
 
     TEST_CLASS (LayoutInitUnitTests)
@@ -443,6 +538,85 @@ namespace FancyZonesUnitTests
         }
     };
 
+    TEST_CLASS (LayoutZonesCacheUnitTests)
+    {
+        const LayoutData m_data{
+            .uuid = FancyZonesUtils::GuidFromString(L"{2D8AB5B4-6E64-4C2F-9A5B-3B63B8F0C1E7}").value(),
+            .type = ZoneSetLayoutType::Grid,
+            .showSpacing = true,
+            .spacing = 16,
+            .zoneCount = 5,
+            .sensitivityRadius = 20
+        };
+
+        TEST_METHOD_INITIALIZE(Init)
+        {
+            LayoutZonesCache::instance().Clear();
+        }
+
+    public:
+        TEST_METHOD (SameGeometry)
+        {
+            const auto before = LayoutZonesCache::instance().GetStats();
+
+            const auto expected = LayoutZonesCache::instance().GetZones(m_data, RECT{ 0, 0, 1920, 1080 }, Mocks::Monitor());
+            const auto actual = LayoutZonesCache::instance().GetZones(m_data, RECT{ 0, 0, 1920, 1080 }, Mocks::Monitor());
+
+            const auto after = LayoutZonesCache::instance().GetStats();
+            Assert::IsTrue(expected == actual);
+            Assert::AreEqual(before.misses + 1, after.misses);
+            Assert::AreEqual(before.hits + 1, after.hits);
+        }
+
+        TEST_METHOD (SameSizeOnOtherMonitor)
+        {
+            const auto expected = LayoutZonesCache::instance().GetZones(m_data, RECT{ 0, 0, 1920, 1080 }, Mocks::Monitor());
+            const auto actual = LayoutZonesCache::instance().GetZones(m_data, RECT{ 1920, 0, 3840, 1080 }, Mocks::Monitor());
+
+            Assert::IsTrue(expected == actual);
+        }
+
+        TEST_METHOD (OtherSize)
+        {
+            const auto zones = LayoutZonesCache::instance().GetZones(m_data, RECT{ 0, 0, 1920, 1080 }, Mocks::Monitor());
+            const auto otherZones = LayoutZonesCache::instance().GetZones(m_data, RECT{ 0, 0, 2560, 1440 }, Mocks::Monitor());
+
+            Assert::IsTrue(zones != otherZones);
+            Assert::AreEqual(1920L, zones->rbegin()->second.GetZoneRect().right + m_data.spacing);
+            Assert::AreEqual(2560L, otherZones->rbegin()->second.GetZoneRect().right + m_data.spacing);
+        }
+
+        TEST_METHOD (OtherParameters)
+        {
+            LayoutData data = m_data;
+            data.zoneCount = 6;
+
+            const auto zones = LayoutZonesCache::instance().GetZones(m_data, RECT{ 0, 0, 1920, 1080 }, Mocks::Monitor());
+            const auto otherZones = LayoutZonesCache::instance().GetZones(data, RECT{ 0, 0, 1920, 1080 }, Mocks::Monitor());
+
+            Assert::IsTrue(zones != otherZones);
+            Assert::AreEqual(static_cast<size_t>(5), zones->size());
+            Assert::AreEqual(static_cast<size_t>(6), otherZones->size());
+        }
+
+        TEST_METHOD (ClearedOnCustomLayoutsLoad)
+        {
+            const auto zones = LayoutZonesCache::instance().GetZones(m_data, RECT{ 0, 0, 1920, 1080 }, Mocks::Monitor());
+            CustomLayouts::instance().LoadData();
+            const auto actual = LayoutZonesCache::instance().GetZones(m_data, RECT{ 0, 0, 1920, 1080 }, Mocks::Monitor());
+
+            Assert::IsTrue(zones != actual);
+        }
+
+        TEST_METHOD (CustomLayoutNotFound)
+        {
+            LayoutData data = m_data;
+            data.type = ZoneSetLayoutType::Custom;
+
+            Assert::IsTrue(LayoutZonesCache::instance().GetZones(data, RECT{ 0, 0, 1920, 1080 }, Mocks::Monitor()) == nullptr);
+        }
+    };
+
     TEST_CLASS (ZoneIndexSetUnitTests)
     {
         TEST_METHOD (BitmaskFromIndexSetTest)
@@ -507,5 +681,35 @@ namespace FancyZonesUnitTests
                 Assert::AreEqual(set[i], actual[i]);
             }
         }
+
+        TEST_METHOD (BitsetToIndexSetIsSorted)
+        {
+            ZoneIndexBitset bitset = ZoneIndexBitset::FromIndexSet({ 127, 3, 64, 0, 63, 3 });
+
+            Assert::AreEqual(static_cast<size_t>(5), bitset.Size());
+            Assert::IsTrue(ZoneIndexSet{ 0, 3, 63, 64, 127 } == bitset.ToIndexSet());
+        }
+
+        TEST_METHOD (BitsetIgnoresOutOfRangeIndexes)
+        {
+            ZoneIndexBitset bitset{};
+
+            Assert::IsFalse(bitset.Insert(-1));
+            Assert::IsFalse(bitset.Insert(ZoneIndexBitset::Capacity));
+            Assert::IsFalse(bitset.Contains(ZoneIndexBitset::Capacity));
+            Assert::IsTrue(bitset.Empty());
+        }
+
+        TEST_METHOD (BitsetSetAlgebra)
+        {
+            const ZoneIndexBitset lhs = ZoneIndexBitset::FromIndexSet({ 1, 2, 70 });
+            const ZoneIndexBitset rhs = ZoneIndexBitset::FromIndexSet({ 2, 3, 70, 100 });
+
+            Assert::IsTrue(ZoneIndexSet{ 1, 2, 3, 70, 100 } == (lhs | rhs).ToIndexSet());
+            Assert::IsTrue(ZoneIndexSet{ 2, 70 } == (lhs & rhs).ToIndexSet());
+            Assert::IsTrue(ZoneIndexSet{ 1 } == (lhs - rhs).ToIndexSet());
+            Assert::IsTrue(lhs == ZoneIndexBitset::FromIndexSet({ 70, 1, 2 }));
+            Assert::IsFalse(lhs == rhs);
+        }
     };
 }
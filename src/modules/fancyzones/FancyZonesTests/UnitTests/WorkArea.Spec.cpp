@@ -285,6 +285,19 @@ namespace FancyZonesUnitTests
             }
         }
 
+        TEST_METHOD (SnapZonedWindowsTest)
+        {
+            const auto workArea = WorkArea::Create(m_hInst, m_workAreaId, m_parentUniqueId, m_workAreaRect);
+            const auto window = Mocks::WindowCreate(m_hInst);
+
+            const ZoneIndexSet expected = { 1, 2 };
+            Assert::IsTrue(workArea->Snap(window, expected));
+
+            const auto zonedWindows = FancyZonesWindowProperties::GetZonedWindows();
+            Assert::IsTrue(zonedWindows.contains(window));
+            Assert::IsTrue(expected == zonedWindows.at(window));
+        }
+
         TEST_METHOD (SnapAppZoneHistoryTest)
         {
             const auto workArea = WorkArea::Create(m_hInst, m_workAreaId, m_parentUniqueId, m_workAreaRect);
@@ -350,6 +363,17 @@ namespace FancyZonesUnitTests
             Assert::IsTrue(actual.empty());
         }
 
+        TEST_METHOD (UnsnapZonedWindowsTest)
+        {
+            const auto workArea = WorkArea::Create(m_hInst, m_workAreaId, m_parentUniqueId, m_workAreaRect);
+            const auto window = Mocks::WindowCreate(m_hInst);
+
+            Assert::IsTrue(workArea->Snap(window, { 1, 2 }));
+            Assert::IsTrue(workArea->Unsnap(window));
+
+            Assert::IsFalse(FancyZonesWindowProperties::GetZonedWindows().contains(window));
+        }
+
         TEST_METHOD (UnsnapAppZoneHistoryTest)
         {
             const auto workArea = WorkArea::Create(m_hInst, m_workAreaId, m_parentUniqueId, m_workAreaRect);
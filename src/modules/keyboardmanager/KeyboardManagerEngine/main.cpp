@@ -20,7 +20,8 @@ int WINAPI wWinMain(_In_ HINSTANCE /*hInstance*/,
                     _In_ int /*nCmdShow*/)
 {
     winrt::init_apartment();
-    LoggerHelpers::init_logger(KeyboardManagerConstants::ModuleName, L"Engine", LogSettings::keyboardManagerLoggerName);
+    // Logs from the hooks, which shouldn't wait for the disk
+    LoggerHelpers::init_logger(KeyboardManagerConstants::ModuleName, L"Engine", LogSettings::keyboardManagerLoggerName, AsyncLogOptions{});
 
     Shared::Trace::ETWTrace trace;
     trace.UpdateState(true);
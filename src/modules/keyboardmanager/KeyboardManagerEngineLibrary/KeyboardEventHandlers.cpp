@@ -218,16 +218,27 @@ namespace KeyboardEventHandlers
     {
         auto resetChordsResults = ResetChordsIfNeeded(data, state, activatedApp);
 
-        // Check if any shortcut is currently in the invoked state
-        bool isShortcutInvoked = state.CheckShortcutRemapInvoked(activatedApp);
+        // Get the shortcuts this key event can act on, and check if any shortcut is currently in the invoked state
+        const ShortcutRemapIndex& remapIndex = state.GetShortcutRemapIndex(activatedApp);
+        ShortcutRemapCandidates candidates;
+        bool isShortcutInvoked = remapIndex.GetCandidates(data->lParam->vkCode, resetChordsResults.AnyChordStarted, candidates);
 
         // Get shortcut table for given activatedApp
         ShortcutRemapTable& reMap = state.GetShortcutRemapTable(activatedApp);
 
-        // Iterate through the shortcut remaps and apply whichever has been pressed
-        for (auto& itShortcut : state.GetSortedShortcutRemapVector(activatedApp))
+        static bool isAltRightKeyInvoked = false;
+
+        // Check if the right Alt key (AltGr) is pressed.
+        if (!state.GetSortedShortcutRemapVector(activatedApp).empty() && data->lParam->vkCode == VK_RMENU && ii.GetVirtualKeyState(VK_LCONTROL))
         {
-            const auto it = reMap.find(itShortcut);
+            isAltRightKeyInvoked = true;
+        }
+
+        // Iterate through the shortcut remaps that can apply, in the order of the sorted vector, and apply whichever has been pressed
+        for (const uint32_t position : candidates)
+        {
+            Shortcut& itShortcut = remapIndex.GetShortcut(position);
+            const auto it = remapIndex.GetRemap(position);
 
             // If a shortcut is currently in the invoked state then skip till the shortcut that is currently invoked
             if (isShortcutInvoked && !it->second.isShortcutInvoked)
@@ -247,14 +258,6 @@ namespace KeyboardEventHandlers
             bool isMatchOnChordEnd = false;
             bool isMatchOnChordStart = false;
 
-            static bool isAltRightKeyInvoked = false;
-
-            // Check if the right Alt key (AltGr) is pressed.
-            if (data->lParam->vkCode == VK_RMENU && ii.GetVirtualKeyState(VK_LCONTROL))
-            {
-                isAltRightKeyInvoked = true;
-            }
-
             // If the shortcut has been pressed down
             if (!it->second.isShortcutInvoked && it->first.CheckModifiersKeyboardState(ii))
             {
@@ -984,8 +987,11 @@ namespace KeyboardEventHandlers
 
     void ResetAllOtherStartedChords(State& state, const std::optional<std::wstring>& activatedApp, DWORD keyToKeep)
     {
-        for (auto& itShortcut_2 : state.GetSortedShortcutRemapVector(activatedApp))
+        // Only chord shortcuts can be started
+        const ShortcutRemapIndex& remapIndex = state.GetShortcutRemapIndex(activatedApp);
+        for (const uint32_t position : remapIndex.GetChordPositions())
         {
+            Shortcut& itShortcut_2 = remapIndex.GetShortcut(position);
             if (keyToKeep == NULL || itShortcut_2.actionKey != keyToKeep)
             {
                 itShortcut_2.SetChordStarted(false);
@@ -1023,21 +1029,23 @@ namespace KeyboardEventHandlers
             isNewControlKey = true;
         }
 
+        // Only chord shortcuts can be started
+        const ShortcutRemapIndex& remapIndex = state.GetShortcutRemapIndex(activatedApp);
         if (isNewControlKey)
         {
             //Logger::trace(L"ChordKeyboardHandler:reset");
 
-            for (auto& itShortcut : state.GetSortedShortcutRemapVector(activatedApp))
+            for (const uint32_t position : remapIndex.GetChordPositions())
             {
-                itShortcut.SetChordStarted(false);
+                remapIndex.GetShortcut(position).SetChordStarted(false);
             }
             result.CurrentKeyIsModifierKey = true;
         }
         else
         {
-            for (auto& itShortcut : state.GetSortedShortcutRemapVector(activatedApp))
+            for (const uint32_t position : remapIndex.GetChordPositions())
             {
-                if (itShortcut.IsChordStarted())
+                if (remapIndex.GetShortcut(position).IsChordStarted())
                 {
                     result.AnyChordStarted = true;
                     break;
@@ -1631,52 +1639,30 @@ namespace KeyboardEventHandlers
         // Check if the key event was generated by KeyboardManager to avoid remapping events generated by us.
         if (data->lParam->dwExtraInfo != KeyboardManagerConstants::KEYBOARDMANAGER_SHORTCUT_FLAG)
         {
-            std::wstring process_name;
-
-            // Allocate MAX_PATH amount of memory
-            process_name.resize(MAX_PATH);
-            ii.GetForegroundProcess(process_name);
-
-            // Remove elements after null character
-            process_name.erase(std::find(process_name.begin(), process_name.end(), L'\0'), process_name.end());
-
-            if (process_name.empty())
+            // The foreground app is updated on foreground changes, so this doesn't query the process
+            const ForegroundApp* foregroundApp = ii.GetForegroundApp();
+            if (!foregroundApp)
             {
                 return 0;
             }
 
-            // Convert process name to lower case
-            std::transform(process_name.begin(), process_name.end(), process_name.begin(), towlower);
-
-            std::wstring query_string;
-
-            AppSpecificShortcutRemapTable::iterator it;
-
             // Check if an app-specific shortcut is already activated
             if (state.GetActivatedApp() == KeyboardManagerConstants::NoActivatedApp)
             {
-                query_string = process_name;
-                it = state.appSpecificShortcutReMap.find(query_string);
-
-                // If no entry is found, search for the process name without it's file extension
-                if (it == state.appSpecificShortcutReMap.end())
+                const std::optional<std::wstring>& appName = state.GetAppSpecificShortcutRemapName(*foregroundApp);
+                if (appName)
                 {
-                    // Find index of the file extension
-                    size_t extensionIndex = process_name.find_last_of(L".");
-                    query_string = process_name.substr(0, extensionIndex);
-                    it = state.appSpecificShortcutReMap.find(query_string);
+                    return HandleShortcutRemapEvent(ii, data, state, appName);
                 }
             }
             else
             {
-                query_string = state.GetActivatedApp();
-                it = state.appSpecificShortcutReMap.find(query_string);
-            }
-
-            if (it != state.appSpecificShortcutReMap.end())
-            {
-                bool result = HandleShortcutRemapEvent(ii, data, state, query_string);
-                return result;
+                const std::wstring query_string = state.GetActivatedApp();
+                if (state.appSpecificShortcutReMap.contains(query_string))
+                {
+                    bool result = HandleShortcutRemapEvent(ii, data, state, query_string);
+                    return result;
+                }
             }
         }
 
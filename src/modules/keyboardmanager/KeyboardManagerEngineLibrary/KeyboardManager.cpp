@@ -34,6 +34,22 @@ KeyboardManager::KeyboardManager()
     // Set the static pointer to the newest object of the class
     keyboardManagerObjectPtr = this;
 
+    // Resolve the foreground app when it changes instead of on every key event. The events are delivered to this thread's message loop.
+    // The UWP app hosted by ApplicationFrameHost.exe is resolved from the focused window, so it is resolved again when the focus changes
+    inputHandler.UpdateForegroundApp();
+    for (const DWORD event : { EVENT_SYSTEM_FOREGROUND, EVENT_OBJECT_FOCUS })
+    {
+        auto hook = SetWinEventHook(event, event, nullptr, ForegroundEventProc, 0, 0, WINEVENT_OUTOFCONTEXT);
+        if (hook)
+        {
+            foregroundEventHooks.push_back(hook);
+        }
+        else
+        {
+            Logger::error(L"Failed to set the foreground event hook. {}", get_last_error_or_default(GetLastError()));
+        }
+    }
+
     std::filesystem::path modulePath(PTSettingsHelper::get_module_save_folder_location(moduleName));
     auto changeSettingsCallback = [this](DWORD err) {
         Logger::trace(L"{} event was signaled", KeyboardManagerConstants::SettingsEventName);
@@ -126,6 +142,18 @@ LRESULT CALLBACK KeyboardManager::HookProc(int nCode, const WPARAM wParam, const
     return CallNextHookEx(hookHandleCopy, nCode, wParam, lParam);
 }
 
+void CALLBACK KeyboardManager::ForegroundEventProc(HWINEVENTHOOK, DWORD event, HWND, LONG, LONG, DWORD, DWORD)
+{
+    if (event == EVENT_SYSTEM_FOREGROUND)
+    {
+        keyboardManagerObjectPtr->inputHandler.UpdateForegroundApp();
+    }
+    else
+    {
+        keyboardManagerObjectPtr->inputHandler.UpdateHostedForegroundApp();
+    }
+}
+
 void KeyboardManager::StartLowlevelKeyboardHook()
 {
 #if defined(DISABLE_LOWLEVEL_HOOKS_WHEN_DEBUGGED)
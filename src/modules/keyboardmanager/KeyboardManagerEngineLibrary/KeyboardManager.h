@@ -4,6 +4,8 @@
 #include <keyboardmanager/common/Input.h>
 #include "State.h"
 
+#include <vector>
+
 class KeyboardManager
 {
 public:
@@ -14,6 +16,11 @@ public:
 
     ~KeyboardManager()
     {
+        for (const auto hook : foregroundEventHooks)
+        {
+            UnhookWinEvent(hook);
+        }
+
         if (editorIsRunningEvent)
         {
             CloseHandle(editorIsRunningEvent);
@@ -38,6 +45,9 @@ private:
     // Required for Unhook in old versions of Windows
     static HHOOK hookHandleCopy;
 
+    // Foreground and focus change event hooks, used to keep the foreground app of the input handler up to date
+    std::vector<HWINEVENTHOOK> foregroundEventHooks;
+
     // Static pointer to the current KeyboardManager object required for accessing the HandleKeyboardHookEvent function in the hook procedure
     // Only global or static variables can be accessed in a hook procedure CALLBACK
     static KeyboardManager* keyboardManagerObjectPtr;
@@ -58,6 +68,9 @@ private:
     // Hook procedure definition
     static LRESULT CALLBACK HookProc(int nCode, WPARAM wParam, LPARAM lParam);
 
+    // Foreground and focus change event hook procedure definition
+    static void CALLBACK ForegroundEventProc(HWINEVENTHOOK hWinEventHook, DWORD event, HWND hwnd, LONG idObject, LONG idChild, DWORD idEventThread, DWORD dwmsEventTime);
+
     // Load settings from the file.
     void LoadSettings();
 
@@ -0,0 +1,87 @@
+#include "pch.h"
+#include "ShortcutRemapIndex.h"
+
+ShortcutRemapIndex::ShortcutRemapIndex(std::vector<Shortcut>& sortedKeys, ShortcutRemapTable& reMap) :
+    m_sortedKeys(&sortedKeys), m_keyStart(OtherKeysBucket + 2, 0)
+{
+    m_remaps.reserve(sortedKeys.size());
+    for (uint32_t position = 0; position < sortedKeys.size(); position++)
+    {
+        const Shortcut& shortcut = sortedKeys[position];
+        m_remaps.push_back(reMap.find(shortcut));
+        m_keyStart[GetBucket(shortcut.GetActionKey()) + 1]++;
+        if (shortcut.HasChord())
+        {
+            m_chordPositions.push_back(position);
+        }
+    }
+
+    for (size_t bucket = 1; bucket < m_keyStart.size(); bucket++)
+    {
+        m_keyStart[bucket] += m_keyStart[bucket - 1];
+    }
+
+    // Filling the buckets in position order keeps each of them sorted
+    std::vector<uint32_t> next(m_keyStart.begin(), m_keyStart.end() - 1);
+    m_keyPositions.resize(sortedKeys.size());
+    for (uint32_t position = 0; position < sortedKeys.size(); position++)
+    {
+        m_keyPositions[next[GetBucket(sortedKeys[position].GetActionKey())]++] = position;
+    }
+}
+
+bool ShortcutRemapIndex::GetCandidates(DWORD vkCode, bool anyChordStarted, ShortcutRemapCandidates& candidates) const
+{
+    candidates.clear();
+    for (uint32_t position = 0; position < m_remaps.size(); position++)
+    {
+        if (m_remaps[position]->second.isShortcutInvoked)
+        {
+            candidates.push_back(position);
+        }
+    }
+
+    if (!candidates.empty())
+    {
+        return true;
+    }
+
+    if (m_keyStart.empty())
+    {
+        return false;
+    }
+
+    const size_t bucket = GetBucket(vkCode);
+    const auto keyBegin = m_keyPositions.begin() + m_keyStart[bucket];
+    const auto keyEnd = m_keyPositions.begin() + m_keyStart[bucket + 1];
+    if (!anyChordStarted)
+    {
+        candidates.append(keyBegin, keyEnd);
+        return false;
+    }
+
+    // A started chord resets itself or completes on any key that isn't a modifier
+    auto keyIt = keyBegin;
+    for (const uint32_t chordPosition : m_chordPositions)
+    {
+        if (!(*m_sortedKeys)[chordPosition].IsChordStarted())
+        {
+            continue;
+        }
+
+        while (keyIt != keyEnd && *keyIt < chordPosition)
+        {
+            candidates.push_back(*keyIt++);
+        }
+
+        if (keyIt != keyEnd && *keyIt == chordPosition)
+        {
+            keyIt++;
+        }
+
+        candidates.push_back(chordPosition);
+    }
+
+    candidates.append(keyIt, keyEnd);
+    return false;
+}
@@ -0,0 +1,120 @@
+#pragma once
+#include <array>
+#include <vector>
+
+#include <keyboardmanager/common/MappingConfiguration.h>
+
+// Positions of the shortcuts a key event can act on. A key rarely acts on more than a few shortcuts, so they are kept
+// in a fixed-size buffer on the stack of the hook, and only a key with more candidates than that allocates.
+// Handlers can be reentered through the input they send, so each call needs its own list.
+class ShortcutRemapCandidates
+{
+public:
+    static constexpr size_t InlineCapacity = 32;
+
+    void clear()
+    {
+        m_size = 0;
+        m_overflow.clear();
+    }
+
+    void push_back(uint32_t position)
+    {
+        if (m_size < InlineCapacity)
+        {
+            m_inline[m_size++] = position;
+            return;
+        }
+
+        if (m_overflow.empty())
+        {
+            m_overflow.assign(m_inline.begin(), m_inline.end());
+        }
+        m_overflow.push_back(position);
+        m_size++;
+    }
+
+    template<typename Iterator>
+    void append(Iterator first, Iterator last)
+    {
+        for (; first != last; ++first)
+        {
+            push_back(*first);
+        }
+    }
+
+    const uint32_t* begin() const
+    {
+        return m_overflow.empty() ? m_inline.data() : m_overflow.data();
+    }
+
+    const uint32_t* end() const
+    {
+        return begin() + m_size;
+    }
+
+    size_t size() const
+    {
+        return m_size;
+    }
+
+    bool empty() const
+    {
+        return m_size == 0;
+    }
+
+private:
+    std::array<uint32_t, InlineCapacity> m_inline{};
+    size_t m_size = 0;
+    // Holds all the positions once there are more than InlineCapacity
+    std::vector<uint32_t> m_overflow;
+};
+
+
+// Groups the shortcuts of a remap table by action key, so that a key event only visits the shortcuts it can act on
+// instead of every remapped shortcut. Positions refer to the sorted vector of the table and candidates are returned in
+// ascending order, so shortcuts are still tried in the order of the sorted vector.
+// The index points into the table, so it has to be rebuilt whenever shortcuts are added or cleared.
+class ShortcutRemapIndex
+{
+public:
+    ShortcutRemapIndex() = default;
+    ShortcutRemapIndex(std::vector<Shortcut>& sortedKeys, ShortcutRemapTable& reMap);
+
+    // Fills candidates with the shortcuts a key event can act on and returns whether any shortcut is invoked.
+    // If a shortcut is invoked only the invoked shortcuts are candidates, otherwise the shortcuts with vkCode as action
+    // key and, if a chord was started, the chord shortcuts waiting for their second key.
+    bool GetCandidates(DWORD vkCode, bool anyChordStarted, ShortcutRemapCandidates& candidates) const;
+
+    Shortcut& GetShortcut(uint32_t position) const
+    {
+        return (*m_sortedKeys)[position];
+    }
+
+    ShortcutRemapTable::iterator GetRemap(uint32_t position) const
+    {
+        return m_remaps[position];
+    }
+
+    const std::vector<uint32_t>& GetChordPositions() const
+    {
+        return m_chordPositions;
+    }
+
+private:
+    // Action keys outside of the virtual key range share the last bucket
+    static constexpr size_t OtherKeysBucket = 256;
+
+    static size_t GetBucket(DWORD vkCode)
+    {
+        return vkCode < OtherKeysBucket ? vkCode : OtherKeysBucket;
+    }
+
+    std::vector<Shortcut>* m_sortedKeys = nullptr;
+    std::vector<ShortcutRemapTable::iterator> m_remaps;
+
+    // Positions of the shortcuts of bucket i are m_keyPositions[m_keyStart[i]] to m_keyPositions[m_keyStart[i + 1] - 1]
+    std::vector<uint32_t> m_keyStart;
+    std::vector<uint32_t> m_keyPositions;
+    std::vector<uint32_t> m_chordPositions;
+};
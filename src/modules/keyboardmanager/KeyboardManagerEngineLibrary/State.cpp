@@ -62,6 +62,67 @@ std::vector<Shortcut>& State::GetSortedShortcutRemapVector(const std::optional<s
     return appName ? appSpecificShortcutReMapSortedKeys[*appName] : osLevelShortcutReMapSortedKeys;
 }
 
+const ShortcutRemapIndex& State::GetShortcutRemapIndex(const std::optional<std::wstring>& appName)
+{
+    if (indexedShortcutRemapsVersion != GetShortcutRemapsVersion())
+    {
+        osLevelShortcutRemapIndex = ShortcutRemapIndex(osLevelShortcutReMapSortedKeys, osLevelShortcutReMap);
+        appSpecificShortcutRemapIndex.clear();
+        for (auto& [app, sortedKeys] : appSpecificShortcutReMapSortedKeys)
+        {
+            appSpecificShortcutRemapIndex.emplace(app, ShortcutRemapIndex(sortedKeys, appSpecificShortcutReMap[app]));
+        }
+
+        indexedShortcutRemapsVersion = GetShortcutRemapsVersion();
+    }
+
+    if (appName)
+    {
+        // Matches GetSortedShortcutRemapVector, which has no shortcuts for apps without remaps
+        static const ShortcutRemapIndex emptyIndex;
+        auto itIndex = appSpecificShortcutRemapIndex.find(*appName);
+        return itIndex != appSpecificShortcutRemapIndex.end() ? itIndex->second : emptyIndex;
+    }
+
+    return osLevelShortcutRemapIndex;
+}
+
+// Function to get the name of the app-specific remap table of a foreground app. Returns nullopt if the app has no app-specific remaps
+const std::optional<std::wstring>& State::GetAppSpecificShortcutRemapName(const ForegroundApp& app)
+{
+    if (foregroundAppRemapsVersion != GetShortcutRemapsVersion())
+    {
+        foregroundAppRemaps.clear();
+        foregroundAppRemapsVersion = GetShortcutRemapsVersion();
+    }
+
+    if (app.id >= foregroundAppRemaps.size())
+    {
+        foregroundAppRemaps.resize(app.id + 1);
+    }
+
+    ForegroundAppRemaps& remaps = foregroundAppRemaps[app.id];
+    if (!remaps.resolved)
+    {
+        remaps.resolved = true;
+        if (appSpecificShortcutReMap.contains(app.name))
+        {
+            remaps.appName = app.name;
+        }
+        else
+        {
+            // If no entry is found, search for the process name without it's file extension
+            std::wstring nameWithoutExtension = app.name.substr(0, app.name.find_last_of(L"."));
+            if (appSpecificShortcutReMap.contains(nameWithoutExtension))
+            {
+                remaps.appName = std::move(nameWithoutExtension);
+            }
+        }
+    }
+
+    return remaps.appName;
+}
+
 // Sets the activated target application in app-specific shortcut
 void State::SetActivatedApp(const std::wstring& appName)
 {
@@ -69,7 +130,7 @@ void State::SetActivatedApp(const std::wstring& appName)
 }
 
 // Gets the activated target application in app-specific shortcut
-std::wstring State::GetActivatedApp()
+const std::wstring& State::GetActivatedApp() const
 {
     return activatedAppSpecificShortcutTarget;
 }
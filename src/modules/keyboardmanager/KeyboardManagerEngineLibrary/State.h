@@ -1,5 +1,7 @@
 #pragma once
 #include <keyboardmanager/common/MappingConfiguration.h>
+#include <keyboardmanager/common/ForegroundAppCache.h>
+#include "ShortcutRemapIndex.h"
 
 class State : public MappingConfiguration
 {
@@ -7,6 +9,21 @@ private:
     // Stores the activated target application in app-specific shortcut
     std::wstring activatedAppSpecificShortcutTarget;
 
+    // Indexes of the shortcut tables, built for the shortcut remaps version they were built from
+    std::optional<uint64_t> indexedShortcutRemapsVersion;
+    ShortcutRemapIndex osLevelShortcutRemapIndex;
+    std::map<std::wstring, ShortcutRemapIndex> appSpecificShortcutRemapIndex;
+
+    // App-specific remap table name of each foreground app id, resolved for the shortcut remaps version they were resolved from.
+    // A deque keeps the names in place while new apps are added, since the keyboard hook holds on to them
+    struct ForegroundAppRemaps
+    {
+        bool resolved = false;
+        std::optional<std::wstring> appName;
+    };
+    std::optional<uint64_t> foregroundAppRemapsVersion;
+    std::deque<ForegroundAppRemaps> foregroundAppRemaps;
+
 public:
     // Function to get the iterator of a single key remap given the source key. Returns nullopt if it isn't remapped
     std::optional<SingleKeyRemapTable::iterator> GetSingleKeyRemap(const DWORD& originalKey);
@@ -21,9 +38,15 @@ public:
 
     std::vector<Shortcut>& GetSortedShortcutRemapVector(const std::optional<std::wstring>& appName);
 
+    // Function to get the index of the sorted shortcut remap vector. Rebuilds the indexes if the shortcut remaps changed
+    const ShortcutRemapIndex& GetShortcutRemapIndex(const std::optional<std::wstring>& appName);
+
+    // Function to get the name of the app-specific remap table of a foreground app. Returns nullopt if the app has no app-specific remaps
+    const std::optional<std::wstring>& GetAppSpecificShortcutRemapName(const ForegroundApp& app);
+
     // Sets the activated target application in app-specific shortcut
     void SetActivatedApp(const std::wstring& appName);
 
     // Gets the activated target application in app-specific shortcut
-    std::wstring GetActivatedApp();
+    const std::wstring& GetActivatedApp() const;
 };
\ No newline at end of file
@@ -322,5 +322,96 @@ namespace RemappingLogicTests
             Assert::AreEqual(mockedInputHandler.GetVirtualKeyState(VK_CONTROL), false);
             Assert::AreEqual(mockedInputHandler.GetVirtualKeyState(actionKey), false);
         }
+
+        // Test if the app specific remap takes place when the foreground process name differs in case and extension from the app name
+        TEST_METHOD (AppSpecificShortcut_ShouldGetRemapped_WhenAppNameMatchesProcessNameWithoutExtension)
+        {
+            // Remap Ctrl+A to Alt+V
+            Shortcut src;
+            src.SetKey(VK_CONTROL);
+            src.SetKey(0x41);
+            Shortcut dest;
+            dest.SetKey(VK_MENU);
+            dest.SetKey(0x56);
+            testState.AddAppSpecificShortcut(L"testprocess1", src, dest);
+
+            // Set the testApp as the foreground process
+            mockedInputHandler.SetForegroundProcess(L"TestProcess1.EXE");
+
+            std::vector<INPUT> inputs{
+                { .type = INPUT_KEYBOARD, .ki = { .wVk = VK_CONTROL } },
+                { .type = INPUT_KEYBOARD, .ki = { .wVk = 'A' } }
+            };
+
+            // Send Ctrl+A keydown
+            mockedInputHandler.SendVirtualInput(inputs);
+
+            // Ctrl and A key states should be unchanged, Alt and V key states should be true
+            Assert::AreEqual(mockedInputHandler.GetVirtualKeyState(VK_CONTROL), false);
+            Assert::AreEqual(mockedInputHandler.GetVirtualKeyState(0x41), false);
+            Assert::AreEqual(mockedInputHandler.GetVirtualKeyState(VK_MENU), true);
+            Assert::AreEqual(mockedInputHandler.GetVirtualKeyState(0x56), true);
+        }
+
+        // Test if the app specific remap takes place when it is added after key events were handled for the foreground app
+        TEST_METHOD (AppSpecificShortcut_ShouldGetRemapped_WhenAddedAfterKeyEventsForTheApp)
+        {
+            // Set the testApp as the foreground process
+            mockedInputHandler.SetForegroundProcess(testApp1);
+
+            std::vector<INPUT> inputs{
+                { .type = INPUT_KEYBOARD, .ki = { .wVk = VK_CONTROL } },
+                { .type = INPUT_KEYBOARD, .ki = { .wVk = 'A' } },
+                { .type = INPUT_KEYBOARD, .ki = { .wVk = 'A', .dwFlags = KEYEVENTF_KEYUP } },
+                { .type = INPUT_KEYBOARD, .ki = { .wVk = VK_CONTROL, .dwFlags = KEYEVENTF_KEYUP } }
+            };
+
+            // Send Ctrl+A keydown and keyup without any remap
+            mockedInputHandler.SendVirtualInput(inputs);
+
+            // Remap Ctrl+A to Alt+V
+            Shortcut src;
+            src.SetKey(VK_CONTROL);
+            src.SetKey(0x41);
+            Shortcut dest;
+            dest.SetKey(VK_MENU);
+            dest.SetKey(0x56);
+            testState.AddAppSpecificShortcut(testApp1, src, dest);
+
+            inputs = {
+                { .type = INPUT_KEYBOARD, .ki = { .wVk = VK_CONTROL } },
+                { .type = INPUT_KEYBOARD, .ki = { .wVk = 'A' } }
+            };
+
+            // Send Ctrl+A keydown
+            mockedInputHandler.SendVirtualInput(inputs);
+
+            // Ctrl and A key states should be unchanged, Alt and V key states should be true
+            Assert::AreEqual(mockedInputHandler.GetVirtualKeyState(VK_CONTROL), false);
+            Assert::AreEqual(mockedInputHandler.GetVirtualKeyState(0x41), false);
+            Assert::AreEqual(mockedInputHandler.GetVirtualKeyState(VK_MENU), true);
+            Assert::AreEqual(mockedInputHandler.GetVirtualKeyState(0x56), true);
+        }
+
+        // Test if the foreground app is marked for resolving again whenever its window is hosted by ApplicationFrameHost.exe, whatever app the name resolved to
+        TEST_METHOD (ForegroundAppCache_ShouldTrackFrameHostWindows_WhenTheHostedAppIsResolved)
+        {
+            ForegroundAppCache cache;
+
+            cache.SetForegroundProcess(L"Calculator.exe", true);
+            Assert::IsTrue(cache.IsHostedByFrameHost());
+            Assert::AreEqual(std::wstring(L"calculator.exe"), cache.GetForegroundApp()->name);
+
+            cache.SetForegroundProcess(L"ApplicationFrameHost.exe", true);
+            Assert::IsTrue(cache.IsHostedByFrameHost());
+
+            cache.SetForegroundProcess(testApp1);
+            Assert::IsFalse(cache.IsHostedByFrameHost());
+            Assert::AreEqual(testApp1, cache.GetForegroundApp()->name);
+
+            cache.SetForegroundProcess(L"");
+            Assert::IsFalse(cache.IsHostedByFrameHost());
+            Assert::IsNull(cache.GetForegroundApp());
+        }
     };
 }
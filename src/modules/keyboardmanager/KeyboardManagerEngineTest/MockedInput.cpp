@@ -148,14 +148,14 @@ int MockedInput::GetSendVirtualInputCallCount()
     return sendVirtualInputCallCount;
 }
 
-// Function to get the foreground process name
+// Function to set the foreground process name
 void MockedInput::SetForegroundProcess(std::wstring process)
 {
-    currentProcess = process;
+    foregroundApps.SetForegroundProcess(process);
 }
 
-// Function to get the foreground process name
-void MockedInput::GetForegroundProcess(_Out_ std::wstring& foregroundProcess)
+// Function to get the foreground app
+const ForegroundApp* MockedInput::GetForegroundApp()
 {
-    foregroundProcess = currentProcess;
+    return foregroundApps.GetForegroundApp();
 }
@@ -1,5 +1,6 @@
 #pragma once
 #include <keyboardmanager/common/InputInterface.h>
+#include <keyboardmanager/common/ForegroundAppCache.h>
 #include <vector>
 #include <functional>
 
@@ -22,7 +23,7 @@ namespace KeyboardManagerInput
         int sendVirtualInputCallCount = 0;
         std::function<bool(LowlevelKeyboardEvent*)> sendVirtualInputCallCondition;
 
-        std::wstring currentProcess;
+        ForegroundAppCache foregroundApps;
 
     public:
         MockedInput()
@@ -51,11 +52,11 @@ namespace KeyboardManagerInput
         // Function to get SendVirtualInput call count
         int GetSendVirtualInputCallCount();
 
-        // Function to get the foreground process name
+        // Function to set the foreground process name
         void SetForegroundProcess(std::wstring process);
 
-        // Function to get the foreground process name
-        void GetForegroundProcess(_Out_ std::wstring& foregroundProcess);
+        // Function to get the foreground app
+        const ForegroundApp* GetForegroundApp();
     };
 }
 
@@ -0,0 +1,218 @@
+#include "pch.h"
+
+// Suppressing 26466 - Don't use static_cast downcasts - in CppUnitTest.h
+#pragma warning(push)
+#pragma warning(disable : 26466)
+#include "CppUnitTest.h"
+#pragma warning(pop)
+
+#include "MockedInput.h"
+#include <keyboardmanager/KeyboardManagerEngineLibrary/State.h>
+#include <keyboardmanager/KeyboardManagerEngineLibrary/KeyboardEventHandlers.h>
+#include "TestHelpers.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace RemappingLogicTests
+{
+    // Tests for the index used to find the shortcuts a key event can act on
+    TEST_CLASS (ShortcutRemapIndexTests)
+    {
+    private:
+        KeyboardManagerInput::MockedInput mockedInputHandler;
+        State testState;
+
+        static Shortcut MakeShortcut(DWORD modifier, DWORD actionKey, DWORD secondKey = NULL)
+        {
+            Shortcut shortcut;
+            shortcut.SetKey(modifier);
+            shortcut.SetKey(actionKey);
+            shortcut.SetSecondKey(secondKey);
+            return shortcut;
+        }
+
+        // Returns the shortcuts at the candidate positions, checking that the positions are in ascending order
+        static std::vector<Shortcut> GetCandidateShortcuts(const ShortcutRemapIndex& index, const ShortcutRemapCandidates& candidates)
+        {
+            Assert::IsTrue(std::is_sorted(candidates.begin(), candidates.end()));
+            Assert::IsTrue(std::adjacent_find(candidates.begin(), candidates.end()) == candidates.end());
+
+            std::vector<Shortcut> shortcuts;
+            for (const uint32_t position : candidates)
+            {
+                shortcuts.push_back(index.GetShortcut(position));
+            }
+            return shortcuts;
+        }
+
+        static bool Contains(const std::vector<Shortcut>& shortcuts, const Shortcut& shortcut)
+        {
+            return std::find(shortcuts.begin(), shortcuts.end(), shortcut) != shortcuts.end();
+        }
+
+    public:
+        TEST_METHOD_INITIALIZE(InitializeTestEnv)
+        {
+            // Reset test environment
+            TestHelpers::ResetTestEnv(mockedInputHandler, testState);
+
+            // Set HandleOSLevelShortcutRemapEvent as the hook procedure
+            std::function<intptr_t(LowlevelKeyboardEvent*)> currentHookProc = std::bind(&KeyboardEventHandlers::HandleOSLevelShortcutRemapEvent, std::ref(mockedInputHandler), std::placeholders::_1, std::ref(testState));
+            mockedInputHandler.SetHookProc([currentHookProc](LowlevelKeyboardEvent* data) {
+                if (data->lParam->dwExtraInfo != KeyboardManagerConstants::KEYBOARDMANAGER_SUPPRESS_FLAG)
+                {
+                    return currentHookProc(data);
+                }
+                else
+                {
+                    return 1LL;
+                }
+            });
+        }
+
+        // Test if only the shortcuts with the pressed action key are candidates
+        TEST_METHOD (Candidates_ShouldBeShortcutsWithTheActionKey_WhenNoShortcutIsInvoked)
+        {
+            const Shortcut ctrlA = MakeShortcut(VK_CONTROL, 0x41);
+            const Shortcut altA = MakeShortcut(VK_MENU, 0x41);
+            const Shortcut ctrlB = MakeShortcut(VK_CONTROL, 0x42);
+            testState.AddOSLevelShortcut(ctrlA, MakeShortcut(VK_CONTROL, 0x56));
+            testState.AddOSLevelShortcut(altA, MakeShortcut(VK_CONTROL, 0x57));
+            testState.AddOSLevelShortcut(ctrlB, MakeShortcut(VK_CONTROL, 0x58));
+
+            const ShortcutRemapIndex& index = testState.GetShortcutRemapIndex(std::nullopt);
+            ShortcutRemapCandidates candidates;
+            Assert::IsFalse(index.GetCandidates(0x41, false, candidates));
+
+            const auto shortcuts = GetCandidateShortcuts(index, candidates);
+            Assert::AreEqual(size_t(2), shortcuts.size());
+            Assert::IsTrue(Contains(shortcuts, ctrlA));
+            Assert::IsTrue(Contains(shortcuts, altA));
+
+            Assert::IsFalse(index.GetCandidates(0x43, false, candidates));
+            Assert::IsTrue(candidates.empty());
+        }
+
+        // Test if only the invoked shortcut is a candidate while it is invoked
+        TEST_METHOD (Candidates_ShouldBeInvokedShortcut_WhenAShortcutIsInvoked)
+        {
+            const Shortcut ctrlA = MakeShortcut(VK_CONTROL, 0x41);
+            const Shortcut ctrlB = MakeShortcut(VK_CONTROL, 0x42);
+            testState.AddOSLevelShortcut(ctrlA, MakeShortcut(VK_CONTROL, 0x56));
+            testState.AddOSLevelShortcut(ctrlB, MakeShortcut(VK_CONTROL, 0x57));
+            testState.osLevelShortcutReMap[ctrlB].isShortcutInvoked = true;
+
+            const ShortcutRemapIndex& index = testState.GetShortcutRemapIndex(std::nullopt);
+            ShortcutRemapCandidates candidates;
+            Assert::IsTrue(index.GetCandidates(0x41, false, candidates));
+
+            const auto shortcuts = GetCandidateShortcuts(index, candidates);
+            Assert::AreEqual(size_t(1), shortcuts.size());
+            Assert::IsTrue(shortcuts[0] == ctrlB);
+        }
+
+        // Test if started chords are candidates for any key until they are reset
+        TEST_METHOD (Candidates_ShouldIncludeStartedChords_WhenAChordIsStarted)
+        {
+            const Shortcut ctrlAC = MakeShortcut(VK_CONTROL, 0x41, 0x43);
+            const Shortcut ctrlAD = MakeShortcut(VK_CONTROL, 0x41, 0x44);
+            const Shortcut ctrlB = MakeShortcut(VK_CONTROL, 0x42);
+            testState.AddOSLevelShortcut(ctrlAC, MakeShortcut(VK_CONTROL, 0x56));
+            testState.AddOSLevelShortcut(ctrlAD, MakeShortcut(VK_CONTROL, 0x57));
+            testState.AddOSLevelShortcut(ctrlB, MakeShortcut(VK_CONTROL, 0x58));
+
+            const ShortcutRemapIndex& index = testState.GetShortcutRemapIndex(std::nullopt);
+            Assert::AreEqual(size_t(2), index.GetChordPositions().size());
+            for (const uint32_t position : index.GetChordPositions())
+            {
+                if (index.GetShortcut(position) == ctrlAC)
+                {
+                    index.GetShortcut(position).SetChordStarted(true);
+                }
+            }
+
+            ShortcutRemapCandidates candidates;
+            Assert::IsFalse(index.GetCandidates(0x42, true, candidates));
+            auto shortcuts = GetCandidateShortcuts(index, candidates);
+            Assert::AreEqual(size_t(2), shortcuts.size());
+            Assert::IsTrue(Contains(shortcuts, ctrlAC));
+            Assert::IsTrue(Contains(shortcuts, ctrlB));
+
+            // A started chord with the pressed action key is only returned once
+            Assert::IsFalse(index.GetCandidates(0x41, true, candidates));
+            shortcuts = GetCandidateShortcuts(index, candidates);
+            Assert::AreEqual(size_t(2), shortcuts.size());
+            Assert::IsTrue(Contains(shortcuts, ctrlAC));
+            Assert::IsTrue(Contains(shortcuts, ctrlAD));
+        }
+
+        // Test if the candidates are complete when there are more of them than fit in the fixed-size buffer
+        TEST_METHOD (Candidates_ShouldIncludeAllShortcuts_WhenMoreThanTheInlineCapacity)
+        {
+            // Every combination of Ctrl, Alt, Shift and Win with A, plus a second key for the chords
+            const DWORD modifiers[] = { VK_CONTROL, VK_MENU, VK_SHIFT, VK_LWIN };
+            size_t count = 0;
+            for (DWORD mask = 1; mask < 16; mask++)
+            {
+                for (DWORD secondKey = 0x30; secondKey < 0x33; secondKey++)
+                {
+                    Shortcut shortcut;
+                    for (size_t i = 0; i < 4; i++)
+                    {
+                        if (mask & (1 << i))
+                        {
+                            shortcut.SetKey(modifiers[i]);
+                        }
+                    }
+                    shortcut.SetKey(0x41);
+                    shortcut.SetSecondKey(secondKey);
+                    testState.AddOSLevelShortcut(shortcut, MakeShortcut(VK_CONTROL, 0x56));
+                    count++;
+                }
+            }
+            Assert::IsTrue(count > ShortcutRemapCandidates::InlineCapacity);
+
+            const ShortcutRemapIndex& index = testState.GetShortcutRemapIndex(std::nullopt);
+            ShortcutRemapCandidates candidates;
+            Assert::IsFalse(index.GetCandidates(0x41, false, candidates));
+            Assert::AreEqual(count, candidates.size());
+            Assert::AreEqual(count, GetCandidateShortcuts(index, candidates).size());
+
+            // Reused lists start over
+            Assert::IsFalse(index.GetCandidates(0x42, false, candidates));
+            Assert::IsTrue(candidates.empty());
+        }
+
+        // Test if a shortcut added after key events have been handled is remapped
+        TEST_METHOD (RemappedShortcut_ShouldSetTargetShortcutDown_WhenAddedAfterOtherKeyEvents)
+        {
+            // Remap Ctrl+A to Alt+V
+            testState.AddOSLevelShortcut(MakeShortcut(VK_CONTROL, 0x41), MakeShortcut(VK_MENU, 0x56));
+
+            std::vector<INPUT> inputs{
+                { .type = INPUT_KEYBOARD, .ki = { .wVk = 0x42 } },
+                { .type = INPUT_KEYBOARD, .ki = { .wVk = 0x42, .dwFlags = KEYEVENTF_KEYUP } },
+            };
+
+            // Send B keydown and keyup
+            mockedInputHandler.SendVirtualInput(inputs);
+
+            // Remap Ctrl+B to Alt+W
+            testState.AddOSLevelShortcut(MakeShortcut(VK_CONTROL, 0x42), MakeShortcut(VK_MENU, 0x57));
+
+            inputs = {
+                { .type = INPUT_KEYBOARD, .ki = { .wVk = VK_CONTROL } },
+                { .type = INPUT_KEYBOARD, .ki = { .wVk = 0x42 } },
+            };
+
+            // Send Ctrl+B keydown
+            mockedInputHandler.SendVirtualInput(inputs);
+
+            // Ctrl and B key states should be unchanged, Alt and W key states should be true
+            Assert::AreEqual(mockedInputHandler.GetVirtualKeyState(VK_CONTROL), false);
+            Assert::AreEqual(mockedInputHandler.GetVirtualKeyState(0x42), false);
+            Assert::AreEqual(mockedInputHandler.GetVirtualKeyState(VK_MENU), true);
+            Assert::AreEqual(mockedInputHandler.GetVirtualKeyState(0x57), true);
+        }
+    };
+}
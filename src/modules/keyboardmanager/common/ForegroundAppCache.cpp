@@ -0,0 +1,29 @@
+#include "pch.h"
+#include "ForegroundAppCache.h"
+
+// Function to get the interned app for a process name. Apps are never freed, so the pointer stays valid
+const ForegroundApp* ForegroundAppCache::Intern(const std::wstring& processName)
+{
+    // Convert process name to lower case
+    std::wstring name;
+    name.resize(processName.length());
+    std::transform(processName.begin(), processName.end(), name.begin(), towlower);
+
+    std::scoped_lock lock(internMutex);
+    auto it = appsByName.find(name);
+    if (it != appsByName.end())
+    {
+        return it->second;
+    }
+
+    const ForegroundApp& app = apps.emplace_back(static_cast<uint32_t>(apps.size()), name);
+    appsByName.emplace(std::move(name), &app);
+    return &app;
+}
+
+// Function to set the foreground process. An empty name means that there is no foreground process
+void ForegroundAppCache::SetForegroundProcess(const std::wstring& processName, bool hostedByFrameHost)
+{
+    foregroundApp.store(processName.empty() ? nullptr : Intern(processName), std::memory_order_release);
+    foregroundHostedByFrameHost.store(hostedByFrameHost, std::memory_order_release);
+}
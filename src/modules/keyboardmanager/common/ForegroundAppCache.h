@@ -0,0 +1,49 @@
+#pragma once
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// A process name interned by ForegroundAppCache. Ids are dense and never reused, so they can index per app tables
+struct ForegroundApp
+{
+    uint32_t id;
+
+    // Lower case process name
+    std::wstring name;
+};
+
+// Stores the process in the foreground, so that the keyboard hook doesn't have to query it on every key event.
+// The foreground process is set when it changes and read without locking.
+class ForegroundAppCache
+{
+public:
+    // Function to get the interned app for a process name. Apps are never freed, so the pointer stays valid
+    const ForegroundApp* Intern(const std::wstring& processName);
+
+    // Function to set the foreground process. An empty name means that there is no foreground process.
+    // hostedByFrameHost tells that the foreground window belongs to ApplicationFrameHost.exe, whatever app it hosts
+    void SetForegroundProcess(const std::wstring& processName, bool hostedByFrameHost = false);
+
+    // Function to get the foreground app. Returns nullptr if there is no foreground process
+    const ForegroundApp* GetForegroundApp() const noexcept
+    {
+        return foregroundApp.load(std::memory_order_acquire);
+    }
+
+    // Function to check if the foreground window belongs to ApplicationFrameHost.exe. The app it hosts can change
+    // without a foreground change, so it has to be resolved again
+    bool IsHostedByFrameHost() const noexcept
+    {
+        return foregroundHostedByFrameHost.load(std::memory_order_acquire);
+    }
+
+private:
+    std::mutex internMutex;
+    std::deque<ForegroundApp> apps;
+    std::unordered_map<std::wstring, const ForegroundApp*> appsByName;
+
+    std::atomic<const ForegroundApp*> foregroundApp = nullptr;
+    std::atomic<bool> foregroundHostedByFrameHost = false;
+};
@@ -239,6 +239,32 @@ namespace Helpers
         return process_name;
     }
 
+    // Function to check if a window belongs to ApplicationFrameHost.exe, which hosts the windows of UWP apps
+    bool IsApplicationFrameHostWindow(HWND window)
+    {
+        if (window == nullptr)
+        {
+            return false;
+        }
+
+        // get_process_path(HWND) resolves the hosted app, so query the process that owns the window itself
+        DWORD pid{};
+        GetWindowThreadProcessId(window, &pid);
+        std::wstring process_path = get_process_path(pid);
+        if (process_path.empty())
+        {
+            return false;
+        }
+
+        // Get process name from path
+        PathStripPath(&process_path[0]);
+
+        // Remove elements after null character
+        process_path.erase(std::find(process_path.begin(), process_path.end(), L'\0'), process_path.end());
+
+        return _wcsicmp(process_path.c_str(), L"ApplicationFrameHost.exe") == 0;
+    }
+
     // Function to set key events for modifier keys: When shortcutToCompare is passed (non-empty shortcut), then the key event is sent only if both shortcut's don't have the same modifier key. When keyToBeReleased is passed (non-NULL), then the key event is sent if either the shortcuts don't have the same modifier or if the shortcutToBeSent's modifier matches the keyToBeReleased
     void SetModifierKeyEvents(const Shortcut& shortcutToBeSent, const ModifierKey& winKeyInvoked, std::vector<INPUT>& keyEventArray, bool isKeyDown, ULONG_PTR extraInfoFlag, const Shortcut& shortcutToCompare, const DWORD& keyToBeReleased)
     {
@@ -45,6 +45,9 @@ namespace Helpers
     // Function to return the executable name of the application in focus
     std::wstring GetCurrentApplication(bool keepPath);
 
+    // Function to check if a window belongs to ApplicationFrameHost.exe, which hosts the windows of UWP apps
+    bool IsApplicationFrameHostWindow(HWND window);
+
     // Function to set key events for modifier keys: When shortcutToCompare is passed (non-empty shortcut), then the key event is sent only if both shortcut's don't have the same modifier key. When keyToBeReleased is passed (non-NULL), then the key event is sent if either the shortcuts don't have the same modifier or if the shortcutToBeSent's modifier matches the keyToBeReleased
     void SetModifierKeyEvents(const Shortcut& shortcutToBeSent, const ModifierKey& winKeyInvoked, std::vector<INPUT>& keyEventArray, bool isKeyDown, ULONG_PTR extraInfoFlag, const Shortcut& shortcutToCompare = Shortcut(), const DWORD& keyToBeReleased = NULL);
 
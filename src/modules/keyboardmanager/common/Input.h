@@ -2,6 +2,7 @@
 
 #include <common/logger/logger.h>
 #include <common/utils/winapi_error.h>
+#include <keyboardmanager/common/ForegroundAppCache.h>
 #include <keyboardmanager/common/Helpers.h>
 #include <keyboardmanager/common/InputInterface.h>
 
@@ -10,6 +11,9 @@ namespace KeyboardManagerInput
     // Class used to wrap keyboard input library methods
     class Input : public InputInterface
     {
+    private:
+        ForegroundAppCache foregroundApps;
+
     public:
         // Function to simulate input
         void SendVirtualInput(const std::vector<INPUT>& inputs)
@@ -30,10 +34,27 @@ namespace KeyboardManagerInput
             return (GetAsyncKeyState(key) & 0x8000);
         }
 
-        // Function to get the foreground process name
-        void GetForegroundProcess(_Out_ std::wstring& foregroundProcess)
+        // Function to get the foreground app. Returns nullptr if there is no foreground process
+        const ForegroundApp* GetForegroundApp()
         {
-            foregroundProcess = Helpers::GetCurrentApplication(false);
+            return foregroundApps.GetForegroundApp();
+        }
+
+        // Function to update the foreground app. Should be called whenever the foreground window changes
+        void UpdateForegroundApp()
+        {
+            HWND window = GetForegroundWindow();
+            foregroundApps.SetForegroundProcess(Helpers::GetCurrentApplication(false), Helpers::IsApplicationFrameHostWindow(window));
+        }
+
+        // Function to update the foreground app if its window is hosted by ApplicationFrameHost.exe. Should be called whenever the focus changes,
+        // since the hosted UWP app can change without a foreground change
+        void UpdateHostedForegroundApp()
+        {
+            if (foregroundApps.IsHostedByFrameHost())
+            {
+                UpdateForegroundApp();
+            }
         }
     };
 }
@@ -4,6 +4,8 @@
 #include <vector>
 #include <Windows.h>
 
+struct ForegroundApp;
+
 namespace KeyboardManagerInput
 {
     // Interface used to wrap keyboard input library methods
@@ -16,7 +18,7 @@ namespace KeyboardManagerInput
         // Function to get the state of a particular key
         virtual bool GetVirtualKeyState(int key) = 0;
 
-        // Function to get the foreground process name
-        virtual void GetForegroundProcess(_Out_ std::wstring& foregroundProcess) = 0;
+        // Function to get the foreground app. Returns nullptr if there is no foreground process
+        virtual const ForegroundApp* GetForegroundApp() = 0;
     };
 }
\ No newline at end of file
@@ -15,6 +15,7 @@ void MappingConfiguration::ClearOSLevelShortcuts()
 {
     osLevelShortcutReMap.clear();
     osLevelShortcutReMapSortedKeys.clear();
+    shortcutRemapsVersion++;
 }
 
 // Function to clear the Keys remapping table.
@@ -34,6 +35,7 @@ void MappingConfiguration::ClearAppSpecificShortcuts()
 {
     appSpecificShortcutReMap.clear();
     appSpecificShortcutReMapSortedKeys.clear();
+    shortcutRemapsVersion++;
 }
 
 // Function to add a new OS level shortcut remapping
@@ -49,6 +51,7 @@ bool MappingConfiguration::AddOSLevelShortcut(const Shortcut& originalSC, const
     osLevelShortcutReMap[originalSC] = RemapShortcut(newSC);
     osLevelShortcutReMapSortedKeys.push_back(originalSC);
     Helpers::SortShortcutVectorBasedOnSize(osLevelShortcutReMapSortedKeys);
+    shortcutRemapsVersion++;
 
     return true;
 }
@@ -107,9 +110,15 @@ bool MappingConfiguration::AddAppSpecificShortcut(const std::wstring& app, const
     appSpecificShortcutReMap[process_name][originalSC] = RemapShortcut(newSC);
     appSpecificShortcutReMapSortedKeys[process_name].push_back(originalSC);
     Helpers::SortShortcutVectorBasedOnSize(appSpecificShortcutReMapSortedKeys[process_name]);
+    shortcutRemapsVersion++;
     return true;
 }
 
+uint64_t MappingConfiguration::GetShortcutRemapsVersion() const
+{
+    return shortcutRemapsVersion;
+}
+
 bool MappingConfiguration::LoadSingleKeyRemaps(const json::JsonObject& jsonData)
 {
     bool result = true;
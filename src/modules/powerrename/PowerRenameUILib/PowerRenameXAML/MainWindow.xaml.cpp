@@ -242,29 +242,23 @@ namespace winrt::PowerRenameUI::implementation
             });
         }
 #endif
+        bool enumerateItems = false;
         if (SUCCEEDED(CPowerRenameManager::s_CreateInstance(&m_prManager)))
         {
             g_prManager = m_prManager;
-            // Create the factory for our items
+            // Create the factory for our items, keeping their store to log the memory they use
+            m_itemStore = std::make_shared<CPowerRenameItemStore>();
             CComPtr<IPowerRenameItemFactory> prItemFactory;
-            if (SUCCEEDED(CPowerRenameItem::s_CreateInstance(nullptr, IID_PPV_ARGS(&prItemFactory))))
+            if (SUCCEEDED(CPowerRenameItem::s_CreateInstance(nullptr, m_itemStore, IID_PPV_ARGS(&prItemFactory))))
             {
                 if (SUCCEEDED(m_prManager->PutRenameItemFactory(prItemFactory)))
                 {
                     if (SUCCEEDED(m_prManager->Advise(&m_managerEvents, &m_cookie)))
                     {
-                        CComPtr<IShellItemArray> shellItemArray;
                         // To test PowerRename uncomment DEBUG_BENCHMARK_100K_ENTRIES define
                         if (!g_files.empty())
                         {
-                            if (SUCCEEDED(CreateShellItemArrayFromPaths(std::move(g_files), &shellItemArray)))
-                            {
-                                CComPtr<IEnumShellItems> enumShellItems;
-                                if (SUCCEEDED(shellItemArray->EnumItems(&enumShellItems)))
-                                {
-                                    EnumerateShellItems(enumShellItems);
-                                }
-                            }
+                            enumerateItems = true;
                         }
                         else
                         {
@@ -300,6 +294,13 @@ namespace winrt::PowerRenameUI::implementation
         SearchReplaceChanged();
         InvalidateItemListViewState();
 
+        // The items are enumerated in the background once the search, replace and flags are set,
+        // so that the previews started while enumerating use them and the window stays responsive
+        if (enumerateItems)
+        {
+            EnumerateItems(std::move(g_files));
+        }
+
         SizeChanged({ this, &MainWindow::OnSizeChanged });
         Closed({ this, &MainWindow::OnClosed });
     }
@@ -320,6 +321,12 @@ namespace winrt::PowerRenameUI::implementation
             LastRunSettingsInstance().UpdateLastWindowSize(m_updatedWindowSize->first, m_updatedWindowSize->second);
         }
 
+        if (m_enumThread.joinable())
+        {
+            m_prEnum->Cancel();
+            m_enumThread.join();
+        }
+
         m_etwTrace.Flush();
         m_etwTrace.UpdateState(false);
 
@@ -522,30 +529,73 @@ namespace winrt::PowerRenameUI::implementation
         return hr;
     }
 
-    HRESULT MainWindow::EnumerateShellItems(_In_ IEnumShellItems* enumShellItems)
+    HRESULT MainWindow::EnumerateItems(std::vector<std::wstring> files)
     {
         _TRACER_;
 
-        HRESULT hr = S_OK;
-        // Enumerate the data object and populate the manager
-        if (m_prManager)
+        // Ensure we re-create the enumerator
+        m_prEnum = nullptr;
+        HRESULT hr = CPowerRenameEnum::s_CreateInstance(nullptr, m_prManager, IID_PPV_ARGS(&m_prEnum));
+        if (SUCCEEDED(hr))
         {
             m_disableCountUpdate = true;
+            m_enumStartTime = GetTickCount64();
+            m_firstPreviewMs = 0;
 
-            // Ensure we re-create the enumerator
-            m_prEnum = nullptr;
-            hr = CPowerRenameEnum::s_CreateInstance(nullptr, m_prManager, IID_PPV_ARGS(&m_prEnum));
-            if (SUCCEEDED(hr))
-            {
-                hr = m_prEnum->Start(enumShellItems);
-            }
+            m_enumThread = std::thread([this, files = std::move(files), prEnum = m_prEnum, dispatcherQueue = DispatcherQueue(), weakThis = get_weak()]() mutable {
+                HRESULT result = CoInitializeEx(nullptr, COINIT_APARTMENTTHREADED);
+                if (SUCCEEDED(result))
+                {
+                    {
+                        // Populate the manager, which previews the items as they are added
+                        CComPtr<IShellItemArray> shellItemArray;
+                        result = CreateShellItemArrayFromPaths(std::move(files), &shellItemArray);
+                        CComPtr<IEnumShellItems> enumShellItems;
+                        if (SUCCEEDED(result))
+                        {
+                            result = shellItemArray->EnumItems(&enumShellItems);
+                        }
 
-            m_disableCountUpdate = false;
+                        if (SUCCEEDED(result))
+                        {
+                            result = prEnum->Start(enumShellItems);
+                        }
+                    }
+
+                    CoUninitialize();
+                }
+
+                dispatcherQueue.TryEnqueue([weakThis, result]() {
+                    if (auto self = weakThis.get())
+                    {
+                        self->OnItemsEnumerated(result);
+                    }
+                });
+            });
         }
 
         return hr;
     }
 
+    void MainWindow::OnItemsEnumerated(HRESULT hr)
+    {
+        _TRACER_;
+
+        UINT itemCount = 0;
+        m_prManager->GetItemCount(&itemCount);
+        Logger::debug(L"Enumerated {} items in {} ms with result {:#x}, first preview after {} ms, {} bytes per item",
+                      itemCount,
+                      GetTickCount64() - m_enumStartTime,
+                      static_cast<uint32_t>(hr),
+                      m_firstPreviewMs,
+                      itemCount > 0 ? m_itemStore->GetMemoryUsage() / itemCount : 0);
+
+        m_enumStartTime = 0;
+        m_disableCountUpdate = false;
+        UpdateCounts();
+        InvalidateItemListViewState();
+    }
+
     void MainWindow::SearchReplaceChanged(bool forceRenaming)
     {
         _TRACER_;
@@ -1058,6 +1108,13 @@ namespace winrt::PowerRenameUI::implementation
             m_flagValidationInProgress = false;
         }
 
+        // Time to the first preview showing enumerated items, 0 if none was shown while enumerating
+        UINT itemCount = 0;
+        if (m_enumStartTime != 0 && m_firstPreviewMs == 0 && SUCCEEDED(m_prManager->GetItemCount(&itemCount)) && itemCount > 0)
+        {
+            m_firstPreviewMs = GetTickCount64() - m_enumStartTime;
+        }
+
         UpdateCounts();
         InvalidateItemListViewState();
         return S_OK;
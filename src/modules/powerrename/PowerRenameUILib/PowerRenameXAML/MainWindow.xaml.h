@@ -13,6 +13,7 @@
 #include "ExplorerItemsSource.h"
 
 #include <map>
+#include <thread>
 #include <wil/resource.h>
 
 #include <PowerRenameEnum.h>
@@ -130,7 +131,8 @@ namespace winrt::PowerRenameUI::implementation
         HRESULT CreateShellItemArrayFromPaths(std::vector<std::wstring> files, IShellItemArray** shellItemArray);
 
         HRESULT InitAutoComplete();
-        HRESULT EnumerateShellItems(_In_ IEnumShellItems* enumShellItems);
+        HRESULT EnumerateItems(std::vector<std::wstring> files);
+        void OnItemsEnumerated(HRESULT hr);
         void SearchReplaceChanged(bool forceRenaming = false);
         void ValidateFlags(PowerRenameFlags flag);
         void UpdateFlag(PowerRenameFlags flag, UpdateFlagCommand command);
@@ -152,6 +154,11 @@ namespace winrt::PowerRenameUI::implementation
         bool m_disableCountUpdate = false;
         CComPtr<IPowerRenameManager> m_prManager;
         CComPtr<IPowerRenameEnum> m_prEnum;
+        std::shared_ptr<CPowerRenameItemStore> m_itemStore;
+        // Enumerates the items on its own thread, started once the UI is set up
+        std::thread m_enumThread;
+        ULONGLONG m_enumStartTime = 0; // 0 when not enumerating
+        ULONGLONG m_firstPreviewMs = 0;
         PowerRenameManagerEvents m_managerEvents;
         DWORD m_cookie = 0;
         CComPtr<IPowerRenameMRU> m_searchMRU;
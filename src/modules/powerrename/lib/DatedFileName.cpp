@@ -0,0 +1,265 @@
+#include "pch.h"
+
+#include "DatedFileName.h"
+
+namespace
+{
+    struct TokenInfo
+    {
+        wchar_t letter;
+        size_t count;
+        FileTimeToken token;
+    };
+
+    // Longer tokens go first, so that the longest one matches
+    constexpr std::array TOKENS = {
+        TokenInfo{ L'Y', 4, FileTimeToken::YearFourDigits },
+        TokenInfo{ L'Y', 2, FileTimeToken::YearTwoDigits },
+        TokenInfo{ L'Y', 1, FileTimeToken::YearLastDigit },
+        TokenInfo{ L'M', 4, FileTimeToken::MonthName },
+        TokenInfo{ L'M', 3, FileTimeToken::MonthAbbreviatedName },
+        TokenInfo{ L'M', 2, FileTimeToken::MonthTwoDigits },
+        TokenInfo{ L'M', 1, FileTimeToken::Month },
+        TokenInfo{ L'D', 4, FileTimeToken::DayName },
+        TokenInfo{ L'D', 3, FileTimeToken::DayAbbreviatedName },
+        TokenInfo{ L'D', 2, FileTimeToken::DayTwoDigits },
+        TokenInfo{ L'D', 1, FileTimeToken::Day },
+        TokenInfo{ L'h', 2, FileTimeToken::HourTwoDigits },
+        TokenInfo{ L'h', 1, FileTimeToken::Hour },
+        TokenInfo{ L'm', 2, FileTimeToken::MinuteTwoDigits },
+        TokenInfo{ L'm', 1, FileTimeToken::Minute },
+        TokenInfo{ L's', 2, FileTimeToken::SecondTwoDigits },
+        TokenInfo{ L's', 1, FileTimeToken::Second },
+        TokenInfo{ L'f', 3, FileTimeToken::MillisecondsThreeDigits },
+        TokenInfo{ L'f', 2, FileTimeToken::MillisecondsTwoDigits },
+        TokenInfo{ L'f', 1, FileTimeToken::MillisecondsOneDigit },
+    };
+
+    const TokenInfo* MatchToken(const std::wstring_view text)
+    {
+        for (const auto& info : TOKENS)
+        {
+            if (text.size() >= info.count && std::all_of(text.begin(), text.begin() + info.count, [&](const wchar_t c) { return c == info.letter; }))
+            {
+                return &info;
+            }
+        }
+
+        return nullptr;
+    }
+
+    // Calls callback(offset, length, token) for each token in the text until it returns false
+    template<typename Callback>
+    void ForEachToken(const std::wstring_view text, const Callback& callback)
+    {
+        size_t i = 0;
+        while (i < text.size())
+        {
+            if (text[i] != L'$')
+            {
+                ++i;
+                continue;
+            }
+
+            size_t runEnd = i;
+            while (runEnd < text.size() && text[runEnd] == L'$')
+            {
+                ++runEnd;
+            }
+
+            // Each pair of '$' is an escaped '$', so only the last one of an odd run can start a token
+            const TokenInfo* info = (runEnd - i) % 2 ? MatchToken(text.substr(runEnd)) : nullptr;
+            if (!info)
+            {
+                i = runEnd;
+                continue;
+            }
+
+            if (!callback(runEnd - 1, info->count + 1, info->token))
+            {
+                return;
+            }
+            i = runEnd + info->count;
+        }
+    }
+
+    bool IsNameToken(const FileTimeToken token)
+    {
+        return token == FileTimeToken::MonthName || token == FileTimeToken::MonthAbbreviatedName ||
+               token == FileTimeToken::DayName || token == FileTimeToken::DayAbbreviatedName;
+    }
+
+    // Appends to a fixed size buffer, keeping what fits if it overflows
+    class OutputBuffer
+    {
+    public:
+        OutputBuffer(PWSTR buffer, const size_t capacity) :
+            m_buffer{ buffer }, m_capacity{ capacity }
+        {
+        }
+
+        void Append(const std::wstring_view text)
+        {
+            const size_t count = std::min(text.size(), m_capacity - 1 - m_size);
+            std::copy_n(text.data(), count, m_buffer + m_size);
+            m_size += count;
+            m_truncated |= count < text.size();
+        }
+
+        void AppendNumber(unsigned int value, const size_t minDigits)
+        {
+            wchar_t digits[10];
+            size_t count = 0;
+            do
+            {
+                digits[std::size(digits) - ++count] = static_cast<wchar_t>(L'0' + value % 10);
+                value /= 10;
+            } while (value != 0 || count < minDigits);
+
+            Append({ digits + std::size(digits) - count, count });
+        }
+
+        HRESULT Finish()
+        {
+            m_buffer[m_size] = L'\0';
+            return m_truncated ? STRSAFE_E_INSUFFICIENT_BUFFER : S_OK;
+        }
+
+    private:
+        PWSTR m_buffer;
+        size_t m_capacity;
+        size_t m_size = 0;
+        bool m_truncated = false;
+    };
+}
+
+DatedFileNameTemplate::DatedFileNameTemplate(const std::wstring_view replaceTerm) :
+    m_text{ replaceTerm }
+{
+    ForEachToken(m_text, [this](const size_t offset, const size_t length, const FileTimeToken token) {
+        m_tokens.push_back({ offset, length, token });
+        m_usesNames |= IsNameToken(token);
+        return true;
+    });
+}
+
+bool DatedFileNameTemplate::IsFileTimeUsed(const std::wstring_view replaceTerm)
+{
+    bool used = false;
+    ForEachToken(replaceTerm, [&used](size_t, size_t, FileTimeToken) {
+        used = true;
+        return false;
+    });
+    return used;
+}
+
+HRESULT DatedFileNameTemplate::Expand(_Out_ PWSTR result, UINT cchMax, const SYSTEMTIME& fileTime) const
+{
+    if (m_text.empty())
+    {
+        return E_INVALIDARG;
+    }
+
+    if (cchMax == 0 || cchMax > STRSAFE_MAX_CCH)
+    {
+        return STRSAFE_E_INVALID_PARAMETER;
+    }
+
+    wchar_t localeName[LOCALE_NAME_MAX_LENGTH] = { 0 };
+    if (m_usesNames)
+    {
+        // Names are capitalized with towupper, which depends on the global locale
+        [[maybe_unused]] static const bool globalLocaleSet = [] {
+            std::locale::global(std::locale(""));
+            return true;
+        }();
+
+        if (GetUserDefaultLocaleName(localeName, LOCALE_NAME_MAX_LENGTH) == 0)
+        {
+            StringCchCopy(localeName, LOCALE_NAME_MAX_LENGTH, L"en_US");
+        }
+    }
+
+    const auto appendName = [&](OutputBuffer& output, PCWSTR format) {
+        wchar_t formattedDate[MAX_PATH] = { 0 };
+        GetDateFormatEx(localeName, NULL, &fileTime, format, formattedDate, MAX_PATH, NULL);
+        formattedDate[0] = towupper(formattedDate[0]);
+        output.Append(formattedDate);
+    };
+
+    const std::wstring_view text = m_text;
+    OutputBuffer output{ result, cchMax };
+    size_t literalStart = 0;
+    for (const auto& span : m_tokens)
+    {
+        output.Append(text.substr(literalStart, span.offset - literalStart));
+        literalStart = span.offset + span.length;
+
+        switch (span.token)
+        {
+        case FileTimeToken::YearFourDigits:
+            output.AppendNumber(fileTime.wYear, 4);
+            break;
+        case FileTimeToken::YearTwoDigits:
+            output.AppendNumber(fileTime.wYear % 100, 2);
+            break;
+        case FileTimeToken::YearLastDigit:
+            output.AppendNumber(fileTime.wYear % 10, 1);
+            break;
+        case FileTimeToken::MonthName:
+            appendName(output, L"MMMM");
+            break;
+        case FileTimeToken::MonthAbbreviatedName:
+            appendName(output, L"MMM");
+            break;
+        case FileTimeToken::MonthTwoDigits:
+            output.AppendNumber(fileTime.wMonth, 2);
+            break;
+        case FileTimeToken::Month:
+            output.AppendNumber(fileTime.wMonth, 1);
+            break;
+        case FileTimeToken::DayName:
+            appendName(output, L"dddd");
+            break;
+        case FileTimeToken::DayAbbreviatedName:
+            appendName(output, L"ddd");
+            break;
+        case FileTimeToken::DayTwoDigits:
+            output.AppendNumber(fileTime.wDay, 2);
+            break;
+        case FileTimeToken::Day:
+            output.AppendNumber(fileTime.wDay, 1);
+            break;
+        case FileTimeToken::HourTwoDigits:
+            output.AppendNumber(fileTime.wHour, 2);
+            break;
+        case FileTimeToken::Hour:
+            output.AppendNumber(fileTime.wHour, 1);
+            break;
+        case FileTimeToken::MinuteTwoDigits:
+            output.AppendNumber(fileTime.wMinute, 2);
+            break;
+        case FileTimeToken::Minute:
+            output.AppendNumber(fileTime.wMinute, 1);
+            break;
+        case FileTimeToken::SecondTwoDigits:
+            output.AppendNumber(fileTime.wSecond, 2);
+            break;
+        case FileTimeToken::Second:
+            output.AppendNumber(fileTime.wSecond, 1);
+            break;
+        case FileTimeToken::MillisecondsThreeDigits:
+            output.AppendNumber(fileTime.wMilliseconds, 3);
+            break;
+        case FileTimeToken::MillisecondsTwoDigits:
+            output.AppendNumber(fileTime.wMilliseconds / 10, 2);
+            break;
+        case FileTimeToken::MillisecondsOneDigit:
+            output.AppendNumber(fileTime.wMilliseconds / 100, 1);
+            break;
+        }
+    }
+    output.Append(text.substr(literalStart));
+
+    return output.Finish();
+}
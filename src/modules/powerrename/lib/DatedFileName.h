@@ -0,0 +1,59 @@
+#pragma once
+
+#include "pch.h"
+
+#include <string_view>
+
+enum class FileTimeToken : uint8_t
+{
+    YearFourDigits, // $YYYY
+    YearTwoDigits, // $YY
+    YearLastDigit, // $Y
+    MonthName, // $MMMM
+    MonthAbbreviatedName, // $MMM
+    MonthTwoDigits, // $MM
+    Month, // $M
+    DayName, // $DDDD
+    DayAbbreviatedName, // $DDD
+    DayTwoDigits, // $DD
+    Day, // $D
+    HourTwoDigits, // $hh
+    Hour, // $h
+    MinuteTwoDigits, // $mm
+    Minute, // $m
+    SecondTwoDigits, // $ss
+    Second, // $s
+    MillisecondsThreeDigits, // $fff
+    MillisecondsTwoDigits, // $ff
+    MillisecondsOneDigit, // $f
+};
+
+// A replace term split into literal text and file time tokens, so that it can be expanded for each file
+// without being parsed again. A '$' escaped by another '$' doesn't start a token, and "$$" is kept as is.
+// The longest token wins, so "$YYY" is "$YY" followed by 'Y'.
+class DatedFileNameTemplate
+{
+public:
+    DatedFileNameTemplate() = default;
+    explicit DatedFileNameTemplate(std::wstring_view replaceTerm);
+
+    static bool IsFileTimeUsed(std::wstring_view replaceTerm);
+
+    bool UsesFileTime() const { return !m_tokens.empty(); }
+
+    // Writes the replace term with the tokens replaced by parts of fileTime. Returns E_INVALIDARG for an empty
+    // replace term, and otherwise behaves like StringCchCopy if the result doesn't fit.
+    HRESULT Expand(_Out_ PWSTR result, UINT cchMax, const SYSTEMTIME& fileTime) const;
+
+private:
+    struct TokenSpan
+    {
+        size_t offset = 0; // of the '$'
+        size_t length = 0; // including the '$'
+        FileTimeToken token = FileTimeToken::YearFourDigits;
+    };
+
+    std::wstring m_text;
+    std::vector<TokenSpan> m_tokens;
+    bool m_usesNames = false;
+};
@@ -3,6 +3,15 @@
 #include <ShlGuid.h>
 #include <helpers.h>
 
+namespace
+{
+    // Number of items added before the first preview
+    constexpr UINT FIRST_PREVIEW_COUNT = 1024;
+
+    // Number of items fetched at once from the enumerators of subfolders
+    constexpr ULONG FETCH_BATCH_SIZE = 64;
+}
+
 IFACEMETHODIMP_(ULONG) CPowerRenameEnum::AddRef()
 {
     return InterlockedIncrement(&m_refCount);
@@ -31,8 +40,19 @@ IFACEMETHODIMP CPowerRenameEnum::QueryInterface(_In_ REFIID riid, _Outptr_ void*
 IFACEMETHODIMP CPowerRenameEnum::Start(_In_ IEnumShellItems* enumShellItems)
 {
     m_canceled = false;
+    m_nextPreviewCount = FIRST_PREVIEW_COUNT;
+    m_itemCount = 0;
+    m_previewedCount = 0;
+
     HRESULT hr = _ParseEnumItems(enumShellItems);
 
+    // Items added after the last preview still need one. The UI sets the search term before
+    // enumerating, so this is also the only preview of small selections.
+    if (SUCCEEDED(hr) && m_itemCount != m_previewedCount)
+    {
+        m_spsrm->Start();
+    }
+
     return hr;
 }
 
@@ -87,65 +107,103 @@ HRESULT CPowerRenameEnum::_ParseEnumItems(_In_ IEnumShellItems* pesi, _In_ int d
     {
         hr = S_OK;
 
-        ULONG celtFetched;
-        CComPtr<IShellItem> spsi;
-        std::vector<CComPtr<IShellItem>> items;
-
-        while ((S_OK == pesi->Next(1, &spsi, &celtFetched)))
+        // We need to sort only the first layer, because later ones are enumerated correctly.
+        // Those are added while being enumerated, so that a large folder is never held in memory.
+        if (depth == 0)
         {
-            items.push_back(std::move(spsi));
-            spsi = nullptr;
-        }
+            ULONG celtFetched;
+            CComPtr<IShellItem> spsi;
+            std::vector<CComPtr<IShellItem>> items;
 
-        auto cmpShellItems = [](const CComPtr<IShellItem>& l, const CComPtr<IShellItem>& r) {
-            int res = 0;
-            l->Compare(r, SICHINT_DISPLAY, &res);
-            return res < 0;
-        };
+            while ((S_OK == pesi->Next(1, &spsi, &celtFetched)))
+            {
+                items.push_back(std::move(spsi));
+                spsi = nullptr;
+            }
+
+            auto cmpShellItems = [](const CComPtr<IShellItem>& l, const CComPtr<IShellItem>& r) {
+                int res = 0;
+                l->Compare(r, SICHINT_DISPLAY, &res);
+                return res < 0;
+            };
 
-        // We need to sort only the first layer, because later ones are enumerated correctly
-        if (depth == 0)
             std::sort(begin(items), end(items), cmpShellItems);
 
-        for (const auto& item : items)
-        {
-            if (m_canceled)
+            for (const auto& item : items)
             {
-                return E_ABORT;
+                hr = _AddItem(item, depth);
+                if (FAILED(hr))
+                {
+                    break;
+                }
             }
-
-            CComPtr<IPowerRenameItemFactory> spFactory;
-            hr = m_spsrm->GetRenameItemFactory(&spFactory);
-            if (SUCCEEDED(hr))
+        }
+        else
+        {
+            IShellItem* batch[FETCH_BATCH_SIZE] = {};
+            ULONG celtFetched = 0;
+            HRESULT hrNext = S_OK;
+            while (SUCCEEDED(hr) && hrNext == S_OK)
             {
-                CComPtr<IPowerRenameItem> spNewItem;
-                // Failure may be valid if we come across a shell item that does
-                // not support a file system path.  In that case we simply ignore
-                // the item.
-                if (SUCCEEDED(spFactory->Create(item, &spNewItem)))
+                celtFetched = 0;
+                hrNext = pesi->Next(FETCH_BATCH_SIZE, batch, &celtFetched);
+                for (ULONG i = 0; i < celtFetched; i++)
                 {
-                    spNewItem->PutDepth(depth);
-                    hr = m_spsrm->AddItem(spNewItem);
                     if (SUCCEEDED(hr))
                     {
-                        bool isFolder = false;
-                        if (SUCCEEDED(spNewItem->GetIsFolder(&isFolder)) && isFolder)
-                        {
-                            // Bind to the IShellItem for the IEnumShellItems interface
-                            CComPtr<IEnumShellItems> spesiNext;
-                            hr = item->BindToHandler(nullptr, BHID_EnumItems, IID_PPV_ARGS(&spesiNext));
-                            if (SUCCEEDED(hr))
-                            {
-                                // Parse the folder contents recursively
-                                hr = _ParseEnumItems(spesiNext, depth + 1);
-                            }
-                        }
+                        hr = _AddItem(batch[i], depth);
                     }
+                    batch[i]->Release();
                 }
             }
-            if (FAILED(hr))
+        }
+    }
+
+    return hr;
+}
+
+HRESULT CPowerRenameEnum::_AddItem(_In_ IShellItem* item, _In_ int depth)
+{
+    if (m_canceled)
+    {
+        return E_ABORT;
+    }
+
+    CComPtr<IPowerRenameItemFactory> spFactory;
+    HRESULT hr = m_spsrm->GetRenameItemFactory(&spFactory);
+    if (SUCCEEDED(hr))
+    {
+        CComPtr<IPowerRenameItem> spNewItem;
+        // Failure may be valid if we come across a shell item that does
+        // not support a file system path.  In that case we simply ignore
+        // the item.
+        if (SUCCEEDED(spFactory->Create(item, &spNewItem)))
+        {
+            spNewItem->PutDepth(depth);
+            hr = m_spsrm->AddItem(spNewItem);
+            if (SUCCEEDED(hr))
+            {
+                if (++m_itemCount == m_nextPreviewCount)
+                {
+                    // Start previewing what we have while the enumeration goes on. The preview
+                    // is only an early result, so failing to start it doesn't stop the enumeration.
+                    m_spsrm->Start();
+                    m_nextPreviewCount *= 2;
+                    m_previewedCount = m_itemCount;
+                }
+            }
+
+            bool isFolder = false;
+            if (SUCCEEDED(hr) && SUCCEEDED(spNewItem->GetIsFolder(&isFolder)) && isFolder)
             {
-                break;
+                // Bind to the IShellItem for the IEnumShellItems interface
+                CComPtr<IEnumShellItems> spesiNext;
+                hr = item->BindToHandler(nullptr, BHID_EnumItems, IID_PPV_ARGS(&spesiNext));
+                if (SUCCEEDED(hr))
+                {
+                    // Parse the folder contents recursively
+                    hr = _ParseEnumItems(spesiNext, depth + 1);
+                }
             }
         }
     }
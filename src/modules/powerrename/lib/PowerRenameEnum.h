@@ -1,6 +1,7 @@
 #pragma once
 #include "pch.h"
 #include "PowerRenameInterfaces.h"
+#include <atomic>
 #include <vector>
 #include "srwlock.h"
 
@@ -26,9 +27,17 @@ protected:
 
     HRESULT _Init(_In_ IUnknown* pdo, _In_ IPowerRenameManager* pManager);
     HRESULT _ParseEnumItems(_In_ IEnumShellItems* pesi, _In_ int depth = 0);
+    HRESULT _AddItem(_In_ IShellItem* item, _In_ int depth);
 
     CComPtr<IPowerRenameManager> m_spsrm;
     CComPtr<IUnknown> m_spdo;
-    bool m_canceled = false;
+    // Set by the UI thread while Start runs on the enumeration thread
+    std::atomic<bool> m_canceled = false;
     long m_refCount = 0;
+
+    // The manager previews what has been added so far each time the item count reaches this,
+    // and the count doubles so that large selections are previewed a logarithmic number of times
+    UINT m_nextPreviewCount = 0;
+    UINT m_itemCount = 0;
+    UINT m_previewedCount = 0;
 };
\ No newline at end of file
@@ -33,27 +33,17 @@ IFACEMETHODIMP CPowerRenameItem::QueryInterface(_In_ REFIID riid, _Outptr_ void*
 
 IFACEMETHODIMP CPowerRenameItem::PutPath(_In_opt_ PCWSTR newPath)
 {
-    CSRWSharedAutoLock lock(&m_lock);
-    CoTaskMemFree(m_path);
-    m_path = nullptr;
-    HRESULT hr = S_OK;
+    HRESULT hr = E_INVALIDARG;
     if (newPath != nullptr)
     {
-        hr = SHStrDup(newPath, &m_path);
+        hr = m_store->PutPath(m_storeIndex, newPath);
     }
     return hr;
 }
 
 IFACEMETHODIMP CPowerRenameItem::GetPath(_Outptr_ PWSTR* path)
 {
-    *path = nullptr;
-    CSRWSharedAutoLock lock(&m_lock);
-    HRESULT hr = E_FAIL;
-    if (m_path)
-    {
-        hr = SHStrDup(m_path, path);
-    }
-    return hr;
+    return m_store->GetPath(m_storeIndex, path);
 }
 
 IFACEMETHODIMP CPowerRenameItem::GetTime(_Outptr_ SYSTEMTIME* time)
@@ -67,7 +57,7 @@ IFACEMETHODIMP CPowerRenameItem::GetTime(_Outptr_ SYSTEMTIME* time)
     }
     else
     {
-        HANDLE hFile = CreateFileW(m_path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS, NULL);
+        HANDLE hFile = CreateFileW(m_store->GetPath(m_storeIndex).c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS, NULL);
         if (hFile != INVALID_HANDLE_VALUE)
         {
             FILETIME CreationTime;
@@ -93,31 +83,22 @@ IFACEMETHODIMP CPowerRenameItem::GetTime(_Outptr_ SYSTEMTIME* time)
 
 IFACEMETHODIMP CPowerRenameItem::GetShellItem(_Outptr_ IShellItem** ppsi)
 {
-    return SHCreateItemFromParsingName(m_path, nullptr, IID_PPV_ARGS(ppsi));
+    return SHCreateItemFromParsingName(m_store->GetPath(m_storeIndex).c_str(), nullptr, IID_PPV_ARGS(ppsi));
 }
 
 IFACEMETHODIMP CPowerRenameItem::PutOriginalName(_In_opt_ PCWSTR originalName)
 {
-    CSRWSharedAutoLock lock(&m_lock);
-    CoTaskMemFree(m_originalName);
-    m_originalName = nullptr;
-    HRESULT hr = S_OK;
+    HRESULT hr = E_INVALIDARG;
     if (originalName != nullptr)
     {
-        hr = SHStrDup(originalName, &m_originalName);
+        hr = m_store->PutOriginalName(m_storeIndex, originalName);
     }
     return hr;
 }
 
 IFACEMETHODIMP CPowerRenameItem::GetOriginalName(_Outptr_ PWSTR* originalName)
 {
-    CSRWSharedAutoLock lock(&m_lock);
-    HRESULT hr = E_FAIL;
-    if (m_originalName)
-    {
-        hr = SHStrDup(m_originalName, originalName);
-    }
-    return hr;
+    return m_store->GetOriginalName(m_storeIndex, originalName);
 }
 
 IFACEMETHODIMP CPowerRenameItem::PutNewName(_In_opt_ PCWSTR newName)
@@ -207,7 +188,7 @@ IFACEMETHODIMP CPowerRenameItem::ShouldRenameItem(_In_ DWORD flags, _Out_ bool*
 {
     // Should we perform a rename on this item given its
     // state and the options that were set?
-    bool hasChanged = m_newName != nullptr && (lstrcmp(m_originalName, m_newName) != 0) && (lstrcmp(L"", m_newName) != 0);
+    bool hasChanged = m_newName != nullptr && (m_store->CompareOriginalName(m_storeIndex, m_newName) != 0) && (lstrcmp(L"", m_newName) != 0);
     bool excludeBecauseFolder = (m_isFolder && (flags & PowerRenameFlags::ExcludeFolders));
     bool excludeBecauseFile = (!m_isFolder && (flags & PowerRenameFlags::ExcludeFiles));
     bool excludeBecauseSubFolderContent = (m_depth > 0 && (flags & PowerRenameFlags::ExcludeSubfolders));
@@ -247,10 +228,15 @@ IFACEMETHODIMP CPowerRenameItem::Reset()
 }
 
 HRESULT CPowerRenameItem::s_CreateInstance(_In_opt_ IShellItem* psi, _In_ REFIID iid, _Outptr_ void** resultInterface)
+{
+    return s_CreateInstance(psi, std::make_shared<CPowerRenameItemStore>(), iid, resultInterface);
+}
+
+HRESULT CPowerRenameItem::s_CreateInstance(_In_opt_ IShellItem* psi, _In_ std::shared_ptr<CPowerRenameItemStore> store, _In_ REFIID iid, _Outptr_ void** resultInterface)
 {
     *resultInterface = nullptr;
 
-    CPowerRenameItem* newRenameItem = new CPowerRenameItem();
+    CPowerRenameItem* newRenameItem = new CPowerRenameItem(std::move(store));
     HRESULT hr = E_OUTOFMEMORY;
     if (newRenameItem)
     {
@@ -270,40 +256,40 @@ HRESULT CPowerRenameItem::s_CreateInstance(_In_opt_ IShellItem* psi, _In_ REFIID
     return hr;
 }
 
-CPowerRenameItem::CPowerRenameItem() :
+CPowerRenameItem::CPowerRenameItem(std::shared_ptr<CPowerRenameItemStore> store) :
     m_refCount(1),
-    m_id(++s_id)
+    m_id(++s_id),
+    m_store(std::move(store))
 {
 }
 
 CPowerRenameItem::~CPowerRenameItem()
 {
-    CoTaskMemFree(m_path);
     CoTaskMemFree(m_newName);
-    CoTaskMemFree(m_originalName);
 }
 
 HRESULT CPowerRenameItem::_Init(_In_ IShellItem* psi)
 {
     // Get the full filesystem path from the shell item
-    HRESULT hr = psi->GetDisplayName(SIGDN_FILESYSPATH, &m_path);
+    PWSTR path = nullptr;
+    HRESULT hr = psi->GetDisplayName(SIGDN_FILESYSPATH, &path);
     if (SUCCEEDED(hr))
     {
-        hr = SHStrDup(PathFindFileName(m_path), &m_originalName);
+        // The original name is the last component of the path
+        m_storeIndex = m_store->Add(path);
+        CoTaskMemFree(path);
+
+        // Check if we are a folder now so we can check this attribute quickly later
+        // Also check if the shell allows us to rename the item.
+        SFGAOF att = 0;
+        hr = psi->GetAttributes(SFGAO_STREAM | SFGAO_FOLDER | SFGAO_CANRENAME, &att);
         if (SUCCEEDED(hr))
         {
-            // Check if we are a folder now so we can check this attribute quickly later
-            // Also check if the shell allows us to rename the item.
-            SFGAOF att = 0;
-            hr = psi->GetAttributes(SFGAO_STREAM | SFGAO_FOLDER | SFGAO_CANRENAME, &att);
-            if (SUCCEEDED(hr))
-            {
-                // Some items can be both folders and streams (ex: zip folders).
-                m_isFolder = (att & SFGAO_FOLDER) && !(att & SFGAO_STREAM);
-                // The shell lets us know if an item should not be renamed
-                // (ex: user profile director, windows dir, etc).
-                m_canRename = (att & SFGAO_CANRENAME);
-            }
+            // Some items can be both folders and streams (ex: zip folders).
+            m_isFolder = (att & SFGAO_FOLDER) && !(att & SFGAO_STREAM);
+            // The shell lets us know if an item should not be renamed
+            // (ex: user profile director, windows dir, etc).
+            m_canRename = (att & SFGAO_CANRENAME);
         }
     }
 
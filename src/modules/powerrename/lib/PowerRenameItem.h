@@ -1,6 +1,7 @@
 #pragma once
 #include "pch.h"
 #include "PowerRenameInterfaces.h"
+#include "PowerRenameItemStore.h"
 #include "srwlock.h"
 
 class CPowerRenameItem :
@@ -38,15 +39,17 @@ public:
     // IPowerRenameItemFactory
     IFACEMETHODIMP Create(_In_ IShellItem* psi, _Outptr_ IPowerRenameItem** ppItem)
     {
-        return CPowerRenameItem::s_CreateInstance(psi, IID_PPV_ARGS(ppItem));
+        return CPowerRenameItem::s_CreateInstance(psi, m_store, IID_PPV_ARGS(ppItem));
     }
 
 public:
+    // Items created through the returned factory share its item store
     static HRESULT s_CreateInstance(_In_opt_ IShellItem* psi, _In_ REFIID iid, _Outptr_ void** resultInterface);
+    static HRESULT s_CreateInstance(_In_opt_ IShellItem* psi, _In_ std::shared_ptr<CPowerRenameItemStore> store, _In_ REFIID iid, _Outptr_ void** resultInterface);
 
 protected:
     static int s_id;
-    CPowerRenameItem();
+    explicit CPowerRenameItem(std::shared_ptr<CPowerRenameItemStore> store);
     virtual ~CPowerRenameItem();
 
     HRESULT _Init(_In_ IShellItem* psi);
@@ -59,8 +62,8 @@ protected:
     int                             m_iconIndex = -1;
     UINT                            m_depth = 0;
     PowerRenameItemRenameStatus     m_status = PowerRenameItemRenameStatus::Init;
-    PWSTR                           m_path = nullptr;
-    PWSTR                           m_originalName = nullptr;
+    std::shared_ptr<CPowerRenameItemStore> m_store;
+    UINT                            m_storeIndex = UINT_MAX; // Path and original name, if any
     PWSTR                           m_newName = nullptr;
     SYSTEMTIME                      m_time = {0};
     CSRWLock                        m_lock;
@@ -0,0 +1,178 @@
+#include "pch.h"
+#include "PowerRenameItemStore.h"
+
+#include <algorithm>
+
+UINT CPowerRenameItemStore::Add(_In_ PCWSTR path)
+{
+    const std::wstring_view fullPath = path;
+    const size_t leafStart = PathFindFileName(path) - path;
+
+    CSRWExclusiveAutoLock lock(&m_lock);
+    const uint32_t nameOffset = _AppendName(fullPath.substr(leafStart));
+    m_parentIndex.push_back(_InternParent(fullPath.substr(0, leafStart)));
+    m_leafOffset.push_back(nameOffset);
+    m_originalNameOffset.push_back(nameOffset);
+
+    return static_cast<UINT>(m_parentIndex.size() - 1);
+}
+
+HRESULT CPowerRenameItemStore::GetPath(_In_ UINT index, _Outptr_ PWSTR* path)
+{
+    *path = nullptr;
+    const std::wstring fullPath = GetPath(index);
+    return fullPath.empty() ? E_FAIL : SHStrDup(fullPath.c_str(), path);
+}
+
+std::wstring CPowerRenameItemStore::GetPath(_In_ UINT index)
+{
+    CSRWSharedAutoLock lock(&m_lock);
+    std::wstring path;
+    if (index < m_parentIndex.size())
+    {
+        path = m_parents[m_parentIndex[index]];
+        path += &m_names[m_leafOffset[index]];
+    }
+    return path;
+}
+
+HRESULT CPowerRenameItemStore::PutPath(_In_ UINT index, _In_ PCWSTR path)
+{
+    const std::wstring_view fullPath = path;
+    const size_t leafStart = PathFindFileName(path) - path;
+
+    CSRWExclusiveAutoLock lock(&m_lock);
+    HRESULT hr = E_INVALIDARG;
+    if (index < m_parentIndex.size())
+    {
+        m_parentIndex[index] = _InternParent(fullPath.substr(0, leafStart));
+        const bool shared = m_leafOffset[index] == m_originalNameOffset[index];
+        m_leafOffset[index] = _ReplaceName(m_leafOffset[index], shared, fullPath.substr(leafStart));
+        _CompactNamesIfNeeded();
+        hr = S_OK;
+    }
+    return hr;
+}
+
+HRESULT CPowerRenameItemStore::GetOriginalName(_In_ UINT index, _Outptr_ PWSTR* originalName)
+{
+    CSRWSharedAutoLock lock(&m_lock);
+    HRESULT hr = E_FAIL;
+    if (index < m_originalNameOffset.size())
+    {
+        hr = SHStrDup(&m_names[m_originalNameOffset[index]], originalName);
+    }
+    return hr;
+}
+
+HRESULT CPowerRenameItemStore::PutOriginalName(_In_ UINT index, _In_ PCWSTR originalName)
+{
+    CSRWExclusiveAutoLock lock(&m_lock);
+    HRESULT hr = E_INVALIDARG;
+    if (index < m_originalNameOffset.size())
+    {
+        const bool shared = m_leafOffset[index] == m_originalNameOffset[index];
+        m_originalNameOffset[index] = _ReplaceName(m_originalNameOffset[index], shared, originalName);
+        _CompactNamesIfNeeded();
+        hr = S_OK;
+    }
+    return hr;
+}
+
+int CPowerRenameItemStore::CompareOriginalName(_In_ UINT index, _In_ PCWSTR name)
+{
+    CSRWSharedAutoLock lock(&m_lock);
+    return lstrcmp(index < m_originalNameOffset.size() ? &m_names[m_originalNameOffset[index]] : L"", name);
+}
+
+size_t CPowerRenameItemStore::GetMemoryUsage()
+{
+    CSRWSharedAutoLock lock(&m_lock);
+    size_t bytes = m_names.capacity() * sizeof(wchar_t) +
+                   (m_parentIndex.capacity() + m_leafOffset.capacity() + m_originalNameOffset.capacity()) * sizeof(uint32_t);
+
+    // Map nodes hold a key, a value and two pointers
+    bytes += m_parentIndices.bucket_count() * sizeof(void*) +
+             m_parentIndices.size() * (sizeof(std::wstring_view) + sizeof(uint32_t) + 2 * sizeof(void*));
+    for (const auto& parent : m_parents)
+    {
+        bytes += sizeof(parent) + (parent.capacity() + 1) * sizeof(wchar_t);
+    }
+
+    return bytes;
+}
+
+uint32_t CPowerRenameItemStore::_InternParent(std::wstring_view parent)
+{
+    // Siblings are usually added one after another
+    if (!m_parentIndex.empty() && m_parents[m_parentIndex.back()] == parent)
+    {
+        return m_parentIndex.back();
+    }
+
+    const auto it = m_parentIndices.find(parent);
+    if (it != m_parentIndices.end())
+    {
+        return it->second;
+    }
+
+    const auto index = static_cast<uint32_t>(m_parents.size());
+    m_parentIndices.emplace(m_parents.emplace_back(parent), index);
+    return index;
+}
+
+uint32_t CPowerRenameItemStore::_AppendName(std::wstring_view name)
+{
+    const auto offset = static_cast<uint32_t>(m_names.size());
+    m_names.insert(m_names.end(), name.begin(), name.end());
+    m_names.push_back(L'\0');
+    return offset;
+}
+
+uint32_t CPowerRenameItemStore::_ReplaceName(uint32_t offset, bool shared, std::wstring_view name)
+{
+    const size_t length = wcslen(&m_names[offset]);
+
+    // The last path component and the original name share their slot until one of them changes
+    if (!shared && name.size() <= length)
+    {
+        std::copy(name.begin(), name.end(), m_names.begin() + offset);
+        m_names[offset + name.size()] = L'\0';
+        m_unusedNames += length - name.size();
+        return offset;
+    }
+
+    if (!shared)
+    {
+        m_unusedNames += length + 1;
+    }
+    return _AppendName(name);
+}
+
+void CPowerRenameItemStore::_CompactNamesIfNeeded()
+{
+    // Compacting once half of the arena is unused keeps renames amortized constant time
+    if (m_unusedNames <= m_names.size() / 2)
+    {
+        return;
+    }
+
+    std::vector<wchar_t> names;
+    names.reserve(m_names.size() - m_unusedNames);
+    auto append = [&names](PCWSTR name) {
+        const auto offset = static_cast<uint32_t>(names.size());
+        names.insert(names.end(), name, name + wcslen(name) + 1);
+        return offset;
+    };
+
+    for (size_t i = 0; i < m_leafOffset.size(); i++)
+    {
+        const uint32_t leafOffset = m_leafOffset[i];
+        const uint32_t originalNameOffset = m_originalNameOffset[i];
+        m_leafOffset[i] = append(&m_names[leafOffset]);
+        m_originalNameOffset[i] = originalNameOffset == leafOffset ? m_leafOffset[i] : append(&m_names[originalNameOffset]);
+    }
+
+    m_names.swap(names);
+    m_unusedNames = 0;
+}
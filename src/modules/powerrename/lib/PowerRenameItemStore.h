@@ -0,0 +1,53 @@
+#pragma once
+#include "pch.h"
+#include "srwlock.h"
+
+#include <deque>
+#include <string_view>
+#include <unordered_map>
+
+// Paths and original names of the items created by one item factory, kept as a struct of arrays.
+// Parent folders are interned and names are stored back to back in a single arena, so an item
+// only costs its name and a few indices instead of two separately allocated strings.
+class CPowerRenameItemStore
+{
+public:
+    // Returns the index of the new item, whose original name is the last component of the path
+    UINT Add(_In_ PCWSTR path);
+
+    HRESULT GetPath(_In_ UINT index, _Outptr_ PWSTR* path);
+    std::wstring GetPath(_In_ UINT index);
+    HRESULT PutPath(_In_ UINT index, _In_ PCWSTR path);
+
+    HRESULT GetOriginalName(_In_ UINT index, _Outptr_ PWSTR* originalName);
+    HRESULT PutOriginalName(_In_ UINT index, _In_ PCWSTR originalName);
+    // Same as lstrcmp with the original name
+    int CompareOriginalName(_In_ UINT index, _In_ PCWSTR name);
+
+    // Bytes used by all items, including the interned parent folders
+    size_t GetMemoryUsage();
+
+private:
+    uint32_t _InternParent(std::wstring_view parent);
+    uint32_t _AppendName(std::wstring_view name);
+    // Writes the name over the one at the offset when it fits and isn't shared, otherwise appends it
+    uint32_t _ReplaceName(uint32_t offset, bool shared, std::wstring_view name);
+    void _CompactNamesIfNeeded();
+
+    CSRWLock m_lock;
+
+    // Parent folders including the trailing separator. A deque never moves its elements,
+    // so the map keys can point into them.
+    std::deque<std::wstring> m_parents;
+    std::unordered_map<std::wstring_view, uint32_t> m_parentIndices;
+
+    // Null-terminated names back to back
+    std::vector<wchar_t> m_names;
+    // Characters of m_names no longer used by any item, reclaimed by compacting
+    size_t m_unusedNames = 0;
+
+    // Per item. Initially the original name and the last path component share the same name.
+    std::vector<uint32_t> m_parentIndex;
+    std::vector<uint32_t> m_leafOffset;
+    std::vector<uint32_t> m_originalNameOffset;
+};
@@ -4,9 +4,12 @@
 #include <algorithm>
 #include <shlobj.h>
 #include <cstring>
+#include <mutex>
+#include <thread>
 #include "helpers.h"
 #include "trace.h"
 #include <Renaming.h>
+#include <Enumerating.h>
 
 namespace fs = std::filesystem;
 
@@ -15,6 +18,18 @@ extern HINSTANCE g_hostHInst;
 // The default FOF flags to use in the rename operations
 #define FOF_DEFAULTFLAGS (FOF_ALLOWUNDO | FOFX_ADDUNDORECORD | FOFX_SHOWELEVATIONPROMPT | FOF_RENAMEONCOLLISION)
 
+// Custom messages for worker threads
+enum
+{
+    SRM_REGEX_ITEMS_UPDATED = (WM_APP + 1), // Chunk of rename items processed by regex worker thread
+    SRM_REGEX_ITEM_RENAMED_KEEP_UI, // Single rename item processed by rename worker thread in case UI remains opened
+    SRM_REGEX_STARTED, // RegEx operation was started
+    SRM_REGEX_CANCELED, // Regex operation was canceled
+    SRM_REGEX_COMPLETE, // Regex worker thread completed
+    SRM_FILEOP_COMPLETE, // File Operation worker thread completed
+    SRM_PREVIEW_REQUESTED // Enumeration thread asked to preview the items added so far
+};
+
 IFACEMETHODIMP_(ULONG)
 CPowerRenameManager::AddRef()
 {
@@ -83,7 +98,9 @@ IFACEMETHODIMP CPowerRenameManager::UnAdvise(_In_ DWORD cookie)
 
 IFACEMETHODIMP CPowerRenameManager::Start()
 {
-    return E_NOTIMPL;
+    // The enumeration runs on its own thread, so the preview is started by the thread that
+    // owns the manager, like the other regex operations
+    return PostMessage(m_hwndMessage, SRM_PREVIEW_REQUESTED, 0, 0) ? S_OK : HRESULT_FROM_WIN32(GetLastError());
 }
 
 IFACEMETHODIMP CPowerRenameManager::Stop()
@@ -502,17 +519,6 @@ HRESULT CPowerRenameManager::_Init()
     return S_OK;
 }
 
-// Custom messages for worker threads
-enum
-{
-    SRM_REGEX_ITEM_UPDATED = (WM_APP + 1), // Single rename item processed by regex worker thread
-    SRM_REGEX_ITEM_RENAMED_KEEP_UI, // Single rename item processed by rename worker thread in case UI remains opened
-    SRM_REGEX_STARTED, // RegEx operation was started
-    SRM_REGEX_CANCELED, // Regex operation was canceled
-    SRM_REGEX_COMPLETE, // Regex worker thread completed
-    SRM_FILEOP_COMPLETE // File Operation worker thread completed
-};
-
 struct WorkerThreadData
 {
     HWND hwndManager = nullptr;
@@ -520,8 +526,93 @@ struct WorkerThreadData
     HANDLE cancelEvent = nullptr;
     HWND hwndParent = nullptr;
     CComPtr<IPowerRenameManager> spsrm;
+    std::vector<CComPtr<IPowerRenameItem>> items;
 };
 
+namespace
+{
+    // Number of items a regex worker processes before checking for cancellation and reporting progress
+    constexpr size_t REGEX_WORKER_CHUNK_SIZE = 128;
+
+    // Calls processChunk(first, last) for consecutive chunks of [0, itemCount) on up to threadCount threads,
+    // including the calling one. Returns false if the cancel event was signaled before all chunks were processed.
+    // If processing a chunk throws, no further chunks are started and the exception is rethrown here.
+    template<typename ProcessChunk>
+    bool ForEachItemChunk(const WorkerThreadData& wtd, const size_t itemCount, const size_t threadCount, const ProcessChunk& processChunk)
+    {
+        const size_t chunkCount = (itemCount + REGEX_WORKER_CHUNK_SIZE - 1) / REGEX_WORKER_CHUNK_SIZE;
+        std::atomic<size_t> nextChunk = 0;
+        std::atomic<bool> stop = false;
+        std::atomic<bool> canceled = false;
+        std::exception_ptr error;
+        std::mutex errorMutex;
+
+        auto worker = [&] {
+            while (!stop)
+            {
+                const size_t chunk = nextChunk++;
+                if (chunk >= chunkCount)
+                {
+                    break;
+                }
+
+                if (WaitForSingleObject(wtd.cancelEvent, 0) == WAIT_OBJECT_0)
+                {
+                    canceled = true;
+                    stop = true;
+                    break;
+                }
+
+                const size_t first = chunk * REGEX_WORKER_CHUNK_SIZE;
+                const size_t last = std::min(first + REGEX_WORKER_CHUNK_SIZE, itemCount);
+                try
+                {
+                    processChunk(first, last);
+                }
+                catch (...)
+                {
+                    std::scoped_lock lock(errorMutex);
+                    if (!error)
+                    {
+                        error = std::current_exception();
+                    }
+                    stop = true;
+                    break;
+                }
+
+                PostMessage(wtd.hwndManager, SRM_REGEX_ITEMS_UPDATED, GetCurrentThreadId(), static_cast<LPARAM>(last - first));
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for (size_t i = 1; i < std::min(threadCount, chunkCount); ++i)
+        {
+            threads.emplace_back([&] {
+                const HRESULT hr = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+                worker();
+                if (SUCCEEDED(hr))
+                {
+                    CoUninitialize();
+                }
+            });
+        }
+
+        worker();
+
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+
+        if (error)
+        {
+            std::rethrow_exception(error);
+        }
+
+        return !canceled;
+    }
+}
+
 // Msg-only worker window proc for communication from our worker threads
 LRESULT CALLBACK CPowerRenameManager::s_msgWndProc(_In_ HWND hwnd, _In_ UINT uMsg, _In_ WPARAM wParam, _In_ LPARAM lParam)
 {
@@ -553,7 +644,7 @@ LRESULT CPowerRenameManager::_WndProc(_In_ HWND hwnd, _In_ UINT msg, _In_ WPARAM
 
     switch (msg)
     {
-    case SRM_REGEX_ITEM_UPDATED:
+    case SRM_REGEX_ITEMS_UPDATED:
     {
         // Do nothing.
         break;
@@ -580,6 +671,10 @@ LRESULT CPowerRenameManager::_WndProc(_In_ HWND hwnd, _In_ UINT msg, _In_ WPARAM
         _OnRegExCompleted(static_cast<DWORD>(wParam));
         break;
 
+    case SRM_PREVIEW_REQUESTED:
+        _OnPreviewRequested();
+        break;
+
     default:
         lRes = DefWindowProc(hwnd, msg, wParam, lParam);
         break;
@@ -890,6 +985,15 @@ HRESULT CPowerRenameManager::_CreateRegExWorkerThread()
         pwtd->cancelEvent = m_cancelRegExWorkerEvent;
         pwtd->hwndParent = m_hwndParent;
         pwtd->spsrm = this;
+        {
+            // Looking items up by index walks the map, so take them all at once
+            CSRWSharedAutoLock lock(&m_lockItems);
+            pwtd->items.reserve(m_renameItems.size());
+            for (const auto& [id, item] : m_renameItems)
+            {
+                pwtd->items.emplace_back(item);
+            }
+        }
         m_regExWorkerThreadHandle = CreateThread(nullptr, 0, s_regexWorkerThread, pwtd, 0, nullptr);
         hr = E_FAIL;
         if (m_regExWorkerThreadHandle)
@@ -922,25 +1026,38 @@ DWORD WINAPI CPowerRenameManager::s_regexWorkerThread(_In_ void* pv)
 
                 winrt::check_hresult(pwtd->spsrm->GetRenameRegEx(&spRenameRegEx));
 
-                UINT itemCount = 0;
-                unsigned long itemEnumIndex = 0;
-                winrt::check_hresult(pwtd->spsrm->GetItemCount(&itemCount));
-
-                for (UINT u = 0; u < itemCount; u++)
-                {
-                    // Check if cancel event is signaled
-                    if (WaitForSingleObject(pwtd->cancelEvent, 0) == WAIT_OBJECT_0)
+                DWORD flags = 0;
+                winrt::check_hresult(spRenameRegEx->GetFlags(&flags));
+
+                PWSTR replaceTerm = nullptr;
+                winrt::check_hresult(spRenameRegEx->GetReplaceTerm(&replaceTerm));
+                const bool useFileTime = isFileTimeUsed(replaceTerm);
+                // An item's enumeration index is the number of items renamed before it. Whether an item is renamed
+                // can depend on the index it gets (e.g. a1 stays a1 at index 0 of a${start=1}), so an item's index
+                // is only known once the items before it are done
+                const bool useEnumeration = (flags & EnumerateItems) && replaceTerm && !parseEnumOptions(replaceTerm).empty();
+                CoTaskMemFree(replaceTerm);
+
+                // File time tokens are expanded from a time stored in the shared regex object, so such items
+                // have to be processed one at a time. So do enumerated items, in order
+                const size_t threadCount = useFileTime || useEnumeration ? 1 : std::max(std::thread::hardware_concurrency(), 1u);
+                auto& items = pwtd->items;
+
+                // Only used with a single thread, which processes the chunks in order
+                unsigned long enumIndex = 0;
+                const bool completed = ForEachItemChunk(*pwtd, items.size(), threadCount, [&](const size_t first, const size_t last) {
+                    for (size_t i = first; i < last; ++i)
                     {
-                        // Canceled from manager
-                        // Send the manager thread the canceled message
-                        PostMessage(pwtd->hwndManager, SRM_REGEX_CANCELED, GetCurrentThreadId(), 0);
-                        break;
+                        unsigned long itemEnumIndex = 0;
+                        DoRename(spRenameRegEx, useEnumeration ? enumIndex : itemEnumIndex, items[i]);
                     }
+                });
 
-                    CComPtr<IPowerRenameItem> spItem;
-                    winrt::check_hresult(pwtd->spsrm->GetItemByIndex(u, &spItem));
-
-                    DoRename(spRenameRegEx, itemEnumIndex, spItem);
+                if (!completed)
+                {
+                    // Canceled from manager
+                    // Send the manager thread the canceled message
+                    PostMessage(pwtd->hwndManager, SRM_REGEX_CANCELED, GetCurrentThreadId(), 0);
                 }
             }
 
@@ -1097,6 +1214,20 @@ void CPowerRenameManager::_OnRegExCompleted(_In_ DWORD threadId)
     }
 }
 
+void CPowerRenameManager::_OnPreviewRequested()
+{
+    // Preview the items added so far. Nothing to do until there is something to search for.
+    PWSTR searchTerm = nullptr;
+    if (m_spRegEx && SUCCEEDED(m_spRegEx->GetSearchTerm(&searchTerm)) && searchTerm != nullptr)
+    {
+        if (searchTerm[0] != L'\0')
+        {
+            _PerformRegExRename();
+        }
+        CoTaskMemFree(searchTerm);
+    }
+}
+
 void CPowerRenameManager::_OnRenameStarted()
 {
     CSRWSharedAutoLock lock(&m_lockEvents);
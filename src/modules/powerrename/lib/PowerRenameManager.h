@@ -67,6 +67,7 @@ protected:
     void _OnRegExStarted(_In_ DWORD threadId);
     void _OnRegExCanceled(_In_ DWORD threadId);
     void _OnRegExCompleted(_In_ DWORD threadId);
+    void _OnPreviewRequested();
     void _OnRenameStarted();
     void _OnRenameCompleted();
 
@@ -11,6 +11,39 @@
 using std::conditional_t;
 using std::regex_error;
 
+struct CPowerRenameRegEx::SearchPattern
+{
+    std::optional<std::wregex> stdRegex;
+    std::optional<boost::wregex> boostRegex;
+};
+
+namespace
+{
+    template<bool Std, class Regex = conditional_t<Std, std::wregex, boost::wregex>, class Options = decltype(Regex::icase)>
+    Regex CompileRegex(const std::wstring& searchTerm, const bool caseInsensitive)
+    {
+        return Regex(searchTerm, Options::ECMAScript | (caseInsensitive ? Options::icase : Options{}));
+    }
+
+    template<bool Std, class Regex = conditional_t<Std, std::wregex, boost::wregex>>
+    void RegexReplaceEx(std::wstring& result, const std::wstring& source, const Regex& pattern, const std::wstring& replaceTerm, const bool matchAll)
+    {
+        using Flags = conditional_t<Std, std::regex_constants::match_flag_type, boost::regex_constants::match_flags>;
+        const auto flags = matchAll ? Flags::match_default : Flags::format_first_only;
+
+        regex_replace(std::back_inserter(result), source.begin(), source.end(), pattern, replaceTerm, flags);
+    }
+
+    std::wstring EscapeGroupReferences(const std::wstring& replaceTerm)
+    {
+        static const std::wregex zeroGroupRegex(L"(([^\\$]|^)(\\$\\$)*)\\$[0]");
+        static const std::wregex otherGroupsRegex(L"(([^\\$]|^)(\\$\\$)*)\\$([1-9])");
+
+        std::wstring result = regex_replace(replaceTerm, zeroGroupRegex, L"$1$$$0");
+        return regex_replace(result, otherGroupsRegex, L"$1$0$4");
+    }
+}
+
 IFACEMETHODIMP_(ULONG)
 CPowerRenameRegEx::AddRef()
 {
@@ -107,6 +140,7 @@ IFACEMETHODIMP CPowerRenameRegEx::PutSearchTerm(_In_ PCWSTR searchTerm, bool for
             {
                 hr = SHStrDup(searchTerm, &m_searchTerm);
             }
+            _CompileSearchPattern();
         }
     }
 
@@ -250,6 +284,7 @@ IFACEMETHODIMP CPowerRenameRegEx::PutReplaceTerm(_In_ PCWSTR replaceTerm, bool f
                 hr = _OnEnumerateOrRandomizeItemsChanged();
             else
                 hr = SHStrDup(replaceTerm, &m_replaceTerm);
+            _UpdateCompiledReplaceTerm();
         }
     }
 
@@ -276,20 +311,30 @@ IFACEMETHODIMP CPowerRenameRegEx::PutFlags(_In_ DWORD flags)
         const bool refreshReplaceTerm =
             (!!(m_flags & EnumerateItems) != newEnumerate) ||
             (!!(m_flags & RandomizeItems) != newRandomizer);
+        const bool recompileSearchTerm = (m_flags ^ flags) & (UseRegularExpressions | CaseSensitive);
 
         m_flags = flags;
 
-        if (refreshReplaceTerm)
+        if (refreshReplaceTerm || recompileSearchTerm)
         {
             CSRWExclusiveAutoLock lock(&m_lock);
-            if (newEnumerate || newRandomizer)
+            if (refreshReplaceTerm)
             {
-                _OnEnumerateOrRandomizeItemsChanged();
+                if (newEnumerate || newRandomizer)
+                {
+                    _OnEnumerateOrRandomizeItemsChanged();
+                }
+                else
+                {
+                    CoTaskMemFree(m_replaceTerm);
+                    SHStrDup(m_RawReplaceTerm.c_str(), &m_replaceTerm);
+                }
+                _UpdateCompiledReplaceTerm();
             }
-            else
+
+            if (recompileSearchTerm)
             {
-                CoTaskMemFree(m_replaceTerm);
-                SHStrDup(m_RawReplaceTerm.c_str(), &m_replaceTerm);
+                _CompileSearchPattern();
             }
         }
         _OnFlagsChanged();
@@ -359,18 +404,42 @@ CPowerRenameRegEx::~CPowerRenameRegEx()
     CoTaskMemFree(m_replaceTerm);
 }
 
-template<bool Std, class Regex = conditional_t<Std, std::wregex, boost::wregex>, class Options = decltype(Regex::icase)>
-static std::wstring RegexReplaceEx(const std::wstring& source, const std::wstring& searchTerm, const std::wstring& replaceTerm, const bool matchAll, const bool caseInsensitive)
+void CPowerRenameRegEx::_CompileSearchPattern()
 {
-    Regex pattern(searchTerm, Options::ECMAScript | (caseInsensitive ? Options::icase : Options{}));
-
-    using Flags = conditional_t<Std, std::regex_constants::match_flag_type, boost::regex_constants::match_flags>;
-    const auto flags = matchAll ? Flags::match_default : Flags::format_first_only;
+    m_searchPattern.reset();
+    if (!(m_flags & UseRegularExpressions) || !m_searchTerm || wcslen(m_searchTerm) == 0)
+    {
+        return;
+    }
 
-    return regex_replace(source, pattern, replaceTerm, flags);
+    const std::wstring searchTerm{ m_searchTerm };
+    const bool caseInsensitive = !(m_flags & CaseSensitive);
+    auto pattern = std::make_unique<SearchPattern>();
+    try
+    {
+        if (_useBoostLib)
+        {
+            pattern->boostRegex = CompileRegex<false>(searchTerm, caseInsensitive);
+        }
+        else
+        {
+            pattern->stdRegex = CompileRegex<true>(searchTerm, caseInsensitive);
+        }
+        m_searchPattern = std::move(pattern);
+    }
+    catch (const regex_error&)
+    {
+    }
+    catch (const boost::regex_error&)
+    {
+    }
 }
 
-static constexpr std::array RegexReplaceDispatch = { RegexReplaceEx<true>, RegexReplaceEx<false> };
+void CPowerRenameRegEx::_UpdateCompiledReplaceTerm()
+{
+    m_regexReplaceTerm = m_replaceTerm ? EscapeGroupReferences(m_replaceTerm) : std::wstring{};
+    m_fileTimeTemplate = m_replaceTerm ? DatedFileNameTemplate(m_replaceTerm) : DatedFileNameTemplate{};
+}
 
 HRESULT CPowerRenameRegEx::Replace(_In_ PCWSTR source, _Outptr_ PWSTR* result, unsigned long& enumIndex)
 {
@@ -385,12 +454,11 @@ HRESULT CPowerRenameRegEx::Replace(_In_ PCWSTR source, _Outptr_ PWSTR* result, u
     std::wstring res = source;
     try
     {
-        // TODO: creating the regex could be costly.  May want to cache this.
         wchar_t newReplaceTerm[MAX_PATH] = { 0 };
         bool fileTimeErrorOccurred = false;
         if (m_useFileTime)
         {
-            if (FAILED(GetDatedFileName(newReplaceTerm, ARRAYSIZE(newReplaceTerm), m_replaceTerm, m_fileTime)))
+            if (FAILED(m_fileTimeTemplate.Expand(newReplaceTerm, ARRAYSIZE(newReplaceTerm), m_fileTime)))
                 fileTimeErrorOccurred = true;
         }
 
@@ -412,9 +480,6 @@ HRESULT CPowerRenameRegEx::Replace(_In_ PCWSTR source, _Outptr_ PWSTR* result, u
             replaceTerm = m_replaceTerm;
         }
 
-        static const std::wregex zeroGroupRegex(L"(([^\\$]|^)(\\$\\$)*)\\$[0]");
-        static const std::wregex otherGroupsRegex(L"(([^\\$]|^)(\\$\\$)*)\\$([1-9])");
-
         if ((m_flags & EnumerateItems) || (m_flags & RandomizeItems))
         {
             int ei = 0; // Enumerators index
@@ -490,11 +555,32 @@ HRESULT CPowerRenameRegEx::Replace(_In_ PCWSTR source, _Outptr_ PWSTR* result, u
         bool replacedSomething = false;
         if (m_flags & UseRegularExpressions)
         {
-            replaceTerm = regex_replace(replaceTerm, zeroGroupRegex, L"$1$$$0");
-            replaceTerm = regex_replace(replaceTerm, otherGroupsRegex, L"$1$0$4");
+            if (!m_searchPattern)
+            {
+                return E_FAIL;
+            }
+
+            // The escaped replace term only has to be recomputed when it differs per item
+            const bool replaceTermPerItem = (m_flags & EnumerateItems) || (m_flags & RandomizeItems) || m_useFileTime;
+            if (replaceTermPerItem)
+            {
+                replaceTerm = EscapeGroupReferences(replaceTerm);
+            }
+            const std::wstring& regexReplaceTerm = replaceTermPerItem ? replaceTerm : m_regexReplaceTerm;
+
+            thread_local std::wstring buffer;
+            buffer.clear();
+            if (m_searchPattern->boostRegex)
+            {
+                RegexReplaceEx<false>(buffer, originalSource, *m_searchPattern->boostRegex, regexReplaceTerm, m_flags & MatchAllOccurrences);
+            }
+            else
+            {
+                RegexReplaceEx<true>(buffer, originalSource, *m_searchPattern->stdRegex, regexReplaceTerm, m_flags & MatchAllOccurrences);
+            }
 
-            res = RegexReplaceDispatch[_useBoostLib](source, m_searchTerm, replaceTerm, m_flags & MatchAllOccurrences, !(m_flags & CaseSensitive));
-            replacedSomething = originalSource != res;
+            replacedSomething = originalSource != buffer;
+            res = buffer;
         }
         else
         {
@@ -2,6 +2,7 @@
 #include "pch.h"
 #include "srwlock.h"
 
+#include "DatedFileName.h"
 #include "Enumerating.h"
 
 #include "Randomizer.h"
@@ -42,6 +43,8 @@ protected:
     void _OnFlagsChanged();
     void _OnFileTimeChanged();
     HRESULT _OnEnumerateOrRandomizeItemsChanged();
+    void _CompileSearchPattern();
+    void _UpdateCompiledReplaceTerm();
 
     size_t _Find(std::wstring data, std::wstring toSearch, bool caseInsensitive, size_t pos);
 
@@ -51,6 +54,14 @@ protected:
     PWSTR m_replaceTerm = nullptr;
     std::wstring m_RawReplaceTerm; 
 
+    // m_searchTerm compiled with the current flags, null if regular expressions aren't used or the pattern is invalid
+    struct SearchPattern;
+    std::unique_ptr<const SearchPattern> m_searchPattern;
+    // m_replaceTerm with $0 and $N group references escaped for regex_replace
+    std::wstring m_regexReplaceTerm;
+    // m_replaceTerm split into text and file time tokens
+    DatedFileNameTemplate m_fileTimeTemplate;
+
     SYSTEMTIME m_fileTime = { 0 };
     bool m_useFileTime = false;
 
@@ -611,6 +611,95 @@ TEST_METHOD (VerifyRandomizerRegExAllBackToBack)
     CoTaskMemFree(result);
 }
 
+TEST_METHOD (VerifySearchPatternRecompiledOnChange)
+{
+    CComPtr<IPowerRenameRegEx> renameRegEx;
+    Assert::IsTrue(CPowerRenameRegEx::s_CreateInstance(&renameRegEx) == S_OK);
+    DWORD flags = UseRegularExpressions;
+    Assert::IsTrue(renameRegEx->PutFlags(flags) == S_OK);
+    PWSTR result = nullptr;
+    Assert::IsTrue(renameRegEx->PutSearchTerm(L"(B)ar") == S_OK);
+    Assert::IsTrue(renameRegEx->PutReplaceTerm(L"$1az") == S_OK);
+    unsigned long index = {};
+    Assert::IsTrue(renameRegEx->Replace(L"foobar", &result, index) == S_OK);
+    Assert::AreEqual(L"foobaz", result);
+    CoTaskMemFree(result);
+
+    Assert::IsTrue(renameRegEx->PutFlags(flags | CaseSensitive) == S_OK);
+    Assert::IsTrue(renameRegEx->Replace(L"foobar", &result, index) == S_OK);
+    Assert::AreEqual(L"foobar", result);
+    CoTaskMemFree(result);
+
+    Assert::IsTrue(renameRegEx->PutSearchTerm(L"(b)ar") == S_OK);
+    Assert::IsTrue(renameRegEx->Replace(L"foobar", &result, index) == S_OK);
+    Assert::AreEqual(L"foobaz", result);
+    CoTaskMemFree(result);
+
+    Assert::IsTrue(renameRegEx->PutReplaceTerm(L"$1$1") == S_OK);
+    Assert::IsTrue(renameRegEx->Replace(L"foobar", &result, index) == S_OK);
+    Assert::AreEqual(L"foobb", result);
+    CoTaskMemFree(result);
+
+    Assert::IsTrue(renameRegEx->PutSearchTerm(L"(b") == S_OK);
+    Assert::IsTrue(renameRegEx->Replace(L"foobar", &result, index) == E_FAIL);
+    Assert::IsTrue(result == nullptr);
+
+    Assert::IsTrue(renameRegEx->PutSearchTerm(L"(o)b") == S_OK);
+    Assert::IsTrue(renameRegEx->Replace(L"foobar", &result, index) == S_OK);
+    Assert::AreEqual(L"foooar", result);
+    CoTaskMemFree(result);
+}
+
+// Measures how many names per second Replace renames with a cached pattern, against recompiling the pattern for
+// every name as Replace used to. Toggling the CaseSensitive flag between names forces the recompilation.
+TEST_METHOD (ReplaceThroughputBenchmark)
+{
+    constexpr int itemCount = 20000;
+
+    CComPtr<IPowerRenameRegEx> renameRegEx;
+    Assert::IsTrue(CPowerRenameRegEx::s_CreateInstance(&renameRegEx) == S_OK);
+    const DWORD flags = UseRegularExpressions | MatchAllOccurrences;
+    Assert::IsTrue(renameRegEx->PutFlags(flags) == S_OK);
+    Assert::IsTrue(renameRegEx->PutSearchTerm(L"IMG_(\\d{4})(\\d{2})(\\d{2})_(\\d+)") == S_OK);
+    Assert::IsTrue(renameRegEx->PutReplaceTerm(L"$1-$2-$3 photo $4") == S_OK);
+
+    std::vector<std::wstring> names;
+    names.reserve(itemCount);
+    for (int i = 0; i < itemCount; i++)
+    {
+        names.push_back(std::format(L"IMG_2024{:02}{:02}_{:04}.jpg", i % 12 + 1, i % 28 + 1, i));
+    }
+
+    const auto run = [&](bool recompile) {
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < itemCount; i++)
+        {
+            if (recompile)
+            {
+                Assert::IsTrue(renameRegEx->PutFlags(i % 2 ? flags : flags | CaseSensitive) == S_OK);
+            }
+
+            PWSTR result = nullptr;
+            unsigned long index = {};
+            Assert::IsTrue(renameRegEx->Replace(names[i].c_str(), &result, index) == S_OK);
+            CoTaskMemFree(result);
+        }
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        return itemCount / elapsed.count();
+    };
+
+    const double recompiledItemsPerSecond = run(true);
+    Assert::IsTrue(renameRegEx->PutFlags(flags) == S_OK);
+    const double cachedItemsPerSecond = run(false);
+    Logger::WriteMessage(std::format(L"Replace: {:.0f} items/s with the cached pattern, {:.0f} items/s recompiling it for every item\n", cachedItemsPerSecond, recompiledItemsPerSecond).c_str());
+
+    PWSTR result = nullptr;
+    unsigned long index = {};
+    Assert::IsTrue(renameRegEx->Replace(names[41].c_str(), &result, index) == S_OK);
+    Assert::AreEqual(L"2024-06-14 photo 0041.jpg", result);
+    CoTaskMemFree(result);
+}
+
 #ifndef TESTS_PARTIAL
 };
 }
@@ -0,0 +1,136 @@
+#include "pch.h"
+#include <DatedFileName.h>
+#include "Helpers.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace DatedFileNameTests
+{
+    TEST_CLASS (SimpleTests)
+    {
+    public:
+        // The regex_replace chain GetDatedFileName used before DatedFileNameTemplate
+        static std::wstring RegexDatedFileName(const std::wstring& source, SYSTEMTIME fileTime)
+        {
+            const auto tokenRegex = [](const std::wstring& token) { return std::wregex(L"(([^\\$]|^)(\\$\\$)*)\\$" + token); };
+            static const std::array regexes = { tokenRegex(L"YYYY"), tokenRegex(L"YY"), tokenRegex(L"Y"), tokenRegex(L"MMMM"), tokenRegex(L"MMM"), tokenRegex(L"MM"), tokenRegex(L"M"), tokenRegex(L"DDDD"), tokenRegex(L"DDD"), tokenRegex(L"DD"), tokenRegex(L"D"), tokenRegex(L"hh"), tokenRegex(L"h"), tokenRegex(L"mm"), tokenRegex(L"m"), tokenRegex(L"ss"), tokenRegex(L"s"), tokenRegex(L"fff"), tokenRegex(L"ff"), tokenRegex(L"f") };
+
+            wchar_t localeName[LOCALE_NAME_MAX_LENGTH];
+            if (GetUserDefaultLocaleName(localeName, LOCALE_NAME_MAX_LENGTH) == 0)
+            {
+                StringCchCopy(localeName, LOCALE_NAME_MAX_LENGTH, L"en_US");
+            }
+
+            const auto name = [&](PCWSTR format) {
+                wchar_t formattedDate[MAX_PATH] = { 0 };
+                GetDateFormatEx(localeName, NULL, &fileTime, format, formattedDate, MAX_PATH, NULL);
+                formattedDate[0] = towupper(formattedDate[0]);
+                return std::wstring(formattedDate);
+            };
+            const auto number = [](int value, int digits) {
+                wchar_t formatted[MAX_PATH] = { 0 };
+                StringCchPrintf(formatted, MAX_PATH, L"%0*d", digits, value);
+                return std::wstring(formatted);
+            };
+
+            const std::array values = { number(fileTime.wYear, 4), number(fileTime.wYear % 100, 2), number(fileTime.wYear % 10, 1), name(L"MMMM"), name(L"MMM"), number(fileTime.wMonth, 2), number(fileTime.wMonth, 1), name(L"dddd"), name(L"ddd"), number(fileTime.wDay, 2), number(fileTime.wDay, 1), number(fileTime.wHour, 2), number(fileTime.wHour, 1), number(fileTime.wMinute, 2), number(fileTime.wMinute, 1), number(fileTime.wSecond, 2), number(fileTime.wSecond, 1), number(fileTime.wMilliseconds, 3), number(fileTime.wMilliseconds / 10, 2), number(fileTime.wMilliseconds / 100, 1) };
+
+            std::wstring result = source;
+            for (size_t i = 0; i < regexes.size(); i++)
+            {
+                result = std::regex_replace(result, regexes[i], L"$01" + values[i]);
+            }
+            return result;
+        }
+
+        // The regex searches isFileTimeUsed used before DatedFileNameTemplate
+        static bool RegexFileTimeUsed(const std::wstring& source)
+        {
+            static const std::array patterns = { std::wregex{ L"(([^\\$]|^)(\\$\\$)*)\\$Y" }, std::wregex{ L"(([^\\$]|^)(\\$\\$)*)\\$M" }, std::wregex{ L"(([^\\$]|^)(\\$\\$)*)\\$D" }, std::wregex{ L"(([^\\$]|^)(\\$\\$)*)\\$h" }, std::wregex{ L"(([^\\$]|^)(\\$\\$)*)\\$m" }, std::wregex{ L"(([^\\$]|^)(\\$\\$)*)\\$s" }, std::wregex{ L"(([^\\$]|^)(\\$\\$)*)\\$f" } };
+            return std::any_of(patterns.begin(), patterns.end(), [&](const std::wregex& pattern) { return std::regex_search(source, pattern); });
+        }
+
+        static std::wstring Expand(const std::wstring& source, SYSTEMTIME fileTime)
+        {
+            wchar_t result[MAX_PATH] = { 0 };
+            Assert::IsTrue(GetDatedFileName(result, ARRAYSIZE(result), source.c_str(), fileTime) == S_OK);
+            return result;
+        }
+
+        TEST_CLASS_INITIALIZE(ClassInitialize)
+        {
+            std::locale::global(std::locale(""));
+        }
+
+        TEST_METHOD (VerifyMatchesRegexReplace)
+        {
+            // Every replace term of up to 4 characters made of '$', token letters and other text. The regex chain can't
+            // match the same token twice in a row ("$D$D"), those cases are covered by VerifyRepeatedTokens.
+            const SYSTEMTIME fileTime = { 2020, 7, 5, 3, 22, 6, 42, 453 };
+            const std::wstring alphabet = L"$YMDhmsfx";
+            const std::wregex repeatedToken(L"\\$(Y+|M+|D+|h+|m+|s+|f+)\\$");
+            for (size_t length = 1; length <= 4; length++)
+            {
+                std::wstring source(length, L' ');
+                size_t combinations = 1;
+                for (size_t i = 0; i < length; i++)
+                {
+                    combinations *= alphabet.size();
+                }
+
+                for (size_t combination = 0; combination < combinations; combination++)
+                {
+                    for (size_t i = 0, rest = combination; i < length; i++, rest /= alphabet.size())
+                    {
+                        source[i] = alphabet[rest % alphabet.size()];
+                    }
+
+                    Assert::AreEqual(RegexFileTimeUsed(source), isFileTimeUsed(source.c_str()), source.c_str());
+                    if (!std::regex_search(source, repeatedToken))
+                    {
+                        Assert::AreEqual(RegexDatedFileName(source, fileTime), Expand(source, fileTime), source.c_str());
+                    }
+                }
+            }
+        }
+
+        TEST_METHOD (VerifyRepeatedTokens)
+        {
+            const SYSTEMTIME fileTime = { 2020, 7, 5, 3, 22, 6, 42, 453 };
+            Assert::AreEqual(std::wstring(L"33"), Expand(L"$D$D", fileTime));
+            Assert::AreEqual(std::wstring(L"20202020"), Expand(L"$YYYY$YYYY", fileTime));
+            Assert::AreEqual(std::wstring(L"0707"), Expand(L"$MM$MM", fileTime));
+            Assert::AreEqual(std::wstring(L"22$$22"), Expand(L"$hh$$$hh", fileTime));
+        }
+
+        TEST_METHOD (VerifyEscapedTokens)
+        {
+            const SYSTEMTIME fileTime = { 2020, 7, 5, 3, 22, 6, 42, 453 };
+            Assert::AreEqual(std::wstring(L"$$YYYY"), Expand(L"$$YYYY", fileTime));
+            Assert::AreEqual(std::wstring(L"$$2020"), Expand(L"$$$YYYY", fileTime));
+            Assert::AreEqual(std::wstring(L"20Y-453f"), Expand(L"$YYY-$ffff", fileTime));
+            Assert::IsFalse(isFileTimeUsed(L"$$Y$$$$M"));
+            Assert::IsTrue(isFileTimeUsed(L"$$$s"));
+        }
+
+        TEST_METHOD (VerifyTemplateReuse)
+        {
+            DatedFileNameTemplate fileTimeTemplate(L"IMG_$YYYY$MM$DD_$hh$mm$ss");
+            Assert::IsTrue(fileTimeTemplate.UsesFileTime());
+
+            wchar_t result[MAX_PATH] = { 0 };
+            Assert::IsTrue(fileTimeTemplate.Expand(result, ARRAYSIZE(result), SYSTEMTIME{ 2020, 7, 5, 3, 22, 6, 42, 453 }) == S_OK);
+            Assert::AreEqual(L"IMG_20200703_220642", result);
+            Assert::IsTrue(fileTimeTemplate.Expand(result, ARRAYSIZE(result), SYSTEMTIME{ 1999, 12, 5, 31, 23, 59, 58, 0 }) == S_OK);
+            Assert::AreEqual(L"IMG_19991231_235958", result);
+        }
+
+        TEST_METHOD (VerifyResultTruncated)
+        {
+            wchar_t result[8] = { 0 };
+            Assert::IsTrue(GetDatedFileName(result, ARRAYSIZE(result), L"foo_$YYYY$MM", SYSTEMTIME{ 2020, 7, 5, 3, 22, 6, 42, 453 }) == STRSAFE_E_INSUFFICIENT_BUFFER);
+            Assert::AreEqual(L"foo_202", result);
+            Assert::IsTrue(GetDatedFileName(result, ARRAYSIZE(result), L"", SYSTEMTIME{ 2020, 7, 5, 3, 22, 6, 42, 453 }) == E_INVALIDARG);
+        }
+    };
+}
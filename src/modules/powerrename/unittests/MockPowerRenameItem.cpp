@@ -18,14 +18,11 @@ HRESULT CMockPowerRenameItem::CreateInstance(_In_opt_ PCWSTR path, _In_opt_ PCWS
 
 void CMockPowerRenameItem::Init(_In_opt_ PCWSTR path, _In_opt_ PCWSTR originalName, _In_ UINT depth, _In_ bool isFolder, _In_ SYSTEMTIME time)
 {
-    if (path != nullptr)
-    {
-        SHStrDup(path, &m_path);
-    }
+    m_storeIndex = m_store->Add(path != nullptr ? path : L"");
 
     if (originalName != nullptr)
     {
-        SHStrDup(originalName, &m_originalName);
+        m_store->PutOriginalName(m_storeIndex, originalName);
     }
 
     m_depth = depth;
@@ -7,6 +7,11 @@ class CMockPowerRenameItem :
     public CPowerRenameItem
 {
 public:
+    CMockPowerRenameItem() :
+        CPowerRenameItem(std::make_shared<CPowerRenameItemStore>())
+    {
+    }
+
     static HRESULT CreateInstance(_In_opt_ PCWSTR path, _In_opt_ PCWSTR originalName, _In_ UINT depth, _In_ bool isFolder, _In_ SYSTEMTIME time, _Outptr_ IPowerRenameItem** ppItem);
     void Init(_In_opt_ PCWSTR path, _In_opt_ PCWSTR originalName, _In_ UINT depth, _In_ bool isFolder, _In_ SYSTEMTIME time);
 };
@@ -0,0 +1,128 @@
+#include "pch.h"
+#include <PowerRenameItemStore.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace PowerRenameItemStoreTests
+{
+    TEST_CLASS (SimpleTests)
+    {
+    public:
+        static std::wstring GetOriginalName(CPowerRenameItemStore& store, UINT index)
+        {
+            PWSTR originalName = nullptr;
+            Assert::IsTrue(store.GetOriginalName(index, &originalName) == S_OK);
+            std::wstring result = originalName;
+            CoTaskMemFree(originalName);
+            return result;
+        }
+
+        TEST_METHOD (VerifyAddSplitsPath)
+        {
+            CPowerRenameItemStore store;
+            const UINT file = store.Add(L"c:\\foo\\bar.txt");
+            const UINT folder = store.Add(L"c:\\foo\\baz");
+
+            Assert::AreEqual(std::wstring(L"c:\\foo\\bar.txt"), store.GetPath(file));
+            Assert::AreEqual(std::wstring(L"bar.txt"), GetOriginalName(store, file));
+            Assert::AreEqual(std::wstring(L"c:\\foo\\baz"), store.GetPath(folder));
+            Assert::AreEqual(std::wstring(L"baz"), GetOriginalName(store, folder));
+            Assert::AreEqual(0, store.CompareOriginalName(file, L"bar.txt"));
+            Assert::AreNotEqual(0, store.CompareOriginalName(file, L"baz"));
+        }
+
+        TEST_METHOD (VerifyPutPathKeepsOriginalName)
+        {
+            CPowerRenameItemStore store;
+            const UINT index = store.Add(L"c:\\foo\\bar.txt");
+            const UINT sibling = store.Add(L"c:\\foo\\sibling.txt");
+
+            Assert::IsTrue(store.PutPath(index, L"c:\\renamed\\qux.txt") == S_OK);
+            Assert::IsTrue(store.PutOriginalName(index, L"qux.txt") == S_OK);
+
+            Assert::AreEqual(std::wstring(L"c:\\renamed\\qux.txt"), store.GetPath(index));
+            Assert::AreEqual(std::wstring(L"qux.txt"), GetOriginalName(store, index));
+            Assert::AreEqual(std::wstring(L"c:\\foo\\sibling.txt"), store.GetPath(sibling));
+        }
+
+        TEST_METHOD (VerifyRenamesReuseNames)
+        {
+            CPowerRenameItemStore store;
+            const UINT index = store.Add(L"c:\\foo\\a_long_original_name.txt");
+            const UINT sibling = store.Add(L"c:\\foo\\sibling.txt");
+
+            // The first rename can't reuse the name shared with the original name
+            Assert::IsTrue(store.PutPath(index, L"c:\\foo\\renamed_0.txt") == S_OK);
+            const size_t renamedOnce = store.GetMemoryUsage();
+
+            for (int i = 1; i < 10000; i++)
+            {
+                const std::wstring name = L"renamed_" + std::to_wstring(i % 10) + L".txt";
+                Assert::IsTrue(store.PutPath(index, (L"c:\\foo\\" + name).c_str()) == S_OK);
+                Assert::AreEqual(L"c:\\foo\\" + name, store.GetPath(index));
+            }
+
+            Assert::AreEqual(renamedOnce, store.GetMemoryUsage());
+            Assert::AreEqual(std::wstring(L"a_long_original_name.txt"), GetOriginalName(store, index));
+            Assert::AreEqual(std::wstring(L"c:\\foo\\sibling.txt"), store.GetPath(sibling));
+            Assert::AreEqual(std::wstring(L"sibling.txt"), GetOriginalName(store, sibling));
+        }
+
+        TEST_METHOD (VerifyLongerNamesAreCompacted)
+        {
+            CPowerRenameItemStore store;
+            for (int i = 0; i < 100; i++)
+            {
+                store.Add((L"c:\\foo\\" + std::to_wstring(i)).c_str());
+            }
+
+            // Each rename is longer than the last, so the old names are left behind until compacted
+            std::wstring name = L"x";
+            for (int i = 0; i < 100; i++)
+            {
+                name += L'x';
+                for (UINT index = 0; index < 100; index++)
+                {
+                    Assert::IsTrue(store.PutPath(index, (L"c:\\foo\\" + name).c_str()) == S_OK);
+                    Assert::IsTrue(store.PutOriginalName(index, name.c_str()) == S_OK);
+                }
+            }
+
+            // Without compacting, the arena would hold every name ever used, about 50 times the current ones
+            Assert::IsTrue(store.GetMemoryUsage() < 8 * 100 * 2 * (name.size() + 1) * sizeof(wchar_t));
+            for (UINT index = 0; index < 100; index++)
+            {
+                Assert::AreEqual(L"c:\\foo\\" + name, store.GetPath(index));
+                Assert::AreEqual(name, GetOriginalName(store, index));
+            }
+        }
+
+        TEST_METHOD (VerifyInvalidIndex)
+        {
+            CPowerRenameItemStore store;
+            PWSTR value = nullptr;
+            Assert::IsTrue(store.GetPath(0, &value) == E_FAIL);
+            Assert::IsTrue(store.GetOriginalName(0, &value) == E_FAIL);
+            Assert::IsTrue(store.PutPath(0, L"c:\\foo") == E_INVALIDARG);
+            Assert::IsTrue(store.PutOriginalName(0, L"foo") == E_INVALIDARG);
+            Assert::AreNotEqual(0, store.CompareOriginalName(0, L"foo"));
+        }
+
+        TEST_METHOD (VerifyParentFoldersAreShared)
+        {
+            CPowerRenameItemStore store;
+            const std::wstring parent = L"c:\\a\\fairly\\long\\parent\\folder\\name\\";
+            store.Add((parent + L"0").c_str());
+            const size_t singleItem = store.GetMemoryUsage();
+
+            for (int i = 1; i < 1000; i++)
+            {
+                store.Add((parent + std::to_wstring(i)).c_str());
+            }
+
+            // Each item costs its name and its indices, not another copy of the parent folder
+            Assert::IsTrue(store.GetMemoryUsage() - singleItem < 999 * (parent.size() * sizeof(wchar_t)));
+            Assert::AreEqual(parent + L"999", store.GetPath(999));
+        }
+    };
+}
@@ -174,6 +174,21 @@ namespace PowerRenameManagerTests
             RenameHelper(renamePairs, ARRAYSIZE(renamePairs), L"foo", L"bar", SYSTEMTIME{ 2020, 7, 3, 22, 15, 6, 42, 453 }, DEFAULT_FLAGS);
         }
 
+        TEST_METHOD (VerifyEnumeratedRenameKeepsItemOrder)
+        {
+            // f1.log keeps its name at index 0, but it is the second item renamed, so it gets index 1. Items are
+            // numbered in order, as if they were renamed one after another
+            rename_pairs renamePairs[] = {
+                { L"f7.txt", L"f1.txt", true, true, 0 },
+                { L"f1.log", L"f2.log", true, true, 0 },
+                { L"f8.txt", L"f3.txt", true, true, 0 },
+                { L"g.txt", L"g_norename.txt", true, false, 0 },
+                { L"f9.txt", L"f4.txt", true, true, 0 }
+            };
+
+            RenameHelper(renamePairs, ARRAYSIZE(renamePairs), L"^f\\d", L"f${start=1}", SYSTEMTIME{ 2020, 7, 3, 22, 15, 6, 42, 453 }, UseRegularExpressions | EnumerateItems);
+        }
+
         TEST_METHOD (VerifyFilesOnlyRename)
         {
             // Verify only files are renamed when folders match too
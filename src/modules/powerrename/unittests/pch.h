@@ -4,4 +4,8 @@
 #include "targetver.h"
 
 #include <atlbase.h>
+#include <chrono>
+#include <format>
+#include <string>
+#include <vector>
 #include "CppUnitTestInclude.h"
\ No newline at end of file
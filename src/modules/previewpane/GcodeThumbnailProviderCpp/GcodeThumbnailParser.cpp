@@ -0,0 +1,348 @@
+#include "pch.h"
+#include "GcodeThumbnailParser.h"
+
+#include <cctype>
+#include <cstring>
+
+namespace
+{
+    // Longer lines aren't expected in a comment header, the file is probably not G-code
+    constexpr size_t maxLineLength = 64 * 1024;
+
+    constexpr uint32_t invalidBase64 = 0x80000000;
+
+    // For each position in a quantum of 4 characters, the value of every character already shifted to its place in
+    // the 24 decoded bits, or invalidBase64. Decoding a quantum then takes 4 lookups and no branches.
+    struct Base64Tables
+    {
+        uint32_t shifted[4][256];
+    };
+
+    constexpr Base64Tables MakeBase64Tables()
+    {
+        constexpr char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+        Base64Tables tables{};
+        for (auto& table : tables.shifted)
+        {
+            for (auto& value : table)
+            {
+                value = invalidBase64;
+            }
+        }
+        for (uint32_t value = 0; value < 64; ++value)
+        {
+            for (uint32_t position = 0; position < 4; ++position)
+            {
+                tables.shifted[position][static_cast<unsigned char>(alphabet[value])] = value << (18 - 6 * position);
+            }
+        }
+        return tables;
+    }
+
+    constexpr Base64Tables base64Tables = MakeBase64Tables();
+
+    uint32_t DecodeQuantum(const unsigned char* text)
+    {
+        return base64Tables.shifted[0][text[0]] | base64Tables.shifted[1][text[1]] | base64Tables.shifted[2][text[2]] | base64Tables.shifted[3][text[3]];
+    }
+
+    GcodeThumbnailFormat ParseFormat(std::string_view suffix)
+    {
+        std::string upper(suffix);
+        for (auto& c : upper)
+        {
+            c = static_cast<char>(toupper(static_cast<unsigned char>(c)));
+        }
+
+        if (upper.empty())
+        {
+            return GcodeThumbnailFormat::PNG;
+        }
+        if (upper == "_JPG")
+        {
+            return GcodeThumbnailFormat::JPG;
+        }
+        if (upper == "_QOI")
+        {
+            return GcodeThumbnailFormat::QOI;
+        }
+        return GcodeThumbnailFormat::Unknown;
+    }
+}
+
+bool DecodeBase64(std::string_view text, std::vector<uint8_t>& output, bool isFinal)
+{
+    if (text.size() % 4 != 0)
+    {
+        return false;
+    }
+
+    size_t padding = 0;
+    if (isFinal && !text.empty())
+    {
+        padding = text[text.size() - 1] != '=' ? 0 : text[text.size() - 2] != '=' ? 1 : 2;
+    }
+
+    const size_t quanta = text.size() / 4 - (padding != 0);
+    const size_t offset = output.size();
+    output.resize(offset + quanta * 3 + (padding != 0 ? 3 - padding : 0));
+
+    auto in = reinterpret_cast<const unsigned char*>(text.data());
+    uint8_t* out = output.data() + offset;
+    uint32_t errors = 0;
+    for (size_t i = 0; i < quanta; ++i, in += 4, out += 3)
+    {
+        const uint32_t bits = DecodeQuantum(in);
+        errors |= bits;
+        out[0] = static_cast<uint8_t>(bits >> 16);
+        out[1] = static_cast<uint8_t>(bits >> 8);
+        out[2] = static_cast<uint8_t>(bits);
+    }
+
+    if (padding != 0)
+    {
+        const unsigned char last[4] = { in[0], in[1], static_cast<unsigned char>(padding == 1 ? in[2] : 'A'), 'A' };
+        const uint32_t bits = DecodeQuantum(last);
+        errors |= bits;
+        out[0] = static_cast<uint8_t>(bits >> 16);
+        if (padding == 1)
+        {
+            out[1] = static_cast<uint8_t>(bits >> 8);
+        }
+    }
+
+    if (errors & invalidBase64)
+    {
+        output.resize(offset);
+        return false;
+    }
+    return true;
+}
+
+bool DecodeQoi(const uint8_t* data, size_t size, uint32_t& width, uint32_t& height, std::vector<uint8_t>& bgra)
+{
+    // Based on https://github.com/phoboslab/qoi/blob/master/qoi.h
+    constexpr size_t headerSize = 14;
+    constexpr size_t paddingSize = 8;
+    // The most pixels a byte encodes, with a run of 62
+    constexpr uint64_t maxPixelsPerByte = 62;
+
+    if (size < headerSize + paddingSize || memcmp(data, "qoif", 4) != 0)
+    {
+        return false;
+    }
+
+    const auto readUInt32BigEndian = [](const uint8_t* bytes) {
+        return (static_cast<uint32_t>(bytes[0]) << 24) | (static_cast<uint32_t>(bytes[1]) << 16) | (static_cast<uint32_t>(bytes[2]) << 8) | bytes[3];
+    };
+    width = readUInt32BigEndian(data + 4);
+    height = readUInt32BigEndian(data + 8);
+    const uint8_t channels = data[12];
+    const uint8_t colorSpace = data[13];
+    if (width == 0 || height == 0 || width > maxQoiDimension || height > maxQoiDimension || channels < 3 || channels > 4 || colorSpace > 1)
+    {
+        return false;
+    }
+
+    // A header claiming more pixels than the chunks can encode would make us allocate for nothing
+    if (static_cast<uint64_t>(width) * height > (size - headerSize - paddingSize) * maxPixelsPerByte)
+    {
+        return false;
+    }
+
+    const size_t pixelCount = static_cast<size_t>(width) * height;
+    bgra.resize(pixelCount * 4);
+
+    uint8_t index[64][4] = {};
+    uint8_t r = 0, g = 0, b = 0, a = 255;
+    size_t run = 0;
+    size_t position = headerSize;
+    const size_t chunksEnd = size - paddingSize;
+    uint8_t* out = bgra.data();
+    for (size_t pixel = 0; pixel < pixelCount; ++pixel, out += 4)
+    {
+        if (run > 0)
+        {
+            --run;
+        }
+        else if (position < chunksEnd)
+        {
+            const uint8_t b1 = data[position++];
+            if (b1 == 0xfe)
+            {
+                r = data[position];
+                g = data[position + 1];
+                b = data[position + 2];
+                position += 3;
+            }
+            else if (b1 == 0xff)
+            {
+                r = data[position];
+                g = data[position + 1];
+                b = data[position + 2];
+                a = data[position + 3];
+                position += 4;
+            }
+            else if ((b1 & 0xc0) == 0x00)
+            {
+                r = index[b1][0];
+                g = index[b1][1];
+                b = index[b1][2];
+                a = index[b1][3];
+            }
+            else if ((b1 & 0xc0) == 0x40)
+            {
+                r = static_cast<uint8_t>(r + ((b1 >> 4) & 0x03) - 2);
+                g = static_cast<uint8_t>(g + ((b1 >> 2) & 0x03) - 2);
+                b = static_cast<uint8_t>(b + (b1 & 0x03) - 2);
+            }
+            else if ((b1 & 0xc0) == 0x80)
+            {
+                const uint8_t b2 = data[position++];
+                const int vg = (b1 & 0x3f) - 32;
+                r = static_cast<uint8_t>(r + vg - 8 + ((b2 >> 4) & 0x0f));
+                g = static_cast<uint8_t>(g + vg);
+                b = static_cast<uint8_t>(b + vg - 8 + (b2 & 0x0f));
+            }
+            else
+            {
+                run = b1 & 0x3f;
+            }
+
+            uint8_t* entry = index[(r * 3 + g * 5 + b * 7 + a * 11) % 64];
+            entry[0] = r;
+            entry[1] = g;
+            entry[2] = b;
+            entry[3] = a;
+        }
+
+        out[0] = b;
+        out[1] = g;
+        out[2] = r;
+        out[3] = a;
+    }
+
+    return true;
+}
+
+bool GcodeThumbnailParser::Feed(const char* data, size_t size)
+{
+    const char* end = data + size;
+    while (!m_done && data < end)
+    {
+        auto newLine = static_cast<const char*>(memchr(data, '\n', end - data));
+        if (!newLine)
+        {
+            m_partialLine.append(data, end);
+            if (m_partialLine.size() > maxLineLength)
+            {
+                m_done = true;
+            }
+            break;
+        }
+
+        if (m_partialLine.empty())
+        {
+            m_done = !ParseLine({ data, static_cast<size_t>(newLine - data) });
+        }
+        else
+        {
+            m_partialLine.append(data, newLine);
+            m_done = !ParseLine(m_partialLine);
+            m_partialLine.clear();
+        }
+        data = newLine + 1;
+    }
+    return !m_done;
+}
+
+std::optional<GcodeThumbnail> GcodeThumbnailParser::GetBestThumbnail()
+{
+    // The last line may not end with a new line
+    if (!m_done && !m_partialLine.empty())
+    {
+        ParseLine(m_partialLine);
+        m_partialLine.clear();
+    }
+    m_done = true;
+
+    return std::move(m_best);
+}
+
+bool GcodeThumbnailParser::ParseLine(std::string_view line)
+{
+    if (!line.empty() && line.back() == '\r')
+    {
+        line.remove_suffix(1);
+    }
+
+    constexpr std::string_view thumbnailPrefix = "; thumbnail";
+    if (line.starts_with(thumbnailPrefix))
+    {
+        // "; thumbnail_QOI begin 128x128 4556", "; thumbnail end", but also "; thumbnails = 128x128"
+        std::string_view rest = line.substr(thumbnailPrefix.size());
+        const size_t formatEnd = rest.find(' ');
+        if (formatEnd != std::string_view::npos)
+        {
+            std::string_view keyword = rest.substr(formatEnd + 1);
+            keyword = keyword.substr(0, keyword.find(' '));
+            if (keyword == "begin")
+            {
+                BeginBlock(rest.substr(0, formatEnd));
+            }
+            else if (keyword == "end")
+            {
+                EndBlock();
+            }
+        }
+        return true;
+    }
+
+    if (m_inBlock)
+    {
+        // Base64 lines start with "; "
+        if (m_blockValid && line.size() > 2)
+        {
+            m_pendingBase64.append(line.substr(2));
+            const size_t count = m_pendingBase64.size() & ~size_t{ 3 };
+            if (count != 0 && m_pendingBase64.find('=') >= count)
+            {
+                m_blockValid = DecodeBase64({ m_pendingBase64.data(), count }, m_block.data, false);
+                m_pendingBase64.erase(0, count);
+            }
+        }
+        return true;
+    }
+
+    // The header ends at the first line that isn't blank or a comment
+    const size_t first = line.find_first_not_of(" \t");
+    return first == std::string_view::npos || line[first] == ';';
+}
+
+void GcodeThumbnailParser::BeginBlock(std::string_view format)
+{
+    m_inBlock = true;
+    m_block.format = ParseFormat(format);
+    m_block.data.clear();
+    m_pendingBase64.clear();
+    m_blockValid = m_block.format != GcodeThumbnailFormat::Unknown;
+}
+
+void GcodeThumbnailParser::EndBlock()
+{
+    if (!m_inBlock)
+    {
+        return;
+    }
+    m_inBlock = false;
+
+    if (m_blockValid && DecodeBase64(m_pendingBase64, m_block.data) && !m_block.data.empty())
+    {
+        if (!m_best || m_block.format > m_best->format || (m_block.format == m_best->format && m_block.data.size() > m_best->data.size()))
+        {
+            m_best = std::move(m_block);
+            m_block = GcodeThumbnail{};
+        }
+    }
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Ordered from the least to the most preferred format, like GcodeThumbnailFormat in FilePreviewCommon
+enum class GcodeThumbnailFormat
+{
+    Unknown,
+    JPG,
+    QOI,
+    PNG,
+};
+
+struct GcodeThumbnail
+{
+    GcodeThumbnailFormat format = GcodeThumbnailFormat::Unknown;
+    std::vector<uint8_t> data;
+};
+
+// Finds the best thumbnail embedded in a G-code file, fed in chunks of any size. Slicers write the thumbnails as
+// base64 blocks between "; thumbnail begin" and "; thumbnail end" lines in the comment header at the start of the
+// file, so parsing stops at the first G-code command and the rest of the file is never read.
+// The best thumbnail is the one with the most preferred format, then the largest one, like GcodeHelper.GetBestThumbnail.
+class GcodeThumbnailParser
+{
+public:
+    // Returns false once the comment header is over, no more data is needed then
+    bool Feed(const char* data, size_t size);
+
+    // Call once all the data was fed, or Feed returned false
+    std::optional<GcodeThumbnail> GetBestThumbnail();
+
+private:
+    bool ParseLine(std::string_view line);
+    void BeginBlock(std::string_view format);
+    void EndBlock();
+
+    bool m_done = false;
+    // Start of a line split between two chunks
+    std::string m_partialLine;
+
+    bool m_inBlock = false;
+    GcodeThumbnail m_block;
+    // Base64 characters of the current block that don't make a full quantum of 4 yet
+    std::string m_pendingBase64;
+    bool m_blockValid = false;
+
+    std::optional<GcodeThumbnail> m_best;
+};
+
+// Decodes base64 text and appends the bytes to output. Returns false if the text isn't valid base64.
+// With isFinal set to false the text must be a multiple of 4 characters long and can't contain padding.
+bool DecodeBase64(std::string_view text, std::vector<uint8_t>& output, bool isFinal = true);
+
+// Larger QOI images are rejected, like the thumbnails larger than MaxThumbnailSize in the .NET provider
+constexpr uint32_t maxQoiDimension = 10000;
+
+// Decodes a QOI image to top-down 32 bits BGRA pixels with straight alpha. Returns false if the image is invalid,
+// larger than maxQoiDimension or has fewer chunks than its size needs.
+bool DecodeQoi(const uint8_t* data, size_t size, uint32_t& width, uint32_t& height, std::vector<uint8_t>& bgra);
@@ -1,25 +1,34 @@
 #include "pch.h"
 #include "GcodeThumbnailProvider.h"
 
+#include <algorithm>
 #include <filesystem>
-#include <fstream>
-#include <shellapi.h>
+#include <new>
 #include <Shlwapi.h>
 #include <string>
+#include <vector>
+#include <wincodec.h>
 
 #include <wil/com.h>
 
-#include <common/utils/process_path.h>
 #include <common/interop/shared_constants.h>
 #include <common/logger/logger.h>
 #include <common/SettingsAPI/settings_helpers.h>
-#include <common/utils/process_path.h>
+#include <common/utils/gpo.h>
+
+#include "GcodeThumbnailParser.h"
+#include "../ThumbnailCache/ThumbnailCache.h"
 
-extern HINSTANCE g_hInst;
 extern long g_cDllRef;
 
+namespace
+{
+    // The maximum dimension (width or height) thumbnail we will generate.
+    constexpr UINT MaxThumbnailSize = 10000;
+}
+
 GcodeThumbnailProvider::GcodeThumbnailProvider() :
-    m_cRef(1), m_pStream(NULL), m_process(NULL)
+    m_cRef(1), m_pStream(NULL)
 {
     std::filesystem::path logFilePath(PTSettingsHelper::get_local_low_folder_location());
     logFilePath.append(LogSettings::gcodeThumbLogPath);
@@ -92,110 +101,207 @@ IFACEMETHODIMP GcodeThumbnailProvider::Initialize(IStream* pStream, DWORD grfMod
 
 IFACEMETHODIMP GcodeThumbnailProvider::GetThumbnail(UINT cx, HBITMAP* phbmp, WTS_ALPHATYPE* pdwAlpha)
 {
-    // Read stream into the buffer
-    char buffer[4096];
-    ULONG cbRead;
-
     Logger::trace(L"Begin");
 
-    GUID guid;
-    if (CoCreateGuid(&guid) == S_OK)
+    *phbmp = NULL;
+    if (cx == 0 || cx > MaxThumbnailSize)
     {
-        wil::unique_cotaskmem_string guidString;
-        if (SUCCEEDED(StringFromCLSID(guid, &guidString)))
-        {
-            Logger::info(L"Read stream and save to tmp file.");
-
-            // {CLSID} -> CLSID
-            std::wstring guid = std::wstring(guidString.get()).substr(1, std::wstring(guidString.get()).size() - 2);
-            std::wstring filePath = PTSettingsHelper::get_local_low_folder_location() + L"\\GCodeThumbnail-Temp\\";
-            if (!std::filesystem::exists(filePath))
-            {
-                std::filesystem::create_directories(filePath);
-            }
-
-            std::wstring fileName = filePath + guid + L".gcode";
-            
-            // Write data to tmp file
-            std::fstream file;
-            file.open(fileName, std::ios_base::out | std::ios_base::binary);
-
-            if (!file.is_open())
-            {
-                return 0;
-            }
-
-            while (true)
-            {
-                auto result = m_pStream->Read(buffer, 4096, &cbRead);
-
-                file.write(buffer, cbRead);
-                if (result == S_FALSE)
-                {               
-                    break;
-                }
-            }
-            file.close();
+        Logger::info(L"Unsupported thumbnail size {}.", cx);
 
+        // ensure releasing the stream
+        if (m_pStream)
+        {
             m_pStream->Release();
             m_pStream = NULL;
-
-            try
-            {
-                Logger::info(L"Start GcodeThumbnailProvider.exe");
-
-                STARTUPINFO info = { sizeof(info) };
-                std::wstring cmdLine{ L"\"" + fileName + L"\"" };
-                cmdLine += L" ";
-                cmdLine += std::to_wstring(cx);
-
-                std::wstring appPath = get_module_folderpath(g_hInst) + L"\\PowerToys.GcodeThumbnailProvider.exe";
-
-                SHELLEXECUTEINFO sei{ sizeof(sei) };
-                sei.fMask = { SEE_MASK_NOCLOSEPROCESS | SEE_MASK_FLAG_NO_UI };
-                sei.lpFile = appPath.c_str();
-                sei.lpParameters = cmdLine.c_str();
-                sei.nShow = SW_SHOWDEFAULT;
-                ShellExecuteEx(&sei);
-                m_process = sei.hProcess;
-                WaitForSingleObject(m_process, INFINITE);
-                std::filesystem::remove(fileName);
-
-
-                std::wstring fileNameBmp = filePath + guid + L".bmp";
-                if (std::filesystem::exists(fileNameBmp))
-                {
-                    *phbmp = static_cast<HBITMAP>(LoadImage(NULL, fileNameBmp.c_str(), IMAGE_BITMAP, 0, 0, LR_LOADFROMFILE));
-                    *pdwAlpha = WTS_ALPHATYPE::WTSAT_ARGB;
-                    std::filesystem::remove(fileNameBmp);
-                }
-                else
-                {
-                    Logger::info(L"Bmp file not generated.");
-                    return E_FAIL;
-                }
-            }
-            catch (std::exception& e)
-            {
-                std::wstring errorMessage = std::wstring{ winrt::to_hstring(e.what()) };
-                Logger::error(L"Failed to start GcodeThumbnailProvider.exe. Error: {}", errorMessage);
-            }
         }
+        return E_FAIL;
     }
 
-    // ensure releasing the stream (not all if branches contain it)
-    if (m_pStream)
+    return ThumbnailCache::GetThumbnail(L"Gcode", powertoys_gpo::getConfiguredGcodeThumbnailsEnabledValue(), m_pStream, cx, phbmp, pdwAlpha, [&] {
+        // No exception may leave the COM method
+        try
+        {
+            return GenerateThumbnail(cx, phbmp, pdwAlpha);
+        }
+        catch (const std::bad_alloc&)
+        {
+            Logger::error(L"Out of memory generating the thumbnail.");
+            return E_OUTOFMEMORY;
+        }
+        catch (...)
+        {
+            Logger::error(L"Failed to generate the thumbnail.");
+            return E_FAIL;
+        }
+    });
+}
+
+#pragma endregion
+
+#pragma region Helper Functions
+
+HRESULT GcodeThumbnailProvider::GenerateThumbnail(UINT cx, HBITMAP* phbmp, WTS_ALPHATYPE* pdwAlpha)
+{
+    HRESULT hr = E_FAIL;
+
+    // Only the comment header at the start of the file is read, the parser tells when it's over.
+    GcodeThumbnailParser parser;
+    std::vector<char> buffer(64 * 1024);
+    ULONG cbRead = 0;
+    HRESULT readResult;
+    do
+    {
+        readResult = m_pStream->Read(buffer.data(), static_cast<ULONG>(buffer.size()), &cbRead);
+    } while (SUCCEEDED(readResult) && parser.Feed(buffer.data(), cbRead) && readResult == S_OK && cbRead > 0);
+
+    auto thumbnail = parser.GetBestThumbnail();
+    if (thumbnail)
     {
-        m_pStream->Release();
-        m_pStream = NULL;
+        hr = CreateThumbnailBitmap(*thumbnail, cx, phbmp);
+        if (SUCCEEDED(hr))
+        {
+            *pdwAlpha = WTS_ALPHATYPE::WTSAT_ARGB;
+        }
+        else
+        {
+            Logger::error(L"Failed to decode the thumbnail. Error: {:#x}", static_cast<unsigned int>(hr));
+        }
+    }
+    else
+    {
+        Logger::info(L"No thumbnail found.");
     }
 
-    return S_OK;
+    return hr;
 }
 
+HRESULT GcodeThumbnailProvider::CreateThumbnailBitmap(const GcodeThumbnail& thumbnail, UINT cx, HBITMAP* phbmp)
+{
+    auto factory = wil::CoCreateInstanceNoThrow<IWICImagingFactory>(CLSID_WICImagingFactory);
+    if (!factory)
+    {
+        return E_FAIL;
+    }
 
-#pragma endregion
+    // PNG and JPG thumbnails are decoded by WIC, QOI ones by DecodeQoi
+    wil::com_ptr_nothrow<IWICBitmapSource> source;
+    HRESULT hr;
+    if (thumbnail.format == GcodeThumbnailFormat::QOI)
+    {
+        uint32_t width = 0;
+        uint32_t height = 0;
+        std::vector<uint8_t> pixels;
+        if (!DecodeQoi(thumbnail.data.data(), thumbnail.data.size(), width, height, pixels))
+        {
+            return E_FAIL;
+        }
 
-#pragma region Helper Functions
+        wil::com_ptr_nothrow<IWICBitmap> bitmap;
+        hr = factory->CreateBitmapFromMemory(width, height, GUID_WICPixelFormat32bppBGRA, width * 4, static_cast<UINT>(pixels.size()), pixels.data(), &bitmap);
+        if (FAILED(hr))
+        {
+            return hr;
+        }
+        source.attach(bitmap.detach());
+    }
+    else
+    {
+        wil::com_ptr_nothrow<IStream> stream;
+        stream.attach(SHCreateMemStream(thumbnail.data.data(), static_cast<UINT>(thumbnail.data.size())));
+        if (!stream)
+        {
+            return E_OUTOFMEMORY;
+        }
+
+        wil::com_ptr_nothrow<IWICBitmapDecoder> decoder;
+        hr = factory->CreateDecoderFromStream(stream.get(), nullptr, WICDecodeMetadataCacheOnDemand, &decoder);
+        if (FAILED(hr))
+        {
+            return hr;
+        }
+
+        wil::com_ptr_nothrow<IWICBitmapFrameDecode> frame;
+        hr = decoder->GetFrame(0, &frame);
+        if (FAILED(hr))
+        {
+            return hr;
+        }
+        source.attach(frame.detach());
+    }
+
+    UINT width = 0;
+    UINT height = 0;
+    hr = source->GetSize(&width, &height);
+    if (FAILED(hr))
+    {
+        return hr;
+    }
+
+    if (width == 0 || height == 0 || width > MaxThumbnailSize || height > MaxThumbnailSize)
+    {
+        Logger::info(L"Unsupported thumbnail image size {}x{}.", width, height);
+        return E_FAIL;
+    }
+
+    if ((width != cx || height > cx) && (height != cx || width > cx))
+    {
+        // We are not the appropriate size for caller. Resize now while respecting the aspect ratio.
+        const float scale = (std::min)(static_cast<float>(cx) / width, static_cast<float>(cx) / height);
+        width = static_cast<UINT>(width * scale);
+        height = static_cast<UINT>(height * scale);
+        if (width == 0 || height == 0)
+        {
+            return E_FAIL;
+        }
+
+        wil::com_ptr_nothrow<IWICBitmapScaler> scaler;
+        hr = factory->CreateBitmapScaler(&scaler);
+        if (SUCCEEDED(hr))
+        {
+            hr = scaler->Initialize(source.get(), width, height, WICBitmapInterpolationModeHighQualityCubic);
+        }
+        if (FAILED(hr))
+        {
+            return hr;
+        }
+        source.attach(scaler.detach());
+    }
+
+    wil::com_ptr_nothrow<IWICFormatConverter> converter;
+    hr = factory->CreateFormatConverter(&converter);
+    if (SUCCEEDED(hr))
+    {
+        hr = converter->Initialize(source.get(), GUID_WICPixelFormat32bppBGRA, WICBitmapDitherTypeNone, nullptr, 0.0, WICBitmapPaletteTypeCustom);
+    }
+    if (FAILED(hr))
+    {
+        return hr;
+    }
+
+    BITMAPINFO bmi = {};
+    bmi.bmiHeader.biSize = sizeof(bmi.bmiHeader);
+    bmi.bmiHeader.biWidth = width;
+    bmi.bmiHeader.biHeight = -static_cast<LONG>(height); // top-down
+    bmi.bmiHeader.biPlanes = 1;
+    bmi.bmiHeader.biBitCount = 32;
+    bmi.bmiHeader.biCompression = BI_RGB;
+
+    void* bits = nullptr;
+    HBITMAP bitmap = CreateDIBSection(nullptr, &bmi, DIB_RGB_COLORS, &bits, nullptr, 0);
+    if (!bitmap)
+    {
+        return E_OUTOFMEMORY;
+    }
+
+    hr = converter->CopyPixels(nullptr, width * 4, width * height * 4, static_cast<BYTE*>(bits));
+    if (FAILED(hr))
+    {
+        DeleteObject(bitmap);
+        return hr;
+    }
+
+    *phbmp = bitmap;
+    return S_OK;
+}
 
 #pragma endregion
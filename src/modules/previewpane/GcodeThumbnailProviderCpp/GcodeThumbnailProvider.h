@@ -6,6 +6,8 @@
 #include <string>
 #include <thumbcache.h>
 
+struct GcodeThumbnail;
+
 class GcodeThumbnailProvider :
     public IInitializeWithStream,
     public IThumbnailProvider
@@ -33,5 +35,9 @@ private:
     // Provided during initialization.
     IStream* m_pStream;
 
-    HANDLE m_process;
+    // Reads the comment header of the stream and decodes the best thumbnail in it
+    HRESULT GenerateThumbnail(UINT cx, HBITMAP* phbmp, WTS_ALPHATYPE* pdwAlpha);
+
+    // Decodes the thumbnail and scales it to fit in cx x cx pixels
+    static HRESULT CreateThumbnailBitmap(const GcodeThumbnail& thumbnail, UINT cx, HBITMAP* phbmp);
 };
\ No newline at end of file
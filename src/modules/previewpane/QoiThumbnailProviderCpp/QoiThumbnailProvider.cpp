@@ -13,8 +13,11 @@
 #include <common/interop/shared_constants.h>
 #include <common/logger/logger.h>
 #include <common/SettingsAPI/settings_helpers.h>
+#include <common/utils/gpo.h>
 #include <common/utils/process_path.h>
 
+#include "../ThumbnailCache/ThumbnailCache.h"
+
 extern HINSTANCE g_hInst;
 extern long g_cDllRef;
 
@@ -91,6 +94,15 @@ IFACEMETHODIMP QoiThumbnailProvider::Initialize(IStream* pStream, DWORD grfMode)
 #pragma region IThumbnailProvider
 
 IFACEMETHODIMP QoiThumbnailProvider::GetThumbnail(UINT cx, HBITMAP* phbmp, WTS_ALPHATYPE* pdwAlpha)
+{
+    *phbmp = NULL;
+
+    return ThumbnailCache::GetThumbnail(L"Qoi", powertoys_gpo::getConfiguredQoiThumbnailsEnabledValue(), m_pStream, cx, phbmp, pdwAlpha, [&] {
+        return GenerateThumbnail(cx, phbmp, pdwAlpha);
+    });
+}
+
+HRESULT QoiThumbnailProvider::GenerateThumbnail(UINT cx, HBITMAP* phbmp, WTS_ALPHATYPE* pdwAlpha)
 {
     // Read stream into the buffer
     char buffer[4096];
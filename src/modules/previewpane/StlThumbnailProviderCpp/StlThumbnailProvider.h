@@ -34,4 +34,7 @@ private:
     IStream* m_pStream;
 
     HANDLE m_process;
+
+    // Runs the .NET thumbnail provider on a copy of the stream
+    HRESULT GenerateThumbnail(UINT cx, HBITMAP* phbmp, WTS_ALPHATYPE* pdwAlpha);
 };
\ No newline at end of file
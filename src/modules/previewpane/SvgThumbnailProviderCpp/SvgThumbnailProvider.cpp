@@ -12,8 +12,11 @@
 #include <common/interop/shared_constants.h>
 #include <common/logger/logger.h>
 #include <common/SettingsAPI/settings_helpers.h>
+#include <common/utils/gpo.h>
 #include <common/utils/process_path.h>
 
+#include "../ThumbnailCache/ThumbnailCache.h"
+
 extern HINSTANCE g_hInst;
 extern long g_cDllRef;
 
@@ -90,6 +93,15 @@ IFACEMETHODIMP SvgThumbnailProvider::Initialize(IStream* pStream, DWORD grfMode)
 #pragma region IThumbnailProvider
 
 IFACEMETHODIMP SvgThumbnailProvider::GetThumbnail(UINT cx, HBITMAP* phbmp, WTS_ALPHATYPE* pdwAlpha)
+{
+    *phbmp = NULL;
+
+    return ThumbnailCache::GetThumbnail(L"Svg", powertoys_gpo::getConfiguredSvgThumbnailsEnabledValue(), m_pStream, cx, phbmp, pdwAlpha, [&] {
+        return GenerateThumbnail(cx, phbmp, pdwAlpha);
+    });
+}
+
+HRESULT SvgThumbnailProvider::GenerateThumbnail(UINT cx, HBITMAP* phbmp, WTS_ALPHATYPE* pdwAlpha)
 {
     // Read stream into the buffer
     char buffer[4096];
@@ -0,0 +1,354 @@
+#include "pch.h"
+#include "ThumbnailCache.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <wil/resource.h>
+
+#include <common/logger/logger.h>
+#include <common/SettingsAPI/settings_helpers.h>
+
+#include "ThumbnailCacheStore.h"
+
+namespace
+{
+    // Room for about 250 thumbnails of 256 x 256 pixels
+    constexpr DWORD cacheFileSize = 64 * 1024 * 1024;
+    constexpr wchar_t cacheFilePath[] = L"\\ThumbnailCache\\thumbnails.cache";
+    constexpr wchar_t cacheMutexName[] = L"Local\\PowerToysThumbnailCacheMutex";
+
+    // Don't make Explorer wait for the cache when another process holds it for too long
+    constexpr DWORD lockTimeoutMs = 1000;
+
+    // Bytes of the start and of the end of the stream in its key
+    constexpr ULONG sampleSize = 64 * 1024;
+
+    // A failed read or write of a page of the mapping raises an exception, e.g. when the disk is full.
+    // This function can't hold objects with destructors because of __try.
+    template<typename Callback>
+    bool CallHandlingPageErrors(Callback& callback)
+    {
+        __try
+        {
+            callback();
+            return true;
+        }
+        __except (GetExceptionCode() == EXCEPTION_IN_PAGE_ERROR ? EXCEPTION_EXECUTE_HANDLER : EXCEPTION_CONTINUE_SEARCH)
+        {
+            return false;
+        }
+    }
+
+    class CacheFile
+    {
+    public:
+        // Returns nullptr if the cache can't be used
+        static CacheFile* Get()
+        {
+            static std::unique_ptr<CacheFile> cacheFile = Open();
+            return cacheFile.get();
+        }
+
+        // Calls callback with the store while holding the lock shared by all the processes using the cache.
+        // Returns false if the lock couldn't be taken or the file can't be accessed anymore.
+        template<typename Callback>
+        bool Use(Callback&& callback)
+        {
+            if (m_failed)
+            {
+                return false;
+            }
+
+            const DWORD status = WaitForSingleObject(m_mutex.get(), lockTimeoutMs);
+            if (status != WAIT_OBJECT_0 && status != WAIT_ABANDONED)
+            {
+                return false;
+            }
+            auto unlock = wil::scope_exit([this] { ReleaseMutex(m_mutex.get()); });
+
+            auto call = [&] {
+                if (!m_store)
+                {
+                    m_store = std::make_unique<ThumbnailCacheStore>(m_view.get(), cacheFileSize);
+                }
+                else if (status == WAIT_ABANDONED)
+                {
+                    // A process died while writing to the file, the records this process indexed may be torn
+                    Logger::warn(L"The thumbnail cache lock was abandoned, rebuilding the index");
+                    m_store->Recover();
+                }
+                callback(*m_store);
+            };
+            if (!CallHandlingPageErrors(call))
+            {
+                Logger::error(L"Failed to access the thumbnail cache file");
+                m_failed = true;
+            }
+            return !m_failed;
+        }
+
+    private:
+        wil::unique_hfile m_file;
+        wil::unique_handle m_mapping;
+        wil::unique_mapview_ptr<uint8_t> m_view;
+        wil::unique_handle m_mutex;
+        std::unique_ptr<ThumbnailCacheStore> m_store;
+        bool m_failed = false;
+
+        static std::unique_ptr<CacheFile> Open()
+        {
+            std::filesystem::path path(PTSettingsHelper::get_local_low_folder_location() + cacheFilePath);
+            std::error_code error;
+            std::filesystem::create_directories(path.parent_path(), error);
+
+            auto cacheFile = std::make_unique<CacheFile>();
+            cacheFile->m_file.reset(CreateFileW(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr));
+            if (!cacheFile->m_file)
+            {
+                Logger::error(L"Failed to open the thumbnail cache file. Error: {}", GetLastError());
+                return nullptr;
+            }
+
+            // Grows a new file to its full size
+            cacheFile->m_mapping.reset(CreateFileMappingW(cacheFile->m_file.get(), nullptr, PAGE_READWRITE, 0, cacheFileSize, nullptr));
+            if (cacheFile->m_mapping)
+            {
+                cacheFile->m_view.reset(static_cast<uint8_t*>(MapViewOfFile(cacheFile->m_mapping.get(), FILE_MAP_READ | FILE_MAP_WRITE, 0, 0, cacheFileSize)));
+            }
+            cacheFile->m_mutex.reset(CreateMutexW(nullptr, FALSE, cacheMutexName));
+            if (!cacheFile->m_view || !cacheFile->m_mutex)
+            {
+                Logger::error(L"Failed to map the thumbnail cache file. Error: {}", GetLastError());
+                return nullptr;
+            }
+            return cacheFile;
+        }
+    };
+
+    bool ReadFully(IStream* stream, uint8_t* buffer, ULONG size, ULONG& bytesRead)
+    {
+        bytesRead = 0;
+        while (bytesRead < size)
+        {
+            ULONG count = 0;
+            if (FAILED(stream->Read(buffer + bytesRead, size - bytesRead, &count)))
+            {
+                return false;
+            }
+            if (count == 0)
+            {
+                break;
+            }
+            bytesRead += count;
+        }
+        return true;
+    }
+
+    std::optional<uint64_t> ComputeKey(const wchar_t* provider, IStream* stream, UINT cx)
+    {
+        STATSTG stat{};
+        if (!stream || FAILED(stream->Stat(&stat, STATFLAG_NONAME)))
+        {
+            return std::nullopt;
+        }
+
+        const uint64_t size = stat.cbSize.QuadPart;
+        const uint64_t properties[] = { size, (static_cast<uint64_t>(stat.mtime.dwHighDateTime) << 32) | stat.mtime.dwLowDateTime, cx };
+        uint64_t hash = HashThumbnailData(provider, wcslen(provider) * sizeof(wchar_t), 0);
+        hash = HashThumbnailData(properties, sizeof(properties), hash);
+
+        std::vector<uint8_t> sample(sampleSize);
+        const auto hashSample = [&](uint64_t offset) {
+            LARGE_INTEGER position;
+            position.QuadPart = static_cast<LONGLONG>(offset);
+            ULONG bytesRead;
+            if (FAILED(stream->Seek(position, STREAM_SEEK_SET, nullptr)) || !ReadFully(stream, sample.data(), sampleSize, bytesRead))
+            {
+                return false;
+            }
+            hash = HashThumbnailData(sample.data(), bytesRead, hash);
+            return true;
+        };
+        const bool hashed = hashSample(0) && (size <= 2 * sampleSize || hashSample(size - sampleSize));
+
+        // The provider reads the stream from its start
+        LARGE_INTEGER start{};
+        if (FAILED(stream->Seek(start, STREAM_SEEK_SET, nullptr)) || !hashed)
+        {
+            return std::nullopt;
+        }
+        return hash;
+    }
+
+    BITMAPINFO MakeBitmapInfo(uint32_t width, uint32_t height)
+    {
+        BITMAPINFO info{};
+        info.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+        info.bmiHeader.biWidth = static_cast<LONG>(width);
+        // Top-down
+        info.bmiHeader.biHeight = -static_cast<LONG>(height);
+        info.bmiHeader.biPlanes = 1;
+        info.bmiHeader.biBitCount = 32;
+        info.bmiHeader.biCompression = BI_RGB;
+        return info;
+    }
+
+    bool GetBitmapPixels(HBITMAP hbmp, uint32_t& width, uint32_t& height, std::vector<uint8_t>& pixels)
+    {
+        BITMAP bitmap{};
+        if (!GetObject(hbmp, sizeof(bitmap), &bitmap) || bitmap.bmWidth <= 0 || bitmap.bmHeight == 0)
+        {
+            return false;
+        }
+
+        width = static_cast<uint32_t>(bitmap.bmWidth);
+        height = static_cast<uint32_t>(std::abs(bitmap.bmHeight));
+        pixels.resize(static_cast<size_t>(width) * height * 4);
+
+        BITMAPINFO info = MakeBitmapInfo(width, height);
+        HDC dc = GetDC(nullptr);
+        const int lines = GetDIBits(dc, hbmp, 0, height, pixels.data(), &info, DIB_RGB_COLORS);
+        ReleaseDC(nullptr, dc);
+        return lines == static_cast<int>(height);
+    }
+
+    HBITMAP CreateBitmap(const ThumbnailCacheStore::Thumbnail& thumbnail)
+    {
+        BITMAPINFO info = MakeBitmapInfo(thumbnail.width, thumbnail.height);
+        void* bits = nullptr;
+        HBITMAP bitmap = CreateDIBSection(nullptr, &info, DIB_RGB_COLORS, &bits, nullptr, 0);
+        if (bitmap)
+        {
+            memcpy(bits, thumbnail.pixels, static_cast<size_t>(thumbnail.width) * thumbnail.height * 4);
+        }
+        return bitmap;
+    }
+
+    uint64_t MicrosecondsSince(std::chrono::steady_clock::time_point start)
+    {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+    }
+
+    // Looks up the thumbnail of a stream in the cache, and caches the thumbnail generated on a miss
+    class CachedThumbnail
+    {
+    public:
+        // Leaves the stream at its start. The stream isn't cached if it can't be read or seeked
+        CachedThumbnail(const wchar_t* provider, IStream* stream, UINT cx);
+
+        bool TryGet(HBITMAP* phbmp, WTS_ALPHATYPE* pdwAlpha);
+
+        // Call with the result of the thumbnail generation after a miss
+        void Store(HRESULT hr, HBITMAP hbmp, WTS_ALPHATYPE alpha);
+
+    private:
+        std::optional<uint64_t> m_key;
+        std::chrono::steady_clock::time_point m_start;
+    };
+
+    CachedThumbnail::CachedThumbnail(const wchar_t* provider, IStream* stream, UINT cx) :
+        m_start(std::chrono::steady_clock::now())
+    {
+        if (CacheFile::Get())
+        {
+            m_key = ComputeKey(provider, stream, cx);
+        }
+    }
+
+    bool CachedThumbnail::TryGet(HBITMAP* phbmp, WTS_ALPHATYPE* pdwAlpha)
+    {
+        if (!m_key)
+        {
+            return false;
+        }
+
+        HBITMAP bitmap = nullptr;
+        WTS_ALPHATYPE alpha = WTSAT_UNKNOWN;
+        ThumbnailCacheStats stats;
+        CacheFile::Get()->Use([&](ThumbnailCacheStore& store) {
+            ThumbnailCacheStore::Thumbnail thumbnail;
+            if (store.Find(*m_key, thumbnail))
+            {
+                bitmap = CreateBitmap(thumbnail);
+                alpha = static_cast<WTS_ALPHATYPE>(thumbnail.alphaType);
+            }
+            if (bitmap)
+            {
+                store.RecordHit(MicrosecondsSince(m_start));
+                stats = store.GetStats();
+            }
+        });
+        if (!bitmap)
+        {
+            return false;
+        }
+
+        Logger::trace(L"Thumbnail cache hit in {} us. {} hits in {} us, {} misses in {} us", MicrosecondsSince(m_start), stats.hits, stats.hitMicroseconds, stats.misses, stats.missMicroseconds);
+        *phbmp = bitmap;
+        *pdwAlpha = alpha;
+        return true;
+    }
+
+    void CachedThumbnail::Store(HRESULT hr, HBITMAP hbmp, WTS_ALPHATYPE alpha)
+    {
+        if (!m_key)
+        {
+            return;
+        }
+
+        const uint64_t elapsed = MicrosecondsSince(m_start);
+        uint32_t width = 0;
+        uint32_t height = 0;
+        std::vector<uint8_t> pixels;
+        const bool generated = SUCCEEDED(hr) && hbmp && GetBitmapPixels(hbmp, width, height, pixels);
+
+        ThumbnailCacheStats stats;
+        CacheFile::Get()->Use([&](ThumbnailCacheStore& store) {
+            store.RecordMiss(elapsed);
+            if (generated)
+            {
+                store.Add(*m_key, width, height, alpha, pixels.data());
+            }
+            stats = store.GetStats();
+        });
+        Logger::trace(L"Thumbnail cache miss, generated in {} us. {} hits in {} us, {} misses in {} us", elapsed, stats.hits, stats.hitMicroseconds, stats.misses, stats.missMicroseconds);
+    }
+}
+
+HRESULT ThumbnailCache::GetThumbnail(const wchar_t* provider, powertoys_gpo::gpo_rule_configured_t policy, IStream*& stream, UINT cx, HBITMAP* phbmp, WTS_ALPHATYPE* pdwAlpha, const std::function<HRESULT()>& generate)
+{
+    HRESULT hr = E_FAIL;
+    if (policy == powertoys_gpo::gpo_rule_configured_disabled)
+    {
+        // Checked before the cache, which may hold thumbnails generated before the policy was set
+        Logger::info(L"{} thumbnails are disabled by GPO.", provider);
+    }
+    else
+    {
+        CachedThumbnail cachedThumbnail(provider, stream, cx);
+        if (cachedThumbnail.TryGet(phbmp, pdwAlpha))
+        {
+            hr = S_OK;
+        }
+        else
+        {
+            hr = generate();
+            // The alpha type is only set when the thumbnail was generated
+            cachedThumbnail.Store(hr, *phbmp, SUCCEEDED(hr) ? *pdwAlpha : WTSAT_UNKNOWN);
+        }
+    }
+
+    if (stream)
+    {
+        stream->Release();
+        stream = nullptr;
+    }
+
+    return hr;
+}
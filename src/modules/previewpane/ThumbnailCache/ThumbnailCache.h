@@ -0,0 +1,18 @@
+#pragma once
+
+#include <Windows.h>
+#include <functional>
+#include <thumbcache.h>
+
+#include <common/utils/gpo.h>
+
+// Thumbnails generated by the thumbnail providers are cached in a file in the LocalLow folder shared by all of them,
+// so thumbnails survive the providers' processes.
+// The key is a hash of the size, modification time and first and last 64 KB of the stream, with the provider and cx.
+namespace ThumbnailCache
+{
+    // Returns the cached thumbnail of the stream, or calls generate on a miss and caches the thumbnail it generated.
+    // generate reads the stream from its start. Nothing is returned when the provider is disabled by GPO, even if
+    // its thumbnails were cached before. The stream is released in any case.
+    HRESULT GetThumbnail(const wchar_t* provider, powertoys_gpo::gpo_rule_configured_t policy, IStream*& stream, UINT cx, HBITMAP* phbmp, WTS_ALPHATYPE* pdwAlpha, const std::function<HRESULT()>& generate);
+}
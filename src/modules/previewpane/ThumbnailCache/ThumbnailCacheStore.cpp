@@ -0,0 +1,360 @@
+#include "pch.h"
+#include "ThumbnailCacheStore.h"
+
+#include <cstring>
+
+namespace
+{
+    constexpr uint32_t fileMagic = 0x43485450; // "PTHC"
+    constexpr uint32_t fileVersion = 1;
+    constexpr uint32_t recordMagic = 0x44434552; // "RECD"
+    // Written where the free space at the end of the ring is too small for the next record
+    constexpr uint32_t wrapMagic = 0x50415257; // "WRAP"
+
+    constexpr uint64_t recordAlignment = 64;
+    constexpr uint64_t invalidPosition = UINT64_MAX;
+
+    constexpr uint64_t prime1 = 11400714785074694791ULL;
+    constexpr uint64_t prime2 = 14029467366897019727ULL;
+    constexpr uint64_t prime3 = 1609587929392839161ULL;
+    constexpr uint64_t prime4 = 9650029242287828579ULL;
+    constexpr uint64_t prime5 = 2870177450012600261ULL;
+
+    uint64_t RotateLeft(uint64_t value, int bits)
+    {
+        return (value << bits) | (value >> (64 - bits));
+    }
+
+    uint64_t Read64(const uint8_t* data)
+    {
+        uint64_t value;
+        memcpy(&value, data, sizeof(value));
+        return value;
+    }
+
+    uint32_t Read32(const uint8_t* data)
+    {
+        uint32_t value;
+        memcpy(&value, data, sizeof(value));
+        return value;
+    }
+
+    uint64_t Round(uint64_t accumulator, uint64_t input)
+    {
+        accumulator += input * prime2;
+        accumulator = RotateLeft(accumulator, 31);
+        return accumulator * prime1;
+    }
+
+    uint64_t Merge(uint64_t accumulator, uint64_t value)
+    {
+        accumulator ^= Round(0, value);
+        return accumulator * prime1 + prime4;
+    }
+
+    uint64_t AlignUp(uint64_t value)
+    {
+        return (value + recordAlignment - 1) & ~(recordAlignment - 1);
+    }
+}
+
+uint64_t HashThumbnailData(const void* data, size_t size, uint64_t seed)
+{
+    auto bytes = static_cast<const uint8_t*>(data);
+    const uint8_t* end = bytes + size;
+
+    uint64_t hash;
+    if (size >= 32)
+    {
+        uint64_t v1 = seed + prime1 + prime2;
+        uint64_t v2 = seed + prime2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - prime1;
+        for (; end - bytes >= 32; bytes += 32)
+        {
+            v1 = Round(v1, Read64(bytes));
+            v2 = Round(v2, Read64(bytes + 8));
+            v3 = Round(v3, Read64(bytes + 16));
+            v4 = Round(v4, Read64(bytes + 24));
+        }
+        hash = RotateLeft(v1, 1) + RotateLeft(v2, 7) + RotateLeft(v3, 12) + RotateLeft(v4, 18);
+        hash = Merge(hash, v1);
+        hash = Merge(hash, v2);
+        hash = Merge(hash, v3);
+        hash = Merge(hash, v4);
+    }
+    else
+    {
+        hash = seed + prime5;
+    }
+
+    hash += size;
+    for (; end - bytes >= 8; bytes += 8)
+    {
+        hash ^= Round(0, Read64(bytes));
+        hash = RotateLeft(hash, 27) * prime1 + prime4;
+    }
+    if (end - bytes >= 4)
+    {
+        hash ^= Read32(bytes) * prime1;
+        hash = RotateLeft(hash, 23) * prime2 + prime3;
+        bytes += 4;
+    }
+    for (; bytes < end; ++bytes)
+    {
+        hash ^= *bytes * prime5;
+        hash = RotateLeft(hash, 11) * prime1;
+    }
+
+    hash ^= hash >> 33;
+    hash *= prime2;
+    hash ^= hash >> 29;
+    hash *= prime3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+struct ThumbnailCacheStore::FileHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t capacity;
+    // Logical position of the next record
+    uint64_t head;
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t hitMicroseconds;
+    uint64_t missMicroseconds;
+};
+
+struct ThumbnailCacheStore::RecordHeader
+{
+    uint32_t magic;
+    // Low bits of the hash of the rest of the header and of the pixels
+    uint32_t checksum;
+    uint64_t position;
+    uint64_t key;
+    uint32_t width;
+    uint32_t height;
+    uint32_t alphaType;
+    uint32_t reserved;
+
+    uint64_t PixelsSize() const
+    {
+        return static_cast<uint64_t>(width) * height * 4;
+    }
+
+    const uint8_t* Pixels() const
+    {
+        return reinterpret_cast<const uint8_t*>(this + 1);
+    }
+
+    uint32_t ComputeChecksum() const
+    {
+        const uint64_t hash = HashThumbnailData(&position, sizeof(RecordHeader) - offsetof(RecordHeader, position), 0);
+        return static_cast<uint32_t>(HashThumbnailData(Pixels(), PixelsSize(), hash));
+    }
+};
+
+ThumbnailCacheStore::ThumbnailCacheStore(uint8_t* view, size_t viewSize) :
+    m_header(reinterpret_cast<FileHeader*>(view)),
+    m_data(view + headerSize),
+    m_capacity((viewSize - headerSize) & ~(recordAlignment - 1))
+{
+    static_assert(sizeof(FileHeader) <= headerSize);
+    static_assert(sizeof(RecordHeader) <= recordAlignment);
+
+    ValidateHeader();
+}
+
+bool ThumbnailCacheStore::Find(uint64_t key, Thumbnail& thumbnail)
+{
+    Sync();
+
+    auto it = m_index.find(key);
+    if (it == m_index.end())
+    {
+        return false;
+    }
+
+    uint64_t position = it->second;
+    const RecordHeader* record = RecordAt(position);
+    // Another process may have overwritten the record, or died while doing so
+    uint64_t size;
+    if (!IsLive(position) || !IsRecordAt(position, size) || record->key != key)
+    {
+        m_index.erase(it);
+        return false;
+    }
+
+    // Copy the record to the head if it's getting close to be overwritten. The copy may overwrite the record itself
+    if (m_header->head - position > m_capacity / 2)
+    {
+        const size_t size = sizeof(RecordHeader) + record->PixelsSize();
+        m_scratch.assign(reinterpret_cast<const uint8_t*>(record), reinterpret_cast<const uint8_t*>(record) + size);
+        const auto copy = reinterpret_cast<const RecordHeader*>(m_scratch.data());
+        position = Append(key, copy->width, copy->height, copy->alphaType, copy->Pixels());
+        record = RecordAt(position);
+    }
+
+    thumbnail.width = record->width;
+    thumbnail.height = record->height;
+    thumbnail.alphaType = record->alphaType;
+    thumbnail.pixels = record->Pixels();
+    return true;
+}
+
+bool ThumbnailCacheStore::Add(uint64_t key, uint32_t width, uint32_t height, uint32_t alphaType, const uint8_t* pixels)
+{
+    Sync();
+    return Append(key, width, height, alphaType, pixels) != invalidPosition;
+}
+
+void ThumbnailCacheStore::Recover()
+{
+    ValidateHeader();
+    m_indexed = false;
+}
+
+void ThumbnailCacheStore::RecordHit(uint64_t microseconds)
+{
+    ++m_header->hits;
+    m_header->hitMicroseconds += microseconds;
+}
+
+void ThumbnailCacheStore::RecordMiss(uint64_t microseconds)
+{
+    ++m_header->misses;
+    m_header->missMicroseconds += microseconds;
+}
+
+ThumbnailCacheStats ThumbnailCacheStore::GetStats() const
+{
+    return { m_header->hits, m_header->misses, m_header->hitMicroseconds, m_header->missMicroseconds };
+}
+
+void ThumbnailCacheStore::ValidateHeader()
+{
+    if (m_header->magic != fileMagic || m_header->version != fileVersion || m_header->capacity != m_capacity)
+    {
+        *m_header = FileHeader{ fileMagic, fileVersion, m_capacity };
+    }
+}
+
+// Indexes the records written by other processes since the last call
+void ThumbnailCacheStore::Sync()
+{
+    const uint64_t head = m_header->head;
+    if (!m_indexed || head < m_indexedHead || head - m_indexedHead > m_capacity)
+    {
+        m_index.clear();
+        m_indexedHead = FindFirstRecord(head);
+        m_prunedHead = head;
+        m_indexed = true;
+    }
+
+    for (uint64_t position = m_indexedHead; position < head;)
+    {
+        const uint64_t offset = position % m_capacity;
+        if (m_capacity - offset < sizeof(RecordHeader) || RecordAt(position)->magic == wrapMagic)
+        {
+            position += m_capacity - offset;
+            continue;
+        }
+
+        uint64_t size;
+        if (!IsRecordAt(position, size))
+        {
+            // Can't tell where the next record starts, the rest is lost
+            break;
+        }
+        m_index[RecordAt(position)->key] = position;
+        position += size;
+    }
+    m_indexedHead = head;
+
+    // Forget the overwritten records once per turn of the ring
+    if (head - m_prunedHead > m_capacity)
+    {
+        std::erase_if(m_index, [this](const auto& entry) { return !IsLive(entry.second); });
+        m_prunedHead = head;
+    }
+}
+
+// The oldest record that wasn't overwritten. Its start isn't known, so it's searched at every aligned position.
+uint64_t ThumbnailCacheStore::FindFirstRecord(uint64_t head) const
+{
+    uint64_t size;
+    for (uint64_t position = AlignUp(head > m_capacity ? head - m_capacity : 0); position < head; position += recordAlignment)
+    {
+        if (IsRecordAt(position, size))
+        {
+            return position;
+        }
+    }
+    return head;
+}
+
+bool ThumbnailCacheStore::IsRecordAt(uint64_t position, uint64_t& size) const
+{
+    const uint64_t available = m_capacity - position % m_capacity;
+    if (available < sizeof(RecordHeader))
+    {
+        return false;
+    }
+
+    const RecordHeader* record = RecordAt(position);
+    if (record->magic != recordMagic || record->position != position || record->PixelsSize() > available - sizeof(RecordHeader))
+    {
+        return false;
+    }
+
+    size = AlignUp(sizeof(RecordHeader) + record->PixelsSize());
+    return record->checksum == record->ComputeChecksum();
+}
+
+// Whether the record at the position wasn't overwritten since it was written
+bool ThumbnailCacheStore::IsLive(uint64_t position) const
+{
+    return m_header->head <= position + m_capacity;
+}
+
+uint64_t ThumbnailCacheStore::Append(uint64_t key, uint32_t width, uint32_t height, uint32_t alphaType, const uint8_t* pixels)
+{
+    const uint64_t pixelsSize = static_cast<uint64_t>(width) * height * 4;
+    const uint64_t size = AlignUp(sizeof(RecordHeader) + pixelsSize);
+    if (width == 0 || height == 0 || size > m_capacity / 4)
+    {
+        return invalidPosition;
+    }
+
+    uint64_t position = m_header->head;
+    const uint64_t offset = position % m_capacity;
+    if (offset + size > m_capacity)
+    {
+        auto marker = reinterpret_cast<RecordHeader*>(m_data + offset);
+        marker->magic = wrapMagic;
+        position += m_capacity - offset;
+    }
+
+    auto record = reinterpret_cast<RecordHeader*>(m_data + position % m_capacity);
+    record->magic = recordMagic;
+    record->position = position;
+    record->key = key;
+    record->width = width;
+    record->height = height;
+    record->alphaType = alphaType;
+    record->reserved = 0;
+    memmove(record + 1, pixels, pixelsSize);
+    record->checksum = record->ComputeChecksum();
+
+    m_header->head = position + size;
+    m_indexedHead = m_header->head;
+    m_index[key] = position;
+    return position;
+}
+
+const ThumbnailCacheStore::RecordHeader* ThumbnailCacheStore::RecordAt(uint64_t position) const
+{
+    return reinterpret_cast<const RecordHeader*>(m_data + position % m_capacity);
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// XXH64 of the bytes, see https://github.com/Cyan4973/xxHash/blob/dev/doc/xxhash_spec.md
+uint64_t HashThumbnailData(const void* data, size_t size, uint64_t seed);
+
+struct ThumbnailCacheStats
+{
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    // Total time spent serving hits, and generating the thumbnails of misses
+    uint64_t hitMicroseconds = 0;
+    uint64_t missMicroseconds = 0;
+};
+
+// Thumbnails stored in a memory-mapped file used as a ring: records are appended after the previous one and wrap to
+// the start of the file at its end, overwriting the oldest records first. A record found in the older half of the
+// ring is appended again, so the thumbnails still in use stay cached like with an LRU.
+// The head of the ring only moves past a record once it's complete, so a crash while writing loses that record and
+// nothing else. Records are checksummed, as the pages of the mapping may not all reach the disk.
+// The file is shared between processes: every call must be made while holding a lock shared by all of them.
+class ThumbnailCacheStore
+{
+public:
+    // Pixels are 32 bits BGRA, top-down
+    struct Thumbnail
+    {
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint32_t alphaType = 0;
+        // Points into the mapping, valid until the lock is released
+        const uint8_t* pixels = nullptr;
+    };
+
+    // Space taken by the header of the file. The thumbnails are stored in the rest of the view
+    static constexpr size_t headerSize = 4096;
+
+    // The view is initialized when it doesn't hold a cache yet, or one in another format
+    ThumbnailCacheStore(uint8_t* view, size_t viewSize);
+
+    // Only returns records whose checksum matches
+    bool Find(uint64_t key, Thumbnail& thumbnail);
+
+    // Returns false if the thumbnail is too large to be cached
+    bool Add(uint64_t key, uint32_t width, uint32_t height, uint32_t alphaType, const uint8_t* pixels);
+
+    // Call after taking a lock abandoned by a process that died holding it. The records it was writing are dropped
+    // and the index is rebuilt from the file.
+    void Recover();
+
+    void RecordHit(uint64_t microseconds);
+    void RecordMiss(uint64_t microseconds);
+
+    // Counters of all the processes using the file
+    ThumbnailCacheStats GetStats() const;
+
+private:
+    struct FileHeader;
+    struct RecordHeader;
+
+    FileHeader* m_header;
+    uint8_t* m_data;
+    uint64_t m_capacity;
+
+    // Logical position of the last record written for every key found in the ring. Positions only grow, the offset of
+    // a record in the file is its position modulo the capacity.
+    std::unordered_map<uint64_t, uint64_t> m_index;
+    // The records before this position are in the index, the ones after were written by other processes since
+    bool m_indexed = false;
+    uint64_t m_indexedHead = 0;
+    uint64_t m_prunedHead = 0;
+
+    std::vector<uint8_t> m_scratch;
+
+    void ValidateHeader();
+    void Sync();
+    uint64_t FindFirstRecord(uint64_t head) const;
+    bool IsRecordAt(uint64_t position, uint64_t& size) const;
+    bool IsLive(uint64_t position) const;
+    uint64_t Append(uint64_t key, uint32_t width, uint32_t height, uint32_t alphaType, const uint8_t* pixels);
+    const RecordHeader* RecordAt(uint64_t position) const;
+};
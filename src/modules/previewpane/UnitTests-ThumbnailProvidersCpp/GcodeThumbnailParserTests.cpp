@@ -0,0 +1,265 @@
+#include "pch.h"
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <GcodeThumbnailProviderCpp/GcodeThumbnailParser.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace GcodeThumbnailParserTests
+{
+    std::vector<uint8_t> Bytes(std::string_view text)
+    {
+        return { text.begin(), text.end() };
+    }
+
+    void AppendUInt32BigEndian(std::vector<uint8_t>& data, uint32_t value)
+    {
+        data.push_back(static_cast<uint8_t>(value >> 24));
+        data.push_back(static_cast<uint8_t>(value >> 16));
+        data.push_back(static_cast<uint8_t>(value >> 8));
+        data.push_back(static_cast<uint8_t>(value));
+    }
+
+    std::vector<uint8_t> QoiImage(uint32_t width, uint32_t height, const std::vector<uint8_t>& chunks)
+    {
+        std::vector<uint8_t> data = Bytes("qoif");
+        AppendUInt32BigEndian(data, width);
+        AppendUInt32BigEndian(data, height);
+        data.push_back(4); // RGBA
+        data.push_back(0); // sRGB
+        data.insert(data.end(), chunks.begin(), chunks.end());
+        data.insert(data.end(), { 0, 0, 0, 0, 0, 0, 0, 1 });
+        return data;
+    }
+
+    std::optional<GcodeThumbnail> Parse(std::string_view gcode, size_t chunkSize)
+    {
+        GcodeThumbnailParser parser;
+        for (size_t i = 0; i < gcode.size(); i += chunkSize)
+        {
+            const auto chunk = gcode.substr(i, chunkSize);
+            if (!parser.Feed(chunk.data(), chunk.size()))
+            {
+                break;
+            }
+        }
+        return parser.GetBestThumbnail();
+    }
+
+    TEST_CLASS (Base64Tests)
+    {
+    public:
+        TEST_METHOD (DecodesText)
+        {
+            std::vector<uint8_t> output;
+            Assert::IsTrue(DecodeBase64("TWFueSBoYW5kcw==", output));
+            Assert::IsTrue(Bytes("Many hands") == output);
+        }
+
+        TEST_METHOD (DecodesPadding)
+        {
+            std::vector<uint8_t> output;
+            Assert::IsTrue(DecodeBase64("TWE=", output));
+            Assert::IsTrue(Bytes("Ma") == output);
+
+            output.clear();
+            Assert::IsTrue(DecodeBase64("TQ==", output));
+            Assert::IsTrue(Bytes("M") == output);
+
+            output.clear();
+            Assert::IsTrue(DecodeBase64("", output));
+            Assert::IsTrue(output.empty());
+        }
+
+        TEST_METHOD (AppendsToOutput)
+        {
+            std::vector<uint8_t> output = Bytes("Ma");
+            Assert::IsTrue(DecodeBase64("bnkg", output, false));
+            Assert::IsTrue(DecodeBase64("aGFuZHM=", output));
+            Assert::IsTrue(Bytes("Many hands") == output);
+        }
+
+        TEST_METHOD (RejectsInvalidText)
+        {
+            std::vector<uint8_t> output = Bytes("kept");
+            Assert::IsFalse(DecodeBase64("TW!u", output));
+            Assert::IsFalse(DecodeBase64("TWF", output));
+            // Padding only ends the last chunk
+            Assert::IsFalse(DecodeBase64("TWE=", output, false));
+            Assert::IsTrue(Bytes("kept") == output);
+        }
+    };
+
+    TEST_CLASS (QoiTests)
+    {
+    public:
+        TEST_METHOD (DecodesChunks)
+        {
+            const auto image = QoiImage(4, 1, {
+                                                  0xff, 10, 20, 30, 255, // RGBA
+                                                  0xc0 | 1, // run of 2
+                                                  0xfe, 40, 50, 60, // RGB, keeps the alpha
+                                              });
+
+            uint32_t width = 0;
+            uint32_t height = 0;
+            std::vector<uint8_t> bgra;
+            Assert::IsTrue(DecodeQoi(image.data(), image.size(), width, height, bgra));
+            Assert::AreEqual(4u, width);
+            Assert::AreEqual(1u, height);
+
+            const std::vector<uint8_t> expected = { 30, 20, 10, 255, 30, 20, 10, 255, 30, 20, 10, 255, 60, 50, 40, 255 };
+            Assert::IsTrue(expected == bgra);
+        }
+
+        TEST_METHOD (RejectsInvalidHeaders)
+        {
+            uint32_t width = 0;
+            uint32_t height = 0;
+            std::vector<uint8_t> bgra;
+
+            auto image = QoiImage(1, 1, { 0xfe, 1, 2, 3 });
+            image[0] = 'x';
+            Assert::IsFalse(DecodeQoi(image.data(), image.size(), width, height, bgra));
+
+            image = QoiImage(0, 1, { 0xfe, 1, 2, 3 });
+            Assert::IsFalse(DecodeQoi(image.data(), image.size(), width, height, bgra));
+
+            image = QoiImage(1, 1, { 0xfe, 1, 2, 3 });
+            Assert::IsFalse(DecodeQoi(image.data(), 14, width, height, bgra));
+        }
+
+        TEST_METHOD (RejectsTooLargeImages)
+        {
+            uint32_t width = 0;
+            uint32_t height = 0;
+            std::vector<uint8_t> bgra;
+
+            // Enough runs for every pixel, only the size is wrong
+            const std::vector<uint8_t> runs((maxQoiDimension + 1) / 62 + 1, 0xc0 | 61);
+            auto image = QoiImage(maxQoiDimension + 1, 1, runs);
+            Assert::IsFalse(DecodeQoi(image.data(), image.size(), width, height, bgra));
+
+            image = QoiImage(maxQoiDimension, 1, runs);
+            Assert::IsTrue(DecodeQoi(image.data(), image.size(), width, height, bgra));
+        }
+
+        TEST_METHOD (RejectsSizesLargerThanThePayload)
+        {
+            uint32_t width = 0;
+            uint32_t height = 0;
+            std::vector<uint8_t> bgra;
+
+            // 1 chunk encodes 62 pixels at most
+            auto image = QoiImage(63, 1, { 0xc0 | 61 });
+            Assert::IsFalse(DecodeQoi(image.data(), image.size(), width, height, bgra));
+
+            image = QoiImage(maxQoiDimension, maxQoiDimension, { 0xc0 | 61 });
+            Assert::IsFalse(DecodeQoi(image.data(), image.size(), width, height, bgra));
+            Assert::IsTrue(bgra.empty());
+
+            image = QoiImage(62, 1, { 0xc0 | 61 });
+            Assert::IsTrue(DecodeQoi(image.data(), image.size(), width, height, bgra));
+        }
+    };
+
+    TEST_CLASS (GcodeThumbnailParserTests)
+    {
+    public:
+        // "Many hands" and "Mary" in base64, split across lines like slicers do
+        static constexpr std::string_view gcode =
+            "; generated by a slicer\r\n"
+            "\r\n"
+            "; thumbnail begin 16x16 16\r\n"
+            "; TWFueSBo\r\n"
+            "; YW5kcw==\r\n"
+            "; thumbnail end\r\n"
+            "; thumbnails = 16x16/PNG\r\n"
+            "; thumbnail_QOI begin 32x32 8\r\n"
+            "; TWFyeQ==\r\n"
+            "; thumbnail_QOI end\r\n"
+            "G28 ; home\r\n"
+            "; thumbnail begin 64x64 12\r\n"
+            "; TWFueSBoYW5kcyBtYWtl\r\n"
+            "; thumbnail end\r\n";
+
+        TEST_METHOD (FindsThePreferredThumbnail)
+        {
+            const auto thumbnail = Parse(gcode, gcode.size());
+            Assert::IsTrue(thumbnail.has_value());
+            Assert::IsTrue(thumbnail->format == GcodeThumbnailFormat::PNG);
+            Assert::IsTrue(Bytes("Many hands") == thumbnail->data);
+        }
+
+        TEST_METHOD (ParsesChunksOfAnySize)
+        {
+            constexpr size_t chunkSizes[] = { 1, 2, 3, 7, 64 };
+            for (const size_t chunkSize : chunkSizes)
+            {
+                const auto thumbnail = Parse(gcode, chunkSize);
+                Assert::IsTrue(thumbnail.has_value());
+                Assert::IsTrue(Bytes("Many hands") == thumbnail->data);
+            }
+        }
+
+        TEST_METHOD (StopsAtTheFirstCommand)
+        {
+            GcodeThumbnailParser parser;
+            const std::string_view header = "; comment\n";
+            Assert::IsTrue(parser.Feed(header.data(), header.size()));
+
+            const std::string_view command = "G28\n; thumbnail begin 16x16 4\n; TWFu\n; thumbnail end\n";
+            Assert::IsFalse(parser.Feed(command.data(), command.size()));
+            Assert::IsFalse(parser.GetBestThumbnail().has_value());
+        }
+
+        TEST_METHOD (PrefersTheLargestThumbnailOfAFormat)
+        {
+            const std::string_view pngs =
+                "; thumbnail begin 16x16 4\n"
+                "; TWFu\n"
+                "; thumbnail end\n"
+                "; thumbnail begin 32x32 8\n"
+                "; TWFueSBo\n"
+                "; thumbnail end\n"
+                "; thumbnail begin 8x8 4\n"
+                "; TWFy\n"
+                "; thumbnail end";
+
+            const auto thumbnail = Parse(pngs, pngs.size());
+            Assert::IsTrue(thumbnail.has_value());
+            Assert::IsTrue(Bytes("Many h") == thumbnail->data);
+        }
+
+        TEST_METHOD (SkipsInvalidBlocks)
+        {
+            const std::string_view blocks =
+                "; thumbnail_BMP begin 16x16 16\n"
+                "; TWFueSBoYW5kcw==\n"
+                "; thumbnail_BMP end\n"
+                "; thumbnail begin 16x16 8\n"
+                "; TW!uTWFu\n"
+                "; thumbnail end\n"
+                "; thumbnail_JPG begin 16x16 4\n"
+                "; TWFu\n"
+                "; thumbnail_JPG end\n"
+                "; thumbnail begin 16x16 4\n"
+                "; TWFu\n";
+
+            // The unknown format, the invalid base64 and the unterminated block are ignored
+            const auto thumbnail = Parse(blocks, blocks.size());
+            Assert::IsTrue(thumbnail.has_value());
+            Assert::IsTrue(thumbnail->format == GcodeThumbnailFormat::JPG);
+            Assert::IsTrue(Bytes("Man") == thumbnail->data);
+        }
+
+        TEST_METHOD (FindsNoThumbnail)
+        {
+            const std::string_view noThumbnail = "; generated by a slicer\nG28\n";
+            Assert::IsFalse(Parse(noThumbnail, noThumbnail.size()).has_value());
+        }
+    };
+}
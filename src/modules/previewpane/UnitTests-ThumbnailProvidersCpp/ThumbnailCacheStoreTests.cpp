@@ -0,0 +1,189 @@
+#include "pch.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include <ThumbnailCache/ThumbnailCacheStore.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace ThumbnailCacheStoreTests
+{
+    constexpr uint32_t width = 32;
+    constexpr uint32_t height = 32;
+    // Room for 15 thumbnails of 32 x 32 pixels, the 16th wraps to the start
+    constexpr size_t viewSize = ThumbnailCacheStore::headerSize + 64 * 1024;
+
+    // Random, so that the pixels of a thumbnail can be found in the view
+    std::vector<uint8_t> MakePixels(uint64_t key)
+    {
+        std::mt19937 random(static_cast<uint32_t>(key));
+        std::vector<uint8_t> pixels(width * height * 4);
+        std::generate(pixels.begin(), pixels.end(), [&] { return static_cast<uint8_t>(random()); });
+        return pixels;
+    }
+
+    void Add(ThumbnailCacheStore& store, uint64_t key)
+    {
+        Assert::IsTrue(store.Add(key, width, height, 2, MakePixels(key).data()));
+    }
+
+    bool IsCached(ThumbnailCacheStore& store, uint64_t key)
+    {
+        ThumbnailCacheStore::Thumbnail thumbnail;
+        if (!store.Find(key, thumbnail))
+        {
+            return false;
+        }
+
+        const auto pixels = MakePixels(key);
+        Assert::AreEqual(width, thumbnail.width);
+        Assert::AreEqual(height, thumbnail.height);
+        Assert::AreEqual(2u, thumbnail.alphaType);
+        Assert::IsTrue(std::equal(pixels.begin(), pixels.end(), thumbnail.pixels));
+        return true;
+    }
+
+    // Flips a byte in the middle of the pixels of the thumbnail, like a write that didn't reach the disk
+    void Corrupt(std::vector<uint8_t>& view, uint64_t key)
+    {
+        const auto pixels = MakePixels(key);
+        auto it = std::search(view.begin() + ThumbnailCacheStore::headerSize, view.end(), pixels.begin(), pixels.end());
+        Assert::IsTrue(it != view.end());
+        it[pixels.size() / 2] ^= 0xFF;
+    }
+
+    TEST_CLASS (ThumbnailCacheStoreTests)
+    {
+    public:
+        TEST_METHOD (FindsAddedThumbnails)
+        {
+            std::vector<uint8_t> view(viewSize);
+            ThumbnailCacheStore store(view.data(), view.size());
+            Add(store, 1);
+            Add(store, 2);
+
+            Assert::IsTrue(IsCached(store, 1));
+            Assert::IsTrue(IsCached(store, 2));
+            Assert::IsFalse(IsCached(store, 3));
+        }
+
+        TEST_METHOD (RejectsTooLargeThumbnails)
+        {
+            std::vector<uint8_t> view(viewSize);
+            ThumbnailCacheStore store(view.data(), view.size());
+            std::vector<uint8_t> pixels(256 * 256 * 4);
+
+            Assert::IsFalse(store.Add(1, 256, 256, 2, pixels.data()));
+            Assert::IsFalse(store.Add(2, 0, 0, 2, pixels.data()));
+        }
+
+        TEST_METHOD (WrapsAroundAndEvictsOldest)
+        {
+            std::vector<uint8_t> view(viewSize);
+            ThumbnailCacheStore store(view.data(), view.size());
+            for (uint64_t key = 0; key < 40; key++)
+            {
+                Add(store, key);
+            }
+
+            for (uint64_t key = 0; key < 20; key++)
+            {
+                Assert::IsFalse(IsCached(store, key));
+            }
+            for (uint64_t key = 30; key < 40; key++)
+            {
+                Assert::IsTrue(IsCached(store, key));
+            }
+        }
+
+        TEST_METHOD (KeepsUsedThumbnails)
+        {
+            std::vector<uint8_t> view(viewSize);
+            ThumbnailCacheStore store(view.data(), view.size());
+            for (uint64_t key = 0; key < 60; key++)
+            {
+                Add(store, key);
+                // Copied to the head of the ring whenever it gets close to be overwritten
+                Assert::IsTrue(IsCached(store, 0));
+            }
+
+            Assert::IsFalse(IsCached(store, 1));
+        }
+
+        TEST_METHOD (RebuildsIndexFromFile)
+        {
+            std::vector<uint8_t> view(viewSize);
+            ThumbnailCacheStore writer(view.data(), view.size());
+            for (uint64_t key = 0; key < 20; key++)
+            {
+                Add(writer, key);
+            }
+
+            // Like another process opening the file, after the ring wrapped
+            ThumbnailCacheStore reader(view.data(), view.size());
+            for (uint64_t key = 10; key < 20; key++)
+            {
+                Assert::IsTrue(IsCached(reader, key));
+            }
+            Assert::IsFalse(IsCached(reader, 0));
+
+            // And the thumbnails added by the other process since then
+            Add(writer, 20);
+            Assert::IsTrue(IsCached(reader, 20));
+        }
+
+        TEST_METHOD (RejectsCorruptedRecords)
+        {
+            std::vector<uint8_t> view(viewSize);
+            ThumbnailCacheStore store(view.data(), view.size());
+            Add(store, 1);
+            Add(store, 2);
+            Add(store, 3);
+
+            Corrupt(view, 2);
+            Assert::IsFalse(IsCached(store, 2));
+            Assert::IsTrue(IsCached(store, 1));
+            Assert::IsTrue(IsCached(store, 3));
+
+            ThumbnailCacheStore reader(view.data(), view.size());
+            Assert::IsFalse(IsCached(reader, 2));
+            Assert::IsTrue(IsCached(reader, 1));
+        }
+
+        TEST_METHOD (RecoversFromTornRecords)
+        {
+            std::vector<uint8_t> view(viewSize);
+            ThumbnailCacheStore store(view.data(), view.size());
+            for (uint64_t key = 0; key < 20; key++)
+            {
+                Add(store, key);
+            }
+
+            // A process dying while overwriting the oldest record leaves it torn
+            Corrupt(view, 5);
+            store.Recover();
+
+            Assert::IsFalse(IsCached(store, 5));
+            for (uint64_t key = 6; key < 20; key++)
+            {
+                Assert::IsTrue(IsCached(store, key));
+            }
+        }
+
+        TEST_METHOD (RecoverResetsInvalidHeader)
+        {
+            std::vector<uint8_t> view(viewSize);
+            ThumbnailCacheStore store(view.data(), view.size());
+            Add(store, 1);
+
+            std::fill(view.begin(), view.begin() + 16, static_cast<uint8_t>(0xCD));
+            store.Recover();
+
+            Assert::IsFalse(IsCached(store, 1));
+            Add(store, 2);
+            Assert::IsTrue(IsCached(store, 2));
+        }
+    };
+}
@@ -0,0 +1,124 @@
+#include "pch.h"
+
+#include <initializer_list>
+#include <string>
+
+#include <hotkey_table.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace CentralizedKeyboardHook;
+
+namespace HotkeyTableTests
+{
+    constexpr DWORD KeyA = 'A';
+    constexpr DWORD KeyB = 'B';
+
+    // Builds the table the way the hook publishes it, with the slot of each hotkey being its position in the list
+    HotkeyTable MakeTable(std::initializer_list<Hotkey> hotkeys)
+    {
+        HotkeyTable table;
+        for (const auto& hotkey : hotkeys)
+        {
+            table.keys[hotkey.key] = true;
+            table.actions.push_back([] { return true; });
+            table.slots[HotkeyTable::Index(hotkey)] = static_cast<uint16_t>(table.actions.size());
+        }
+        return table;
+    }
+
+    // Stands in for the keyboard state, counting how often it's polled
+    struct KeyboardState
+    {
+        Hotkey modifiers;
+        int polls = 0;
+
+        auto Poller()
+        {
+            return [this](DWORD vkCode) {
+                polls++;
+                Hotkey hotkey = modifiers;
+                hotkey.key = static_cast<unsigned char>(vkCode);
+                return hotkey;
+            };
+        }
+    };
+
+    TEST_CLASS (HotkeyTableTests)
+    {
+    public:
+        TEST_METHOD (FindsHotkeyOfTrackedModifiers)
+        {
+            const auto table = MakeTable({ Hotkey{ .key = KeyA }, Hotkey{ .ctrl = true, .key = KeyA }, Hotkey{ .win = true, .shift = true, .key = KeyA } });
+            TrackedKeys trackedKeys;
+            KeyboardState keyboard;
+
+            Assert::AreEqual<uint16_t>(1, FindHotkeySlot(table, trackedKeys, KeyA, keyboard.Poller()));
+
+            trackedKeys.Update(VK_LCONTROL, true);
+            keyboard.modifiers.ctrl = true;
+            Assert::AreEqual<uint16_t>(2, FindHotkeySlot(table, trackedKeys, KeyA, keyboard.Poller()));
+
+            trackedKeys.Update(VK_LCONTROL, false);
+            trackedKeys.Update(VK_RWIN, true);
+            trackedKeys.Update(VK_RSHIFT, true);
+            keyboard.modifiers = Hotkey{ .win = true, .shift = true };
+            Assert::AreEqual<uint16_t>(3, FindHotkeySlot(table, trackedKeys, KeyA, keyboard.Poller()));
+        }
+
+        TEST_METHOD (DoesNotPollKeysWithoutHotkey)
+        {
+            const auto table = MakeTable({ Hotkey{ .ctrl = true, .key = KeyA } });
+            TrackedKeys trackedKeys;
+            KeyboardState keyboard;
+            keyboard.modifiers.ctrl = true;
+
+            trackedKeys.Update(VK_LCONTROL, true);
+            Assert::AreEqual<uint16_t>(0, FindHotkeySlot(table, trackedKeys, KeyB, keyboard.Poller()));
+            Assert::AreEqual(0, keyboard.polls);
+        }
+
+        TEST_METHOD (FindsHotkeyWhenModifierKeyDownWasMissed)
+        {
+            // Only the bare key is tracked, since another hook swallowed the key down of Ctrl
+            const auto table = MakeTable({ Hotkey{ .ctrl = true, .key = KeyA } });
+            TrackedKeys trackedKeys;
+            KeyboardState keyboard;
+            keyboard.modifiers.ctrl = true;
+
+            Assert::AreEqual<uint16_t>(1, FindHotkeySlot(table, trackedKeys, KeyA, keyboard.Poller()));
+            Assert::AreEqual(1, keyboard.polls);
+        }
+
+        TEST_METHOD (FindsHotkeyWhenModifierKeyDownWasMissedWithBareKeyHotkey)
+        {
+            // The bare key has a hotkey of its own, which must not hide the one with the missed modifier
+            const auto table = MakeTable({ Hotkey{ .key = KeyA }, Hotkey{ .alt = true, .key = KeyA } });
+            TrackedKeys trackedKeys;
+            KeyboardState keyboard;
+            keyboard.modifiers.alt = true;
+
+            Assert::AreEqual<uint16_t>(2, FindHotkeySlot(table, trackedKeys, KeyA, keyboard.Poller()));
+        }
+
+        TEST_METHOD (ForgetsModifierWhenKeyUpWasMissed)
+        {
+            const auto table = MakeTable({ Hotkey{ .key = KeyA }, Hotkey{ .ctrl = true, .shift = true, .key = KeyA } });
+            TrackedKeys trackedKeys;
+            KeyboardState keyboard;
+            keyboard.modifiers.shift = true;
+
+            // The key up of Ctrl was missed
+            trackedKeys.Update(VK_LCONTROL, true);
+            trackedKeys.Update(VK_LSHIFT, true);
+            Assert::AreEqual<uint16_t>(0, FindHotkeySlot(table, trackedKeys, KeyA, keyboard.Poller()));
+
+            const Hotkey tracked = trackedKeys.GetHotkey(KeyA);
+            Assert::IsFalse(tracked.ctrl);
+            Assert::IsTrue(tracked.shift);
+
+            keyboard.modifiers.shift = false;
+            trackedKeys.Update(VK_LSHIFT, false);
+            Assert::AreEqual<uint16_t>(1, FindHotkeySlot(table, trackedKeys, KeyA, keyboard.Poller()));
+        }
+    };
+}
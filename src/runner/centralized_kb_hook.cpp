@@ -1,10 +1,13 @@
 #include "pch.h"
 #include "centralized_kb_hook.h"
+#include "hotkey_table.h"
 #include <common/debug_control.h>
 #include <common/utils/winapi_error.h>
 #include <common/logger/logger.h>
 #include <common/interop/shared_constants.h>
 
+#include <atomic>
+
 namespace CentralizedKeyboardHook
 {
     struct HotkeyDescriptor
@@ -23,6 +26,16 @@ namespace CentralizedKeyboardHook
     std::mutex mutex;
     HHOOK hHook{};
 
+    // The published snapshot and the ones it replaced, owned under the lock of hotkeyDescriptors. Replaced snapshots
+    // are freed once no hook proc is reading a snapshot, which is checked after publishing.
+    std::atomic<const HotkeyTable*> hotkeyTable;
+    std::atomic<int> hotkeyTableReaders;
+    std::unique_ptr<HotkeyTable> publishedHotkeyTable;
+    std::vector<std::unique_ptr<HotkeyTable>> replacedHotkeyTables;
+
+    // Only accessed on the hook thread
+    TrackedKeys trackedKeys;
+
     // To store information about handling pressed keys.
     struct PressedKeyDescriptor
     {
@@ -55,6 +68,63 @@ namespace CentralizedKeyboardHook
         }
     } destroyOnExitObj;
 
+    // Counts a hook proc reading the hotkey table for its lifetime
+    struct HotkeyTableReader
+    {
+        HotkeyTableReader()
+        {
+            hotkeyTableReaders++;
+        }
+
+        ~HotkeyTableReader()
+        {
+            hotkeyTableReaders--;
+        }
+    };
+
+    // Builds and publishes the hotkey table from hotkeyDescriptors. Must be called with the lock held
+    void PublishHotkeyTable()
+    {
+        auto table = std::make_unique<HotkeyTable>();
+        for (const auto& descriptor : hotkeyDescriptors)
+        {
+            // Keep the first action registered for a hotkey, as the lookup in the multiset did
+            table->keys[descriptor.hotkey.key] = true;
+            auto& slot = table->slots[HotkeyTable::Index(descriptor.hotkey)];
+            if (slot == 0)
+            {
+                table->actions.push_back(descriptor.action);
+                slot = static_cast<uint16_t>(table->actions.size());
+            }
+        }
+
+        if (publishedHotkeyTable)
+        {
+            replacedHotkeyTables.push_back(std::move(publishedHotkeyTable));
+        }
+        publishedHotkeyTable = std::move(table);
+        hotkeyTable = publishedHotkeyTable.get();
+
+        // A hook proc that starts from now on only sees the new table. This is also false while a hotkey action
+        // registers hotkeys from within the hook proc, in which case the replaced tables are freed on a later change.
+        if (hotkeyTableReaders == 0)
+        {
+            replacedHotkeyTables.clear();
+        }
+    }
+
+    // Returns the hotkey of the key press from the keyboard state
+    Hotkey GetPolledHotkey(const DWORD vkCode)
+    {
+        return Hotkey{
+            .win = (GetAsyncKeyState(VK_LWIN) & 0x8000) || (GetAsyncKeyState(VK_RWIN) & 0x8000),
+            .ctrl = static_cast<bool>(GetAsyncKeyState(VK_CONTROL) & 0x8000),
+            .shift = static_cast<bool>(GetAsyncKeyState(VK_SHIFT) & 0x8000),
+            .alt = static_cast<bool>(GetAsyncKeyState(VK_MENU) & 0x8000),
+            .key = static_cast<unsigned char>(vkCode)
+        };
+    }
+
     // Handle the pressed key proc
     void PressedKeyTimerProc(
         HWND hwnd,
@@ -62,19 +132,22 @@ namespace CentralizedKeyboardHook
         UINT_PTR idTimer,
         DWORD /*dwTime*/)
     {
-        std::multiset<PressedKeyDescriptor> copy;
+        std::vector<std::function<bool()>> actions;
         {
-            // Make a copy, to look for the action to call.
+            // Copy the actions of this timer, to call them outside of the lock.
             std::unique_lock lock{ pressedKeyMutex };
-            copy = pressedKeyDescriptors;
-        }
-        for (const auto& it : copy)
-        {
-            if (it.idTimer == idTimer)
+            for (const auto& it : pressedKeyDescriptors)
             {
-                it.action();
+                if (it.idTimer == idTimer)
+                {
+                    actions.push_back(it.action);
+                }
             }
         }
+        for (const auto& action : actions)
+        {
+            action();
+        }
 
         KillTimer(hwnd, idTimer);
     }
@@ -88,6 +161,9 @@ namespace CentralizedKeyboardHook
 
         const auto& keyPressInfo = *reinterpret_cast<KBDLLHOOKSTRUCT*>(lParam);
 
+        // Keys sent by our actions change the keyboard state too, so track them before passing them along
+        trackedKeys.Update(keyPressInfo.vkCode, wParam == WM_KEYDOWN || wParam == WM_SYSKEYDOWN);
+
         if (keyPressInfo.dwExtraInfo == PowertoyModuleIface::CENTRALIZED_KEYBOARD_HOOK_DONT_TRIGGER_FLAG)
         {
             // The new keystroke was generated from one of our actions. We should pass it along.
@@ -143,34 +219,22 @@ namespace CentralizedKeyboardHook
             return CallNextHookEx(hHook, nCode, wParam, lParam);
         }
 
-        Hotkey hotkey{
-            .win = (GetAsyncKeyState(VK_LWIN) & 0x8000) || (GetAsyncKeyState(VK_RWIN) & 0x8000),
-            .ctrl = static_cast<bool>(GetAsyncKeyState(VK_CONTROL) & 0x8000),
-            .shift = static_cast<bool>(GetAsyncKeyState(VK_SHIFT) & 0x8000),
-            .alt = static_cast<bool>(GetAsyncKeyState(VK_MENU) & 0x8000),
-            .key = static_cast<unsigned char>(keyPressInfo.vkCode)
-        };
-
-        if (hotkey == Hotkey{})
+        if (keyPressInfo.vkCode == 0)
         {
             return CallNextHookEx(hHook, nCode, wParam, lParam);
         }
 
-        std::function<bool()> action;
+        HotkeyTableReader reader;
+        const HotkeyTable* table = hotkeyTable;
+        if (!table)
         {
-            // Hold the lock for the shortest possible duration
-            std::unique_lock lock{ mutex };
-            HotkeyDescriptor dummy{ .hotkey = hotkey };
-            auto it = hotkeyDescriptors.find(dummy);
-            if (it != hotkeyDescriptors.end())
-            {
-                action = it->action;
-            }
+            return CallNextHookEx(hHook, nCode, wParam, lParam);
         }
 
-        if (action)
+        const uint16_t slot = FindHotkeySlot(*table, trackedKeys, keyPressInfo.vkCode, GetPolledHotkey);
+        if (slot != 0)
         {
-            if (action())
+            if (table->actions[slot - 1]())
             {
                 // After invoking the hotkey send a dummy key to prevent Start Menu from activating
                 INPUT dummyEvent[1] = {};
@@ -192,6 +256,7 @@ namespace CentralizedKeyboardHook
         Logger::trace(L"Register hotkey action for {}", moduleName);
         std::unique_lock lock{ mutex };
         hotkeyDescriptors.insert({ .hotkey = hotkey, .moduleName = moduleName, .action = std::move(action) });
+        PublishHotkeyTable();
     }
 
     void AddPressedKeyAction(const std::wstring& moduleName, const DWORD vk, const UINT milliseconds, std::function<bool()>&& action) noexcept
@@ -222,6 +287,7 @@ namespace CentralizedKeyboardHook
                     ++it;
                 }
             }
+            PublishHotkeyTable();
         }
         {
             std::unique_lock lock{ pressedKeyMutex };
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <vector>
+
+#include "../modules/interface/powertoy_module_interface.h"
+
+namespace CentralizedKeyboardHook
+{
+    using Hotkey = PowertoyModuleIface::Hotkey;
+
+    // Immutable snapshot of the registered hotkeys, indexed by modifiers and key. The hook reads the current snapshot
+    // without locking, and registration changes publish a new one.
+    struct HotkeyTable
+    {
+        static size_t Index(const Hotkey& hotkey)
+        {
+            return (hotkey.win | hotkey.ctrl << 1 | hotkey.shift << 2 | hotkey.alt << 3) << 8 | hotkey.key;
+        }
+
+        // Index in actions + 1, or 0 if nothing is registered for the hotkey
+        std::array<uint16_t, 16 * 256> slots{};
+        std::vector<std::function<bool()>> actions;
+
+        // Keys used by a hotkey with any modifiers
+        std::bitset<256> keys;
+    };
+
+    // Keys held down, tracked from the events the hook receives instead of polling the keyboard state on each key press
+    class TrackedKeys
+    {
+    public:
+        void Update(const DWORD vkCode, const bool isDown)
+        {
+            if (vkCode < keysDown.size())
+            {
+                keysDown[vkCode] = isDown;
+            }
+        }
+
+        // Returns the hotkey of the key press from the tracked key states
+        Hotkey GetHotkey(const DWORD vkCode) const
+        {
+            return Hotkey{
+                .win = keysDown[VK_LWIN] || keysDown[VK_RWIN],
+                .ctrl = keysDown[VK_CONTROL] || keysDown[VK_LCONTROL] || keysDown[VK_RCONTROL],
+                .shift = keysDown[VK_SHIFT] || keysDown[VK_LSHIFT] || keysDown[VK_RSHIFT],
+                .alt = keysDown[VK_MENU] || keysDown[VK_LMENU] || keysDown[VK_RMENU],
+                .key = static_cast<unsigned char>(vkCode)
+            };
+        }
+
+        // Clears the tracked modifier keys which are not down in the polled hotkey
+        void ForgetReleasedModifiers(const Hotkey& polledHotkey)
+        {
+            const auto forget = [this](bool isDown, std::initializer_list<int> keys) {
+                for (const int key : keys)
+                {
+                    keysDown[key] = keysDown[key] && isDown;
+                }
+            };
+            forget(polledHotkey.win, { VK_LWIN, VK_RWIN });
+            forget(polledHotkey.ctrl, { VK_CONTROL, VK_LCONTROL, VK_RCONTROL });
+            forget(polledHotkey.shift, { VK_SHIFT, VK_LSHIFT, VK_RSHIFT });
+            forget(polledHotkey.alt, { VK_MENU, VK_LMENU, VK_RMENU });
+        }
+
+    private:
+        std::bitset<256> keysDown;
+    };
+
+    // Returns the slot of the hotkey of the key press, or 0 if no hotkey is registered for it.
+    // A modifier key event can be missed, for example if another hook swallowed it, so the modifiers are confirmed by
+    // polling the keyboard state whenever the key is used by a hotkey. Keys which aren't used by a hotkey are never polled.
+    template<typename PollHotkey>
+    uint16_t FindHotkeySlot(const HotkeyTable& table, TrackedKeys& trackedKeys, const DWORD vkCode, PollHotkey&& pollHotkey)
+    {
+        const Hotkey hotkey = trackedKeys.GetHotkey(vkCode);
+        if (!table.keys[hotkey.key])
+        {
+            return 0;
+        }
+
+        const Hotkey polledHotkey = pollHotkey(vkCode);
+        if (polledHotkey != hotkey)
+        {
+            trackedKeys.ForgetReleasedModifiers(polledHotkey);
+        }
+        return table.slots[HotkeyTable::Index(polledHotkey)];
+    }
+}